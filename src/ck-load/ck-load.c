@@ -25,6 +25,7 @@
 #include <unistd.h>
 #include <limits.h>
 #include <math.h>
+#include <time.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
@@ -36,9 +37,18 @@
 #include <Dt/WmSettings.h>
 
 #include "vertical_meter.h"
+#include "core_strip.h"
+#include "history_graph.h"
+#include "load_history.h"
+#include "../shared/config_utils.h"
+#include "../shared/procfs/procfs.h"
+#include "../shared/procfs/stat_shm.h"
 #include "../shared/session_utils.h"
+#include "../shared/tool_utils.h"
 
-#define NUM_METERS 6
+#define NUM_METERS 9
+/* Meters shown when the kernel has no PSI (CONFIG_PSI off or psi=0). */
+#define NUM_BASE_METERS 6
 
 enum {
     METER_CPU = 0,
@@ -46,15 +56,32 @@ enum {
     METER_SWAP,
     METER_LOAD1,
     METER_LOAD5,
-    METER_LOAD15
+    METER_LOAD15,
+    METER_PSI_CPU,
+    METER_PSI_MEMORY,
+    METER_PSI_IO
 };
 
+/* Form units per meter column */
+#define COLUMN_UNITS 10
+/* Per-core mode: one meter per core up to CORE_METER_MAX cores, one heat strip beyond */
+#define CORE_METER_MAX 16
+#define CORE_METER_UNITS 5
+#define CORE_STRIP_UNITS 20
+/* History pane (-history): graph height, file name in the ck-core config dir */
+#define HISTORY_GRAPH_HEIGHT 100
+#define HISTORY_FILE_NAME "ck-load.history"
+
 /* Update interval in milliseconds */
 #define UPDATE_INTERVAL_MS 1000
 
 /* Maxima in "percent" units for all meters */
 #define PERCENT_MAX 100
 #define LOAD_PERCENT_DEFAULT_MAX 100
+/* PSI triggers wake the meters when "some" stall time passes 10% of a 2 s
+   window; unprivileged triggers need a window that is a multiple of 2 s. */
+#define PSI_TRIGGER_STALL_US 200000
+#define PSI_TRIGGER_WINDOW_US 2000000
 #define ICON_WIDTH 96
 #define ICON_HEIGHT 96
 #define ICON_MARGIN 4
@@ -71,10 +98,43 @@ enum {
 
 static Widget meters[NUM_METERS];
 static Widget value_labels[NUM_METERS];
+static int g_meter_count = NUM_BASE_METERS;
+static int g_core_mode = 0;
+static int g_core_count = 0;
+static ProcfsCpuTimes *g_core_times = NULL;  /* filled by read_system_sample */
+static ProcfsCpuTimes *g_core_prev = NULL;
+static int *g_core_percent = NULL;
+static Widget *g_core_meters = NULL;         /* CORE_METER_MAX cores or fewer */
+static Widget *g_core_labels = NULL;
+static Widget g_core_strip = NULL;           /* more cores than that */
+static Widget g_core_strip_label = NULL;
+static LoadHistory *g_history = NULL;
+static int g_history_mode = 0;
+static Widget g_history_graph = NULL;
+static Widget g_history_label = NULL;
+static int g_history_series = LOAD_HISTORY_CPU;
+static int g_history_span = 1;               /* index into history_spans[] */
+static LoadHistoryColumn *g_history_columns = NULL;
+static int g_history_column_count = 0;
 static XtAppContext app_context;
 static SessionData *session_data = NULL;
 static char g_exec_path[PATH_MAX] = "ck-load";
-static Pixmap g_icon_pixmap = None;
+/* What an icon pixmap holds, so a refresh can redraw just the changed segments. */
+typedef struct {
+    int cpu_segments;
+    int ram_segments;
+    Pixel bg;
+    Pixel fill;
+    Pixel segment;
+    Pixel top;
+    Pixel bottom;
+} IconState;
+
+/* Two pixmaps: the window manager shows the front one while the other is redrawn. */
+static Pixmap g_icon_pixmaps[2] = { None, None };
+static IconState g_icon_drawn[2];
+static int g_icon_drawn_valid[2] = { 0, 0 };
+static int g_icon_front = -1;
 static GC g_icon_gc = NULL;
 static Display *g_icon_display = NULL;
 static int g_icon_screen = -1;
@@ -97,64 +157,59 @@ static Atom g_dtwm_settings_atom = None;
 static int g_logged_no_wm_window = 0;
 static int g_logged_settings_fail = 0;
 static int g_logged_window_ids = 0;
+static ProcfsReader g_procfs;
+static int g_procfs_ready = 0;
+static StatShmReader g_stat_shm = { NULL, 0, 0, -1, 0 };
+static long long g_psi_prev_ms = 0;
+static unsigned long long g_psi_prev_total[PROCFS_PRESSURE_COUNT];
 
-/* ---------- Helper: CPU usage from /proc/stat ---------- */
+/* ---------- Helper: shared /proc reader (files stay open between ticks) ---------- */
 
-static int
-read_cpu_usage_percent(int *out_percent)
+static ProcfsReader *
+get_procfs_reader(void)
 {
-    static unsigned long long prev_user = 0, prev_nice = 0, prev_system = 0;
-    static unsigned long long prev_idle = 0, prev_iowait = 0;
-    static unsigned long long prev_irq = 0, prev_softirq = 0, prev_steal = 0;
-    static int initialized = 0;
-
-    FILE *fp = fopen("/proc/stat", "r");
-    if (!fp) {
-        return -1;
+    if (!g_procfs_ready) {
+        if (procfs_reader_open(&g_procfs, NULL) != 0) {
+            return NULL;
+        }
+        g_procfs_ready = 1;
     }
+    return &g_procfs;
+}
 
-    char buf[256];
-    if (!fgets(buf, sizeof(buf), fp)) {
-        fclose(fp);
-        return -1;
-    }
-    fclose(fp);
-
-    /* Example line:
-     * cpu  4705 150 1222 1048579 77 0 68 0 0 0
-     */
-    char cpu_label[5];
-    unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
-    /* ignore guest, guest_nice */
-    int scanned = sscanf(buf, "%4s %llu %llu %llu %llu %llu %llu %llu %llu",
-                         cpu_label,
-                         &user, &nice, &system, &idle,
-                         &iowait, &irq, &softirq, &steal);
-    if (scanned < 9) {
-        return -1;
+/* ---------- Helper: one sample per tick, from ck-statd or /proc ---------- */
+
+static int
+read_system_sample(StatShmSample *out_sample)
+{
+    if (stat_shm_read(&g_stat_shm, out_sample, g_core_times, g_core_count) == 0) {
+        return 0;
     }
+    ProcfsReader *reader = get_procfs_reader();
+    if (!reader) return -1;
+    return stat_shm_sample_procfs(reader, out_sample, g_core_times, g_core_count);
+}
+
+/* ---------- Helper: CPU usage from /proc/stat ticks ---------- */
 
-    unsigned long long prev_idle_all = prev_idle + prev_iowait;
-    unsigned long long idle_all      = idle + iowait;
+static int
+read_cpu_usage_percent(const StatShmSample *sample, int *out_percent)
+{
+    static unsigned long long prev_total = 0, prev_idle_all = 0;
+    static int initialized = 0;
+    static int last_percent = 0;
 
-    unsigned long long prev_non_idle =
-        prev_user + prev_nice + prev_system + prev_irq + prev_softirq + prev_steal;
-    unsigned long long non_idle =
-        user + nice + system + irq + softirq + steal;
+    if (!(sample->valid & STAT_SHM_HAVE_CPU)) {
+        return -1;
+    }
 
-    unsigned long long prev_total = prev_idle_all + prev_non_idle;
-    unsigned long long total      = idle_all + non_idle;
+    unsigned long long idle_all = procfs_cpu_idle_ticks(&sample->cpu);
+    unsigned long long total    = procfs_cpu_total_ticks(&sample->cpu);
 
     if (!initialized) {
         /* First call: initialize and return 0% */
-        prev_user = user;
-        prev_nice = nice;
-        prev_system = system;
-        prev_idle = idle;
-        prev_iowait = iowait;
-        prev_irq = irq;
-        prev_softirq = softirq;
-        prev_steal = steal;
+        prev_total = total;
+        prev_idle_all = idle_all;
         initialized = 1;
         *out_percent = 0;
         return 0;
@@ -163,59 +218,37 @@ read_cpu_usage_percent(int *out_percent)
     unsigned long long total_diff = total - prev_total;
     unsigned long long idle_diff  = idle_all - prev_idle_all;
 
-    prev_user = user;
-    prev_nice = nice;
-    prev_system = system;
-    prev_idle = idle;
-    prev_iowait = iowait;
-    prev_irq = irq;
-    prev_softirq = softirq;
-    prev_steal = steal;
-
     if (total_diff == 0) {
-        *out_percent = 0;
+        /* No ticks yet: ck-statd has not published a newer sample. */
+        *out_percent = last_percent;
         return 0;
     }
 
+    prev_total = total;
+    prev_idle_all = idle_all;
+
     double cpu_percent = 100.0 * (double)(total_diff - idle_diff) / (double)total_diff;
     if (cpu_percent < 0.0) cpu_percent = 0.0;
     if (cpu_percent > 100.0) cpu_percent = 100.0;
 
-    *out_percent = (int)(cpu_percent + 0.5);
+    last_percent = (int)(cpu_percent + 0.5);
+    *out_percent = last_percent;
     return 0;
 }
 
 /* ---------- Helper: RAM + swap usage from /proc/meminfo ---------- */
 
 static int
-read_mem_and_swap_percent(int *out_ram_percent, int *out_swap_percent,
+read_mem_and_swap_percent(const StatShmSample *sample, int *out_ram_percent, int *out_swap_percent,
                           double *out_ram_used_gb, double *out_swap_used_gb)
 {
-    FILE *fp = fopen("/proc/meminfo", "r");
-    if (!fp) return -1;
-
-    char key[64];
-    unsigned long value;
-    char unit[32];
-
-    unsigned long mem_total = 0;
-    unsigned long mem_available = 0;
-    unsigned long swap_total = 0;
-    unsigned long swap_free = 0;
-
-    while (fscanf(fp, "%63s %lu %31s\n", key, &value, unit) == 3) {
-        if (strcmp(key, "MemTotal:") == 0) {
-            mem_total = value;
-        } else if (strcmp(key, "MemAvailable:") == 0) {
-            mem_available = value;
-        } else if (strcmp(key, "SwapTotal:") == 0) {
-            swap_total = value;
-        } else if (strcmp(key, "SwapFree:") == 0) {
-            swap_free = value;
-        }
-    }
+    if (!(sample->valid & STAT_SHM_HAVE_MEMINFO)) return -1;
+    const ProcfsMemInfo *info = &sample->memory;
 
-    fclose(fp);
+    unsigned long mem_total = info->mem_total_kb;
+    unsigned long mem_available = info->mem_available_kb;
+    unsigned long swap_total = info->swap_total_kb;
+    unsigned long swap_free = info->swap_free_kb;
 
     if (out_ram_used_gb)  *out_ram_used_gb  = 0.0;
     if (out_swap_used_gb) *out_swap_used_gb = 0.0;
@@ -252,24 +285,19 @@ read_mem_and_swap_percent(int *out_ram_percent, int *out_swap_percent,
 /* ---------- Helper: load averages from /proc/loadavg ---------- */
 
 static int
-read_load_percent(int *out_l1, int *out_l5, int *out_l15,
+read_load_percent(const StatShmSample *sample, int *out_l1, int *out_l5, int *out_l15,
                   double *out_raw_l1, double *out_raw_l5, double *out_raw_l15)
 {
-    FILE *fp = fopen("/proc/loadavg", "r");
-    if (!fp) return -1;
-
-    double l1, l5, l15;
-    if (fscanf(fp, "%lf %lf %lf", &l1, &l5, &l15) != 3) {
-        fclose(fp);
+    if (!(sample->valid & STAT_SHM_HAVE_LOADAVG)) {
         return -1;
     }
-    fclose(fp);
+    double l1 = sample->load1, l5 = sample->load5, l15 = sample->load15;
 
     if (out_raw_l1) *out_raw_l1 = l1;
     if (out_raw_l5) *out_raw_l5 = l5;
     if (out_raw_l15) *out_raw_l15 = l15;
 
-    long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    long n_cpus = sample->online_cores;
     if (n_cpus <= 0) n_cpus = 1;
 
     double scale = 100.0 / (double)n_cpus; /* 1.0 load per core = 100% */
@@ -288,6 +316,86 @@ read_load_percent(int *out_l1, int *out_l5, int *out_l15,
     return 0;
 }
 
+/* ---------- Helper: pressure stall meters from /proc/pressure ---------- */
+
+/* Meters show the "some" avg10 share; labels show stall time per second
+   since the previous sample, from the growth of the total counters. */
+static void
+update_pressure_meters(const ProcfsPressure *pressure, long long sampled_ms)
+{
+    static int last_values[PROCFS_PRESSURE_COUNT] = { -1, -1, -1 };
+    static char last_labels[PROCFS_PRESSURE_COUNT][32] = {{0}};
+
+    if (g_meter_count <= METER_PSI_CPU) return;
+    /* Same (or an older) sample than the last update: nothing new. */
+    if (sampled_ms <= g_psi_prev_ms) return;
+
+    long long elapsed_ms = g_psi_prev_ms > 0 ? sampled_ms - g_psi_prev_ms : 0;
+    for (int i = 0; i < PROCFS_PRESSURE_COUNT; ++i) {
+        int meter = METER_PSI_CPU + i;
+        int percent = (int)(pressure[i].some.avg10 + 0.5);
+        if (percent < 0) percent = 0;
+        if (percent > PERCENT_MAX) percent = PERCENT_MAX;
+        if (percent != last_values[i]) {
+            VerticalMeterSetValue(meters[meter], percent);
+            last_values[i] = percent;
+        }
+
+        unsigned long long total = pressure[i].some.total_us;
+        char buf[32];
+        if (elapsed_ms > 0 && total >= g_psi_prev_total[i]) {
+            double stall_ms_per_s = (double)(total - g_psi_prev_total[i]) / (double)elapsed_ms;
+            snprintf(buf, sizeof(buf), "%.0f ms/s", stall_ms_per_s);
+        } else {
+            snprintf(buf, sizeof(buf), "-");
+        }
+        if (strcmp(buf, last_labels[i]) != 0) {
+            XmString s = XmStringCreateLocalized(buf);
+            XtVaSetValues(value_labels[meter], XmNlabelString, s, NULL);
+            XmStringFree(s);
+            snprintf(last_labels[i], sizeof(last_labels[i]), "%s", buf);
+        }
+        g_psi_prev_total[i] = total;
+    }
+    g_psi_prev_ms = sampled_ms;
+}
+
+/* A trigger fired: re-read the pressure files now rather than at the next tick. */
+static void
+pressure_trigger_cb(XtPointer client_data, int *source, XtInputId *id)
+{
+    (void)client_data;
+    (void)source;
+    (void)id;
+
+    ProcfsReader *reader = get_procfs_reader();
+    if (!reader) return;
+    ProcfsPressure pressure[PROCFS_PRESSURE_COUNT];
+    for (int i = 0; i < PROCFS_PRESSURE_COUNT; ++i) {
+        if (procfs_read_pressure(reader, i, &pressure[i]) != 0) return;
+    }
+    update_pressure_meters(pressure, tool_now_ms());
+}
+
+/* Shows the PSI columns when the kernel has PSI and arms a trigger per resource. */
+static void
+init_pressure_meters(void)
+{
+    ProcfsReader *reader = get_procfs_reader();
+    ProcfsPressure pressure;
+    if (!reader || procfs_read_pressure(reader, PROCFS_PRESSURE_CPU, &pressure) != 0) {
+        return;
+    }
+    g_meter_count = NUM_METERS;
+    for (int i = 0; i < PROCFS_PRESSURE_COUNT; ++i) {
+        /* Older kernels only allow triggers with CAP_SYS_RESOURCE; polling still works. */
+        int fd = procfs_open_pressure_trigger(reader, i, PSI_TRIGGER_STALL_US, PSI_TRIGGER_WINDOW_US);
+        if (fd >= 0) {
+            XtAppAddInput(app_context, fd, (XtPointer)XtInputExceptMask, pressure_trigger_cb, NULL);
+        }
+    }
+}
+
 static void
 ensure_icon_resources(Display *display)
 {
@@ -303,6 +411,14 @@ ensure_icon_resources(Display *display)
         XFreeGC(g_icon_display, g_icon_gc);
         g_icon_gc = NULL;
     }
+    for (int i = 0; i < 2; ++i) {
+        if (g_icon_pixmaps[i] != None) {
+            XFreePixmap(g_icon_display, g_icon_pixmaps[i]);
+            g_icon_pixmaps[i] = None;
+        }
+        g_icon_drawn_valid[i] = 0;
+    }
+    g_icon_front = -1;
 
     g_icon_display = display;
     g_icon_screen = screen;
@@ -371,13 +487,20 @@ update_icon_colors(void)
                       NULL);
     }
 
+    Pixel icon_segment = (highlight != 0 && highlight != bg) ? highlight : segment_color;
+    if (icon_segment == bg && segment_color != bg) {
+        icon_segment = segment_color;
+    }
+    /* Deriving the bar colors costs round trips; only redo it after a change. */
+    if (g_icon_colors_inited && g_icon_bg_color == bg && g_icon_top_shadow == top_shadow &&
+        g_icon_bottom_shadow == bottom_shadow && g_icon_segment_color == icon_segment) {
+        return;
+    }
+
     g_icon_bg_color = bg;
     g_icon_top_shadow = top_shadow;
     g_icon_bottom_shadow = bottom_shadow;
-    g_icon_segment_color = (highlight != 0 && highlight != bg) ? highlight : segment_color;
-    if (g_icon_segment_color == g_icon_bg_color && segment_color != g_icon_bg_color) {
-        g_icon_segment_color = segment_color;
-    }
+    g_icon_segment_color = icon_segment;
     g_icon_bar_bg_color = g_icon_bottom_shadow;
     g_icon_bar_bg_color = derive_darker_icon_pixel(g_icon_display, g_icon_screen,
                                                    g_icon_bar_bg_color);
@@ -672,110 +795,114 @@ get_icon_bar_icon_color(Display *display)
     return g_icon_bar_icon_color;
 }
 
-static void
-draw_icon_bars(Display *display, Pixmap pixmap, int cpu_percent, int ram_percent,
-               unsigned long fill_color)
+static int
+icon_bar_width(void)
 {
-    int screen = (g_icon_screen >= 0) ? g_icon_screen : DefaultScreen(display);
-    unsigned long bg = g_icon_colors_inited ? g_icon_bg_color :
-                       WhitePixel(display, screen);
-    unsigned long fill = g_icon_colors_inited ? fill_color :
-                         BlackPixel(display, screen);
-    unsigned long segment_color = g_icon_colors_inited ? g_icon_segment_color :
-                                  BlackPixel(display, screen);
-    unsigned long top_color = g_icon_colors_inited ? g_icon_top_shadow :
-                       WhitePixel(display, screen);
-    unsigned long bottom_color = g_icon_colors_inited ? g_icon_bottom_shadow :
-                                  BlackPixel(display, screen);
-
-    XSetForeground(display, g_icon_gc, bg);
-    XFillRectangle(display, pixmap, g_icon_gc, 0, 0, ICON_WIDTH, ICON_HEIGHT);
-
-    int available_width = ICON_WIDTH - ICON_MARGIN * 2;
-    int bar_height = ICON_HEIGHT - ICON_MARGIN * 2;
-    int bar_width = (available_width - ICON_BAR_GAP) / 2;
-    if (bar_height <= 0 || bar_width <= 0) return;
-
-    if (cpu_percent < 0) cpu_percent = 0;
-    if (cpu_percent > 100) cpu_percent = 100;
-    if (ram_percent < 0) ram_percent = 0;
-    if (ram_percent > 100) ram_percent = 100;
-
-    int cpu_x = ICON_MARGIN;
-    int ram_x = ICON_MARGIN + bar_width + ICON_BAR_GAP;
+    return (ICON_WIDTH - ICON_MARGIN * 2 - ICON_BAR_GAP) / 2;
+}
 
-    int inner_height = bar_height - ICON_BORDER_INSET * 2;
+static int
+icon_max_segments(void)
+{
+    int inner_height = ICON_HEIGHT - ICON_MARGIN * 2 - ICON_BORDER_INSET * 2;
     if (inner_height < 1) inner_height = 1;
-    int inner_top = ICON_MARGIN + ICON_BORDER_INSET;
-    int inner_bottom = inner_top + inner_height - 1;
-    int inner_width = bar_width - ICON_BORDER_INSET * 2;
+    int max_segments = (inner_height + ICON_SEGMENT_GAP) / (ICON_SEGMENT_HEIGHT + ICON_SEGMENT_GAP);
+    return max_segments < 1 ? 1 : max_segments;
+}
 
-    int segment_stride = ICON_SEGMENT_HEIGHT + ICON_SEGMENT_GAP;
-    int max_segments = 0;
-    if (segment_stride > 0 && inner_height > 0) {
-        max_segments = (inner_height + ICON_SEGMENT_GAP) / segment_stride;
-        if (max_segments < 1) max_segments = 1;
-    }
+static int
+icon_segments_for_percent(int percent)
+{
+    if (percent < 0) percent = 0;
+    if (percent > 100) percent = 100;
+    int max_segments = icon_max_segments();
+    int segments = (percent * max_segments + 50) / 100;
+    return segments > max_segments ? max_segments : segments;
+}
 
-    int cpu_segments = (cpu_percent * max_segments + 50) / 100;
-    if (cpu_segments > max_segments) cpu_segments = max_segments;
-    int cpu_inner_x = cpu_x + ICON_BORDER_INSET;
+/* Fills segment slots [from, to) of the bar at bar_x with the GC's foreground. */
+static void
+fill_icon_segments(Display *display, Pixmap pixmap, int bar_x, int from, int to)
+{
+    XRectangle rects[ICON_HEIGHT / (ICON_SEGMENT_HEIGHT + ICON_SEGMENT_GAP) + 1];
+    int inner_top = ICON_MARGIN + ICON_BORDER_INSET;
+    int inner_bottom = ICON_HEIGHT - ICON_MARGIN - ICON_BORDER_INSET - 1;
+    int inner_width = icon_bar_width() - ICON_BORDER_INSET * 2;
     if (inner_width < 1) inner_width = 1;
 
-    XSetForeground(display, g_icon_gc, fill);
-    XFillRectangle(display, pixmap, g_icon_gc,
-                   cpu_x, ICON_MARGIN, bar_width, bar_height);
-    XSetForeground(display, g_icon_gc, segment_color);
-    for (int i = 0; i < cpu_segments; ++i) {
-        int seg_bottom = inner_bottom - i * segment_stride;
+    int count = 0;
+    for (int i = from; i < to && count < (int)(sizeof(rects) / sizeof(rects[0])); ++i) {
+        int seg_bottom = inner_bottom - i * (ICON_SEGMENT_HEIGHT + ICON_SEGMENT_GAP);
         int seg_top = seg_bottom - ICON_SEGMENT_HEIGHT + 1;
         if (seg_top < inner_top) break;
-        XFillRectangle(display, pixmap, g_icon_gc,
-                       cpu_inner_x, seg_top, inner_width, ICON_SEGMENT_HEIGHT);
-    }
-    int cpu_top = ICON_MARGIN;
-    int cpu_bottom = ICON_MARGIN + bar_height - 1;
-    int cpu_left = cpu_x;
-    int cpu_right = cpu_x + bar_width - 1;
-
-    XSetForeground(display, g_icon_gc, bottom_color);
-    XDrawLine(display, pixmap, g_icon_gc, cpu_left, cpu_top, cpu_right, cpu_top);
-    XDrawLine(display, pixmap, g_icon_gc, cpu_left, cpu_top, cpu_left, cpu_bottom);
-    XSetForeground(display, g_icon_gc, top_color);
-    XDrawLine(display, pixmap, g_icon_gc, cpu_left, cpu_bottom, cpu_right, cpu_bottom);
-    XDrawLine(display, pixmap, g_icon_gc, cpu_right, cpu_top, cpu_right, cpu_bottom);
-
-    int ram_segments = (ram_percent * max_segments + 50) / 100;
-    if (ram_segments > max_segments) ram_segments = max_segments;
-    int ram_inner_x = ram_x + ICON_BORDER_INSET;
-
-    XSetForeground(display, g_icon_gc, fill);
+        rects[count].x = (short)(bar_x + ICON_BORDER_INSET);
+        rects[count].y = (short)seg_top;
+        rects[count].width = (unsigned short)inner_width;
+        rects[count].height = ICON_SEGMENT_HEIGHT;
+        count++;
+    }
+    if (count > 0) {
+        XFillRectangles(display, pixmap, g_icon_gc, rects, count);
+    }
+}
+
+static void
+draw_icon_bar(Display *display, Pixmap pixmap, int bar_x, int segments,
+              const IconState *state)
+{
+    int bar_width = icon_bar_width();
+    int bar_height = ICON_HEIGHT - ICON_MARGIN * 2;
+    if (bar_height <= 0 || bar_width <= 0) return;
+
+    XSetForeground(display, g_icon_gc, state->fill);
     XFillRectangle(display, pixmap, g_icon_gc,
-                   ram_x, ICON_MARGIN, bar_width, bar_height);
-    XSetForeground(display, g_icon_gc, segment_color);
-    for (int i = 0; i < ram_segments; ++i) {
-        int seg_bottom = inner_bottom - i * segment_stride;
-        int seg_top = seg_bottom - ICON_SEGMENT_HEIGHT + 1;
-        if (seg_top < inner_top) break;
-        XFillRectangle(display, pixmap, g_icon_gc,
-                       ram_inner_x, seg_top, inner_width, ICON_SEGMENT_HEIGHT);
-    }
-    int ram_top = ICON_MARGIN;
-    int ram_bottom = ICON_MARGIN + bar_height - 1;
-    int ram_left = ram_x;
-    int ram_right = ram_x + bar_width - 1;
-
-    XSetForeground(display, g_icon_gc, bottom_color);
-    XDrawLine(display, pixmap, g_icon_gc, ram_left, ram_top, ram_right, ram_top);
-    XDrawLine(display, pixmap, g_icon_gc, ram_left, ram_top, ram_left, ram_bottom);
-    XSetForeground(display, g_icon_gc, top_color);
-    XDrawLine(display, pixmap, g_icon_gc, ram_left, ram_bottom, ram_right, ram_bottom);
-    XDrawLine(display, pixmap, g_icon_gc, ram_right, ram_top, ram_right, ram_bottom);
-
-    int circle_radius = (ICON_WIDTH < ICON_HEIGHT ? ICON_WIDTH : ICON_HEIGHT) / 2;
-    circle_radius -= ICON_MARGIN + 1;
-    if (circle_radius < 1) circle_radius = 1;
+                   bar_x, ICON_MARGIN, bar_width, bar_height);
+    XSetForeground(display, g_icon_gc, state->segment);
+    fill_icon_segments(display, pixmap, bar_x, 0, segments);
+
+    int top = ICON_MARGIN;
+    int bottom = ICON_MARGIN + bar_height - 1;
+    int left = bar_x;
+    int right = bar_x + bar_width - 1;
+
+    XSetForeground(display, g_icon_gc, state->bottom);
+    XDrawLine(display, pixmap, g_icon_gc, left, top, right, top);
+    XDrawLine(display, pixmap, g_icon_gc, left, top, left, bottom);
+    XSetForeground(display, g_icon_gc, state->top);
+    XDrawLine(display, pixmap, g_icon_gc, left, bottom, right, bottom);
+    XDrawLine(display, pixmap, g_icon_gc, right, top, right, bottom);
+}
+
+/* Lights or clears only the segments between the old and the new count. */
+static void
+update_icon_bar(Display *display, Pixmap pixmap, int bar_x, int drawn, int segments,
+                const IconState *state)
+{
+    if (segments > drawn) {
+        XSetForeground(display, g_icon_gc, state->segment);
+        fill_icon_segments(display, pixmap, bar_x, drawn, segments);
+    } else if (segments < drawn) {
+        XSetForeground(display, g_icon_gc, state->fill);
+        fill_icon_segments(display, pixmap, bar_x, segments, drawn);
+    }
+}
+
+static void
+draw_icon_bars(Display *display, Pixmap pixmap, const IconState *state)
+{
+    XSetForeground(display, g_icon_gc, state->bg);
+    XFillRectangle(display, pixmap, g_icon_gc, 0, 0, ICON_WIDTH, ICON_HEIGHT);
+
+    int cpu_x = ICON_MARGIN;
+    int ram_x = ICON_MARGIN + icon_bar_width() + ICON_BAR_GAP;
+    draw_icon_bar(display, pixmap, cpu_x, state->cpu_segments, state);
+    draw_icon_bar(display, pixmap, ram_x, state->ram_segments, state);
+
     if (DRAW_ICON_DEBUG_CIRCLES) {
+        int screen = (g_icon_screen >= 0) ? g_icon_screen : DefaultScreen(display);
+        int circle_radius = (ICON_WIDTH < ICON_HEIGHT ? ICON_WIDTH : ICON_HEIGHT) / 2;
+        circle_radius -= ICON_MARGIN + 1;
+        if (circle_radius < 1) circle_radius = 1;
         XSetForeground(display, g_icon_gc, BlackPixel(display, screen));
         int cx = ICON_WIDTH / 2;
         int cy = ICON_HEIGHT / 2;
@@ -793,10 +920,58 @@ draw_icon_bars(Display *display, Pixmap pixmap, int cpu_percent, int ram_percent
     }
 }
 
+static int
+icon_colors_equal(const IconState *a, const IconState *b)
+{
+    return a->bg == b->bg && a->fill == b->fill && a->segment == b->segment &&
+           a->top == b->top && a->bottom == b->bottom;
+}
+
+static int
+icon_state_equal(const IconState *a, const IconState *b)
+{
+    return a->cpu_segments == b->cpu_segments && a->ram_segments == b->ram_segments &&
+           icon_colors_equal(a, b);
+}
+
+/* Brings buffer `index` up to `state`, in place when only the segment counts differ. */
 static void
-update_wm_icon_pixmap(Display *display)
+render_icon_buffer(Display *display, int index, const IconState *state)
 {
-    if (!g_icon_pixmap || !g_toplevel || !XtIsRealized(g_toplevel)) return;
+    Pixmap pixmap = g_icon_pixmaps[index];
+    IconState *drawn = &g_icon_drawn[index];
+    if (!g_icon_drawn_valid[index] || !icon_colors_equal(drawn, state) ||
+        DRAW_ICON_DEBUG_CIRCLES) {
+        draw_icon_bars(display, pixmap, state);
+    } else {
+        int cpu_x = ICON_MARGIN;
+        int ram_x = ICON_MARGIN + icon_bar_width() + ICON_BAR_GAP;
+        update_icon_bar(display, pixmap, cpu_x, drawn->cpu_segments, state->cpu_segments, state);
+        update_icon_bar(display, pixmap, ram_x, drawn->ram_segments, state->ram_segments, state);
+    }
+    *drawn = *state;
+    g_icon_drawn_valid[index] = 1;
+}
+
+static int
+ensure_icon_pixmaps(Display *display)
+{
+    int screen = (g_icon_screen >= 0) ? g_icon_screen : DefaultScreen(display);
+    Pixmap root = RootWindow(display, screen);
+    for (int i = 0; i < 2; ++i) {
+        if (g_icon_pixmaps[i] != None) continue;
+        g_icon_pixmaps[i] = XCreatePixmap(display, root, ICON_WIDTH, ICON_HEIGHT,
+                                          DefaultDepth(display, screen));
+        if (g_icon_pixmaps[i] == None) return -1;
+        g_icon_drawn_valid[i] = 0;
+    }
+    return 0;
+}
+
+static void
+update_wm_icon_pixmap(Display *display, Pixmap pixmap)
+{
+    if (!pixmap || !g_toplevel || !XtIsRealized(g_toplevel)) return;
     Window window = XtWindow(g_toplevel);
     if (!window) return;
 
@@ -809,7 +984,7 @@ update_wm_icon_pixmap(Display *display)
         memset(&local, 0, sizeof(local));
     }
     local.flags |= IconPixmapHint;
-    local.icon_pixmap = g_icon_pixmap;
+    local.icon_pixmap = pixmap;
     XSetWMHints(display, window, &local);
 }
 
@@ -838,28 +1013,32 @@ refresh_dynamic_icon(int cpu_percent, int ram_percent)
     }
     int update_icon = iconified || g_show_open_icons;
 
-    ensure_icon_resources(display);
-    update_icon_colors();
-    int screen = (g_icon_screen >= 0) ? g_icon_screen : DefaultScreen(display);
-    Pixel icon_fill = g_icon_colors_inited ? get_icon_bar_icon_color(display) :
-                      BlackPixel(display, screen);
-    Pixmap root = RootWindow(display, screen);
-    Pixmap new_pixmap = None;
     if (update_icon) {
-        new_pixmap = XCreatePixmap(display, root, ICON_WIDTH, ICON_HEIGHT,
-                                   DefaultDepth(display, screen));
-        if (new_pixmap == None) return;
-
-        draw_icon_bars(display, new_pixmap, cpu_percent, ram_percent, icon_fill);
-        XFlush(display);
-        Pixmap prev_pixmap = g_icon_pixmap;
-        g_icon_pixmap = new_pixmap;
-        XtVaSetValues(g_toplevel, XmNiconPixmap, g_icon_pixmap, NULL);
-        if (XtIsRealized(g_toplevel)) {
-            update_wm_icon_pixmap(display);
-        }
-        if (prev_pixmap != None) {
-            XFreePixmap(display, prev_pixmap);
+        ensure_icon_resources(display);
+        update_icon_colors();
+        int screen = (g_icon_screen >= 0) ? g_icon_screen : DefaultScreen(display);
+        IconState state;
+        state.cpu_segments = icon_segments_for_percent(cpu_percent);
+        state.ram_segments = icon_segments_for_percent(ram_percent);
+        state.bg = g_icon_colors_inited ? g_icon_bg_color : WhitePixel(display, screen);
+        state.fill = g_icon_colors_inited ? get_icon_bar_icon_color(display) :
+                     BlackPixel(display, screen);
+        state.segment = g_icon_colors_inited ? g_icon_segment_color : BlackPixel(display, screen);
+        state.top = g_icon_colors_inited ? g_icon_top_shadow : WhitePixel(display, screen);
+        state.bottom = g_icon_colors_inited ? g_icon_bottom_shadow : BlackPixel(display, screen);
+
+        /* The window manager already shows this icon: no drawing, no WM_HINTS. */
+        if (g_icon_front < 0 || !icon_state_equal(&g_icon_drawn[g_icon_front], &state)) {
+            if (ensure_icon_pixmaps(display) != 0) return;
+            /* Never draw into the pixmap the window manager is showing. */
+            int back = (g_icon_front == 0) ? 1 : 0;
+            render_icon_buffer(display, back, &state);
+            XFlush(display);
+            g_icon_front = back;
+            XtVaSetValues(g_toplevel, XmNiconPixmap, g_icon_pixmaps[back], NULL);
+            if (XtIsRealized(g_toplevel)) {
+                update_wm_icon_pixmap(display, g_icon_pixmaps[back]);
+            }
         }
     }
     update_window_title_with_cpu(cpu_percent, iconified, g_show_open_icons);
@@ -867,6 +1046,186 @@ refresh_dynamic_icon(int cpu_percent, int ram_percent)
     g_last_show_open_icons = g_show_open_icons;
 }
 
+/* ---------- Helper: per-core meters (-cores) ---------- */
+
+static void
+set_label_text(Widget label, char *last, size_t last_len, const char *text)
+{
+    if (strcmp(text, last) == 0) return;
+    XmString s = XmStringCreateLocalized((char *)text);
+    XtVaSetValues(label, XmNlabelString, s, NULL);
+    XmStringFree(s);
+    snprintf(last, last_len, "%s", text);
+}
+
+static void
+init_core_mode(void)
+{
+    long configured = sysconf(_SC_NPROCESSORS_CONF);
+    if (configured < 1) configured = 1;
+    if (configured > STAT_SHM_MAX_CORES) configured = STAT_SHM_MAX_CORES;
+    int count = (int)configured;
+
+    g_core_times = (ProcfsCpuTimes *)calloc((size_t)count, sizeof(ProcfsCpuTimes));
+    g_core_prev = (ProcfsCpuTimes *)calloc((size_t)count, sizeof(ProcfsCpuTimes));
+    g_core_percent = (int *)calloc((size_t)count, sizeof(int));
+    if (count <= CORE_METER_MAX) {
+        g_core_meters = (Widget *)calloc((size_t)count, sizeof(Widget));
+        g_core_labels = (Widget *)calloc((size_t)count, sizeof(Widget));
+    }
+    if (!g_core_times || !g_core_prev || !g_core_percent ||
+        (count <= CORE_METER_MAX && (!g_core_meters || !g_core_labels))) {
+        free(g_core_times);
+        free(g_core_prev);
+        free(g_core_percent);
+        free(g_core_meters);
+        free(g_core_labels);
+        g_core_times = NULL;
+        g_core_prev = NULL;
+        g_core_percent = NULL;
+        g_core_meters = NULL;
+        g_core_labels = NULL;
+        return;
+    }
+    for (int i = 0; i < count; ++i) g_core_percent[i] = -1;
+    g_core_count = count;
+    g_core_mode = 1;
+}
+
+/* Per-core deltas come from the same /proc/stat read as the CPU meter; only
+   cores whose value changed are redrawn. */
+static void
+update_core_meters(const StatShmSample *sample)
+{
+    static long long last_sampled_ms = -1;
+    static char last_strip_label[32] = "";
+    static char last_labels[CORE_METER_MAX][8];
+
+    if (!g_core_mode || !(sample->valid & STAT_SHM_HAVE_CPU)) return;
+    /* ck-statd has not published a newer sample: no ticks to compare. */
+    if (sample->sampled_ms == last_sampled_ms) return;
+    last_sampled_ms = sample->sampled_ms;
+
+    int busiest = 0;
+    for (int i = 0; i < g_core_count; ++i) {
+        unsigned long long total = procfs_cpu_total_ticks(&g_core_times[i]);
+        unsigned long long idle = procfs_cpu_idle_ticks(&g_core_times[i]);
+        unsigned long long prev_total = procfs_cpu_total_ticks(&g_core_prev[i]);
+        unsigned long long prev_idle = procfs_cpu_idle_ticks(&g_core_prev[i]);
+
+        int percent = g_core_percent[i] > 0 ? g_core_percent[i] : 0;
+        if (prev_total == 0 || total < prev_total || idle < prev_idle) {
+            /* First sample, or the core is offline (or just came back) */
+            percent = 0;
+        } else if (total > prev_total) {
+            unsigned long long total_diff = total - prev_total;
+            unsigned long long idle_diff = idle - prev_idle;
+            if (idle_diff > total_diff) idle_diff = total_diff;
+            percent = (int)(100.0 * (double)(total_diff - idle_diff) / (double)total_diff + 0.5);
+        }
+        if (percent > busiest) busiest = percent;
+        if (percent == g_core_percent[i]) continue;
+        g_core_percent[i] = percent;
+
+        if (g_core_meters) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "%d%%", percent);
+            VerticalMeterSetValue(g_core_meters[i], percent);
+            set_label_text(g_core_labels[i], last_labels[i], sizeof(last_labels[i]), buf);
+        } else {
+            CoreStripSetValue(g_core_strip, i, percent);
+        }
+    }
+    memcpy(g_core_prev, g_core_times, sizeof(ProcfsCpuTimes) * (size_t)g_core_count);
+
+    if (g_core_strip) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "max %d%%", busiest);
+        set_label_text(g_core_strip_label, last_strip_label, sizeof(last_strip_label), buf);
+    }
+}
+
+/* ---------- Helper: load history (-history) ---------- */
+
+static const int history_spans[] = { 10 * 60, 60 * 60, 6 * 60 * 60, LOAD_HISTORY_SECONDS };
+static const char *history_span_names[] = { "10 min", "1 h", "6 h", "24 h" };
+static const char *history_series_names[LOAD_HISTORY_SERIES] = { "CPU", "RAM", "Swap", "Load 1" };
+
+static void
+init_history(void)
+{
+    char path[PATH_MAX];
+    config_build_path(path, sizeof(path), HISTORY_FILE_NAME);
+    g_history = load_history_open(path);
+    if (!g_history) {
+        fprintf(stderr, "[ck-load] history: cannot map %s, not recording\n", path);
+    }
+}
+
+static void
+update_history_label(void)
+{
+    static char last[64] = "";
+    if (!g_history_label) return;
+    char text[64];
+    snprintf(text, sizeof(text), "%s, last %s",
+             history_series_names[g_history_series], history_span_names[g_history_span]);
+    set_label_text(g_history_label, last, sizeof(last), text);
+}
+
+/* Redraws the graph from the summaries; cheap enough to run every tick at any span. */
+static void
+update_history_view(void)
+{
+    if (!g_history_graph) return;
+    int count = HistoryGraphGetColumnCount(g_history_graph);
+    if (count <= 0) return;
+    if (count != g_history_column_count) {
+        LoadHistoryColumn *columns =
+            (LoadHistoryColumn *)realloc(g_history_columns, sizeof(LoadHistoryColumn) * (size_t)count);
+        if (!columns) return;
+        g_history_columns = columns;
+        g_history_column_count = count;
+    }
+
+    load_history_query(g_history, (LoadHistorySeries)g_history_series, time(NULL),
+                       history_spans[g_history_span], g_history_columns, count);
+
+    /* Load can pass 100%; like the load meters, the scale grows to fit it. */
+    int maximum = PERCENT_MAX;
+    if (g_history_series == LOAD_HISTORY_LOAD) {
+        for (int i = 0; i < count; ++i) {
+            if (g_history_columns[i].valid && g_history_columns[i].max > maximum) {
+                maximum = g_history_columns[i].max;
+            }
+        }
+        maximum = (maximum + LOAD_PERCENT_DEFAULT_MAX - 1) / LOAD_PERCENT_DEFAULT_MAX *
+                  LOAD_PERCENT_DEFAULT_MAX;
+    }
+    HistoryGraphSetData(g_history_graph, g_history_columns, count, maximum);
+}
+
+/* Button 1 zooms out (wrapping back to 10 min), button 3 shows the next series. */
+static void
+history_button_cb(Widget w, XtPointer client_data, XEvent *event, Boolean *continue_dispatch)
+{
+    (void)w;
+    (void)client_data;
+    (void)continue_dispatch;
+    if (!event || event->type != ButtonPress) return;
+
+    int span_count = (int)(sizeof(history_spans) / sizeof(history_spans[0]));
+    if (event->xbutton.button == Button1) {
+        g_history_span = (g_history_span + 1) % span_count;
+    } else if (event->xbutton.button == Button3) {
+        g_history_series = (g_history_series + 1) % LOAD_HISTORY_SERIES;
+    } else {
+        return;
+    }
+    update_history_label();
+    update_history_view();
+}
+
 /* ---------- Timer callback: update all meters ---------- */
 
 static void
@@ -875,9 +1234,9 @@ update_meters_cb(XtPointer client_data, XtIntervalId *id)
     (void)client_data;
     (void)id;
 
-    static int last_values[NUM_METERS] = { -1, -1, -1, -1, -1, -1 };
+    static int last_values[NUM_BASE_METERS] = { -1, -1, -1, -1, -1, -1 };
     static int last_load_max = -1;
-    static char last_labels[NUM_METERS][32] = {{0}};
+    static char last_labels[NUM_BASE_METERS][32] = {{0}};
 
     int cpu_percent;
     int ram_percent, swap_percent;
@@ -885,8 +1244,15 @@ update_meters_cb(XtPointer client_data, XtIntervalId *id)
     int load_max = LOAD_PERCENT_DEFAULT_MAX;
     double ram_used_gb = 0.0, swap_used_gb = 0.0;
     double load1_raw = 0.0, load5_raw = 0.0, load15_raw = 0.0;
+    int have_cpu = 0;
+    int history_values[LOAD_HISTORY_SERIES] = { 0, 0, 0, 0 };
+    StatShmSample sample;
 
-    if (read_cpu_usage_percent(&cpu_percent) == 0) {
+    if (read_system_sample(&sample) != 0) {
+        memset(&sample, 0, sizeof(sample));
+    }
+
+    if (read_cpu_usage_percent(&sample, &cpu_percent) == 0) {
         if (cpu_percent != last_values[METER_CPU]) {
             VerticalMeterSetValue(meters[METER_CPU], cpu_percent);
             last_values[METER_CPU] = cpu_percent;
@@ -900,9 +1266,11 @@ update_meters_cb(XtPointer client_data, XtIntervalId *id)
             snprintf(last_labels[METER_CPU], sizeof(last_labels[METER_CPU]), "%s", buf);
         }
         g_icon_cpu_percent = cpu_percent;
+        history_values[LOAD_HISTORY_CPU] = cpu_percent;
+        have_cpu = 1;
     }
 
-    if (read_mem_and_swap_percent(&ram_percent, &swap_percent,
+    if (read_mem_and_swap_percent(&sample, &ram_percent, &swap_percent,
                                   &ram_used_gb, &swap_used_gb) == 0) {
         if (ram_percent != last_values[METER_RAM]) {
             VerticalMeterSetValue(meters[METER_RAM],  ram_percent);
@@ -931,12 +1299,15 @@ update_meters_cb(XtPointer client_data, XtIntervalId *id)
             snprintf(last_labels[METER_SWAP], sizeof(last_labels[METER_SWAP]), "%s", buf_swap);
         }
         g_icon_ram_percent = ram_percent;
+        history_values[LOAD_HISTORY_RAM] = ram_percent;
+        history_values[LOAD_HISTORY_SWAP] = swap_percent;
     }
 
-    if (read_load_percent(&load1_percent, &load5_percent, &load15_percent,
+    if (read_load_percent(&sample, &load1_percent, &load5_percent, &load15_percent,
                           &load1_raw, &load5_raw, &load15_raw) == 0) {
         /* Dynamically raise the maximum if any load value exceeds the default.
            Keep all three load meters on the same scale. */
+        history_values[LOAD_HISTORY_LOAD] = load1_percent;
         if (load1_percent > load_max) load_max = load1_percent;
         if (load5_percent > load_max) load_max = load5_percent;
         if (load15_percent > load_max) load_max = load15_percent;
@@ -990,6 +1361,17 @@ update_meters_cb(XtPointer client_data, XtIntervalId *id)
         }
     }
 
+    update_core_meters(&sample);
+
+    if (sample.valid & STAT_SHM_HAVE_PRESSURE) {
+        update_pressure_meters(sample.pressure, sample.sampled_ms);
+    }
+
+    if (have_cpu) {
+        load_history_record(g_history, time(NULL), history_values);
+    }
+    update_history_view();
+
     refresh_dynamic_icon(g_icon_cpu_percent, g_icon_ram_percent);
 
     /* Re-arm timer */
@@ -1050,23 +1432,176 @@ static void session_save_cb(Widget w, XtPointer client_data, XtPointer call_data
     if (!session_data) return;
 
     session_capture_geometry(w, session_data, "x", "y", "w", "h");
+    session_data_set_int(session_data, "cores", g_core_mode);
+    session_data_set_int(session_data, "history", g_history_mode);
     session_save(w, session_data, g_exec_path);
 }
 
 /* ---------- Main + UI setup ---------- */
 
+/* Builds one column: a title, a meter (or heat strip) and a value label below it. */
+static Widget
+create_column(Widget parent, int left_pos, int right_pos, const char *title,
+              Boolean strip, Widget *out_value_label)
+{
+    /* Column Form */
+    Widget col_form = XtVaCreateManagedWidget(
+        "colForm",
+        xmFormWidgetClass, parent,
+        XmNleftAttachment,   XmATTACH_POSITION,
+        XmNleftPosition,     left_pos,
+        XmNrightAttachment,  XmATTACH_POSITION,
+        XmNrightPosition,    right_pos,
+        XmNtopAttachment,    XmATTACH_FORM,
+        XmNbottomAttachment, XmATTACH_FORM,
+        NULL
+    );
+
+    /* Column label */
+    XmString xm_title = XmStringCreateLocalized((char *)title);
+    Widget label = XtVaCreateManagedWidget(
+        "meterLabel",
+        xmLabelGadgetClass, col_form,
+        XmNlabelString,    xm_title,
+        XmNalignment,      XmALIGNMENT_CENTER,
+        XmNtopAttachment,  XmATTACH_FORM,
+        XmNleftAttachment, XmATTACH_FORM,
+        XmNrightAttachment,XmATTACH_FORM,
+        NULL
+    );
+    XmStringFree(xm_title);
+
+    /* Vertical meter below the label, filling remaining space */
+    Arg args[8];
+    Cardinal n = 0;
+    /* Initial reasonable size; will be overridden by attachments */
+    XtSetArg(args[n], XmNwidth,  strip ? 80 : 40); n++;
+    XtSetArg(args[n], XmNheight, 150); n++;
+
+    Widget meter = strip ? CoreStripCreate(col_form, "coreStrip", args, n)
+                         : VerticalMeterCreate(col_form, "verticalMeter", args, n);
+
+    XtVaSetValues(
+        meter,
+        XmNtopAttachment,    XmATTACH_WIDGET,
+        XmNtopWidget,        label,
+        XmNleftAttachment,   XmATTACH_FORM,
+        XmNrightAttachment,  XmATTACH_FORM,
+        NULL
+    );
+
+    /* Value label at the bottom */
+    Widget value_label = XtVaCreateManagedWidget(
+        "valueLabel",
+        xmLabelGadgetClass, col_form,
+        XmNalignment,      XmALIGNMENT_CENTER,
+        XmNbottomAttachment, XmATTACH_FORM,
+        XmNleftAttachment, XmATTACH_FORM,
+        XmNrightAttachment,XmATTACH_FORM,
+        NULL
+    );
+    XmString initial = XmStringCreateLocalized("-");
+    XtVaSetValues(value_label, XmNlabelString, initial, NULL);
+    XmStringFree(initial);
+
+    /* Meter sits above the value label */
+    XtVaSetValues(
+        meter,
+        XmNbottomAttachment, XmATTACH_WIDGET,
+        XmNbottomWidget,     value_label,
+        XmNbottomOffset,     2,
+        NULL
+    );
+
+    *out_value_label = value_label;
+    return meter;
+}
+
+static int
+core_column_units(void)
+{
+    if (!g_core_mode) return 0;
+    return g_core_meters ? g_core_count * CORE_METER_UNITS : CORE_STRIP_UNITS;
+}
+
+/* Adds the per-core columns starting at pos; returns the next free position. */
+static int
+create_core_columns(Widget parent, int pos)
+{
+    if (!g_core_mode) return pos;
+    if (!g_core_meters) {
+        g_core_strip = create_column(parent, pos, pos + CORE_STRIP_UNITS, "Cores",
+                                     True, &g_core_strip_label);
+        CoreStripSetCount(g_core_strip, g_core_count);
+        return pos + CORE_STRIP_UNITS;
+    }
+    for (int i = 0; i < g_core_count; ++i) {
+        char title[16];
+        snprintf(title, sizeof(title), "%d", i);
+        g_core_meters[i] = create_column(parent, pos, pos + CORE_METER_UNITS, title,
+                                         False, &g_core_labels[i]);
+        VerticalMeterSetMaximum(g_core_meters[i], PERCENT_MAX);
+        VerticalMeterSetCellHeight(g_core_meters[i], 4);
+        pos += CORE_METER_UNITS;
+    }
+    return pos;
+}
+
+/* Graph with its title above, attached to the bottom of the main form. */
+static Widget
+create_history_pane(Widget parent)
+{
+    Widget pane = XtVaCreateManagedWidget(
+        "historyForm",
+        xmFormWidgetClass, parent,
+        XmNleftAttachment,   XmATTACH_FORM,
+        XmNrightAttachment,  XmATTACH_FORM,
+        XmNbottomAttachment, XmATTACH_FORM,
+        NULL
+    );
+
+    g_history_label = XtVaCreateManagedWidget(
+        "historyLabel",
+        xmLabelGadgetClass, pane,
+        XmNalignment,      XmALIGNMENT_CENTER,
+        XmNtopAttachment,  XmATTACH_FORM,
+        XmNleftAttachment, XmATTACH_FORM,
+        XmNrightAttachment,XmATTACH_FORM,
+        NULL
+    );
+    update_history_label();
+
+    Arg args[4];
+    Cardinal n = 0;
+    XtSetArg(args[n], XmNheight, HISTORY_GRAPH_HEIGHT); n++;
+    g_history_graph = HistoryGraphCreate(pane, "historyGraph", args, n);
+    XtVaSetValues(
+        g_history_graph,
+        XmNtopAttachment,    XmATTACH_WIDGET,
+        XmNtopWidget,        g_history_label,
+        XmNleftAttachment,   XmATTACH_FORM,
+        XmNrightAttachment,  XmATTACH_FORM,
+        XmNbottomAttachment, XmATTACH_FORM,
+        NULL
+    );
+    XtAddEventHandler(g_history_graph, ButtonPressMask, False, history_button_cb, NULL);
+    return pane;
+}
+
     int
     main(int argc, char *argv[])
     {
-        Widget toplevel, main_form;
-        XmString xm_title;
+        Widget toplevel, main_form, columns_form;
     static char *meter_labels[NUM_METERS] = {
         "CPU",
         "RAM",
         "Swap",
         "Load 1",
         "Load 5",
-        "Load 15"
+        "Load 15",
+        "CPU PSI",
+        "Mem PSI",
+        "I/O PSI"
     };
 
     XtSetLanguageProc(NULL, NULL, NULL);
@@ -1085,86 +1620,52 @@ static void session_save_cb(Widget w, XtPointer client_data, XtPointer call_data
     session_data = session_data_create(session_id);
     free(session_id);
     init_exec_path(argv[0]);
+    Boolean session_loaded = session_data && session_load(toplevel, session_data);
+    init_pressure_meters();
+
+    /* -cores (or a restored session that had it) shows every core */
+    int want_cores = session_loaded ? session_data_get_int(session_data, "cores", 0) : 0;
+    /* -history adds the history graph pane; the history is recorded either way */
+    g_history_mode = session_loaded ? session_data_get_int(session_data, "history", 0) : 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-cores") == 0) want_cores = 1;
+        if (strcmp(argv[i], "-history") == 0) g_history_mode = 1;
+    }
+    if (want_cores) init_core_mode();
+    init_history();
 
-    /* Main form, fractional positions used for equal-width columns */
     main_form = XtVaCreateManagedWidget(
         "mainForm",
         xmFormWidgetClass, toplevel,
-        XmNfractionBase, NUM_METERS * 10, /* 10 units per column */
         NULL
     );
 
-    for (int i = 0; i < NUM_METERS; ++i) {
-        int left_pos  = i * 10;
-        int right_pos = (i + 1) * 10;
-
-        /* Column Form */
-        Widget col_form = XtVaCreateManagedWidget(
-            "colForm",
+    /* The columns fill the main form, or the space above the history pane */
+    columns_form = main_form;
+    if (g_history_mode) {
+        Widget history_pane = create_history_pane(main_form);
+        columns_form = XtVaCreateManagedWidget(
+            "columnsForm",
             xmFormWidgetClass, main_form,
-            XmNleftAttachment,   XmATTACH_POSITION,
-            XmNleftPosition,     left_pos,
-            XmNrightAttachment,  XmATTACH_POSITION,
-            XmNrightPosition,    right_pos,
             XmNtopAttachment,    XmATTACH_FORM,
-            XmNbottomAttachment, XmATTACH_FORM,
-            NULL
-        );
-
-        /* Column label */
-        xm_title = XmStringCreateLocalized(meter_labels[i]);
-        Widget label = XtVaCreateManagedWidget(
-            "meterLabel",
-            xmLabelGadgetClass, col_form,
-            XmNlabelString,    xm_title,
-            XmNalignment,      XmALIGNMENT_CENTER,
-            XmNtopAttachment,  XmATTACH_FORM,
-            XmNleftAttachment, XmATTACH_FORM,
-            XmNrightAttachment,XmATTACH_FORM,
-            NULL
-        );
-        XmStringFree(xm_title);
-
-        /* Vertical meter below the label, filling remaining space */
-        Arg args[8];
-        Cardinal n = 0;
-        /* Initial reasonable size; will be overridden by attachments */
-        XtSetArg(args[n], XmNwidth,  40); n++;
-        XtSetArg(args[n], XmNheight, 150); n++;
-
-        Widget meter = VerticalMeterCreate(col_form, "verticalMeter", args, n);
-
-        XtVaSetValues(
-            meter,
-            XmNtopAttachment,    XmATTACH_WIDGET,
-            XmNtopWidget,        label,
             XmNleftAttachment,   XmATTACH_FORM,
             XmNrightAttachment,  XmATTACH_FORM,
+            XmNbottomAttachment, XmATTACH_WIDGET,
+            XmNbottomWidget,     history_pane,
             NULL
         );
+    }
 
-        /* Value label at the bottom */
-        Widget value_label = XtVaCreateManagedWidget(
-            "valueLabel",
-            xmLabelGadgetClass, col_form,
-            XmNalignment,      XmALIGNMENT_CENTER,
-            XmNbottomAttachment, XmATTACH_FORM,
-            XmNleftAttachment, XmATTACH_FORM,
-            XmNrightAttachment,XmATTACH_FORM,
-            NULL
-        );
-        XmString initial = XmStringCreateLocalized("-");
-        XtVaSetValues(value_label, XmNlabelString, initial, NULL);
-        XmStringFree(initial);
+    /* Fractional positions used for the columns */
+    XtVaSetValues(columns_form,
+                  XmNfractionBase, g_meter_count * COLUMN_UNITS + core_column_units(),
+                  NULL);
 
-        /* Meter sits above the value label */
-        XtVaSetValues(
-            meter,
-            XmNbottomAttachment, XmATTACH_WIDGET,
-            XmNbottomWidget,     value_label,
-            XmNbottomOffset,     2,
-            NULL
-        );
+    int pos = 0;
+    for (int i = 0; i < g_meter_count; ++i) {
+        Widget meter = create_column(columns_form, pos, pos + COLUMN_UNITS, meter_labels[i],
+                                     False, &value_labels[i]);
+        pos += COLUMN_UNITS;
 
         /* Configure meter maxima and cell height */
         if (i == METER_LOAD1 || i == METER_LOAD5 || i == METER_LOAD15) {
@@ -1176,7 +1677,11 @@ static void session_save_cb(Widget w, XtPointer client_data, XtPointer call_data
         VerticalMeterSetCellHeight(meter, 4); /* 0 = square cells in your implementation */
 
         meters[i] = meter;
-        value_labels[i] = value_label;
+
+        /* Per-core columns sit right of the aggregate CPU meter */
+        if (i == METER_CPU) {
+            pos = create_core_columns(columns_form, pos);
+        }
     }
 
     g_toplevel = toplevel;
@@ -1190,7 +1695,7 @@ static void session_save_cb(Widget w, XtPointer client_data, XtPointer call_data
     refresh_dynamic_icon(g_icon_cpu_percent, g_icon_ram_percent);
 
     /* Session restore (geometry) */
-    if (session_data && session_load(toplevel, session_data)) {
+    if (session_loaded) {
         session_apply_geometry(toplevel, session_data, "x", "y", "w", "h");
     }
 
@@ -1213,5 +1718,6 @@ static void session_save_cb(Widget w, XtPointer client_data, XtPointer call_data
     XtAppAddTimeOut(app_context, UPDATE_INTERVAL_MS, update_meters_cb, NULL);
 
     XtAppMainLoop(app_context);
+    load_history_close(g_history);
     return 0;
 }
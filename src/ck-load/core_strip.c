@@ -0,0 +1,301 @@
+/*
+ * core_strip.c
+ *
+ * Compact per-core heat strip for Motif.
+ *
+ * - Implemented as a wrapper around XmDrawingArea, like vertical_meter.c.
+ * - Draws the same sunken frame; inside it, one cell per core in a grid
+ *   whose column count keeps the cells as close to square as possible.
+ * - Each cell is shaded in CS_LEVELS steps from the background color (idle)
+ *   to the foreground color (busy). The shades are allocated once.
+ * - CoreStripSetValue() redraws a single cell, and only when its shade
+ *   changes, so a tick with 128 cores costs a handful of XFillRectangle calls.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <X11/Intrinsic.h>
+#include <X11/StringDefs.h>
+#include <Xm/Xm.h>
+#include <Xm/DrawingA.h>
+
+#include "core_strip.h"
+
+#define CS_LEVELS 8
+
+/* -------------------------------------------------------------------------
+ * Internal state
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    int   count;          /* number of cells */
+    unsigned char *levels;/* current shade per cell, 0..CS_LEVELS-1 */
+    int   padding;        /* inner padding from frame to cell area */
+    int   cell_gap;       /* gap between cells (pixels) */
+
+    /* Grid, recomputed on resize */
+    int   columns;
+    int   rows;
+
+    /* GCs */
+    GC    gc_top;
+    GC    gc_bottom;
+    GC    gc_bg;
+    GC    gc_levels[CS_LEVELS];
+} CoreStripData;
+
+/* -------------------------------------------------------------------------
+ * Forward declarations
+ * ------------------------------------------------------------------------- */
+
+static CoreStripData *cs_get_data(Widget w, Boolean create_if_missing);
+static void cs_destroy_cb(Widget w, XtPointer client_data, XtPointer call_data);
+static void cs_expose_cb(Widget w, XtPointer client_data, XtPointer call_data);
+static void cs_resize_cb(Widget w, XtPointer client_data, XtPointer call_data);
+static void cs_draw(Widget w, CoreStripData *cs);
+static void cs_draw_cell(Widget w, CoreStripData *cs, int index);
+
+/* -------------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------------- */
+
+static Pixel cs_mix(Display *dpy, Colormap cmap, const XColor *from, const XColor *to, double factor)
+{
+    XColor mixed = *from;
+    mixed.red   = (unsigned short)(from->red   + (to->red   - from->red)   * factor);
+    mixed.green = (unsigned short)(from->green + (to->green - from->green) * factor);
+    mixed.blue  = (unsigned short)(from->blue  + (to->blue  - from->blue)  * factor);
+    mixed.flags = DoRed | DoGreen | DoBlue;
+    if (XAllocColor(dpy, cmap, &mixed)) {
+        return mixed.pixel;
+    }
+    /* Colormap full: fall back to the nearer end of the ramp. */
+    return factor < 0.5 ? from->pixel : to->pixel;
+}
+
+static CoreStripData *cs_get_data(Widget w, Boolean create_if_missing)
+{
+    CoreStripData *cs = NULL;
+    XtVaGetValues(w, XmNuserData, &cs, NULL);
+
+    if (!cs && create_if_missing) {
+        cs = (CoreStripData *)calloc(1, sizeof(CoreStripData));
+        if (!cs) {
+            return NULL;
+        }
+        cs->padding  = 2;
+        cs->cell_gap = 1;
+
+        Pixel bg, fg, top_shadow, bottom_shadow;
+        XtVaGetValues(w,
+                      XmNbackground,        &bg,
+                      XmNforeground,        &fg,
+                      XmNtopShadowColor,    &top_shadow,
+                      XmNbottomShadowColor, &bottom_shadow,
+                      NULL);
+
+        XGCValues gcv;
+        gcv.foreground = top_shadow;
+        cs->gc_top = XtGetGC(w, GCForeground, &gcv);
+        gcv.foreground = bottom_shadow;
+        cs->gc_bottom = XtGetGC(w, GCForeground, &gcv);
+        gcv.foreground = bg;
+        cs->gc_bg = XtGetGC(w, GCForeground, &gcv);
+
+        Display *dpy = XtDisplay(w);
+        Colormap cmap = DefaultColormap(dpy, DefaultScreen(dpy));
+        XColor from = {0};
+        XColor to = {0};
+        from.pixel = bg;
+        to.pixel = fg;
+        XQueryColor(dpy, cmap, &from);
+        XQueryColor(dpy, cmap, &to);
+        for (int i = 0; i < CS_LEVELS; ++i) {
+            gcv.foreground = cs_mix(dpy, cmap, &from, &to, (double)i / (double)(CS_LEVELS - 1));
+            cs->gc_levels[i] = XtGetGC(w, GCForeground, &gcv);
+        }
+
+        XtVaSetValues(w, XmNuserData, cs, NULL);
+    }
+
+    return cs;
+}
+
+static void cs_destroy_cb(Widget w, XtPointer client_data, XtPointer call_data)
+{
+    (void)client_data;
+    (void)call_data;
+
+    CoreStripData *cs = NULL;
+    XtVaGetValues(w, XmNuserData, &cs, NULL);
+    if (!cs) return;
+
+    if (cs->gc_top)    XtReleaseGC(w, cs->gc_top);
+    if (cs->gc_bottom) XtReleaseGC(w, cs->gc_bottom);
+    if (cs->gc_bg)     XtReleaseGC(w, cs->gc_bg);
+    for (int i = 0; i < CS_LEVELS; ++i) {
+        if (cs->gc_levels[i]) XtReleaseGC(w, cs->gc_levels[i]);
+    }
+
+    free(cs->levels);
+    free(cs);
+    XtVaSetValues(w, XmNuserData, NULL, NULL);
+}
+
+/* Inner area inside the frame and padding; False if there is no room. */
+static Boolean cs_inner_area(Widget w, CoreStripData *cs, int *x0, int *y0, int *inner_w, int *inner_h)
+{
+    Dimension width, height;
+    XtVaGetValues(w, XmNwidth, &width, XmNheight, &height, NULL);
+    *x0 = 1 + cs->padding;
+    *y0 = 1 + cs->padding;
+    *inner_w = (int)width - 2 * (1 + cs->padding);
+    *inner_h = (int)height - 2 * (1 + cs->padding);
+    return *inner_w > 0 && *inner_h > 0;
+}
+
+/* Picks the column count that gives the largest (most square) cells. */
+static void cs_layout(CoreStripData *cs, int inner_w, int inner_h)
+{
+    int best_columns = 1;
+    int best_side = -1;
+    for (int columns = 1; columns <= cs->count; ++columns) {
+        int rows = (cs->count + columns - 1) / columns;
+        int cell_w = inner_w / columns;
+        int cell_h = inner_h / rows;
+        int side = cell_w < cell_h ? cell_w : cell_h;
+        if (side > best_side) {
+            best_side = side;
+            best_columns = columns;
+        }
+    }
+    cs->columns = best_columns;
+    cs->rows = cs->count > 0 ? (cs->count + best_columns - 1) / best_columns : 0;
+}
+
+/* -------------------------------------------------------------------------
+ * Drawing
+ * ------------------------------------------------------------------------- */
+
+static void cs_expose_cb(Widget w, XtPointer client_data, XtPointer call_data)
+{
+    (void)client_data;
+    XmDrawingAreaCallbackStruct *cbs = (XmDrawingAreaCallbackStruct *)call_data;
+
+    if (!cbs || cbs->reason != XmCR_EXPOSE) return;
+
+    CoreStripData *cs = cs_get_data(w, True);
+    if (!cs) return;
+
+    cs_draw(w, cs);
+}
+
+static void cs_resize_cb(Widget w, XtPointer client_data, XtPointer call_data)
+{
+    (void)client_data;
+    (void)call_data;
+
+    CoreStripData *cs = cs_get_data(w, False);
+    if (!cs) return;
+
+    cs_draw(w, cs);
+}
+
+static void cs_draw_cell(Widget w, CoreStripData *cs, int index)
+{
+    if (!XtIsRealized(w) || cs->columns <= 0 || cs->rows <= 0) return;
+
+    int x0, y0, inner_w, inner_h;
+    if (!cs_inner_area(w, cs, &x0, &y0, &inner_w, &inner_h)) return;
+
+    /* Cells stretch to fill the area; the gap separates them. */
+    int column = index % cs->columns;
+    int row = index / cs->columns;
+    int cx0 = x0 + column * inner_w / cs->columns;
+    int cx1 = x0 + (column + 1) * inner_w / cs->columns - cs->cell_gap;
+    int cy0 = y0 + row * inner_h / cs->rows;
+    int cy1 = y0 + (row + 1) * inner_h / cs->rows - cs->cell_gap;
+    if (cx1 <= cx0) cx1 = cx0 + 1;
+    if (cy1 <= cy0) cy1 = cy0 + 1;
+
+    XFillRectangle(XtDisplay(w), XtWindow(w), cs->gc_levels[cs->levels[index]],
+                   cx0, cy0, (unsigned int)(cx1 - cx0), (unsigned int)(cy1 - cy0));
+}
+
+static void cs_draw(Widget w, CoreStripData *cs)
+{
+    if (!XtIsRealized(w)) return;
+
+    Display *dpy = XtDisplay(w);
+    Window   win = XtWindow(w);
+
+    Dimension width, height;
+    XtVaGetValues(w, XmNwidth, &width, XmNheight, &height, NULL);
+    if (width < 4 || height < 4) return;
+
+    XFillRectangle(dpy, win, cs->gc_bg, 0, 0, width, height);
+
+    /* Sunken frame: top/left dark (bottomShadow), bottom/right bright (topShadow) */
+    int x1 = (int)width - 1;
+    int y1 = (int)height - 1;
+    XDrawLine(dpy, win, cs->gc_bottom, 0, 0, x1, 0);
+    XDrawLine(dpy, win, cs->gc_bottom, 0, 0, 0, y1);
+    XDrawLine(dpy, win, cs->gc_top, 0, y1, x1, y1);
+    XDrawLine(dpy, win, cs->gc_top, x1, 0, x1, y1);
+
+    int x0, y0, inner_w, inner_h;
+    if (!cs_inner_area(w, cs, &x0, &y0, &inner_w, &inner_h)) return;
+    cs_layout(cs, inner_w, inner_h);
+    for (int i = 0; i < cs->count; ++i) {
+        cs_draw_cell(w, cs, i);
+    }
+}
+
+/* -------------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------------- */
+
+Widget CoreStripCreate(Widget parent, char *name, Arg *args, Cardinal n)
+{
+    Widget w = XmCreateDrawingArea(parent, name ? name : "coreStrip", args, n);
+
+    XtAddCallback(w, XmNexposeCallback, cs_expose_cb, NULL);
+    XtAddCallback(w, XmNresizeCallback, cs_resize_cb, NULL);
+    XtAddCallback(w, XmNdestroyCallback, cs_destroy_cb, NULL);
+
+    (void)cs_get_data(w, True);
+
+    XtManageChild(w);
+    return w;
+}
+
+void CoreStripSetCount(Widget w, int count)
+{
+    CoreStripData *cs = cs_get_data(w, False);
+    if (!cs) return;
+
+    if (count < 0) count = 0;
+    unsigned char *levels = (unsigned char *)calloc(count > 0 ? (size_t)count : 1, 1);
+    if (!levels) return;
+    free(cs->levels);
+    cs->levels = levels;
+    cs->count = count;
+
+    cs_draw(w, cs);
+}
+
+void CoreStripSetValue(Widget w, int index, int percent)
+{
+    CoreStripData *cs = cs_get_data(w, False);
+    if (!cs || index < 0 || index >= cs->count) return;
+
+    if (percent < 0) percent = 0;
+    if (percent > 100) percent = 100;
+    unsigned char level = (unsigned char)((percent * (CS_LEVELS - 1) + 50) / 100);
+
+    if (cs->levels[index] != level) {
+        cs->levels[index] = level;
+        cs_draw_cell(w, cs, index);
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef CORE_STRIP_H
+#define CORE_STRIP_H
+
+#include <Xm/Xm.h>
+
+/*
+ * core_strip.h
+ *
+ * Compact heat strip for Motif: one small cell per CPU core, laid out in a
+ * grid that fills the widget, shaded from the background color (idle) to
+ * the foreground color (busy). Used by ck-load when there are too many cores
+ * for one VerticalMeter each.
+ *
+ * Public API:
+ *
+ *   Widget CoreStripCreate(Widget parent, char *name, Arg *args, Cardinal n);
+ *   void   CoreStripSetCount(Widget w, int count);
+ *   void   CoreStripSetValue(Widget w, int index, int percent);
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Create and manage a heat strip (an XmDrawingArea with callbacks attached). */
+Widget CoreStripCreate(Widget parent, char *name, Arg *args, Cardinal n);
+
+/* Set the number of cells; all values restart at 0. */
+void CoreStripSetCount(Widget w, int count);
+
+/* Set one cell (0..100). Only that cell is redrawn, and only if its shade changes. */
+void CoreStripSetValue(Widget w, int index, int percent);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* CORE_STRIP_H */
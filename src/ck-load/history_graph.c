@@ -0,0 +1,337 @@
+/*
+ * history_graph.c
+ *
+ * Load history graph for Motif.
+ *
+ * - Implemented as a wrapper around XmDrawingArea, like vertical_meter.c.
+ * - Draws the same sunken frame; inside it, one pixel column per data column:
+ *   a vertical line from min to max in a shade halfway between background
+ *   and foreground, and the averages joined by a line in the foreground.
+ * - The graph is drawn into a backing pixmap in one XDrawSegments batch plus
+ *   an XDrawLines call per run of valid columns; expose events copy from it.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <X11/Intrinsic.h>
+#include <X11/StringDefs.h>
+#include <Xm/Xm.h>
+#include <Xm/DrawingA.h>
+
+#include "history_graph.h"
+
+/* -------------------------------------------------------------------------
+ * Internal state
+ * ------------------------------------------------------------------------- */
+
+typedef struct {
+    LoadHistoryColumn *columns;
+    int   count;
+    int   maximum;
+    int   padding;        /* inner padding from frame to plot area */
+
+    /* Backing pixmap */
+    Pixmap    backing;
+    Dimension backing_w;
+    Dimension backing_h;
+
+    /* Scratch for drawing, count entries each */
+    XSegment *segments;
+    XPoint   *points;
+
+    /* GCs */
+    GC    gc_top;
+    GC    gc_bottom;
+    GC    gc_bg;
+    GC    gc_band;
+    GC    gc_line;
+} HistoryGraphData;
+
+/* -------------------------------------------------------------------------
+ * Forward declarations
+ * ------------------------------------------------------------------------- */
+
+static HistoryGraphData *hg_get_data(Widget w, Boolean create_if_missing);
+static void hg_destroy_cb(Widget w, XtPointer client_data, XtPointer call_data);
+static void hg_expose_cb(Widget w, XtPointer client_data, XtPointer call_data);
+static void hg_resize_cb(Widget w, XtPointer client_data, XtPointer call_data);
+static void hg_draw(Widget w, HistoryGraphData *hg);
+
+/* -------------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------------- */
+
+static Pixel hg_mix(Display *dpy, Colormap cmap, Pixel from_pixel, Pixel to_pixel, double factor)
+{
+    XColor from = {0};
+    XColor to = {0};
+    from.pixel = from_pixel;
+    to.pixel = to_pixel;
+    XQueryColor(dpy, cmap, &from);
+    XQueryColor(dpy, cmap, &to);
+
+    XColor mixed = from;
+    mixed.red   = (unsigned short)(from.red   + (to.red   - from.red)   * factor);
+    mixed.green = (unsigned short)(from.green + (to.green - from.green) * factor);
+    mixed.blue  = (unsigned short)(from.blue  + (to.blue  - from.blue)  * factor);
+    mixed.flags = DoRed | DoGreen | DoBlue;
+    if (XAllocColor(dpy, cmap, &mixed)) {
+        return mixed.pixel;
+    }
+    return to_pixel;
+}
+
+static HistoryGraphData *hg_get_data(Widget w, Boolean create_if_missing)
+{
+    HistoryGraphData *hg = NULL;
+    XtVaGetValues(w, XmNuserData, &hg, NULL);
+
+    if (!hg && create_if_missing) {
+        hg = (HistoryGraphData *)calloc(1, sizeof(HistoryGraphData));
+        if (!hg) {
+            return NULL;
+        }
+        hg->maximum = 100;
+        hg->padding = 2;
+
+        Pixel bg, fg, top_shadow, bottom_shadow;
+        XtVaGetValues(w,
+                      XmNbackground,        &bg,
+                      XmNforeground,        &fg,
+                      XmNtopShadowColor,    &top_shadow,
+                      XmNbottomShadowColor, &bottom_shadow,
+                      NULL);
+
+        XGCValues gcv;
+        gcv.foreground = top_shadow;
+        hg->gc_top = XtGetGC(w, GCForeground, &gcv);
+        gcv.foreground = bottom_shadow;
+        hg->gc_bottom = XtGetGC(w, GCForeground, &gcv);
+        gcv.foreground = bg;
+        hg->gc_bg = XtGetGC(w, GCForeground, &gcv);
+        gcv.foreground = fg;
+        hg->gc_line = XtGetGC(w, GCForeground, &gcv);
+
+        Display *dpy = XtDisplay(w);
+        gcv.foreground = hg_mix(dpy, DefaultColormap(dpy, DefaultScreen(dpy)), bg, fg, 0.4);
+        hg->gc_band = XtGetGC(w, GCForeground, &gcv);
+
+        XtVaSetValues(w, XmNuserData, hg, NULL);
+    }
+
+    return hg;
+}
+
+static void hg_destroy_cb(Widget w, XtPointer client_data, XtPointer call_data)
+{
+    (void)client_data;
+    (void)call_data;
+
+    HistoryGraphData *hg = NULL;
+    XtVaGetValues(w, XmNuserData, &hg, NULL);
+    if (!hg) return;
+
+    if (hg->gc_top)    XtReleaseGC(w, hg->gc_top);
+    if (hg->gc_bottom) XtReleaseGC(w, hg->gc_bottom);
+    if (hg->gc_bg)     XtReleaseGC(w, hg->gc_bg);
+    if (hg->gc_band)   XtReleaseGC(w, hg->gc_band);
+    if (hg->gc_line)   XtReleaseGC(w, hg->gc_line);
+    if (hg->backing)   XFreePixmap(XtDisplay(w), hg->backing);
+
+    free(hg->columns);
+    free(hg->segments);
+    free(hg->points);
+    free(hg);
+    XtVaSetValues(w, XmNuserData, NULL, NULL);
+}
+
+/* -------------------------------------------------------------------------
+ * Drawing
+ * ------------------------------------------------------------------------- */
+
+static void hg_expose_cb(Widget w, XtPointer client_data, XtPointer call_data)
+{
+    (void)client_data;
+    XmDrawingAreaCallbackStruct *cbs = (XmDrawingAreaCallbackStruct *)call_data;
+
+    if (!cbs || cbs->reason != XmCR_EXPOSE) return;
+
+    HistoryGraphData *hg = hg_get_data(w, True);
+    if (!hg) return;
+
+    Dimension width, height;
+    XtVaGetValues(w, XmNwidth, &width, XmNheight, &height, NULL);
+    if (!hg->backing || hg->backing_w != width || hg->backing_h != height) {
+        hg_draw(w, hg);
+        return;
+    }
+
+    XEvent *event = cbs->event;
+    if (event && event->type == Expose) {
+        XCopyArea(XtDisplay(w), hg->backing, XtWindow(w), hg->gc_line,
+                  event->xexpose.x, event->xexpose.y,
+                  (unsigned int)event->xexpose.width, (unsigned int)event->xexpose.height,
+                  event->xexpose.x, event->xexpose.y);
+    } else {
+        XCopyArea(XtDisplay(w), hg->backing, XtWindow(w), hg->gc_line,
+                  0, 0, width, height, 0, 0);
+    }
+}
+
+static void hg_resize_cb(Widget w, XtPointer client_data, XtPointer call_data)
+{
+    (void)client_data;
+    (void)call_data;
+
+    HistoryGraphData *hg = hg_get_data(w, False);
+    if (!hg) return;
+
+    hg_draw(w, hg);
+}
+
+static int hg_value_y(HistoryGraphData *hg, int value, int y0, int inner_h)
+{
+    if (value < 0) value = 0;
+    if (value > hg->maximum) value = hg->maximum;
+    return y0 + inner_h - 1 - (int)((long long)value * (inner_h - 1) / hg->maximum);
+}
+
+static void hg_draw(Widget w, HistoryGraphData *hg)
+{
+    if (!XtIsRealized(w)) return;
+
+    Display *dpy = XtDisplay(w);
+    Window   win = XtWindow(w);
+
+    Dimension width, height;
+    XtVaGetValues(w, XmNwidth, &width, XmNheight, &height, NULL);
+    if (width < 4 || height < 4) return;
+
+    if (!hg->backing || hg->backing_w != width || hg->backing_h != height) {
+        if (hg->backing) XFreePixmap(dpy, hg->backing);
+        int depth = 0;
+        XtVaGetValues(w, XtNdepth, &depth, NULL);
+        hg->backing = XCreatePixmap(dpy, win, width, height, (unsigned int)depth);
+        hg->backing_w = width;
+        hg->backing_h = height;
+    }
+    Drawable d = hg->backing;
+
+    XFillRectangle(dpy, d, hg->gc_bg, 0, 0, width, height);
+
+    /* Sunken frame: top/left dark (bottomShadow), bottom/right bright (topShadow) */
+    int x1 = (int)width - 1;
+    int y1 = (int)height - 1;
+    XDrawLine(dpy, d, hg->gc_bottom, 0, 0, x1, 0);
+    XDrawLine(dpy, d, hg->gc_bottom, 0, 0, 0, y1);
+    XDrawLine(dpy, d, hg->gc_top, 0, y1, x1, y1);
+    XDrawLine(dpy, d, hg->gc_top, x1, 0, x1, y1);
+
+    int x0 = 1 + hg->padding;
+    int y0 = 1 + hg->padding;
+    int inner_w = (int)width - 2 * (1 + hg->padding);
+    int inner_h = (int)height - 2 * (1 + hg->padding);
+    if (inner_w > 0 && inner_h > 1 && hg->count > 0 && hg->segments && hg->points) {
+        /* The newest column sits at the right edge; older ones scroll off the left. */
+        int shown = hg->count < inner_w ? hg->count : inner_w;
+        int first = hg->count - shown;
+        int left = x0 + inner_w - shown;
+
+        int n_segments = 0;
+        for (int i = 0; i < shown; ++i) {
+            const LoadHistoryColumn *column = &hg->columns[first + i];
+            if (!column->valid) continue;
+            XSegment *s = &hg->segments[n_segments++];
+            s->x1 = s->x2 = (short)(left + i);
+            s->y1 = (short)hg_value_y(hg, column->min, y0, inner_h);
+            s->y2 = (short)hg_value_y(hg, column->max, y0, inner_h);
+        }
+        if (n_segments > 0) XDrawSegments(dpy, d, hg->gc_band, hg->segments, n_segments);
+
+        int run = 0;
+        for (int i = 0; i <= shown; ++i) {
+            const LoadHistoryColumn *column = i < shown ? &hg->columns[first + i] : NULL;
+            if (column && column->valid) {
+                hg->points[run].x = (short)(left + i);
+                hg->points[run].y = (short)hg_value_y(hg, column->avg, y0, inner_h);
+                run++;
+                continue;
+            }
+            if (run == 1) {
+                XDrawPoint(dpy, d, hg->gc_line, hg->points[0].x, hg->points[0].y);
+            } else if (run > 1) {
+                XDrawLines(dpy, d, hg->gc_line, hg->points, run, CoordModeOrigin);
+            }
+            run = 0;
+        }
+    }
+
+    XCopyArea(dpy, d, win, hg->gc_line, 0, 0, width, height, 0, 0);
+}
+
+/* -------------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------------- */
+
+Widget HistoryGraphCreate(Widget parent, char *name, Arg *args, Cardinal n)
+{
+    Widget w = XmCreateDrawingArea(parent, name ? name : "historyGraph", args, n);
+
+    XtAddCallback(w, XmNexposeCallback, hg_expose_cb, NULL);
+    XtAddCallback(w, XmNresizeCallback, hg_resize_cb, NULL);
+    XtAddCallback(w, XmNdestroyCallback, hg_destroy_cb, NULL);
+
+    (void)hg_get_data(w, True);
+
+    XtManageChild(w);
+    return w;
+}
+
+int HistoryGraphGetColumnCount(Widget w)
+{
+    HistoryGraphData *hg = hg_get_data(w, False);
+    if (!hg) return 0;
+
+    Dimension width;
+    XtVaGetValues(w, XmNwidth, &width, NULL);
+    int inner_w = (int)width - 2 * (1 + hg->padding);
+    return inner_w > 0 ? inner_w : 0;
+}
+
+void HistoryGraphSetData(Widget w, const LoadHistoryColumn *columns, int count, int maximum)
+{
+    HistoryGraphData *hg = hg_get_data(w, False);
+    if (!hg) return;
+
+    if (count < 0 || !columns) count = 0;
+    if (maximum < 1) maximum = 1;
+    if (count == hg->count && maximum == hg->maximum &&
+        (count == 0 || memcmp(columns, hg->columns, sizeof(LoadHistoryColumn) * (size_t)count) == 0)) {
+        return;
+    }
+
+    if (count != hg->count) {
+        size_t slots = count > 0 ? (size_t)count : 1;
+        LoadHistoryColumn *copy = (LoadHistoryColumn *)malloc(sizeof(LoadHistoryColumn) * slots);
+        XSegment *segments = (XSegment *)malloc(sizeof(XSegment) * slots);
+        XPoint *points = (XPoint *)malloc(sizeof(XPoint) * slots);
+        if (!copy || !segments || !points) {
+            free(copy);
+            free(segments);
+            free(points);
+            return;
+        }
+        free(hg->columns);
+        free(hg->segments);
+        free(hg->points);
+        hg->columns = copy;
+        hg->segments = segments;
+        hg->points = points;
+        hg->count = count;
+    }
+    if (count > 0) memcpy(hg->columns, columns, sizeof(LoadHistoryColumn) * (size_t)count);
+    hg->maximum = maximum;
+
+    hg_draw(w, hg);
+}
@@ -0,0 +1,41 @@
+#ifndef HISTORY_GRAPH_H
+#define HISTORY_GRAPH_H
+
+#include <Xm/Xm.h>
+
+#include "load_history.h"
+
+/*
+ * history_graph.h
+ *
+ * Load history graph for Motif: one pixel column per LoadHistoryColumn,
+ * drawn as a min..max band with the average as a line over it. Columns
+ * without samples stay empty. Used by ck-load's history pane.
+ *
+ * Public API:
+ *
+ *   Widget HistoryGraphCreate(Widget parent, char *name, Arg *args, Cardinal n);
+ *   int    HistoryGraphGetColumnCount(Widget w);
+ *   void   HistoryGraphSetData(Widget w, const LoadHistoryColumn *columns,
+ *                              int count, int maximum);
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Create and manage a history graph (an XmDrawingArea with callbacks attached). */
+Widget HistoryGraphCreate(Widget parent, char *name, Arg *args, Cardinal n);
+
+/* Number of columns that fill the graph at its current width. */
+int HistoryGraphGetColumnCount(Widget w);
+
+/* Replace the data (oldest column first, values 0..maximum).
+ * Nothing is redrawn when the data is unchanged. */
+void HistoryGraphSetData(Widget w, const LoadHistoryColumn *columns, int count, int maximum);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* HISTORY_GRAPH_H */
@@ -0,0 +1,257 @@
+#include "load_history.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifndef PATH_MAX
+#define PATH_MAX 4096
+#endif
+
+#define LH_MAGIC 0x636b6c68u /* "cklh" */
+#define LH_VERSION 1
+#define LH_LEVELS 3
+#define LH_VALUE_MAX 65535
+
+/* Summary bucket sizes in seconds; each divides LOAD_HISTORY_SECONDS. */
+static const int lh_bucket_seconds[LH_LEVELS] = { 10, 60, 600 };
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int seconds;
+    unsigned int series;
+    unsigned int bucket_seconds[LH_LEVELS];
+    unsigned int reserved;
+} LoadHistoryHeader;
+
+typedef struct {
+    unsigned int stamp; /* the second this slot holds; 0 = empty */
+    unsigned short value[LOAD_HISTORY_SERIES];
+} LoadHistorySample;
+
+typedef struct {
+    unsigned int stamp; /* first second of the bucket; 0 = empty */
+    unsigned int count;
+    unsigned short min[LOAD_HISTORY_SERIES];
+    unsigned short max[LOAD_HISTORY_SERIES];
+    unsigned int sum[LOAD_HISTORY_SERIES];
+} LoadHistoryBucket;
+
+struct LoadHistory {
+    void *map;
+    size_t size;
+    LoadHistorySample *samples;
+    LoadHistoryBucket *buckets[LH_LEVELS];
+    int bucket_count[LH_LEVELS];
+};
+
+static size_t lh_file_size(void)
+{
+    size_t size = sizeof(LoadHistoryHeader) + sizeof(LoadHistorySample) * LOAD_HISTORY_SECONDS;
+    for (int i = 0; i < LH_LEVELS; ++i) {
+        size += sizeof(LoadHistoryBucket) * (size_t)(LOAD_HISTORY_SECONDS / lh_bucket_seconds[i]);
+    }
+    return size;
+}
+
+static int lh_header_matches(const LoadHistoryHeader *header)
+{
+    if (header->magic != LH_MAGIC || header->version != LH_VERSION ||
+        header->seconds != LOAD_HISTORY_SECONDS || header->series != LOAD_HISTORY_SERIES) {
+        return 0;
+    }
+    for (int i = 0; i < LH_LEVELS; ++i) {
+        if (header->bucket_seconds[i] != (unsigned int)lh_bucket_seconds[i]) return 0;
+    }
+    return 1;
+}
+
+static void lh_make_parent_dir(const char *path)
+{
+    char dir[PATH_MAX];
+    strncpy(dir, path, sizeof(dir) - 1);
+    dir[sizeof(dir) - 1] = '\0';
+    char *slash = strrchr(dir, '/');
+    if (slash && slash != dir) {
+        *slash = '\0';
+        mkdir(dir, 0700);
+    }
+}
+
+LoadHistory *load_history_open(const char *path)
+{
+    if (!path || !path[0]) return NULL;
+    lh_make_parent_dir(path);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) return NULL;
+
+    size_t size = lh_file_size();
+    struct stat st;
+    int fresh = 0;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != size) {
+        /* New file or another layout: start over with zeroed pages. */
+        if (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)size) != 0) {
+            close(fd);
+            return NULL;
+        }
+        fresh = 1;
+    }
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    LoadHistory *history = (LoadHistory *)calloc(1, sizeof(LoadHistory));
+    if (!history) {
+        munmap(map, size);
+        return NULL;
+    }
+    history->map = map;
+    history->size = size;
+
+    LoadHistoryHeader *header = (LoadHistoryHeader *)map;
+    if (!fresh && !lh_header_matches(header)) {
+        memset(map, 0, size);
+        fresh = 1;
+    }
+    if (fresh) {
+        header->magic = LH_MAGIC;
+        header->version = LH_VERSION;
+        header->seconds = LOAD_HISTORY_SECONDS;
+        header->series = LOAD_HISTORY_SERIES;
+        for (int i = 0; i < LH_LEVELS; ++i) {
+            header->bucket_seconds[i] = (unsigned int)lh_bucket_seconds[i];
+        }
+    }
+
+    char *cursor = (char *)map + sizeof(LoadHistoryHeader);
+    history->samples = (LoadHistorySample *)cursor;
+    cursor += sizeof(LoadHistorySample) * LOAD_HISTORY_SECONDS;
+    for (int i = 0; i < LH_LEVELS; ++i) {
+        history->bucket_count[i] = LOAD_HISTORY_SECONDS / lh_bucket_seconds[i];
+        history->buckets[i] = (LoadHistoryBucket *)cursor;
+        cursor += sizeof(LoadHistoryBucket) * (size_t)history->bucket_count[i];
+    }
+    return history;
+}
+
+void load_history_close(LoadHistory *history)
+{
+    if (!history) return;
+    if (history->map) munmap(history->map, history->size);
+    free(history);
+}
+
+void load_history_record(LoadHistory *history, time_t now,
+                         const int values[LOAD_HISTORY_SERIES])
+{
+    if (!history || !values || now <= 0) return;
+    unsigned int second = (unsigned int)now;
+
+    /* The timer can fire twice within a second; summaries must count it once. */
+    LoadHistorySample *sample = &history->samples[second % LOAD_HISTORY_SECONDS];
+    if (sample->stamp == second) return;
+
+    unsigned short clamped[LOAD_HISTORY_SERIES];
+    for (int s = 0; s < LOAD_HISTORY_SERIES; ++s) {
+        int value = values[s];
+        if (value < 0) value = 0;
+        if (value > LH_VALUE_MAX) value = LH_VALUE_MAX;
+        clamped[s] = (unsigned short)value;
+    }
+    memcpy(sample->value, clamped, sizeof(clamped));
+    sample->stamp = second;
+
+    for (int i = 0; i < LH_LEVELS; ++i) {
+        unsigned int bucket_seconds = (unsigned int)lh_bucket_seconds[i];
+        unsigned int start = second - second % bucket_seconds;
+        LoadHistoryBucket *bucket =
+            &history->buckets[i][(start / bucket_seconds) % (unsigned int)history->bucket_count[i]];
+        if (bucket->stamp != start) {
+            /* A day old (or never used): reuse it for this interval. */
+            bucket->stamp = start;
+            bucket->count = 0;
+            for (int s = 0; s < LOAD_HISTORY_SERIES; ++s) {
+                bucket->min[s] = LH_VALUE_MAX;
+                bucket->max[s] = 0;
+                bucket->sum[s] = 0;
+            }
+        }
+        bucket->count++;
+        for (int s = 0; s < LOAD_HISTORY_SERIES; ++s) {
+            if (clamped[s] < bucket->min[s]) bucket->min[s] = clamped[s];
+            if (clamped[s] > bucket->max[s]) bucket->max[s] = clamped[s];
+            bucket->sum[s] += clamped[s];
+        }
+    }
+}
+
+typedef struct {
+    unsigned int count;
+    unsigned int min;
+    unsigned int max;
+    unsigned long long sum;
+} LoadHistoryAccumulator;
+
+static void lh_accumulate(LoadHistoryAccumulator *acc, unsigned int count,
+                          unsigned int min, unsigned int max, unsigned long long sum)
+{
+    if (acc->count == 0 || min < acc->min) acc->min = min;
+    if (acc->count == 0 || max > acc->max) acc->max = max;
+    acc->count += count;
+    acc->sum += sum;
+}
+
+void load_history_query(const LoadHistory *history, LoadHistorySeries series,
+                        time_t now, int span_seconds,
+                        LoadHistoryColumn *out_columns, int count)
+{
+    if (!out_columns || count <= 0) return;
+    memset(out_columns, 0, sizeof(LoadHistoryColumn) * (size_t)count);
+    if (!history || (int)series < 0 || (int)series >= LOAD_HISTORY_SERIES || now <= 0 || span_seconds <= 0) return;
+    if (span_seconds > LOAD_HISTORY_SECONDS) span_seconds = LOAD_HISTORY_SECONDS;
+
+    /* Coarsest level with at least one bucket per column; -1 = raw samples. */
+    int level = -1;
+    for (int i = 0; i < LH_LEVELS; ++i) {
+        if ((long long)lh_bucket_seconds[i] * count <= span_seconds) level = i;
+    }
+
+    long long first = (long long)now - span_seconds + 1;
+    for (int c = 0; c < count; ++c) {
+        long long from = first + (long long)c * span_seconds / count;
+        long long to = first + (long long)(c + 1) * span_seconds / count;
+        if (to <= from) to = from + 1; /* more columns than seconds: repeat samples */
+
+        LoadHistoryAccumulator acc = {0, 0, 0, 0};
+        if (level < 0) {
+            for (long long t = from; t < to; ++t) {
+                const LoadHistorySample *sample = &history->samples[t % LOAD_HISTORY_SECONDS];
+                if (t <= 0 || sample->stamp != (unsigned int)t) continue;
+                unsigned int value = sample->value[series];
+                lh_accumulate(&acc, 1, value, value, value);
+            }
+        } else {
+            long long bucket_seconds = lh_bucket_seconds[level];
+            for (long long start = from - from % bucket_seconds; start < to; start += bucket_seconds) {
+                const LoadHistoryBucket *bucket =
+                    &history->buckets[level][(start / bucket_seconds) % history->bucket_count[level]];
+                if (start <= 0 || bucket->stamp != (unsigned int)start || bucket->count == 0) continue;
+                lh_accumulate(&acc, bucket->count, bucket->min[series], bucket->max[series],
+                              bucket->sum[series]);
+            }
+        }
+
+        if (acc.count > 0) {
+            out_columns[c].valid = 1;
+            out_columns[c].min = (int)acc.min;
+            out_columns[c].max = (int)acc.max;
+            out_columns[c].avg = (int)((acc.sum + acc.count / 2) / acc.count);
+        }
+    }
+}
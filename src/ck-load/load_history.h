@@ -0,0 +1,64 @@
+#ifndef CK_LOAD_HISTORY_H
+#define CK_LOAD_HISTORY_H
+
+#include <time.h>
+
+/*
+ * 24 hours of per-second load history in a fixed-size, memory-mapped ring
+ * file (ck-load.history in the ck-core config directory).
+ *
+ * Samples are keyed by wall-clock second, so the file picks up where it left
+ * off after a restart and seconds when ck-load was not running stay empty.
+ * Recording a sample is a few stores into the mapping; the kernel writes the
+ * pages back on its own, so there is no system call per sample.
+ *
+ * Next to the raw ring the file keeps summary rings for 10 s, 1 min and
+ * 10 min buckets (min, max, sum and count per series), updated as samples
+ * come in. A query for a long span reads the coarsest summary that still
+ * gives every column at least one bucket, so drawing 24 hours touches a few
+ * thousand buckets instead of 86400 samples.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOAD_HISTORY_SECONDS (24 * 60 * 60)
+
+typedef enum {
+    LOAD_HISTORY_CPU = 0,  /* percent */
+    LOAD_HISTORY_RAM,      /* percent */
+    LOAD_HISTORY_SWAP,     /* percent */
+    LOAD_HISTORY_LOAD,     /* 1-minute load in percent of the online cores */
+    LOAD_HISTORY_SERIES
+} LoadHistorySeries;
+
+typedef struct {
+    int valid;  /* 0 when no sample falls into the column */
+    int min;
+    int max;
+    int avg;
+} LoadHistoryColumn;
+
+typedef struct LoadHistory LoadHistory;
+
+/* Maps path (created or reset when missing or of another layout).
+ * Returns NULL if the file cannot be created or mapped. */
+LoadHistory *load_history_open(const char *path);
+void load_history_close(LoadHistory *history);
+
+/* Stores the values of second `now`; a second already recorded is kept. */
+void load_history_record(LoadHistory *history, time_t now,
+                         const int values[LOAD_HISTORY_SERIES]);
+
+/* Summarizes the span_seconds up to and including `now` into count columns,
+ * oldest first. */
+void load_history_query(const LoadHistory *history, LoadHistorySeries series,
+                        time_t now, int span_seconds,
+                        LoadHistoryColumn *out_columns, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CK_LOAD_HISTORY_H */
@@ -9,6 +9,11 @@
  * - Each cell is square by default (height == width), unless a specific
  *   cell height is set.
  * - Value in [0..maximum] determines how many cells are filled.
+ * - Drawing goes to an off-screen backing pixmap: a value change repaints
+ *   only the cells whose state (empty, filled, outlined) changed, in one
+ *   XFillRectangles/XDrawRectangles batch per GC, and copies just that band
+ *   to the window. Expose events are plain copies from the pixmap, which
+ *   keeps traffic low over remote X connections.
  *
  * Public API (declare in a header if you like):
  *
@@ -56,8 +61,28 @@ typedef struct {
     GC    gc_top;
     GC    gc_bottom;
     GC    gc_bar;
+
+    /* Backing pixmap and the cell layout last drawn into it */
+    Pixmap    backing;
+    Dimension backing_w;
+    Dimension backing_h;
+    int   cells;          /* cells that fit; 0 = nothing drawn yet */
+    int   cell_x;
+    int   cell_bottom;    /* bottom row of cell 0 */
+    int   cell_w;
+    int   cell_h;
+    int   cell_step;      /* cell height + gap */
+    int   drawn_solid;    /* filled cells currently in the pixmap */
+    int   drawn_outlined; /* outlined cells above them */
+    XRectangle *rects;    /* scratch for the batches, 3 * cells entries */
 } VerticalMeterData;
 
+enum {
+    VM_CELL_EMPTY,
+    VM_CELL_SOLID,
+    VM_CELL_OUTLINED
+};
+
 /* -------------------------------------------------------------------------
  * Forward declarations
  * ------------------------------------------------------------------------- */
@@ -67,6 +92,7 @@ static void vm_destroy_cb(Widget w, XtPointer client_data, XtPointer call_data);
 static void vm_expose_cb(Widget w, XtPointer client_data, XtPointer call_data);
 static void vm_resize_cb(Widget w, XtPointer client_data, XtPointer call_data);
 static void vm_draw(Widget w, VerticalMeterData *vm);
+static void vm_draw_full(Widget w, VerticalMeterData *vm);
 static double vm_pixel_brightness(Display *dpy, Colormap cmap, Pixel pixel);
 static Pixel vm_mix_with_white(Display *dpy, Colormap cmap, XColor *base, double factor);
 
@@ -202,7 +228,9 @@ static void vm_destroy_cb(Widget w, XtPointer client_data, XtPointer call_data)
     if (vm->gc_bottom) XtReleaseGC(w, vm->gc_bottom);
     if (vm->gc_bar)    XtReleaseGC(w, vm->gc_bar);
     if (vm->gc_bg)     XtReleaseGC(w, vm->gc_bg);
+    if (vm->backing)   XFreePixmap(XtDisplay(w), vm->backing);
 
+    free(vm->rects);
     free(vm);
     XtVaSetValues(w, XmNuserData, NULL, NULL);
 }
@@ -221,7 +249,23 @@ static void vm_expose_cb(Widget w, XtPointer client_data, XtPointer call_data)
     VerticalMeterData *vm = vm_get_data(w, True);
     if (!vm) return;
 
-    vm_draw(w, vm);
+    Dimension width, height;
+    XtVaGetValues(w, XmNwidth, &width, XmNheight, &height, NULL);
+    if (!vm->backing || vm->backing_w != width || vm->backing_h != height) {
+        vm_draw_full(w, vm);
+        return;
+    }
+
+    /* Restore just the exposed area from the backing pixmap */
+    if (cbs->event && cbs->event->type == Expose) {
+        XExposeEvent *ev = &cbs->event->xexpose;
+        XCopyArea(XtDisplay(w), vm->backing, XtWindow(w), vm->gc_bar,
+                  ev->x, ev->y, (unsigned int)ev->width, (unsigned int)ev->height,
+                  ev->x, ev->y);
+    } else {
+        XCopyArea(XtDisplay(w), vm->backing, XtWindow(w), vm->gc_bar,
+                  0, 0, width, height, 0, 0);
+    }
 }
 
 static void vm_resize_cb(Widget w, XtPointer client_data, XtPointer call_data)
@@ -232,10 +276,53 @@ static void vm_resize_cb(Widget w, XtPointer client_data, XtPointer call_data)
     VerticalMeterData *vm = vm_get_data(w, False);
     if (!vm) return;
 
-    vm_draw(w, vm);
+    vm_draw_full(w, vm);
 }
 
-static void vm_draw(Widget w, VerticalMeterData *vm)
+/* Cells to fill and to outline for the current value and maxima. */
+static void vm_cell_counts(const VerticalMeterData *vm, int max_cells, int *out_solid, int *out_outlined)
+{
+    int value  = vm->value;
+    int maxval = (vm->maximum > 0) ? vm->maximum : 100;
+    int default_max = (vm->default_max > 0) ? vm->default_max : maxval;
+    if (default_max > maxval) default_max = maxval;
+    if (value < 0) value = 0;
+    if (value > maxval) value = maxval;
+
+    int filled_cells = (max_cells * value + maxval / 2) / maxval;
+    int default_cells = (max_cells * default_max + maxval / 2) / maxval;
+    if (default_cells > max_cells) default_cells = max_cells;
+
+    int solid_cells = filled_cells;
+    if (solid_cells > default_cells) solid_cells = default_cells;
+    *out_solid = solid_cells;
+    *out_outlined = filled_cells - solid_cells;
+}
+
+static int vm_cell_state(int index, int solid, int outlined)
+{
+    if (index < solid) return VM_CELL_SOLID;
+    if (index < solid + outlined) return VM_CELL_OUTLINED;
+    return VM_CELL_EMPTY;
+}
+
+/* Rectangle of cell i; outlines extend one pixel right and down, so the
+ * area cleared before redrawing a cell includes that pixel too. */
+static XRectangle vm_cell_rect(const VerticalMeterData *vm, int index, int with_outline)
+{
+    XRectangle rect;
+    rect.x = (short)vm->cell_x;
+    rect.y = (short)(vm->cell_bottom - index * vm->cell_step - vm->cell_h + 1);
+    rect.width = (unsigned short)(vm->cell_w + (with_outline ? 1 : 0));
+    rect.height = (unsigned short)(vm->cell_h + (with_outline ? 1 : 0));
+    return rect;
+}
+
+/*
+ * Repaints the whole meter into a (new) backing pixmap and copies it to the
+ * window. Used on resize, first expose, or when the pixmap is missing.
+ */
+static void vm_draw_full(Widget w, VerticalMeterData *vm)
 {
     if (!XtIsRealized(w)) return;
 
@@ -252,14 +339,18 @@ static void vm_draw(Widget w, VerticalMeterData *vm)
         return;
     }
 
-    /* Clear background */
-    if (vm->gc_bg) {
-        XFillRectangle(dpy, win, vm->gc_bg, 0, 0, width, height);
-    } else {
-        XSetForeground(dpy, vm->gc_bar, vm->bg);
-        XFillRectangle(dpy, win, vm->gc_bar, 0, 0, width, height);
+    if (!vm->backing || vm->backing_w != width || vm->backing_h != height) {
+        if (vm->backing) XFreePixmap(dpy, vm->backing);
+        int depth = DefaultDepthOfScreen(XtScreen(w));
+        XtVaGetValues(w, XtNdepth, &depth, NULL);
+        vm->backing = XCreatePixmap(dpy, win, width, height, (unsigned int)depth);
+        vm->backing_w = width;
+        vm->backing_h = height;
     }
-    XSetForeground(dpy, vm->gc_bar, vm->bar_color);  /* restore bar color */
+    Drawable d = vm->backing;
+
+    /* Clear background */
+    XFillRectangle(dpy, d, vm->gc_bg, 0, 0, width, height);
 
     /* Draw sunken frame around whole widget */
     /* Outer rectangle border */
@@ -269,14 +360,20 @@ static void vm_draw(Widget w, VerticalMeterData *vm)
     int y1 = (int)height - 1;
 
     /* Sunken: top/left dark (bottomShadow), bottom/right bright (topShadow) */
-    /* Top */
-    XDrawLine(dpy, win, vm->gc_bottom, x0, y0, x1, y0);
-    /* Left */
-    XDrawLine(dpy, win, vm->gc_bottom, x0, y0, x0, y1);
-    /* Bottom */
-    XDrawLine(dpy, win, vm->gc_top, x0, y1, x1, y1);
-    /* Right */
-    XDrawLine(dpy, win, vm->gc_top, x1, y0, x1, y1);
+    XSegment dark[2] = {
+        { (short)x0, (short)y0, (short)x1, (short)y0 },  /* Top */
+        { (short)x0, (short)y0, (short)x0, (short)y1 }   /* Left */
+    };
+    XSegment bright[2] = {
+        { (short)x0, (short)y1, (short)x1, (short)y1 },  /* Bottom */
+        { (short)x1, (short)y0, (short)x1, (short)y1 }   /* Right */
+    };
+    XDrawSegments(dpy, d, vm->gc_bottom, dark, 2);
+    XDrawSegments(dpy, d, vm->gc_top, bright, 2);
+
+    vm->cells = 0;
+    vm->drawn_solid = 0;
+    vm->drawn_outlined = 0;
 
     /* Inner content area (inside the frame + padding) */
     int pad = vm->padding;
@@ -285,8 +382,6 @@ static void vm_draw(Widget w, VerticalMeterData *vm)
     int inner_x1 = x1 - 1 - pad;
     int inner_y1 = y1 - 1 - pad;
 
-    if (inner_x1 <= inner_x0 || inner_y1 <= inner_y0) return;
-
     int inner_w = inner_x1 - inner_x0 + 1;
     int inner_h = inner_y1 - inner_y0 + 1;
 
@@ -307,56 +402,101 @@ static void vm_draw(Widget w, VerticalMeterData *vm)
 
     /* Compute how many cells fit vertically */
     int cell_total = cell_height + cell_gap;
-    if (cell_total <= 0) return;
 
-    int max_cells = inner_h / cell_total;
-    if (max_cells <= 0) {
-        max_cells = 1;
+    if (inner_x1 > inner_x0 && inner_y1 > inner_y0 && cell_total > 0) {
+        int max_cells = inner_h / cell_total;
+        if (max_cells <= 0) {
+            max_cells = 1;
+        }
+        /* The topmost cell must still fit inside the frame */
+        while (max_cells > 0 &&
+               inner_y1 - (max_cells - 1) * cell_total - cell_height + 1 < inner_y0) {
+            max_cells--;
+        }
+
+        XRectangle *rects = (XRectangle *)realloc(vm->rects, sizeof(XRectangle) * 3 * (size_t)(max_cells > 0 ? max_cells : 1));
+        if (rects) {
+            vm->rects = rects;
+            vm->cells = max_cells;
+            vm->cell_x = inner_x0 + (inner_w - cell_width) / 2;
+            vm->cell_bottom = inner_y1;
+            vm->cell_w = cell_width;
+            vm->cell_h = cell_height;
+            vm->cell_step = cell_total;
+        }
     }
 
-    /* Determine how many cells to fill based on value/maximum */
-    int value  = vm->value;
-    int maxval = (vm->maximum > 0) ? vm->maximum : 100;
-    int default_max = (vm->default_max > 0) ? vm->default_max : maxval;
-    if (default_max > maxval) default_max = maxval;
-    if (value < 0) value = 0;
-    if (value > maxval) value = maxval;
+    if (vm->cells > 0) {
+        int solid, outlined;
+        vm_cell_counts(vm, vm->cells, &solid, &outlined);
+        /* Filled cells from the bottom up, then the outlined ones above them */
+        for (int i = 0; i < solid + outlined; ++i) {
+            vm->rects[i] = vm_cell_rect(vm, i, 0);
+        }
+        if (solid > 0) XFillRectangles(dpy, d, vm->gc_bar, vm->rects, solid);
+        if (outlined > 0) XDrawRectangles(dpy, d, vm->gc_bar, vm->rects + solid, outlined);
+        vm->drawn_solid = solid;
+        vm->drawn_outlined = outlined;
+    }
 
-    int filled_cells = (max_cells * value + maxval / 2) / maxval;
-    int default_cells = (max_cells * default_max + maxval / 2) / maxval;
-    if (default_cells > max_cells) default_cells = max_cells;
+    XCopyArea(dpy, d, win, vm->gc_bar, 0, 0, width, height, 0, 0);
+}
 
-    int solid_cells = filled_cells;
-    if (solid_cells > default_cells) solid_cells = default_cells;
-    int outlined_cells = filled_cells - solid_cells;
-
-    /* Draw filled cells from bottom up */
-    int cx = inner_x0 + (inner_w - cell_width) / 2;
-    int cy_bottom = inner_y1;
-
-    for (int i = 0; i < max_cells; ++i) {
-        int cell_y1 = cy_bottom - i * cell_total;
-        int cell_y0 = cell_y1 - cell_height + 1;
-
-        if (cell_y0 < inner_y0) break;
-
-        if (i < solid_cells) {
-            /* Filled cell */
-            XFillRectangle(dpy, win, vm->gc_bar,
-                           cx, cell_y0,
-                           (unsigned int)cell_width,
-                           (unsigned int)cell_height);
-        } else if (i < solid_cells + outlined_cells) {
-            /* Outlined cell */
-            XDrawRectangle(dpy, win, vm->gc_bar,
-                           cx, cell_y0,
-                           (unsigned int)cell_width,
-                           (unsigned int)cell_height);
-        } else {
-            /* Empty cell – optionally draw outline, or skip for clean look */
-            /* Here we just leave it blank so the meter is clean. */
-        }
+/*
+ * Brings the window up to date after a value or maximum change: only cells
+ * whose state differs from what the pixmap holds are repainted, and only the
+ * band spanning them is copied to the window.
+ */
+static void vm_draw(Widget w, VerticalMeterData *vm)
+{
+    if (!XtIsRealized(w)) return;
+
+    Dimension width, height;
+    XtVaGetValues(w, XmNwidth, &width, XmNheight, &height, NULL);
+    if (!vm->backing || vm->backing_w != width || vm->backing_h != height) {
+        vm_draw_full(w, vm);
+        return;
     }
+    if (vm->cells <= 0) return;
+
+    int solid, outlined;
+    vm_cell_counts(vm, vm->cells, &solid, &outlined);
+    if (solid == vm->drawn_solid && outlined == vm->drawn_outlined) return;
+
+    /* Batches: cells to clear, to fill and to outline */
+    XRectangle *clear = vm->rects;
+    XRectangle *fill = vm->rects + vm->cells;
+    XRectangle *outline = vm->rects + 2 * vm->cells;
+    int n_clear = 0, n_fill = 0, n_outline = 0;
+    int low = -1, high = -1;
+
+    for (int i = 0; i < vm->cells; ++i) {
+        int before = vm_cell_state(i, vm->drawn_solid, vm->drawn_outlined);
+        int after = vm_cell_state(i, solid, outlined);
+        if (before == after) continue;
+        if (low < 0) low = i;
+        high = i;
+        /* Filling covers the old outline except its right/bottom pixel */
+        if (before != VM_CELL_EMPTY) clear[n_clear++] = vm_cell_rect(vm, i, 1);
+        if (after == VM_CELL_SOLID) fill[n_fill++] = vm_cell_rect(vm, i, 0);
+        if (after == VM_CELL_OUTLINED) outline[n_outline++] = vm_cell_rect(vm, i, 0);
+    }
+    vm->drawn_solid = solid;
+    vm->drawn_outlined = outlined;
+    if (low < 0) return;
+
+    Display *dpy = XtDisplay(w);
+    if (n_clear > 0) XFillRectangles(dpy, vm->backing, vm->gc_bg, clear, n_clear);
+    if (n_fill > 0) XFillRectangles(dpy, vm->backing, vm->gc_bar, fill, n_fill);
+    if (n_outline > 0) XDrawRectangles(dpy, vm->backing, vm->gc_bar, outline, n_outline);
+
+    /* Cells grow upwards: the band runs from the top of 'high' to below 'low' */
+    XRectangle top = vm_cell_rect(vm, high, 1);
+    XRectangle bottom = vm_cell_rect(vm, low, 1);
+    int band_y = top.y;
+    int band_h = bottom.y + bottom.height - top.y;
+    XCopyArea(dpy, vm->backing, XtWindow(w), vm->gc_bar,
+              top.x, band_y, top.width, (unsigned int)band_h, top.x, band_y);
 }
 
 static double vm_pixel_brightness(Display *dpy, Colormap cmap, Pixel pixel)
@@ -469,5 +609,6 @@ void VerticalMeterSetCellHeight(Widget w, int cell_height)
     if (cell_height < 0) cell_height = 0;
     vm->cell_height = cell_height;
 
-    vm_draw(w, vm);
+    /* The cell layout changes, so the pixmap is repainted from scratch */
+    vm_draw_full(w, vm);
 }
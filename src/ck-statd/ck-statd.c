@@ -0,0 +1,123 @@
+/*
+ * ck-statd: samples system-wide statistics once per interval and publishes
+ * them in shared memory (see src/shared/procfs/stat_shm.h), so ck-load,
+ * ck-tasks and their icons stop reading the same /proc files on timers of
+ * their own.
+ *
+ *   ck-statd [--interval SECONDS] [--proc-root DIR]
+ *
+ * Clients check the segment's age and read /proc themselves when the daemon
+ * is not running, so starting it (for example from the session's startup
+ * programs) is optional. Only one instance publishes at a time.
+ */
+
+#include "../shared/procfs/procfs.h"
+#include "../shared/procfs/stat_shm.h"
+#include "../shared/tool_utils.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STATD_DEFAULT_INTERVAL_MS 1000
+#define STATD_MIN_INTERVAL_MS 100
+
+static volatile sig_atomic_t g_statd_stop = 0;
+
+static void statd_on_signal(int signo)
+{
+    (void)signo;
+    g_statd_stop = 1;
+}
+
+static void statd_usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [--interval SECONDS] [--proc-root DIR]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    int interval_ms = STATD_DEFAULT_INTERVAL_MS;
+    const char *proc_root = NULL;
+    for (int i = 1; i < argc; ++i) {
+        const char *value = NULL;
+        if ((value = tool_option_value(argc, argv, &i, "--interval")) != NULL) {
+            char *end = NULL;
+            double seconds = strtod(value, &end);
+            if (end == value || *end != '\0' || seconds * 1000.0 < STATD_MIN_INTERVAL_MS || seconds > 3600.0) {
+                fprintf(stderr, "ck-statd: interval must be between %.1f and 3600 seconds\n",
+                        STATD_MIN_INTERVAL_MS / 1000.0);
+                statd_usage(argv[0]);
+                return 2;
+            }
+            interval_ms = (int)(seconds * 1000.0 + 0.5);
+        } else if ((value = tool_option_value(argc, argv, &i, "--proc-root")) != NULL) {
+            proc_root = value;
+        } else {
+            fprintf(stderr, "ck-statd: unknown option '%s'\n", argv[i]);
+            statd_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    ProcfsReader reader;
+    if (procfs_reader_open(&reader, proc_root) != 0) {
+        fprintf(stderr, "ck-statd: cannot open %s\n", proc_root ? proc_root : PROCFS_DEFAULT_ROOT);
+        return 1;
+    }
+
+    long configured = sysconf(_SC_NPROCESSORS_CONF);
+    if (configured < 1) configured = 1;
+    if (configured > STAT_SHM_MAX_CORES) configured = STAT_SHM_MAX_CORES;
+    int max_cores = (int)configured;
+    ProcfsCpuTimes *cores = (ProcfsCpuTimes *)calloc((size_t)max_cores, sizeof(ProcfsCpuTimes));
+    if (!cores) {
+        procfs_reader_close(&reader);
+        return 1;
+    }
+
+    char error[256];
+    StatShmWriter writer;
+    if (stat_shm_writer_open(&writer, max_cores, interval_ms, error, sizeof(error)) != 0) {
+        fprintf(stderr, "ck-statd: %s\n", error);
+        free(cores);
+        procfs_reader_close(&reader);
+        return 1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = statd_on_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigaction(SIGHUP, &action, NULL);
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!g_statd_stop) {
+        StatShmSample sample;
+        if (stat_shm_sample_procfs(&reader, &sample, cores, max_cores) == 0) {
+            stat_shm_writer_publish(&writer, &sample, cores);
+        }
+
+        /* Absolute deadlines keep the period from drifting by the sampling time. */
+        tool_timespec_add_ms(&next, interval_ms);
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec > next.tv_sec || (now.tv_sec == next.tv_sec && now.tv_nsec > next.tv_nsec)) {
+            next = now; /* suspended or overloaded: do not catch up with a burst */
+        }
+        while (!g_statd_stop && clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {
+        }
+    }
+
+    stat_shm_writer_close(&writer);
+    free(cores);
+    procfs_reader_close(&reader);
+    return 0;
+}
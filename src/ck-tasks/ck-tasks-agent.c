@@ -0,0 +1,264 @@
+/*
+ * ck-tasks-agent: runs the ck-tasks model on this host and streams process
+ * and system snapshots to ck-tasks (File > Connect) over TCP or a UNIX socket.
+ *
+ *   ck-tasks-agent [--listen ADDRESS] [--interval SECONDS] [--zlib] [--proc-root DIR]
+ *
+ * The default listen address is localhost on TASKS_WIRE_DEFAULT_PORT; use
+ * --listen 0.0.0.0:PORT (or an SSH tunnel) to reach it from elsewhere. There
+ * is no authentication, so only expose it on trusted networks.
+ *
+ * One scan per interval is shared by all clients; each client has its own
+ * encoder, so it only receives what changed since the last frame it was sent.
+ * A client whose previous frame is still queued skips a snapshot instead of
+ * letting frames pile up; its next delta simply covers both intervals.
+ */
+
+#include "ck-tasks-model.h"
+#include "ck-tasks-wire.h"
+#include "../shared/tool_utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define AGENT_DEFAULT_INTERVAL_MS 1000
+#define AGENT_MIN_INTERVAL_MS 100
+#define AGENT_MAX_CLIENTS 16
+
+typedef struct {
+    const char *listen_address;
+    int interval_ms;
+    int compress;
+    const char *proc_root;
+} AgentOptions;
+
+typedef struct {
+    int fd;
+    TasksWireEncoder *encoder;
+    TasksWireBuffer out;
+    size_t out_sent;
+} AgentClient;
+
+static volatile sig_atomic_t g_agent_stop = 0;
+
+static void agent_on_signal(int signo)
+{
+    (void)signo;
+    g_agent_stop = 1;
+}
+
+static void agent_usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [--listen ADDRESS] [--interval SECONDS] [--zlib] [--proc-root DIR]\n"
+            "  ADDRESS is [HOST:]PORT, [V6ADDR]:PORT or unix:PATH (default localhost:%d)\n",
+            argv0, TASKS_WIRE_DEFAULT_PORT);
+}
+
+static int agent_parse_options(int argc, char **argv, AgentOptions *options)
+{
+    static char default_address[32];
+    snprintf(default_address, sizeof(default_address), "localhost:%d", TASKS_WIRE_DEFAULT_PORT);
+    memset(options, 0, sizeof(*options));
+    options->listen_address = default_address;
+    options->interval_ms = AGENT_DEFAULT_INTERVAL_MS;
+    for (int i = 1; i < argc; ++i) {
+        const char *value = NULL;
+        if (strcmp(argv[i], "--zlib") == 0) {
+            options->compress = 1;
+        } else if ((value = tool_option_value(argc, argv, &i, "--listen")) != NULL) {
+            options->listen_address = value;
+        } else if ((value = tool_option_value(argc, argv, &i, "--interval")) != NULL) {
+            char *end = NULL;
+            double seconds = strtod(value, &end);
+            if (end == value || *end != '\0' || seconds * 1000.0 < AGENT_MIN_INTERVAL_MS || seconds > 3600.0) {
+                fprintf(stderr, "ck-tasks-agent: interval must be between %.1f and 3600 seconds\n",
+                        AGENT_MIN_INTERVAL_MS / 1000.0);
+                return -1;
+            }
+            options->interval_ms = (int)(seconds * 1000.0 + 0.5);
+        } else if ((value = tool_option_value(argc, argv, &i, "--proc-root")) != NULL) {
+            options->proc_root = value;
+        } else {
+            fprintf(stderr, "ck-tasks-agent: unknown option '%s'\n", argv[i]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void agent_drop_client(AgentClient *clients, int *count, int index)
+{
+    AgentClient *client = &clients[index];
+    close(client->fd);
+    tasks_wire_encoder_destroy(client->encoder);
+    tasks_wire_buffer_free(&client->out);
+    clients[index] = clients[--*count];
+}
+
+/* Sends as much of the queued frame as the socket takes; -1 if the peer is gone. */
+static int agent_flush(AgentClient *client)
+{
+    while (client->out_sent < client->out.length) {
+        ssize_t rc = send(client->fd, client->out.data + client->out_sent, client->out.length - client->out_sent,
+                          MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (rc < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -1;
+        }
+        client->out_sent += (size_t)rc;
+    }
+    client->out.length = 0;
+    client->out_sent = 0;
+    return 0;
+}
+
+static int agent_send_snapshot(AgentClient *client, TasksProcessList *list, const TasksSystemStats *stats)
+{
+    if (client->out.length > 0) return 0;
+    if (tasks_wire_encode_snapshot(client->encoder, list, stats, &client->out) != 0) return -1;
+    client->out_sent = 0;
+    return agent_flush(client);
+}
+
+static void agent_accept(int listen_fd, AgentClient *clients, int *count, const char *host,
+                         TasksProcessList *list, const TasksSystemStats *stats, int compress)
+{
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) return;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    if (*count >= AGENT_MAX_CLIENTS) {
+        close(fd);
+        return;
+    }
+    AgentClient *client = &clients[*count];
+    memset(client, 0, sizeof(*client));
+    client->fd = fd;
+    client->encoder = tasks_wire_encoder_create(compress);
+    if (!client->encoder || tasks_wire_encode_hello(client->encoder, host, &client->out) != 0) {
+        tasks_wire_encoder_destroy(client->encoder);
+        tasks_wire_buffer_free(&client->out);
+        close(fd);
+        return;
+    }
+    (*count)++;
+    /* Hand over the latest scan right away instead of after an interval. */
+    if (agent_flush(client) != 0 || (list && agent_send_snapshot(client, list, stats) != 0)) {
+        agent_drop_client(clients, count, *count - 1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    AgentOptions options;
+    if (agent_parse_options(argc, argv, &options) != 0) {
+        agent_usage(argv[0]);
+        return 2;
+    }
+
+    char error[256];
+    int listen_fd = tasks_wire_listen(options.listen_address, error, sizeof(error));
+    if (listen_fd < 0) {
+        fprintf(stderr, "ck-tasks-agent: cannot listen on %s\n", error);
+        return 1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = agent_on_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    tasks_model_initialize();
+    if (options.proc_root && tasks_model_set_proc_root(options.proc_root) != 0) {
+        fprintf(stderr, "ck-tasks-agent: cannot use %s as the proc root\n", options.proc_root);
+        tasks_model_shutdown();
+        close(listen_fd);
+        return 1;
+    }
+
+    char host[256];
+    if (gethostname(host, sizeof(host)) != 0) snprintf(host, sizeof(host), "unknown");
+    host[sizeof(host) - 1] = '\0';
+
+    AgentClient clients[AGENT_MAX_CLIENTS];
+    int client_count = 0;
+    TasksProcessList *list = NULL;
+    TasksSystemStats stats;
+    memset(&stats, 0, sizeof(stats));
+    long long next_scan = tool_now_ms();
+    int rc = 0;
+
+    while (!g_agent_stop) {
+        long long now = tool_now_ms();
+        if (now >= next_scan) {
+            /* Keep scanning without clients so CPU figures are ready when one connects. */
+            TasksProcessList *scanned = NULL;
+            if (tasks_model_list_processes(&scanned) == 0 && scanned) {
+                tasks_model_free_processes(list);
+                list = scanned;
+                if (tasks_model_get_system_stats(&stats) != 0) memset(&stats, 0, sizeof(stats));
+                for (int i = client_count - 1; i >= 0; --i) {
+                    if (agent_send_snapshot(&clients[i], list, &stats) != 0) {
+                        agent_drop_client(clients, &client_count, i);
+                    }
+                }
+            } else {
+                fprintf(stderr, "ck-tasks-agent: process scan failed\n");
+            }
+            next_scan += options.interval_ms;
+            if (next_scan <= now) next_scan = now + options.interval_ms;
+        }
+
+        struct pollfd fds[AGENT_MAX_CLIENTS + 1];
+        fds[0].fd = listen_fd;
+        fds[0].events = POLLIN;
+        for (int i = 0; i < client_count; ++i) {
+            fds[i + 1].fd = clients[i].fd;
+            fds[i + 1].events = POLLIN | (clients[i].out.length > 0 ? POLLOUT : 0);
+        }
+        long long wait_ms = next_scan - tool_now_ms();
+        if (wait_ms < 0) wait_ms = 0;
+        int ready = poll(fds, (nfds_t)client_count + 1, (int)wait_ms);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "ck-tasks-agent: poll failed: %s\n", strerror(errno));
+            rc = 1;
+            break;
+        }
+        /* Walk backwards: dropping a client moves the last one into its slot. */
+        for (int i = client_count - 1; i >= 0; --i) {
+            short revents = fds[i + 1].revents;
+            if (!revents) continue;
+            int gone = (revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+            if (!gone && (revents & POLLIN)) {
+                /* Clients send nothing; readable means closed (or junk to discard). */
+                char discard[256];
+                ssize_t n = recv(clients[i].fd, discard, sizeof(discard), MSG_DONTWAIT);
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) gone = 1;
+            }
+            if (!gone && (revents & POLLOUT) && agent_flush(&clients[i]) != 0) gone = 1;
+            if (gone) agent_drop_client(clients, &client_count, i);
+        }
+        if (fds[0].revents & POLLIN) {
+            agent_accept(listen_fd, clients, &client_count, host, list, &stats, options.compress);
+        }
+    }
+
+    while (client_count > 0) agent_drop_client(clients, &client_count, client_count - 1);
+    tasks_model_free_processes(list);
+    tasks_model_shutdown();
+    close(listen_fd);
+    return rc;
+}
@@ -0,0 +1,467 @@
+#include "ck-tasks-batch.h"
+#include "ck-tasks-model.h"
+#include "../shared/tool_utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH_DEFAULT_INTERVAL_MS 1000
+#define BATCH_MIN_INTERVAL_MS 50
+#define BATCH_INITIAL_BUFFER 65536
+
+typedef enum {
+    BATCH_FORMAT_CSV,
+    BATCH_FORMAT_JSONL,
+} BatchFormat;
+
+typedef struct {
+    int interval_ms;
+    BatchFormat format;
+    long count;              /* snapshots to write, 0 = until interrupted */
+    const char *output_path; /* NULL = stdout */
+    const char *proc_root;
+} BatchOptions;
+
+/* Output for one snapshot; grows to the largest snapshot seen and is reused. */
+typedef struct {
+    char *data;
+    size_t used;
+    size_t capacity;
+    int failed;
+} BatchBuffer;
+
+static volatile sig_atomic_t g_batch_stop = 0;
+
+static const char *const batch_csv_header =
+    "time,event,pid,name,user,cpu_percent,memory_mb,threads,command,"
+    "memory_percent,mem_used_kb,mem_total_kb,load1_percent,load5_percent,load15_percent\n";
+
+static void batch_on_signal(int signo)
+{
+    (void)signo;
+    g_batch_stop = 1;
+}
+
+static int buffer_reserve(BatchBuffer *buffer, size_t extra)
+{
+    if (buffer->failed) return -1;
+    if (buffer->used + extra <= buffer->capacity) return 0;
+    size_t capacity = buffer->capacity ? buffer->capacity : BATCH_INITIAL_BUFFER;
+    while (capacity < buffer->used + extra) capacity *= 2;
+    char *data = (char *)realloc(buffer->data, capacity);
+    if (!data) {
+        buffer->failed = 1;
+        return -1;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 0;
+}
+
+static void buffer_append(BatchBuffer *buffer, const char *text, size_t len)
+{
+    if (buffer_reserve(buffer, len) != 0) return;
+    memcpy(buffer->data + buffer->used, text, len);
+    buffer->used += len;
+}
+
+static void buffer_printf(BatchBuffer *buffer, const char *format, ...)
+{
+    if (buffer_reserve(buffer, 128) != 0) return;
+    for (;;) {
+        size_t room = buffer->capacity - buffer->used;
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buffer->data + buffer->used, room, format, args);
+        va_end(args);
+        if (len < 0) {
+            buffer->failed = 1;
+            return;
+        }
+        if ((size_t)len < room) {
+            buffer->used += (size_t)len;
+            return;
+        }
+        if (buffer_reserve(buffer, (size_t)len + 1) != 0) return;
+    }
+}
+
+/* Quotes the field only if it needs it (RFC 4180). */
+static void buffer_append_csv(BatchBuffer *buffer, const char *text)
+{
+    if (!text) return;
+    size_t len = strlen(text);
+    if (strcspn(text, ",\"\r\n") == len) {
+        buffer_append(buffer, text, len);
+        return;
+    }
+    if (buffer_reserve(buffer, len * 2 + 2) != 0) return;
+    char *out = buffer->data + buffer->used;
+    *out++ = '"';
+    for (const char *p = text; *p; ++p) {
+        if (*p == '"') *out++ = '"';
+        *out++ = *p;
+    }
+    *out++ = '"';
+    buffer->used = (size_t)(out - buffer->data);
+}
+
+static void buffer_append_json(BatchBuffer *buffer, const char *text)
+{
+    if (!text) text = "";
+    size_t len = strlen(text);
+    /* Worst case every byte becomes a \u00XX escape. */
+    if (buffer_reserve(buffer, len * 6 + 2) != 0) return;
+    char *out = buffer->data + buffer->used;
+    *out++ = '"';
+    for (const unsigned char *p = (const unsigned char *)text; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            *out++ = '\\';
+            *out++ = (char)*p;
+        } else if (*p < 0x20) {
+            out += sprintf(out, "\\u%04x", (unsigned int)*p);
+        } else {
+            *out++ = (char)*p;
+        }
+    }
+    *out++ = '"';
+    buffer->used = (size_t)(out - buffer->data);
+}
+
+static void batch_format_time(char *out, size_t out_len)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    snprintf(out, out_len, "%lld.%03ld", (long long)now.tv_sec, now.tv_nsec / 1000000L);
+}
+
+static void batch_write_system(BatchBuffer *buffer, BatchFormat format, const char *time_text,
+                               const TasksSystemStats *stats)
+{
+    if (format == BATCH_FORMAT_CSV) {
+        buffer_printf(buffer, "%s,system,,,,%d,,,,%d,%lu,%lu,%d,%d,%d\n", time_text, stats->cpu_percent,
+                      stats->memory_percent, stats->mem_used_kb, stats->mem_total_kb, stats->load1_percent,
+                      stats->load5_percent, stats->load15_percent);
+    } else {
+        buffer_printf(buffer,
+                      "{\"time\":%s,\"event\":\"system\",\"cpu_percent\":%d,\"memory_percent\":%d,"
+                      "\"mem_used_kb\":%lu,\"mem_total_kb\":%lu,\"load1_percent\":%d,\"load5_percent\":%d,"
+                      "\"load15_percent\":%d}\n",
+                      time_text, stats->cpu_percent, stats->memory_percent, stats->mem_used_kb, stats->mem_total_kb,
+                      stats->load1_percent, stats->load5_percent, stats->load15_percent);
+    }
+}
+
+/*
+ * One process row. Started processes carry every field including the command
+ * line; changed ones carry the fields in `fields` (JSON) or everything but
+ * the command (CSV, which has fixed columns).
+ */
+static void batch_write_process(BatchBuffer *buffer, BatchFormat format, const char *time_text,
+                                const char *event, TasksProcessList *list, int index, unsigned int fields)
+{
+    int started = strcmp(event, "start") == 0;
+    if (format == BATCH_FORMAT_CSV) {
+        buffer_printf(buffer, "%s,%s,%d,", time_text, event, (int)list->pids[index]);
+        buffer_append_csv(buffer, tasks_model_process_name(list, index));
+        buffer_append(buffer, ",", 1);
+        buffer_append_csv(buffer, tasks_model_process_user(list, index));
+        buffer_printf(buffer, ",%.1f,%.1f,%d,", list->cpu_percent[index], list->memory_mb[index],
+                      list->threads[index]);
+        if (started) buffer_append_csv(buffer, tasks_model_process_command(list, index));
+        buffer_append(buffer, ",,,,,,\n", 7);
+        return;
+    }
+
+    buffer_printf(buffer, "{\"time\":%s,\"event\":\"%s\",\"pid\":%d", time_text, event, (int)list->pids[index]);
+    if (fields & TASKS_PROCESS_FIELD_NAME) {
+        buffer_append(buffer, ",\"name\":", 8);
+        buffer_append_json(buffer, tasks_model_process_name(list, index));
+    }
+    if (fields & TASKS_PROCESS_FIELD_USER) {
+        buffer_append(buffer, ",\"user\":", 8);
+        buffer_append_json(buffer, tasks_model_process_user(list, index));
+    }
+    if (fields & TASKS_PROCESS_FIELD_CPU) buffer_printf(buffer, ",\"cpu_percent\":%.1f", list->cpu_percent[index]);
+    if (fields & TASKS_PROCESS_FIELD_MEMORY) buffer_printf(buffer, ",\"memory_mb\":%.1f", list->memory_mb[index]);
+    if (fields & TASKS_PROCESS_FIELD_THREADS) buffer_printf(buffer, ",\"threads\":%d", list->threads[index]);
+    if (started) {
+        buffer_append(buffer, ",\"command\":", 11);
+        buffer_append_json(buffer, tasks_model_process_command(list, index));
+    }
+    buffer_append(buffer, "}\n", 2);
+}
+
+static void batch_write_exit(BatchBuffer *buffer, BatchFormat format, const char *time_text, pid_t pid)
+{
+    if (format == BATCH_FORMAT_CSV) {
+        buffer_printf(buffer, "%s,exit,%d,,,,,,,,,,,,\n", time_text, (int)pid);
+    } else {
+        buffer_printf(buffer, "{\"time\":%s,\"event\":\"exit\",\"pid\":%d}\n", time_text, (int)pid);
+    }
+}
+
+/* Returns 0, or -1 with errno set (EPIPE when the reader went away). */
+static int batch_flush(BatchBuffer *buffer, int fd)
+{
+    size_t offset = 0;
+    while (offset < buffer->used) {
+        ssize_t written = write(fd, buffer->data + offset, buffer->used - offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        offset += (size_t)written;
+    }
+    buffer->used = 0;
+    return 0;
+}
+
+/* Values are written with one decimal; smaller movements are not a change. */
+static long batch_tenths(double value)
+{
+    return (long)(value * 10.0 + (value < 0.0 ? -0.5 : 0.5));
+}
+
+static unsigned int batch_changed_fields(const TasksProcessList *old_list, int old_index,
+                                         const TasksProcessList *new_list, int new_index)
+{
+    unsigned int fields = 0;
+    if (batch_tenths(old_list->cpu_percent[old_index]) != batch_tenths(new_list->cpu_percent[new_index])) {
+        fields |= TASKS_PROCESS_FIELD_CPU;
+    }
+    if (batch_tenths(old_list->memory_mb[old_index]) != batch_tenths(new_list->memory_mb[new_index])) {
+        fields |= TASKS_PROCESS_FIELD_MEMORY;
+    }
+    if (old_list->threads[old_index] != new_list->threads[new_index]) fields |= TASKS_PROCESS_FIELD_THREADS;
+    if (strcmp(tasks_model_process_name(old_list, old_index), tasks_model_process_name(new_list, new_index)) != 0) {
+        fields |= TASKS_PROCESS_FIELD_NAME;
+    }
+    if (strcmp(tasks_model_process_user(old_list, old_index), tasks_model_process_user(new_list, new_index)) != 0) {
+        fields |= TASKS_PROCESS_FIELD_USER;
+    }
+    return fields;
+}
+
+static int compare_ints(const void *a, const void *b)
+{
+    int left = *(const int *)a;
+    int right = *(const int *)b;
+    return (left > right) - (left < right);
+}
+
+/*
+ * Formats the stats and the difference between the previous and the new
+ * view. The diff supplies the pid matching; changes are judged on the
+ * written values, so sub-0.1 jitter does not produce rows.
+ */
+static void batch_write_snapshot(BatchBuffer *buffer, BatchFormat format, const TasksSystemStats *stats,
+                                 int stats_ok, const TasksProcessView *old_view, const TasksProcessView *new_view,
+                                 TasksProcessDiff *diff)
+{
+    char time_text[32];
+    batch_format_time(time_text, sizeof(time_text));
+    if (stats_ok) batch_write_system(buffer, format, time_text, stats);
+
+    for (int i = 0; i < diff->old_count; ++i) {
+        if (diff->old_to_new[i] < 0) {
+            batch_write_exit(buffer, format, time_text, old_view->list->pids[old_view->rows[i]]);
+        }
+    }
+    /* Added rows come out of the pid hash; keep the output in pid order. */
+    if (diff->added_count > 1) qsort(diff->added, (size_t)diff->added_count, sizeof(int), compare_ints);
+    const unsigned int all_fields = TASKS_PROCESS_FIELD_NAME | TASKS_PROCESS_FIELD_USER | TASKS_PROCESS_FIELD_CPU |
+                                    TASKS_PROCESS_FIELD_MEMORY | TASKS_PROCESS_FIELD_THREADS;
+    for (int i = 0; i < diff->added_count; ++i) {
+        batch_write_process(buffer, format, time_text, "start", new_view->list, new_view->rows[diff->added[i]],
+                            all_fields);
+    }
+    for (int i = 0; i < diff->old_count; ++i) {
+        int match = diff->old_to_new[i];
+        if (match < 0) continue;
+        int new_index = new_view->rows[match];
+        unsigned int fields = batch_changed_fields(old_view->list, old_view->rows[i], new_view->list, new_index);
+        if (fields) batch_write_process(buffer, format, time_text, "change", new_view->list, new_index, fields);
+    }
+}
+
+static void batch_usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s --batch [--interval SECONDS] [--format csv|jsonl] [--count N]\n"
+            "          [--output FILE] [--proc-root DIR]\n",
+            argv0);
+}
+
+static int batch_parse_options(int argc, char **argv, BatchOptions *options)
+{
+    memset(options, 0, sizeof(*options));
+    options->interval_ms = BATCH_DEFAULT_INTERVAL_MS;
+    options->format = BATCH_FORMAT_CSV;
+    for (int i = 1; i < argc; ++i) {
+        const char *value = NULL;
+        if (strcmp(argv[i], "--batch") == 0) continue;
+        if ((value = tool_option_value(argc, argv, &i, "--interval")) != NULL) {
+            char *end = NULL;
+            double seconds = strtod(value, &end);
+            if (end == value || *end != '\0' || seconds * 1000.0 < BATCH_MIN_INTERVAL_MS || seconds > 86400.0) {
+                fprintf(stderr, "ck-tasks: interval must be between %.2f and 86400 seconds\n",
+                        BATCH_MIN_INTERVAL_MS / 1000.0);
+                return -1;
+            }
+            options->interval_ms = (int)(seconds * 1000.0 + 0.5);
+        } else if ((value = tool_option_value(argc, argv, &i, "--format")) != NULL) {
+            if (strcmp(value, "csv") == 0) {
+                options->format = BATCH_FORMAT_CSV;
+            } else if (strcmp(value, "jsonl") == 0) {
+                options->format = BATCH_FORMAT_JSONL;
+            } else {
+                fprintf(stderr, "ck-tasks: unknown format '%s' (csv or jsonl)\n", value);
+                return -1;
+            }
+        } else if ((value = tool_option_value(argc, argv, &i, "--count")) != NULL) {
+            char *end = NULL;
+            options->count = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || options->count < 0) {
+                fprintf(stderr, "ck-tasks: invalid count '%s'\n", value);
+                return -1;
+            }
+        } else if ((value = tool_option_value(argc, argv, &i, "--output")) != NULL) {
+            options->output_path = value;
+        } else if ((value = tool_option_value(argc, argv, &i, "--proc-root")) != NULL) {
+            options->proc_root = value;
+        } else {
+            fprintf(stderr, "ck-tasks: unknown batch option '%s'\n", argv[i]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int tasks_batch_requested(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i] && strcmp(argv[i], "--batch") == 0) return 1;
+    }
+    return 0;
+}
+
+int tasks_batch_main(int argc, char **argv)
+{
+    BatchOptions options;
+    if (batch_parse_options(argc, argv, &options) != 0) {
+        batch_usage(argv[0]);
+        return 2;
+    }
+
+    int fd = STDOUT_FILENO;
+    if (options.output_path) {
+        fd = open(options.output_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            fprintf(stderr, "ck-tasks: cannot open %s: %s\n", options.output_path, strerror(errno));
+            return 1;
+        }
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = batch_on_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    /* A closed pipe shows up as EPIPE from write() and ends the run. */
+    signal(SIGPIPE, SIG_IGN);
+
+    tasks_model_initialize();
+    if (options.proc_root && tasks_model_set_proc_root(options.proc_root) != 0) {
+        fprintf(stderr, "ck-tasks: cannot use %s as the proc root\n", options.proc_root);
+        tasks_model_shutdown();
+        if (fd != STDOUT_FILENO) close(fd);
+        return 1;
+    }
+
+    BatchBuffer buffer = {0};
+    TasksProcessView views[2] = {{0}, {0}};
+    TasksProcessView *old_view = &views[0];
+    TasksProcessView *new_view = &views[1];
+    TasksProcessDiff diff;
+    memset(&diff, 0, sizeof(diff));
+    int rc = 0;
+
+    if (options.format == BATCH_FORMAT_CSV) buffer_append(&buffer, batch_csv_header, strlen(batch_csv_header));
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    for (long written = 0; !g_batch_stop && (options.count == 0 || written < options.count); ++written) {
+        if (written > 0) {
+            tool_timespec_add_ms(&deadline, options.interval_ms);
+            int sleep_rc;
+            do {
+                sleep_rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+            } while (sleep_rc == EINTR && !g_batch_stop);
+            if (g_batch_stop) break;
+        }
+
+        TasksSystemStats stats;
+        int stats_ok = tasks_model_get_system_stats(&stats) == 0;
+        TasksProcessList *list = NULL;
+        if (tasks_model_list_processes(&list) != 0 || !list) {
+            fprintf(stderr, "ck-tasks: process scan failed\n");
+            rc = 1;
+            break;
+        }
+        if (tasks_model_reserve_process_view(new_view, list->count) != 0) {
+            tasks_model_free_processes(list);
+            rc = 1;
+            break;
+        }
+        new_view->list = list;
+        new_view->count = list->count;
+        for (int i = 0; i < list->count; ++i) new_view->rows[i] = i;
+
+        if (tasks_model_diff_processes(old_view, new_view, &diff) != 0) {
+            rc = 1;
+        } else {
+            batch_write_snapshot(&buffer, options.format, &stats, stats_ok, old_view, new_view, &diff);
+        }
+        if (rc == 0 && buffer.failed) {
+            fprintf(stderr, "ck-tasks: out of memory formatting snapshot\n");
+            rc = 1;
+        }
+        if (rc == 0 && batch_flush(&buffer, fd) != 0) {
+            if (errno != EPIPE) {
+                fprintf(stderr, "ck-tasks: write failed: %s\n", strerror(errno));
+                rc = 1;
+            }
+            g_batch_stop = 1;
+        }
+
+        /* The new view becomes the baseline for the next delta. */
+        tasks_model_free_processes(old_view->list);
+        old_view->list = NULL;
+        old_view->count = 0;
+        TasksProcessView *swap = old_view;
+        old_view = new_view;
+        new_view = swap;
+        if (rc != 0) break;
+    }
+
+    tasks_model_free_processes(old_view->list);
+    tasks_model_free_process_view(&views[0]);
+    tasks_model_free_process_view(&views[1]);
+    tasks_model_free_process_diff(&diff);
+    free(buffer.data);
+    tasks_model_shutdown();
+    if (fd != STDOUT_FILENO && close(fd) != 0 && rc == 0) {
+        fprintf(stderr, "ck-tasks: cannot close %s: %s\n", options.output_path, strerror(errno));
+        rc = 1;
+    }
+    return rc;
+}
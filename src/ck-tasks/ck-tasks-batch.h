@@ -0,0 +1,20 @@
+#ifndef CK_TASKS_BATCH_H
+#define CK_TASKS_BATCH_H
+
+/*
+ * Headless export mode: ck-tasks --batch [--interval SECONDS] [--format csv|jsonl]
+ * [--count N] [--output FILE] [--proc-root DIR].
+ *
+ * Runs the model without Xt and streams one record per snapshot with the
+ * system stats, followed by the processes that started, changed or exited
+ * since the previous snapshot (the first snapshot lists every process).
+ * A snapshot is formatted into one reusable buffer and written with a
+ * single write().
+ */
+
+/* True if argv asks for batch mode; main() must check before touching Xt. */
+int tasks_batch_requested(int argc, char **argv);
+/* Returns the process exit status. */
+int tasks_batch_main(int argc, char **argv);
+
+#endif /* CK_TASKS_BATCH_H */
@@ -0,0 +1,777 @@
+/*
+ * ck-tasks-bench: refresh benchmark for the ck-tasks model.
+ *
+ * Builds a synthetic system in a temporary directory and points the model at
+ * it, so no X server and no particular host are needed:
+ *
+ *   proc/      stat, meminfo, loadavg, uptime and <pid>/{stat,status,cmdline}
+ *              for every pid; a quarter of the pids get multi-kilobyte
+ *              command lines
+ *   etc/       init.d scripts with LSB headers and rc3.d start links
+ *   utmp       a run level record and a set of user sessions
+ *   cgroup/    a cgroup v2 tree of four slices holding the groups; a
+ *              quarter of the groups have processes
+ *
+ * For every pid count it times tasks_model_list_processes() plus the command
+ * lookups a visible page of the process table makes. Every refresh advances
+ * uptime and the per-pid tick counters, and a slice of pids is replaced
+ * between refreshes so stale sample eviction is exercised as well as
+ * lookups. Each list is also searched the way the process filter does it:
+ * the search index is built and a query is typed one character at a time.
+ * tasks_model_list_services(), tasks_model_list_users() and
+ * tasks_model_list_cgroups() are timed once against the same tree, and
+ * again with one init script, utmp or one group's cgroup.events changed
+ * before every refresh.
+ *
+ * Latencies are reported as percentiles over the warm refreshes (the first,
+ * cold refresh is reported on its own) together with the number of heap
+ * allocations per refresh. Allocations are counted by wrapping malloc,
+ * calloc, realloc and strdup at link time (see the Makefile rule), so only
+ * calls made from the model and the shared procfs code are seen.
+ *
+ * Usage: ck-tasks-bench [-n pids[,pids...]] [-i iterations] [-s services] [-u users] [-c cgroups]
+ */
+
+#include "ck-tasks-model.h"
+#include "ck-tasks-search.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <utmp.h>
+
+#define BENCH_DEFAULT_PID_COUNTS "1000,10000,50000"
+#define BENCH_DEFAULT_ITERATIONS 20
+#define BENCH_DEFAULT_SERVICES 200
+#define BENCH_DEFAULT_USERS 64
+#define BENCH_DEFAULT_CGROUPS 1000
+#define BENCH_CGROUP_SLICES 4
+#define BENCH_MAX_PID_COUNTS 16
+#define BENCH_FIRST_PID 100
+/* Rows whose command a refresh resolves, like one screen of the process table. */
+#define BENCH_VISIBLE_ROWS 40
+#define BENCH_LONG_CMDLINE_ARGS 48
+/* Typed into the process filter one character at a time. */
+#define BENCH_SEARCH_QUERY "Bench-12"
+
+static char g_root[PATH_MAX];
+static char g_proc_root[PATH_MAX + 8];
+static unsigned long g_allocations = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+char *__real_strdup(const char *str);
+
+void *__wrap_malloc(size_t size)
+{
+    g_allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    g_allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    g_allocations++;
+    return __real_realloc(ptr, size);
+}
+
+char *__wrap_strdup(const char *str)
+{
+    g_allocations++;
+    return __real_strdup(str);
+}
+
+typedef struct {
+    double *ms;
+    unsigned long *allocations;
+    int count;
+} BenchSamples;
+
+static int write_file(const char *path, const char *data, size_t len)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        fprintf(stderr, "ck-tasks-bench: cannot write %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    size_t written = fwrite(data, 1, len, fp);
+    int close_rc = fclose(fp);
+    return (written == len && close_rc == 0) ? 0 : -1;
+}
+
+static int make_dir(const char *path)
+{
+    if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "ck-tasks-bench: cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int write_system_files(int iteration)
+{
+    char path[PATH_MAX + 32];
+    char data[512];
+    int len;
+
+    unsigned long long busy = 1000ULL * (unsigned long long)(iteration + 1);
+    len = snprintf(data, sizeof(data), "cpu  %llu 0 %llu %llu 0 0 0 0 0 0\n", busy, busy / 2, busy * 4);
+    snprintf(path, sizeof(path), "%s/stat", g_proc_root);
+    if (write_file(path, data, (size_t)len) != 0) return -1;
+
+    len = snprintf(data, sizeof(data),
+                   "MemTotal:       16384000 kB\nMemFree:         8192000 kB\n"
+                   "MemAvailable:   12288000 kB\nSwapTotal:       2048000 kB\nSwapFree:        2048000 kB\n");
+    snprintf(path, sizeof(path), "%s/meminfo", g_proc_root);
+    if (write_file(path, data, (size_t)len) != 0) return -1;
+
+    len = snprintf(data, sizeof(data), "0.50 0.40 0.30 1/100 100\n");
+    snprintf(path, sizeof(path), "%s/loadavg", g_proc_root);
+    if (write_file(path, data, (size_t)len) != 0) return -1;
+
+    len = snprintf(data, sizeof(data), "%d.00 0.00\n", 1000 + iteration * 2);
+    snprintf(path, sizeof(path), "%s/uptime", g_proc_root);
+    return write_file(path, data, (size_t)len);
+}
+
+/* NUL-separated argv; every fourth pid looks like a JVM with a long class path. */
+static size_t format_cmdline(char *data, size_t data_len, pid_t pid)
+{
+    size_t len = (size_t)snprintf(data, data_len, "/usr/bin/bench-%d", (int)pid) + 1;
+    if (pid % 4 == 0) {
+        for (int i = 0; i < BENCH_LONG_CMDLINE_ARGS && len < data_len; ++i) {
+            len += (size_t)snprintf(data + len, data_len - len,
+                                    "-Dbench.option.%d=/opt/bench/lib/module-%d/classes:/opt/bench/lib/extra",
+                                    i, (int)pid) + 1;
+        }
+    }
+    if (len < data_len) {
+        len += (size_t)snprintf(data + len, data_len - len, "--worker=%d", (int)pid) + 1;
+    }
+    return len < data_len ? len : data_len;
+}
+
+static int write_pid(pid_t pid, int iteration)
+{
+    char path[PATH_MAX + 32];
+    char data[8192];
+    int len;
+
+    snprintf(path, sizeof(path), "%s/%d", g_proc_root, (int)pid);
+    if (make_dir(path) != 0) return -1;
+
+    unsigned long long utime = (unsigned long long)(pid % 97) * (unsigned long long)(iteration + 1);
+    len = snprintf(data, sizeof(data),
+                   "%d (bench-%d) S 1 %d %d 0 -1 4194560 100 0 0 0 %llu %llu 0 0 20 0 %d 0 100 "
+                   "10485760 %d 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 0 0 0 0 0 0\n",
+                   (int)pid, (int)pid, (int)pid, (int)pid, utime, utime / 2, 1 + (int)(pid % 8),
+                   256 + (int)(pid % 1024));
+    snprintf(path, sizeof(path), "%s/%d/stat", g_proc_root, (int)pid);
+    if (write_file(path, data, (size_t)len) != 0) return -1;
+
+    if (iteration > 0) return 0;
+
+    len = snprintf(data, sizeof(data), "Name:\tbench-%d\nState:\tS (sleeping)\nUid:\t%d\t%d\t%d\t%d\n",
+                   (int)pid, (int)(pid % 3), (int)(pid % 3), (int)(pid % 3), (int)(pid % 3));
+    snprintf(path, sizeof(path), "%s/%d/status", g_proc_root, (int)pid);
+    if (write_file(path, data, (size_t)len) != 0) return -1;
+
+    size_t cmdline_len = format_cmdline(data, sizeof(data), pid);
+    snprintf(path, sizeof(path), "%s/%d/cmdline", g_proc_root, (int)pid);
+    return write_file(path, data, cmdline_len);
+}
+
+static void remove_pid(pid_t pid)
+{
+    static const char *const files[] = { "stat", "status", "cmdline" };
+    char path[PATH_MAX + 32];
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+        snprintf(path, sizeof(path), "%s/%d/%s", g_proc_root, (int)pid, files[i]);
+        unlink(path);
+    }
+    snprintf(path, sizeof(path), "%s/%d", g_proc_root, (int)pid);
+    rmdir(path);
+}
+
+static void remove_tree(const char *path)
+{
+    DIR *dp = opendir(path);
+    if (dp) {
+        struct dirent *ent = NULL;
+        while ((ent = readdir(dp)) != NULL) {
+            if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+            char child[PATH_MAX];
+            snprintf(child, sizeof(child), "%s/%s", path, ent->d_name);
+            struct stat st;
+            if (lstat(child, &st) == 0 && S_ISDIR(st.st_mode)) {
+                remove_tree(child);
+            } else {
+                unlink(child);
+            }
+        }
+        closedir(dp);
+    }
+    rmdir(path);
+}
+
+/* etc/init.d/bench-svc-N scripts; every other one is started from rc3.d. */
+static int write_services(int service_count)
+{
+    char path[PATH_MAX + 64];
+    char target[64];
+    char data[1024];
+    static const char *const dirs[] = { "etc", "etc/init.d", "etc/rc3.d" };
+    for (size_t i = 0; i < sizeof(dirs) / sizeof(dirs[0]); ++i) {
+        snprintf(path, sizeof(path), "%s/%s", g_root, dirs[i]);
+        if (make_dir(path) != 0) return -1;
+    }
+    for (int i = 0; i < service_count; ++i) {
+        int len = snprintf(data, sizeof(data),
+                           "#!/bin/sh\n"
+                           "### BEGIN INIT INFO\n"
+                           "# Provides:          bench-svc-%d\n"
+                           "# Required-Start:    $local_fs $network\n"
+                           "# Required-Stop:     $local_fs\n"
+                           "# Default-Start:     2 3 4 5\n"
+                           "# Default-Stop:      0 1 6\n"
+                           "# Short-Description: Benchmark service %d\n"
+                           "# Description:       Synthetic init script generated by ck-tasks-bench.\n"
+                           "### END INIT INFO\n"
+                           "exit 0\n",
+                           i, i);
+        snprintf(path, sizeof(path), "%s/etc/init.d/bench-svc-%d", g_root, i);
+        if (write_file(path, data, (size_t)len) != 0) return -1;
+        chmod(path, 0755);
+        if (i % 2 != 0) continue;
+        snprintf(target, sizeof(target), "../init.d/bench-svc-%d", i);
+        snprintf(path, sizeof(path), "%s/etc/rc3.d/S%02dbench-svc-%d", g_root, i % 100, i);
+        if (symlink(target, path) != 0 && errno != EEXIST) {
+            fprintf(stderr, "ck-tasks-bench: cannot link %s: %s\n", path, strerror(errno));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* A run level 3 record followed by user_count sessions. */
+static int write_utmp(const char *path, int user_count)
+{
+    struct utmp *records = (struct utmp *)calloc((size_t)user_count + 1, sizeof(struct utmp));
+    if (!records) return -1;
+    records[0].ut_type = RUN_LVL;
+    records[0].ut_pid = '3';
+    snprintf(records[0].ut_user, sizeof(records[0].ut_user), "runlevel");
+    snprintf(records[0].ut_line, sizeof(records[0].ut_line), "~");
+    time_t now = time(NULL);
+    for (int i = 0; i < user_count; ++i) {
+        struct utmp *ut = &records[i + 1];
+        ut->ut_type = USER_PROCESS;
+        ut->ut_pid = BENCH_FIRST_PID + i;
+        snprintf(ut->ut_user, sizeof(ut->ut_user), "bench%d", i);
+        snprintf(ut->ut_line, sizeof(ut->ut_line), "pts/%d", i);
+        snprintf(ut->ut_id, sizeof(ut->ut_id), "%u", (unsigned int)i % 1000U);
+        snprintf(ut->ut_host, sizeof(ut->ut_host), "host-%d.example.org", i);
+        ut->ut_tv.tv_sec = (int32_t)(now - i * 60);
+    }
+    int rc = write_file(path, (const char *)records, sizeof(struct utmp) * ((size_t)user_count + 1));
+    free(records);
+    return rc;
+}
+
+static int write_cgroup_files(const char *dir, int group, int populated)
+{
+    static const char *const names[] = { "cgroup.events", "cpu.stat", "memory.current", "io.stat", "pids.current" };
+    char path[PATH_MAX + 64];
+    char data[256];
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        int len = 0;
+        switch (i) {
+        case 0:
+            len = snprintf(data, sizeof(data), "populated %d\nfrozen 0\n", populated);
+            break;
+        case 1:
+            len = snprintf(data, sizeof(data), "usage_usec %d\nuser_usec %d\nsystem_usec 0\n",
+                           group * 1000, group * 1000);
+            break;
+        case 2:
+            len = snprintf(data, sizeof(data), "%d\n", group * 4096);
+            break;
+        case 3:
+            len = snprintf(data, sizeof(data),
+                           "8:0 rbytes=%d wbytes=%d rios=1 wios=1 dbytes=0 dios=0\n", group * 512, group * 256);
+            break;
+        default:
+            len = snprintf(data, sizeof(data), "%d\n", populated ? 1 + group % 8 : 0);
+            break;
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        if (write_file(path, data, (size_t)len) != 0) return -1;
+    }
+    return 0;
+}
+
+/* cgroup/bench-N.slice/group-M.scope; every fourth group is populated. */
+static int write_cgroups(int group_count)
+{
+    char path[PATH_MAX + 64];
+    snprintf(path, sizeof(path), "%s/cgroup", g_root);
+    if (make_dir(path) != 0) return -1;
+    snprintf(path, sizeof(path), "%s/cgroup/cgroup.controllers", g_root);
+    if (write_file(path, "cpu io memory pids\n", 19) != 0) return -1;
+    for (int slice = 0; slice < BENCH_CGROUP_SLICES; ++slice) {
+        snprintf(path, sizeof(path), "%s/cgroup/bench-%d.slice", g_root, slice);
+        if (make_dir(path) != 0 || write_cgroup_files(path, slice, 1) != 0) return -1;
+    }
+    for (int i = 0; i < group_count; ++i) {
+        snprintf(path, sizeof(path), "%s/cgroup/bench-%d.slice/group-%d.scope", g_root, i % BENCH_CGROUP_SLICES, i);
+        if (make_dir(path) != 0 || write_cgroup_files(path, i, i % 4 == 0) != 0) return -1;
+    }
+    return 0;
+}
+
+static double elapsed_ms(const struct timespec *start, const struct timespec *end)
+{
+    return (double)(end->tv_sec - start->tv_sec) * 1000.0 + (double)(end->tv_nsec - start->tv_nsec) / 1.0e6;
+}
+
+static int samples_init(BenchSamples *samples, int capacity)
+{
+    samples->ms = (double *)calloc((size_t)capacity, sizeof(double));
+    samples->allocations = (unsigned long *)calloc((size_t)capacity, sizeof(unsigned long));
+    samples->count = 0;
+    return (samples->ms && samples->allocations) ? 0 : -1;
+}
+
+static void samples_free(BenchSamples *samples)
+{
+    free(samples->ms);
+    free(samples->allocations);
+    samples->ms = NULL;
+    samples->allocations = NULL;
+    samples->count = 0;
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double left = *(const double *)a;
+    double right = *(const double *)b;
+    return (left > right) - (left < right);
+}
+
+/* Nearest-rank percentile of a sorted array. */
+static double percentile(const double *sorted, int count, int pct)
+{
+    int rank = (pct * count + 99) / 100;
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
+/* Prints one result line; samples[0] is the cold refresh, the rest are warm. */
+static void report(const char *label, BenchSamples *samples)
+{
+    if (samples->count <= 0) return;
+    printf("%-22s cold %8.2f ms %7lu allocs", label, samples->ms[0], samples->allocations[0]);
+    int warm = samples->count - 1;
+    if (warm > 0) {
+        unsigned long alloc_total = 0;
+        for (int i = 1; i < samples->count; ++i) alloc_total += samples->allocations[i];
+        qsort(samples->ms + 1, (size_t)warm, sizeof(double), compare_doubles);
+        const double *sorted = samples->ms + 1;
+        printf(" | warm p50 %8.2f p90 %8.2f p99 %8.2f max %8.2f ms %7.1f allocs",
+               percentile(sorted, warm, 50), percentile(sorted, warm, 90), percentile(sorted, warm, 99),
+               sorted[warm - 1], (double)alloc_total / warm);
+    }
+    printf("\n");
+}
+
+/* Builds the index for list and types BENCH_SEARCH_QUERY, each keystroke
+ * re-testing only the rows the previous prefix matched. Returns the matches. */
+static int bench_search(const TasksProcessList *list, TasksSearchIndex *index,
+                        TasksSearchMatches *matches, int *rows)
+{
+    tasks_search_index_clear(index);
+    tasks_search_matches_invalidate(matches);
+    for (int i = 0; i < list->count; ++i) {
+        char pid_string[16];
+        snprintf(pid_string, sizeof(pid_string), "%d", (int)list->pids[i]);
+        const char *fields[] = { tasks_model_process_name(list, i), tasks_model_process_user(list, i), pid_string };
+        if (tasks_search_index_add_row(index, fields, 3) < 0) return -1;
+    }
+
+    int count = 0;
+    size_t query_len = strlen(BENCH_SEARCH_QUERY);
+    for (size_t typed = 1; typed <= query_len; ++typed) {
+        char prefix[TASKS_SEARCH_QUERY_MAX];
+        char folded[TASKS_SEARCH_QUERY_MAX];
+        memcpy(prefix, BENCH_SEARCH_QUERY, typed);
+        prefix[typed] = '\0';
+        size_t folded_len = tasks_search_fold(prefix, folded, sizeof(folded));
+        const int *candidates = NULL;
+        int candidate_count = list->count;
+        if (tasks_search_matches_narrow(matches, folded)) {
+            candidates = matches->rows;
+            candidate_count = matches->count;
+        }
+        count = 0;
+        for (int k = 0; k < candidate_count; ++k) {
+            int i = candidates ? candidates[k] : k;
+            if (tasks_search_index_match(index, i, folded, folded_len)) rows[count++] = i;
+        }
+        tasks_search_matches_store(matches, folded, rows, count);
+    }
+    return count;
+}
+
+static int bench_processes(int pid_count, int iterations)
+{
+    /* Each refresh retires the oldest churn pids and spawns as many new ones. */
+    int churn = pid_count / 20;
+    pid_t first_pid = BENCH_FIRST_PID;
+    pid_t next_pid = BENCH_FIRST_PID + pid_count;
+    int rc = make_dir(g_proc_root);
+
+    if (rc == 0 && write_system_files(0) != 0) rc = -1;
+    for (pid_t pid = first_pid; rc == 0 && pid < next_pid; ++pid) {
+        if (write_pid(pid, 0) != 0) rc = -1;
+    }
+    if (rc == 0 && tasks_model_set_proc_root(g_proc_root) != 0) {
+        fprintf(stderr, "ck-tasks-bench: cannot open proc root %s\n", g_proc_root);
+        rc = -1;
+    }
+
+    BenchSamples samples;
+    BenchSamples search_samples;
+    TasksSearchIndex index;
+    TasksSearchMatches matches;
+    memset(&index, 0, sizeof(index));
+    memset(&matches, 0, sizeof(matches));
+    int *rows = (int *)malloc(sizeof(int) * (size_t)pid_count);
+    if (samples_init(&samples, iterations) != 0 || samples_init(&search_samples, iterations) != 0 || !rows) rc = -1;
+    for (int iter = 0; rc == 0 && iter < iterations; ++iter) {
+        if (iter > 0) {
+            for (int i = 0; i < churn; ++i) {
+                remove_pid(first_pid++);
+                if (write_pid(next_pid++, 0) != 0) rc = -1;
+            }
+            for (pid_t pid = first_pid; rc == 0 && pid < next_pid; pid += 7) {
+                if (write_pid(pid, iter) != 0) rc = -1;
+            }
+            if (write_system_files(iter) != 0) rc = -1;
+            if (rc != 0) break;
+        }
+
+        TasksProcessList *list = NULL;
+        struct timespec start, end;
+        unsigned long allocations = g_allocations;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int list_rc = tasks_model_list_processes(&list);
+        int count = list ? list->count : 0;
+        int first_row = count > 0 ? (iter * BENCH_VISIBLE_ROWS) % count : 0;
+        for (int row = first_row; row < count && row < first_row + BENCH_VISIBLE_ROWS; ++row) {
+            tasks_model_process_command(list, row);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        samples.allocations[samples.count] = g_allocations - allocations;
+        samples.ms[samples.count++] = elapsed_ms(&start, &end);
+        if (list_rc != 0 || count != pid_count) {
+            fprintf(stderr, "ck-tasks-bench: refresh %d listed %d of %d pids\n", iter, count, pid_count);
+            rc = -1;
+        }
+
+        if (rc == 0) {
+            allocations = g_allocations;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            int matched = bench_search(list, &index, &matches, rows);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            search_samples.allocations[search_samples.count] = g_allocations - allocations;
+            search_samples.ms[search_samples.count++] = elapsed_ms(&start, &end);
+            if (matched < 0) {
+                fprintf(stderr, "ck-tasks-bench: search index for refresh %d failed\n", iter);
+                rc = -1;
+            }
+        }
+        tasks_model_free_processes(list);
+    }
+
+    if (rc == 0) {
+        char label[64];
+        snprintf(label, sizeof(label), "processes %d", pid_count);
+        report(label, &samples);
+        snprintf(label, sizeof(label), "search %d", pid_count);
+        report(label, &search_samples);
+    }
+    samples_free(&samples);
+    samples_free(&search_samples);
+    tasks_search_index_free(&index);
+    tasks_search_matches_free(&matches);
+    free(rows);
+    remove_tree(g_proc_root);
+    return rc;
+}
+
+static int time_services(BenchSamples *samples, int expected)
+{
+    TasksServiceEntry *entries = NULL;
+    int count = 0;
+    TasksInitInfo info;
+    struct timespec start, end;
+    unsigned long allocations = g_allocations;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int list_rc = tasks_model_list_services(&entries, &count, &info, 1);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    samples->allocations[samples->count] = g_allocations - allocations;
+    samples->ms[samples->count++] = elapsed_ms(&start, &end);
+    tasks_model_free_services(entries, count);
+    if (list_rc < 0 || (list_rc == 0 && count != expected)) {
+        fprintf(stderr, "ck-tasks-bench: services listed %d of %d\n", count, expected);
+        return -1;
+    }
+    return 0;
+}
+
+/* Appends a line to one init script, as a package upgrade would rewrite it. */
+static int touch_service(int index)
+{
+    char path[PATH_MAX + 64];
+    snprintf(path, sizeof(path), "%s/etc/init.d/bench-svc-%d", g_root, index);
+    FILE *fp = fopen(path, "a");
+    if (!fp) {
+        fprintf(stderr, "ck-tasks-bench: cannot write %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fputs("# touched\n", fp);
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+/* Unchanged listings come from the cache; "touched" changes one script
+ * before every refresh, so the directories are walked again and that one
+ * header is parsed. */
+static int bench_services(int expected, int iterations)
+{
+    BenchSamples samples;
+    BenchSamples touched_samples;
+    int rc = samples_init(&samples, iterations);
+    if (samples_init(&touched_samples, iterations) != 0) rc = -1;
+    for (int iter = 0; rc == 0 && iter < iterations; ++iter) {
+        rc = time_services(&samples, expected);
+    }
+    for (int iter = 0; rc == 0 && iter < iterations; ++iter) {
+        rc = touch_service(expected > 0 ? iter % expected : 0);
+        if (rc == 0) rc = time_services(&touched_samples, expected);
+    }
+    if (rc == 0) {
+        char label[64];
+        snprintf(label, sizeof(label), "services %d", expected);
+        report(label, &samples);
+        snprintf(label, sizeof(label), "services touched %d", expected);
+        report(label, &touched_samples);
+    }
+    samples_free(&samples);
+    samples_free(&touched_samples);
+    return rc;
+}
+
+static int time_users(BenchSamples *samples, int expected)
+{
+    TasksUserEntry *entries = NULL;
+    int count = 0;
+    struct timespec start, end;
+    unsigned long allocations = g_allocations;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int list_rc = tasks_model_list_users(&entries, &count);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    samples->allocations[samples->count] = g_allocations - allocations;
+    samples->ms[samples->count++] = elapsed_ms(&start, &end);
+    tasks_model_free_users(entries, count);
+    if (list_rc != 0 || count != expected) {
+        fprintf(stderr, "ck-tasks-bench: users listed %d of %d\n", count, expected);
+        return -1;
+    }
+    return 0;
+}
+
+/* Like the services: "touched" rewrites utmp before every refresh, as a
+ * login or logout would. */
+static int bench_users(const char *utmp_path, int expected, int iterations)
+{
+    BenchSamples samples;
+    BenchSamples touched_samples;
+    int rc = samples_init(&samples, iterations);
+    if (samples_init(&touched_samples, iterations) != 0) rc = -1;
+    for (int iter = 0; rc == 0 && iter < iterations; ++iter) {
+        rc = time_users(&samples, expected);
+    }
+    for (int iter = 0; rc == 0 && iter < iterations; ++iter) {
+        rc = write_utmp(utmp_path, expected);
+        if (rc == 0) rc = time_users(&touched_samples, expected);
+    }
+    if (rc == 0) {
+        char label[64];
+        snprintf(label, sizeof(label), "users %d", expected);
+        report(label, &samples);
+        snprintf(label, sizeof(label), "users touched %d", expected);
+        report(label, &touched_samples);
+    }
+    samples_free(&samples);
+    samples_free(&touched_samples);
+    return rc;
+}
+
+static int time_cgroups(BenchSamples *samples, int expected)
+{
+    TasksCgroupEntry *entries = NULL;
+    int count = 0;
+    struct timespec start, end;
+    unsigned long allocations = g_allocations;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int list_rc = tasks_model_list_cgroups(&entries, &count);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    samples->allocations[samples->count] = g_allocations - allocations;
+    samples->ms[samples->count++] = elapsed_ms(&start, &end);
+    tasks_model_free_cgroups(entries);
+    /* The root and the slices are listed as well. */
+    if (list_rc != 0 || count != expected + BENCH_CGROUP_SLICES + 1) {
+        fprintf(stderr, "ck-tasks-bench: cgroups listed %d of %d\n", count, expected + BENCH_CGROUP_SLICES + 1);
+        return -1;
+    }
+    return 0;
+}
+
+/* Populated groups are re-read on every refresh either way; "touched" also
+ * rewrites the cgroup.events of one empty group, as a process starting in
+ * it would, so that group is re-read too. */
+static int bench_cgroups(int expected, int iterations)
+{
+    BenchSamples samples;
+    BenchSamples touched_samples;
+    int rc = samples_init(&samples, iterations);
+    if (samples_init(&touched_samples, iterations) != 0) rc = -1;
+    for (int iter = 0; rc == 0 && iter < iterations; ++iter) {
+        rc = time_cgroups(&samples, expected);
+    }
+    for (int iter = 0; rc == 0 && iter < iterations; ++iter) {
+        int group = expected > 0 ? (iter * 4 + 1) % expected : 0;
+        char path[PATH_MAX + 64];
+        snprintf(path, sizeof(path), "%s/cgroup/bench-%d.slice/group-%d.scope", g_root,
+                 group % BENCH_CGROUP_SLICES, group);
+        rc = expected > 0 ? write_cgroup_files(path, group, 0) : 0;
+        if (rc == 0) rc = time_cgroups(&touched_samples, expected);
+    }
+    if (rc == 0) {
+        char label[64];
+        snprintf(label, sizeof(label), "cgroups %d", expected);
+        report(label, &samples);
+        snprintf(label, sizeof(label), "cgroups touched %d", expected);
+        report(label, &touched_samples);
+    }
+    samples_free(&samples);
+    samples_free(&touched_samples);
+    return rc;
+}
+
+static int parse_pid_counts(const char *spec, int *counts, int max_counts)
+{
+    int n = 0;
+    const char *p = spec;
+    while (*p) {
+        char *end = NULL;
+        long value = strtol(p, &end, 10);
+        if (end == p || value <= 0 || value > 1000000 || n >= max_counts) return -1;
+        counts[n++] = (int)value;
+        p = end;
+        if (*p == ',') {
+            p++;
+        } else if (*p) {
+            return -1;
+        }
+    }
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    const char *pid_spec = BENCH_DEFAULT_PID_COUNTS;
+    int iterations = BENCH_DEFAULT_ITERATIONS;
+    int service_count = BENCH_DEFAULT_SERVICES;
+    int user_count = BENCH_DEFAULT_USERS;
+    int cgroup_count = BENCH_DEFAULT_CGROUPS;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:i:s:u:c:")) != -1) {
+        switch (opt) {
+        case 'n':
+            pid_spec = optarg;
+            break;
+        case 'i':
+            iterations = atoi(optarg);
+            break;
+        case 's':
+            service_count = atoi(optarg);
+            break;
+        case 'u':
+            user_count = atoi(optarg);
+            break;
+        case 'c':
+            cgroup_count = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n pids[,pids...]] [-i iterations] [-s services] [-u users] [-c cgroups]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    int pid_counts[BENCH_MAX_PID_COUNTS];
+    int pid_count_n = parse_pid_counts(pid_spec, pid_counts, BENCH_MAX_PID_COUNTS);
+    if (pid_count_n <= 0 || iterations <= 0 || service_count < 0 || user_count < 0 || cgroup_count < 0) {
+        fprintf(stderr, "ck-tasks-bench: pid counts and iterations must be positive\n");
+        return 2;
+    }
+
+    const char *tmp = getenv("TMPDIR");
+    snprintf(g_root, sizeof(g_root), "%s/ck-tasks-bench.XXXXXX", (tmp && tmp[0]) ? tmp : "/tmp");
+    if (!mkdtemp(g_root)) {
+        fprintf(stderr, "ck-tasks-bench: mkdtemp failed: %s\n", strerror(errno));
+        return 1;
+    }
+    snprintf(g_proc_root, sizeof(g_proc_root), "%s/proc", g_root);
+
+    char utmp_path[PATH_MAX + 8];
+    snprintf(utmp_path, sizeof(utmp_path), "%s/utmp", g_root);
+    int rc = 0;
+    if (write_services(service_count) != 0 || write_utmp(utmp_path, user_count) != 0 ||
+        write_cgroups(cgroup_count) != 0) {
+        rc = 1;
+    }
+
+    tasks_model_initialize();
+    char cgroup_root[PATH_MAX + 8];
+    snprintf(cgroup_root, sizeof(cgroup_root), "%s/cgroup", g_root);
+    if (rc == 0 && (tasks_model_set_system_root(g_root) != 0 || tasks_model_set_utmp_path(utmp_path) != 0 ||
+                    tasks_model_set_cgroup_root(cgroup_root) != 0)) {
+        fprintf(stderr, "ck-tasks-bench: cannot use %s as the system root\n", g_root);
+        rc = 1;
+    }
+
+    if (rc == 0) printf("ck-tasks-bench: %d refreshes per run, %s\n", iterations, g_root);
+    for (int i = 0; rc == 0 && i < pid_count_n; ++i) {
+        if (bench_processes(pid_counts[i], iterations) != 0) rc = 1;
+    }
+    if (rc == 0 && bench_services(service_count, iterations) != 0) rc = 1;
+    if (rc == 0 && bench_users(utmp_path, user_count, iterations) != 0) rc = 1;
+    if (rc == 0 && bench_cgroups(cgroup_count, iterations) != 0) rc = 1;
+
+    tasks_model_shutdown();
+    remove_tree(g_root);
+    return rc;
+}
@@ -1,16 +1,24 @@
 #include "ck-tasks-ctrl.h"
+#include "ck-tasks-sampler.h"
+#include "ck-tasks-details.h"
+#include "ck-tasks-remote.h"
+#include "ck-tasks-search.h"
 
 #include "../shared/about_dialog.h"
+#include "../shared/tool_utils.h"
+#include "../shared/user_cache.h"
 #include <X11/Intrinsic.h>
 #include <X11/Xatom.h>
 #include <Xm/Xm.h>
 #include <Xm/MessageB.h>
 #include <Xm/List.h>
 #include <Xm/ScrollBar.h>
+#include <Xm/SelectioB.h>
 #include <Xm/TextF.h>
 #include <Xm/ToggleBG.h>
 
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <limits.h>
@@ -18,25 +26,102 @@
 #include <stdio.h>
 #include <string.h>
 #include <strings.h>
-#include <pwd.h>
 #include <ctype.h>
 #include <X11/Xlib.h>
+#include <X11/Xlib-xcb.h>
 #include <X11/Xutil.h>
+#include <xcb/xcb.h>
+
+/*
+ * Refresh policy per data source. A source is collected on every pass while
+ * one of its tabs is shown, every hidden_interval_ms while hidden (0 = only
+ * when its tab is shown again), and always when it has been marked dirty.
+ */
+typedef struct {
+    unsigned int source;
+    unsigned int tabs;          /* bits (1 << TasksTab) that show it; 0 = always shown */
+    int hidden_interval_ms;
+} TasksSourcePolicy;
+
+#define TASKS_TAB_BIT(tab) (1u << (tab))
+
+static const TasksSourcePolicy source_policies[] = {
+    /* The status bar and the window icon always show the system stats. */
+    {TASKS_SOURCE_STATS, 0, 0},
+    /* Applications resolve window pids through the process list; the status
+     * bar process count is allowed to lag while both tabs are hidden. */
+    {TASKS_SOURCE_PROCESSES, TASKS_TAB_BIT(TASKS_TAB_PROCESSES) | TASKS_TAB_BIT(TASKS_TAB_APPLICATIONS), 10000},
+    {TASKS_SOURCE_APPLICATIONS, TASKS_TAB_BIT(TASKS_TAB_APPLICATIONS), 0},
+    {TASKS_SOURCE_SERVICES, TASKS_TAB_BIT(TASKS_TAB_SERVICES), 0},
+    {TASKS_SOURCE_USERS, TASKS_TAB_BIT(TASKS_TAB_USERS), 0},
+    {TASKS_SOURCE_NETWORK, TASKS_TAB_BIT(TASKS_TAB_NETWORKING), 0},
+    {TASKS_SOURCE_CGROUPS, TASKS_TAB_BIT(TASKS_TAB_CGROUPS), 0},
+};
+
+#define TASKS_SOURCE_POLICY_COUNT (sizeof(source_policies) / sizeof(source_policies[0]))
+
+/* Detail columns of a visible row are re-read at most every TTL; a worker
+ * pass gives up after the budget so a scroll never waits on a slow process. */
+#define TASKS_DETAILS_TTL_MS 3000
+#define TASKS_DETAILS_BUDGET_MS 100
+#define TASKS_DETAILS_MAX_ROWS 256
+
+/* Length of /proc/<pid>/comm: the kernel keeps 15 bytes of the name. */
+#define TASKS_COMM_MAX 15
+
+/* Sources a connected agent supplies; the local sampler skips them meanwhile. */
+#define TASKS_REMOTE_SOURCES (TASKS_SOURCE_STATS | TASKS_SOURCE_PROCESSES)
+
+typedef struct {
+    long long last_refresh_ms; /* 0 = never collected */
+    Boolean dirty;
+} TasksSourceState;
 
 struct TasksController {
     TasksUi *ui;
     SessionData *session;
     Widget about_shell;
-    TasksProcessEntry *process_entries;
-    int process_count;
+    TasksSampler *sampler;
+    XtInputId sampler_input;
+    TasksDetails *details;
+    XtInputId details_input;
+    TasksRemote *remote;             /* set while showing an agent's host */
+    XtInputId remote_input;
+    TasksRemoteState remote_state;
+    char remote_address[256];
+    TasksSourceState sources[TASKS_SOURCE_POLICY_COUNT];
+    unsigned int scheduled_sources;
+    TasksProcessList *all_processes;
+    TasksProcessView process_views[2]; /* shown rows and scratch for the next filter pass */
+    int process_view_index;
+    TasksProcessDiff process_diff;
+    TasksSearchIndex process_search;   /* over all_processes; built when a search first needs it */
+    TasksSearchMatches process_matches;
+    TasksApplicationEntry *all_applications; /* last listing, before the search filter */
+    int all_applications_count;
+    TasksSearchIndex apps_search;
+    TasksSearchMatches apps_matches;
+    TasksPidIndex pid_by_comm;         /* window pid lookups over all_processes */
+    TasksPidIndex pid_by_argv0;
+    TasksPidIndex pid_by_exe;          /* basename of argv[0] */
+    Boolean pid_names_indexed;
+    Boolean pid_commands_indexed;
     TasksApplicationEntry *applications;
     int applications_count;
     int selected_application;
     TasksUserEntry *user_sessions;
     int user_session_count;
+    TasksNetInterface *net_interfaces;
+    TasksNetSocket *net_sockets;
+    TasksCgroupEntry *cgroups;
     TasksServiceEntry *service_entries;
     int service_count;
     TasksInitInfo service_init_info;
+    /* Newest listing not shown yet (the table was paused); the model does
+     * not hand out an unchanged listing again. */
+    TasksServiceEntry *pending_services;
+    int pending_service_count;
+    TasksInitInfo pending_init_info;
     int process_total_count;
     XtIntervalId refresh_timer;
     int refresh_interval_ms;
@@ -57,31 +142,32 @@ static void window_collection_init(WindowCollection *collection);
 static int window_collection_add_unique(WindowCollection *collection, Window window);
 static void window_collection_add_from_atom(Display *dpy, Window root, const char *atom_name, WindowCollection *collection);
 static int query_client_list(Display *dpy, Window root, Window **out_list, unsigned long *out_count);
-static int window_property_contains_atom(Display *dpy, Window window, Atom property, Atom value);
-static int get_window_wm_state(Display *dpy, Window window, long *state_out);
-static int window_is_task_list_window(Display *dpy, Window window);
-static int window_get_net_wm_types(Display *dpy, Window window, Atom **out_types, unsigned long *out_count);
-static int atom_list_contains_any(const Atom *atoms, unsigned long atom_count, const Atom *needles, size_t needle_count);
-static int window_has_net_wm_state(Display *dpy, Window window, const char *state_name);
 
 static void tasks_ctrl_schedule_refresh(TasksController *ctrl);
+static void tasks_ctrl_mark_dirty(TasksController *ctrl, unsigned int sources);
+static unsigned int tasks_ctrl_due_sources(TasksController *ctrl);
+static void tasks_ctrl_update_sources(TasksController *ctrl);
 static void tasks_ctrl_refresh_applications(TasksController *ctrl);
-static void tasks_ctrl_refresh_users(TasksController *ctrl);
-static void tasks_ctrl_refresh_services(TasksController *ctrl);
+static void tasks_ctrl_apply_snapshot(TasksController *ctrl, TasksSnapshot *snapshot);
+static void tasks_ctrl_refresh_now(TasksController *ctrl);
+static void tasks_ctrl_apply_process_filter(TasksController *ctrl, Boolean incremental);
+static void tasks_ctrl_refresh_users(TasksController *ctrl, TasksSnapshot *snapshot);
+static void tasks_ctrl_refresh_network(TasksController *ctrl, TasksSnapshot *snapshot);
+static void tasks_ctrl_refresh_cgroups(TasksController *ctrl, TasksSnapshot *snapshot);
+static void tasks_ctrl_refresh_services(TasksController *ctrl, TasksSnapshot *snapshot);
 static void on_apps_close(Widget widget, XtPointer client, XtPointer call);
-static int tasks_ctrl_filter_processes(TasksController *ctrl, TasksProcessEntry *entries, int count);
+static void tasks_ctrl_filter_processes(TasksController *ctrl, TasksProcessView *view);
 static void tasks_ctrl_apply_filter_state(TasksController *ctrl, Boolean state);
 static void tasks_ctrl_set_search_text(TasksController *ctrl, const char *text);
-static int tasks_ctrl_entry_matches_search(TasksController *ctrl, const TasksProcessEntry *entry);
 static void on_process_search_changed(Widget widget, XtPointer client, XtPointer call);
-static int contains_ignore_case(const char *text, const char *pattern);
 static void tasks_ctrl_set_virtual_window(TasksController *ctrl, int start);
 static void tasks_ctrl_update_virtual_scrollbar(TasksController *ctrl);
+static void tasks_ctrl_request_details(TasksController *ctrl);
+static void tasks_ctrl_connect(TasksController *ctrl, const char *address);
 static void on_process_scroll(Widget widget, XtPointer client, XtPointer call);
-static int get_window_command(Display *dpy, Window window, char *out, size_t out_len);
 static pid_t tasks_ctrl_find_pid_by_command(TasksController *ctrl, const char *command);
-static void get_window_wm_class(Display *dpy, Window window, char *out, size_t out_len);
-static int tasks_ctrl_application_matches_search(TasksController *ctrl, const TasksApplicationEntry *entry);
+static void tasks_ctrl_invalidate_process_names(TasksController *ctrl);
+static void tasks_ctrl_filter_applications(TasksController *ctrl);
 static void on_apps_search_changed(Widget widget, XtPointer client, XtPointer call);
 
 static void destroy_dialog(Widget widget, XtPointer client, XtPointer call)
@@ -101,13 +187,40 @@ static void on_file_exit(Widget widget, XtPointer client, XtPointer call)
     XtAppSetExitFlag(app);
 }
 
+static void on_connect_ok(Widget widget, XtPointer client, XtPointer call)
+{
+    (void)call;
+    TasksController *ctrl = client;
+    Widget text = XmSelectionBoxGetChild(widget, XmDIALOG_TEXT);
+    char *value = text ? XmTextFieldGetString(text) : NULL;
+    if (ctrl) tasks_ctrl_connect(ctrl, value ? value : "");
+    if (value) XtFree(value);
+    XtDestroyWidget(widget);
+}
+
 static void on_file_connect(Widget widget, XtPointer client, XtPointer call)
 {
     (void)widget;
     (void)call;
     TasksController *ctrl = client;
     if (!ctrl) return;
-    tasks_ui_update_status(ctrl->ui, "Connect to Remote placeholder.");
+    Widget dialog = XmCreatePromptDialog(tasks_ui_get_toplevel(ctrl->ui), "tasksConnectDialog", NULL, 0);
+    XtVaSetValues(XtParent(dialog), XmNtitle, "Connect to Remote", NULL);
+    XmString label = XmStringCreateLocalized(
+        "Host running ck-tasks-agent (host[:port] or unix:path).\n"
+        "Leave empty to show this computer again:");
+    XtVaSetValues(dialog, XmNselectionLabelString, label, NULL);
+    XmStringFree(label);
+    Widget text = XmSelectionBoxGetChild(dialog, XmDIALOG_TEXT);
+    if (text) {
+        XmTextFieldSetString(text, ctrl->remote ? ctrl->remote_address : "");
+        XmTextFieldSetSelection(text, 0, XmTextFieldGetLastPosition(text), CurrentTime);
+    }
+    Widget help = XmSelectionBoxGetChild(dialog, XmDIALOG_HELP_BUTTON);
+    if (help) XtUnmanageChild(help);
+    XtAddCallback(dialog, XmNokCallback, on_connect_ok, ctrl);
+    XtAddCallback(dialog, XmNcancelCallback, destroy_dialog, NULL);
+    XtManageChild(dialog);
 }
 
 static void on_file_new_window(Widget widget, XtPointer client, XtPointer call)
@@ -141,28 +254,294 @@ static void on_view_refresh(Widget widget, XtPointer client, XtPointer call)
     (void)call;
     TasksController *ctrl = client;
     if (!ctrl) return;
-    TasksProcessEntry *entries = NULL;
-    int count = 0;
-    if (tasks_model_list_processes(&entries, &count) == 0) {
-        ctrl->process_total_count = count;
-        count = tasks_ctrl_filter_processes(ctrl, entries, count);
-        tasks_model_free_processes(ctrl->process_entries, ctrl->process_count);
-        ctrl->process_entries = entries;
-        ctrl->process_count = count;
-        tasks_ui_set_processes(ctrl->ui, entries, count);
-        tasks_ctrl_set_virtual_window(ctrl, ctrl->virtual_row_start);
-        tasks_ui_update_process_count(ctrl->ui, ctrl->process_total_count);
-        TasksSystemStats stats;
-        if (tasks_model_get_system_stats(&stats) == 0) {
-        tasks_ui_update_system_stats(ctrl->ui, &stats);
+    /* An explicit refresh also brings hidden tabs up to date. */
+    tasks_ctrl_mark_dirty(ctrl, TASKS_SOURCE_ALL);
+    tasks_ctrl_refresh_now(ctrl);
+}
+
+static void tasks_ctrl_mark_dirty(TasksController *ctrl, unsigned int sources)
+{
+    for (size_t i = 0; i < TASKS_SOURCE_POLICY_COUNT; ++i) {
+        if (source_policies[i].source & sources) ctrl->sources[i].dirty = True;
+    }
+}
+
+/* Sources the next pass, one refresh interval from now, should collect. */
+static unsigned int tasks_ctrl_due_sources(TasksController *ctrl)
+{
+    unsigned int tab_bit = TASKS_TAB_BIT(tasks_ui_get_current_tab(ctrl->ui));
+    int interval = ctrl->refresh_interval_ms > 0 ? ctrl->refresh_interval_ms : 2000;
+    long long next_pass_ms = tool_now_ms() + interval;
+    unsigned int due = 0;
+    for (size_t i = 0; i < TASKS_SOURCE_POLICY_COUNT; ++i) {
+        const TasksSourcePolicy *policy = &source_policies[i];
+        const TasksSourceState *state = &ctrl->sources[i];
+        Boolean shown = policy->tabs == 0 || (policy->tabs & tab_bit) != 0;
+        if (state->dirty || state->last_refresh_ms == 0 || shown) {
+            due |= policy->source;
+        } else if (policy->hidden_interval_ms > 0 &&
+                   next_pass_ms - state->last_refresh_ms >= policy->hidden_interval_ms) {
+            due |= policy->source;
         }
+    }
+    return due;
+}
+
+static void tasks_ctrl_sources_refreshed(TasksController *ctrl, unsigned int sources)
+{
+    long long now = tool_now_ms();
+    for (size_t i = 0; i < TASKS_SOURCE_POLICY_COUNT; ++i) {
+        if (!(source_policies[i].source & sources)) continue;
+        ctrl->sources[i].last_refresh_ms = now;
+        ctrl->sources[i].dirty = False;
+    }
+}
+
+/* Scheduled sources that are collected on this host. */
+static unsigned int tasks_ctrl_local_sources(TasksController *ctrl)
+{
+    unsigned int sources = ctrl->scheduled_sources;
+    if (ctrl->remote) sources &= ~(unsigned int)TASKS_REMOTE_SOURCES;
+    return sources;
+}
+
+/* Hands the sources due on the next pass to the sampler. */
+static void tasks_ctrl_update_sources(TasksController *ctrl)
+{
+    ctrl->scheduled_sources = tasks_ctrl_due_sources(ctrl);
+    if (ctrl->sampler) {
+        tasks_sampler_set_sources(ctrl->sampler, tasks_ctrl_local_sources(ctrl));
+    }
+}
+
+/* Runs a pass now over everything due, e.g. after a tab switch marked sources dirty. */
+static void tasks_ctrl_refresh_now(TasksController *ctrl)
+{
+    tasks_ctrl_update_sources(ctrl);
+    if (ctrl->sampler) {
+        tasks_sampler_request(ctrl->sampler);
+        return;
+    }
+    TasksSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    tasks_snapshot_collect(&snapshot, tasks_ctrl_local_sources(ctrl), ctrl->show_disabled_services ? 1 : 0);
+    tasks_ctrl_apply_snapshot(ctrl, &snapshot);
+    tasks_snapshot_clear(&snapshot);
+}
+
+static void on_tab_selected(Widget widget, XtPointer client, XtPointer call)
+{
+    (void)widget;
+    (void)call;
+    TasksController *ctrl = client;
+    if (!ctrl) return;
+    /* Sources of the newly shown tab may be a hidden interval (or forever) old. */
+    unsigned int tab_bit = TASKS_TAB_BIT(tasks_ui_get_current_tab(ctrl->ui));
+    int interval = ctrl->refresh_interval_ms > 0 ? ctrl->refresh_interval_ms : 2000;
+    long long now = tool_now_ms();
+    unsigned int stale = 0;
+    for (size_t i = 0; i < TASKS_SOURCE_POLICY_COUNT; ++i) {
+        const TasksSourcePolicy *policy = &source_policies[i];
+        if (!(policy->tabs & tab_bit)) continue;
+        if (now - ctrl->sources[i].last_refresh_ms >= interval) stale |= policy->source;
+    }
+    tasks_ctrl_request_details(ctrl);
+    if (!stale) {
+        tasks_ctrl_update_sources(ctrl);
+        return;
+    }
+    tasks_ctrl_mark_dirty(ctrl, stale);
+    tasks_ctrl_refresh_now(ctrl);
+}
+
+static void on_sampler_input(XtPointer client, int *fd, XtInputId *id)
+{
+    (void)fd;
+    (void)id;
+    TasksController *ctrl = client;
+    if (!ctrl || !ctrl->sampler) return;
+    TasksSnapshot *snapshot = tasks_sampler_acquire(ctrl->sampler);
+    if (!snapshot) return;
+    if (ctrl->remote) {
+        /* A pass scheduled before connecting must not overwrite the agent's data. */
+        snapshot->sources &= ~(unsigned int)TASKS_REMOTE_SOURCES;
+        snapshot->stats_ok = 0;
+    }
+    tasks_ctrl_apply_snapshot(ctrl, snapshot);
+    tasks_sampler_release(ctrl->sampler, snapshot);
+}
+
+/* Back to this host: the local sampler takes over the agent's sources. */
+static void tasks_ctrl_disconnect(TasksController *ctrl)
+{
+    if (!ctrl->remote) return;
+    if (ctrl->remote_input) {
+        XtRemoveInput(ctrl->remote_input);
+        ctrl->remote_input = 0;
+    }
+    tasks_remote_destroy(ctrl->remote);
+    ctrl->remote = NULL;
+    ctrl->remote_address[0] = '\0';
+    ctrl->ui->process_details = ctrl->details;
+    tasks_ctrl_mark_dirty(ctrl, TASKS_REMOTE_SOURCES);
+    tasks_ctrl_refresh_now(ctrl);
+}
+
+static void on_remote_input(XtPointer client, int *fd, XtInputId *id)
+{
+    (void)fd;
+    (void)id;
+    TasksController *ctrl = client;
+    if (!ctrl || !ctrl->remote) return;
+    char message[256];
+    char status[512];
+    TasksRemoteState state = tasks_remote_get_state(ctrl->remote, message, sizeof(message));
+    if (state == TASKS_REMOTE_FAILED) {
+        snprintf(status, sizeof(status), "Connection to %s ended: %s", ctrl->remote_address, message);
+        tasks_ctrl_disconnect(ctrl);
+        tasks_ui_update_status(ctrl->ui, status);
+        return;
+    }
+    if (state != ctrl->remote_state && state == TASKS_REMOTE_CONNECTED) {
+        snprintf(status, sizeof(status), "Connected to %s (%s).", message, ctrl->remote_address);
+        tasks_ui_update_status(ctrl->ui, status);
+    }
+    ctrl->remote_state = state;
+    TasksSnapshot *snapshot = tasks_remote_acquire(ctrl->remote);
+    if (!snapshot) return;
+    tasks_ctrl_apply_snapshot(ctrl, snapshot);
+    tasks_remote_release(ctrl->remote, snapshot);
+}
+
+/* Shows the host of the agent at address, or this host again if it is empty. */
+static void tasks_ctrl_connect(TasksController *ctrl, const char *address)
+{
+    while (isspace((unsigned char)*address)) address++;
+    size_t len = strlen(address);
+    while (len > 0 && isspace((unsigned char)address[len - 1])) len--;
+    if (len == 0) {
+        if (ctrl->remote) {
+            tasks_ctrl_disconnect(ctrl);
+            tasks_ui_update_status(ctrl->ui, "Showing this computer.");
+        }
+        return;
+    }
+    if (len >= sizeof(ctrl->remote_address)) {
+        tasks_ui_update_status(ctrl->ui, "Remote address is too long.");
+        return;
+    }
+    if (ctrl->remote) {
+        XtRemoveInput(ctrl->remote_input);
+        ctrl->remote_input = 0;
+        tasks_remote_destroy(ctrl->remote);
+        ctrl->remote = NULL;
+    }
+    memcpy(ctrl->remote_address, address, len);
+    ctrl->remote_address[len] = '\0';
+    ctrl->remote = tasks_remote_create(ctrl->remote_address);
+    if (!ctrl->remote) {
+        ctrl->remote_address[0] = '\0';
+        tasks_ui_update_status(ctrl->ui, "Cannot start the remote connection.");
+        tasks_ctrl_mark_dirty(ctrl, TASKS_REMOTE_SOURCES);
+        tasks_ctrl_refresh_now(ctrl);
+        return;
+    }
+    ctrl->remote_state = TASKS_REMOTE_CONNECTING;
+    /* Cached details belong to local pids; the agent does not send them. */
+    ctrl->ui->process_details = NULL;
+    ctrl->remote_input = XtAppAddInput(tasks_ui_get_app_context(ctrl->ui), tasks_remote_get_fd(ctrl->remote),
+                                       (XtPointer)XtInputReadMask, on_remote_input, ctrl);
+    tasks_ctrl_update_sources(ctrl);
+    char status[512];
+    snprintf(status, sizeof(status), "Connecting to %s...", ctrl->remote_address);
+    tasks_ui_update_status(ctrl->ui, status);
+}
+
+static void on_details_input(XtPointer client, int *fd, XtInputId *id)
+{
+    (void)fd;
+    (void)id;
+    TasksController *ctrl = client;
+    if (!ctrl || !ctrl->details) return;
+    if (tasks_details_collect(ctrl->details) > 0) {
+        tasks_ui_refresh_process_details(ctrl->ui);
+    }
+}
+
+/* Takes ownership of the snapshot arrays the UI keeps showing; only pointers
+ * are swapped here, the collection work happened on the sampler thread. */
+static void tasks_ctrl_apply_snapshot(TasksController *ctrl, TasksSnapshot *snapshot)
+{
+    if (!ctrl || !snapshot) return;
+    unsigned int refreshed = snapshot->sources;
+    if (snapshot->sources & TASKS_SOURCE_PROCESSES) {
+        if (snapshot->processes_ok) {
+            /* The shown rows still point into the previous list until the diff is done. */
+            TasksProcessList *previous = ctrl->all_processes;
+            ctrl->all_processes = snapshot->processes;
+            snapshot->processes = NULL;
+            tasks_search_index_clear(&ctrl->process_search);
+            tasks_search_matches_invalidate(&ctrl->process_matches);
+            tasks_ctrl_invalidate_process_names(ctrl);
+            ctrl->process_total_count = ctrl->all_processes ? ctrl->all_processes->count : 0;
+            tasks_ctrl_apply_process_filter(ctrl, True);
+            tasks_model_free_processes(previous);
+            tasks_ui_update_process_count(ctrl->ui, ctrl->process_total_count);
+        } else {
+            tasks_ui_update_status(ctrl->ui, "Unable to refresh process list.");
+            refreshed &= ~(unsigned int)TASKS_SOURCE_PROCESSES;
+        }
+    }
+    if (snapshot->stats_ok) {
+        tasks_ui_update_system_stats(ctrl->ui, &snapshot->stats);
+        /* The history is sampled here; an agent does not send one. */
+        if (!ctrl->remote) tasks_ui_update_cpu_history(ctrl->ui, tasks_model_get_cpu_history());
+    }
+    /* Applications were due when this pass was scheduled; they are listed
+     * here on the X thread, after the processes they resolve pids against. */
+    if (ctrl->scheduled_sources & TASKS_SOURCE_APPLICATIONS) {
         tasks_ctrl_refresh_applications(ctrl);
-        tasks_ctrl_refresh_services(ctrl);
-        tasks_ctrl_refresh_users(ctrl);
-        // tasks_ui_update_status(ctrl->ui, "Process list refreshed.");
+        refreshed |= TASKS_SOURCE_APPLICATIONS;
+    }
+    if (snapshot->sources & TASKS_SOURCE_SERVICES) {
+        tasks_ctrl_refresh_services(ctrl, snapshot);
+    }
+    if (snapshot->sources & TASKS_SOURCE_USERS) {
+        tasks_ctrl_refresh_users(ctrl, snapshot);
+    }
+    if (snapshot->sources & TASKS_SOURCE_NETWORK) {
+        tasks_ctrl_refresh_network(ctrl, snapshot);
+    }
+    if (snapshot->sources & TASKS_SOURCE_CGROUPS) {
+        tasks_ctrl_refresh_cgroups(ctrl, snapshot);
+    }
+    tasks_ctrl_sources_refreshed(ctrl, refreshed);
+    tasks_ctrl_update_sources(ctrl);
+}
+
+/* Rebuild the visible process rows from the last full list (no rescan). With
+ * incremental set, the table gets a pid-keyed diff against the rows it shows
+ * instead of a whole new data set. */
+static void tasks_ctrl_apply_process_filter(TasksController *ctrl, Boolean incremental)
+{
+    if (!ctrl) return;
+    TasksProcessView *shown = &ctrl->process_views[ctrl->process_view_index];
+    TasksProcessView *view = &ctrl->process_views[ctrl->process_view_index ^ 1];
+    view->list = ctrl->all_processes;
+    view->count = 0;
+    if (view->list && view->list->count > 0 &&
+        tasks_model_reserve_process_view(view, view->list->count) == 0) {
+        tasks_ctrl_filter_processes(ctrl, view);
+    }
+    if (incremental && tasks_model_diff_processes(shown, view, &ctrl->process_diff) == 0) {
+        tasks_ui_apply_process_delta(ctrl->ui, view, &ctrl->process_diff);
     } else {
-        tasks_ui_update_status(ctrl->ui, "Unable to refresh process list.");
+        tasks_ui_set_processes(ctrl->ui, view);
     }
+    shown->list = NULL;
+    shown->count = 0;
+    ctrl->process_view_index ^= 1;
+    tasks_ctrl_set_virtual_window(ctrl, ctrl->virtual_row_start);
 }
 
 static void on_view_show_tab(Widget widget, XtPointer client, XtPointer call)
@@ -198,7 +577,11 @@ static void on_options_update(Widget widget, XtPointer client, XtPointer call)
     if (interval_ms <= 0) interval_ms = 2000;
     ctrl->refresh_interval_ms = interval_ms;
     tasks_ui_update_status(ctrl->ui, "Update interval changed.");
-    tasks_ctrl_schedule_refresh(ctrl);
+    if (ctrl->sampler) {
+        tasks_sampler_set_interval(ctrl->sampler, interval_ms);
+    } else {
+        tasks_ctrl_schedule_refresh(ctrl);
+    }
 }
 
 static void on_options_filter_by_user(Widget widget, XtPointer client, XtPointer call)
@@ -208,7 +591,7 @@ static void on_options_filter_by_user(Widget widget, XtPointer client, XtPointer
     if (!ctrl) return;
     Boolean state = XmToggleButtonGadgetGetState(widget);
     tasks_ctrl_apply_filter_state(ctrl, state);
-    on_view_refresh(NULL, ctrl, NULL);
+    tasks_ctrl_apply_process_filter(ctrl, False);
     tasks_ui_update_status(ctrl->ui, state ? "Filtering to current user." : "Showing all users.");
 }
 
@@ -219,7 +602,7 @@ static void on_process_filter_toggle(Widget widget, XtPointer client, XtPointer
     if (!ctrl) return;
     Boolean state = XmToggleButtonGadgetGetState(widget);
     tasks_ctrl_apply_filter_state(ctrl, state);
-    on_view_refresh(NULL, ctrl, NULL);
+    tasks_ctrl_apply_process_filter(ctrl, False);
     tasks_ui_update_status(ctrl->ui, state ? "Filtering to current user." : "Showing all users.");
 }
 
@@ -231,7 +614,7 @@ static void on_process_search_changed(Widget widget, XtPointer client, XtPointer
     char *value = XmTextFieldGetString(widget);
     tasks_ctrl_set_search_text(ctrl, value);
     XtFree(value);
-    on_view_refresh(NULL, ctrl, NULL);
+    tasks_ctrl_apply_process_filter(ctrl, False);
     tasks_ui_update_status(ctrl->ui, "Process search filter applied.");
 }
 
@@ -249,7 +632,7 @@ static void on_apps_search_changed(Widget widget, XtPointer client, XtPointer ca
     memcpy(ctrl->apps_search_text, value, len);
     ctrl->apps_search_text[len] = '\0';
     XtFree(value);
-    tasks_ctrl_refresh_applications(ctrl);
+    tasks_ctrl_filter_applications(ctrl);
     tasks_ui_update_status(ctrl->ui, "Application filter applied.");
 }
 
@@ -303,202 +686,433 @@ static void on_about(Widget widget, XtPointer client, XtPointer call)
     XtPopup(shell, XtGrabNone);
 }
 
-static int get_window_pid(Display *dpy, Window window, pid_t *out_pid)
-{
-    if (!dpy || !out_pid) return -1;
-    const char *pid_atoms[] = {
-        "_NET_WM_PID",
-        "_DT_WM_PID",
-        "DtWM_PID",
-        NULL
-    };
-    for (const char **atom_name = pid_atoms; atom_name && *atom_name; ++atom_name) {
-        Atom pid_atom = XInternAtom(dpy, *atom_name, True);
-        if (pid_atom == None) continue;
-        Atom type = None;
-        int format = 0;
-        unsigned long nitems = 0;
-        unsigned long bytes_after = 0;
-        unsigned char *data = NULL;
-        int status = XGetWindowProperty(dpy, window, pid_atom, 0, 1, False, XA_CARDINAL,
-                                        &type, &format, &nitems, &bytes_after, &data);
-        if (status == Success && data && nitems > 0) {
-            pid_t pid = (pid_t)(*(unsigned long *)data);
-            XFree(data);
-            *out_pid = pid;
-            return 0;
+/*
+ * The applications listing reads a dozen properties from every client
+ * window. Through Xlib each one is a blocking round trip, so the listing
+ * goes through the XCB connection underneath instead: the requests for all
+ * windows are sent first and the replies collected afterwards, once to pick
+ * the task list windows and once for their titles, classes, commands and
+ * pids. Every request that was sent must have its reply collected or
+ * discarded, or XCB keeps it queued.
+ */
+enum {
+    APP_ATOM_UTF8_STRING,
+    APP_ATOM_NET_WM_PID,
+    APP_ATOM_DT_WM_PID,
+    APP_ATOM_DTWM_PID,
+    APP_ATOM_NET_WM_VISIBLE_NAME,
+    APP_ATOM_NET_WM_NAME,
+    APP_ATOM_WM_STATE,
+    APP_ATOM_NET_WM_STATE,
+    APP_ATOM_NET_WM_STATE_SKIP_TASKBAR,
+    APP_ATOM_NET_WM_STATE_SKIP_PAGER,
+    APP_ATOM_NET_WM_STATE_HIDDEN,
+    APP_ATOM_NET_WM_WINDOW_TYPE,
+    APP_ATOM_FIRST_SKIPPED_TYPE,
+    APP_ATOM_COUNT = APP_ATOM_FIRST_SKIPPED_TYPE + 12
+};
+
+static char *app_atom_names[APP_ATOM_COUNT] = {
+    "UTF8_STRING",
+    "_NET_WM_PID",
+    "_DT_WM_PID",
+    "DtWM_PID",
+    "_NET_WM_VISIBLE_NAME",
+    "_NET_WM_NAME",
+    "WM_STATE",
+    "_NET_WM_STATE",
+    "_NET_WM_STATE_SKIP_TASKBAR",
+    "_NET_WM_STATE_SKIP_PAGER",
+    "_NET_WM_STATE_HIDDEN",
+    "_NET_WM_WINDOW_TYPE",
+    /* Window types that never get a task list entry. */
+    "_NET_WM_WINDOW_TYPE_UTILITY",
+    "_NET_WM_WINDOW_TYPE_TOOLBAR",
+    "_NET_WM_WINDOW_TYPE_MENU",
+    "_NET_WM_WINDOW_TYPE_SPLASH",
+    "_NET_WM_WINDOW_TYPE_DOCK",
+    "_NET_WM_WINDOW_TYPE_DESKTOP",
+    "_NET_WM_WINDOW_TYPE_NOTIFICATION",
+    "_NET_WM_WINDOW_TYPE_DROPDOWN_MENU",
+    "_NET_WM_WINDOW_TYPE_POPUP_MENU",
+    "_NET_WM_WINDOW_TYPE_TOOLTIP",
+    "_NET_WM_WINDOW_TYPE_COMBO",
+    "_NET_WM_WINDOW_TYPE_DND"
+};
+
+#define APP_PID_ATOMS 3   /* APP_ATOM_NET_WM_PID .. APP_ATOM_DTWM_PID */
+
+typedef struct {
+    xcb_get_property_cookie_t cookie;
+    int sent;
+} WindowPropertyRequest;
+
+typedef struct {
+    Window window;
+    xcb_get_window_attributes_cookie_t attributes;
+    WindowPropertyRequest net_state;
+    WindowPropertyRequest wm_state;
+    WindowPropertyRequest types;
+    WindowPropertyRequest pids[APP_PID_ATOMS];
+    WindowPropertyRequest titles[3]; /* _NET_WM_VISIBLE_NAME, _NET_WM_NAME, WM_NAME */
+    WindowPropertyRequest wm_class;
+    WindowPropertyRequest command;
+} WindowFetch;
+
+/* Atoms that do not exist yet come back as None; nothing can carry them.
+ * XInternAtoms returns 0 as soon as any name is missing, which is the
+ * normal case here, but still fills in every atom that does exist. */
+static void app_atoms_intern(Display *dpy, Atom *atoms)
+{
+    (void)XInternAtoms(dpy, app_atom_names, APP_ATOM_COUNT, True, atoms);
+}
+
+/* length is in 32-bit units, as for XGetWindowProperty. */
+static void window_property_send(xcb_connection_t *conn, WindowPropertyRequest *request,
+                                 Window window, Atom property, Atom type, uint32_t length)
+{
+    request->sent = (property != None);
+    if (request->sent) {
+        request->cookie = xcb_get_property(conn, 0, (xcb_window_t)window, (xcb_atom_t)property,
+                                           (xcb_atom_t)type, 0, length);
+    }
+}
+
+/* NULL when the request was not sent, failed (the window may be gone by now)
+ * or the property is not set. The reply is released with free(). */
+static xcb_get_property_reply_t *window_property_reply(xcb_connection_t *conn, WindowPropertyRequest *request)
+{
+    if (!request->sent) return NULL;
+    request->sent = 0;
+    xcb_generic_error_t *error = NULL;
+    xcb_get_property_reply_t *reply = xcb_get_property_reply(conn, request->cookie, &error);
+    free(error);
+    if (reply && reply->type == XCB_NONE) {
+        free(reply);
+        return NULL;
+    }
+    return reply;
+}
+
+static void window_property_discard(xcb_connection_t *conn, WindowPropertyRequest *request)
+{
+    if (!request->sent) return;
+    request->sent = 0;
+    xcb_discard_reply(conn, request->cookie.sequence);
+}
+
+static int property_is_atom_list(const xcb_get_property_reply_t *reply)
+{
+    return reply && reply->type == XA_ATOM && reply->format == 32 && reply->value_len > 0;
+}
+
+static int property_contains_atom(const xcb_get_property_reply_t *reply, Atom value)
+{
+    if (!property_is_atom_list(reply) || value == None) return 0;
+    const xcb_atom_t *atoms = (const xcb_atom_t *)xcb_get_property_value(reply);
+    for (uint32_t i = 0; i < reply->value_len; ++i) {
+        if (atoms[i] == (xcb_atom_t)value) return 1;
+    }
+    return 0;
+}
+
+/* Copies a format-8 property up to its first NUL. */
+static size_t property_copy_text(const xcb_get_property_reply_t *reply, char *out, size_t out_len)
+{
+    if (!out || out_len == 0) return 0;
+    out[0] = '\0';
+    if (!reply || reply->format != 8) return 0;
+    const char *text = (const char *)xcb_get_property_value(reply);
+    size_t len = (size_t)xcb_get_property_value_length(reply);
+    const char *nul = (const char *)memchr(text, '\0', len);
+    if (nul) len = (size_t)(nul - text);
+    if (len >= out_len) len = out_len - 1;
+    memcpy(out, text, len);
+    out[len] = '\0';
+    return len;
+}
+
+static void window_fetch_send_filter(xcb_connection_t *conn, WindowFetch *fetch, const Atom *atoms)
+{
+    fetch->attributes = xcb_get_window_attributes(conn, (xcb_window_t)fetch->window);
+    window_property_send(conn, &fetch->net_state, fetch->window, atoms[APP_ATOM_NET_WM_STATE], XA_ATOM, 32);
+    window_property_send(conn, &fetch->wm_state, fetch->window, atoms[APP_ATOM_WM_STATE], AnyPropertyType, 2);
+    window_property_send(conn, &fetch->types, fetch->window, atoms[APP_ATOM_NET_WM_WINDOW_TYPE], XA_ATOM, 32);
+}
+
+static int window_fetch_is_task_list_window(xcb_connection_t *conn, WindowFetch *fetch, const Atom *atoms)
+{
+    xcb_generic_error_t *error = NULL;
+    xcb_get_window_attributes_reply_t *attrs =
+        xcb_get_window_attributes_reply(conn, fetch->attributes, &error);
+    free(error);
+    xcb_get_property_reply_t *net_state = window_property_reply(conn, &fetch->net_state);
+    xcb_get_property_reply_t *wm_state = window_property_reply(conn, &fetch->wm_state);
+    xcb_get_property_reply_t *types = window_property_reply(conn, &fetch->types);
+
+    int listed = 0;
+    if (attrs && attrs->_class == XCB_WINDOW_CLASS_INPUT_OUTPUT && !attrs->override_redirect &&
+        !property_contains_atom(net_state, atoms[APP_ATOM_NET_WM_STATE_SKIP_TASKBAR]) &&
+        !property_contains_atom(net_state, atoms[APP_ATOM_NET_WM_STATE_SKIP_PAGER]) &&
+        (attrs->map_state == XCB_MAP_STATE_VIEWABLE ||
+         property_contains_atom(net_state, atoms[APP_ATOM_NET_WM_STATE_HIDDEN]))) {
+        listed = 1;
+        if (wm_state && wm_state->format == 32 && wm_state->value_len >= 1 &&
+            *(const uint32_t *)xcb_get_property_value(wm_state) == WithdrawnState) {
+            listed = 0;
+        }
+        for (int i = APP_ATOM_FIRST_SKIPPED_TYPE; listed && i < APP_ATOM_COUNT; ++i) {
+            if (property_contains_atom(types, atoms[i])) listed = 0;
+        }
+    }
+    free(attrs);
+    free(net_state);
+    free(wm_state);
+    free(types);
+    return listed;
+}
+
+static void window_fetch_send_info(xcb_connection_t *conn, WindowFetch *fetch, const Atom *atoms)
+{
+    for (int i = 0; i < APP_PID_ATOMS; ++i) {
+        window_property_send(conn, &fetch->pids[i], fetch->window, atoms[APP_ATOM_NET_WM_PID + i], XA_CARDINAL, 1);
+    }
+    window_property_send(conn, &fetch->titles[0], fetch->window, atoms[APP_ATOM_NET_WM_VISIBLE_NAME], AnyPropertyType, 128);
+    window_property_send(conn, &fetch->titles[1], fetch->window, atoms[APP_ATOM_NET_WM_NAME], AnyPropertyType, 128);
+    window_property_send(conn, &fetch->titles[2], fetch->window, XA_WM_NAME, AnyPropertyType, 128);
+    window_property_send(conn, &fetch->wm_class, fetch->window, XA_WM_CLASS, XA_STRING, 64);
+    window_property_send(conn, &fetch->command, fetch->window, XA_WM_COMMAND, XA_STRING, 64);
+}
+
+static int window_fetch_pid(xcb_connection_t *conn, WindowFetch *fetch, pid_t *out_pid)
+{
+    int found = 0;
+    for (int i = 0; i < APP_PID_ATOMS; ++i) {
+        if (found) {
+            window_property_discard(conn, &fetch->pids[i]);
+            continue;
+        }
+        xcb_get_property_reply_t *reply = window_property_reply(conn, &fetch->pids[i]);
+        if (reply && reply->format == 32 && reply->value_len > 0) {
+            *out_pid = (pid_t)*(const uint32_t *)xcb_get_property_value(reply);
+            found = 1;
         }
-        if (data) XFree(data);
+        free(reply);
     }
-    return -1;
+    return found ? 0 : -1;
 }
 
-static void get_window_title(Display *dpy, Window window, char *buffer, size_t len)
+static void window_fetch_title(xcb_connection_t *conn, WindowFetch *fetch, const Atom *atoms,
+                               char *buffer, size_t len)
 {
-    if (!buffer || len == 0) return;
     buffer[0] = '\0';
-    Atom utf8 = XInternAtom(dpy, "UTF8_STRING", True);
-    const char *net_names[] = {
-        "_NET_WM_VISIBLE_NAME",
-        "_NET_WM_NAME"
-    };
-    for (size_t i = 0; i < sizeof(net_names) / sizeof(net_names[0]); ++i) {
-        Atom net_name = XInternAtom(dpy, net_names[i], True);
-        if (net_name == None) continue;
-        Atom type = None;
-        int format = 0;
-        unsigned long nitems = 0;
-        unsigned long bytes_after = 0;
-        unsigned char *data = NULL;
-        int status = XGetWindowProperty(dpy, window, net_name, 0, 128, False, AnyPropertyType,
-                                        &type, &format, &nitems, &bytes_after, &data);
-        if (status == Success && data && nitems > 0) {
-            if (type == utf8 || type == XA_STRING) {
-                snprintf(buffer, len, "%s", (char *)data);
-                XFree(data);
-                if (buffer[0]) return;
-            }
+    for (int i = 0; i < 3; ++i) {
+        if (buffer[0]) {
+            window_property_discard(conn, &fetch->titles[i]);
+            continue;
         }
-        if (data) XFree(data);
-    }
-
-    Atom wm_name = XInternAtom(dpy, "WM_NAME", True);
-    if (wm_name != None) {
-        Atom type = None;
-        int format = 0;
-        unsigned long nitems = 0;
-        unsigned long bytes_after = 0;
-        unsigned char *data = NULL;
-        int status = XGetWindowProperty(dpy, window, wm_name, 0, 128, False, AnyPropertyType,
-                                        &type, &format, &nitems, &bytes_after, &data);
-        if (status == Success && data && nitems > 0) {
-            if (type == utf8 || type == XA_STRING) {
-                snprintf(buffer, len, "%s", (char *)data);
-                XFree(data);
-                if (buffer[0]) return;
-            }
+        xcb_get_property_reply_t *reply = window_property_reply(conn, &fetch->titles[i]);
+        /* The EWMH names are UTF-8; WM_NAME is taken in whatever encoding it has. */
+        if (reply && (i == 2 || reply->type == XA_STRING ||
+                      (atoms[APP_ATOM_UTF8_STRING] != None && reply->type == (xcb_atom_t)atoms[APP_ATOM_UTF8_STRING]))) {
+            property_copy_text(reply, buffer, len);
         }
-        if (data) XFree(data);
+        free(reply);
     }
+}
 
-    char *name = NULL;
-    if (XFetchName(dpy, window, &name) > 0 && name) {
-        snprintf(buffer, len, "%s", name);
-        XFree(name);
+/* WM_CLASS holds the instance and class names, each NUL-terminated. */
+static void window_fetch_wm_class(xcb_connection_t *conn, WindowFetch *fetch, char *out, size_t out_len)
+{
+    out[0] = '\0';
+    xcb_get_property_reply_t *reply = window_property_reply(conn, &fetch->wm_class);
+    if (!reply || reply->format != 8) {
+        free(reply);
+        return;
+    }
+    const char *value = (const char *)xcb_get_property_value(reply);
+    int value_len = xcb_get_property_value_length(reply);
+    int name_len = 0;
+    while (name_len < value_len && value[name_len]) ++name_len;
+    int class_start = name_len < value_len ? name_len + 1 : value_len;
+    int class_len = 0;
+    while (class_start + class_len < value_len && value[class_start + class_len]) ++class_len;
+    if (name_len > 0 && class_len > 0) {
+        snprintf(out, out_len, "%.*s/%.*s", name_len, value, class_len, value + class_start);
+    } else if (class_len > 0) {
+        snprintf(out, out_len, "%.*s", class_len, value + class_start);
+    } else if (name_len > 0) {
+        snprintf(out, out_len, "%.*s", name_len, value);
     }
+    free(reply);
 }
 
-static void get_window_wm_class(Display *dpy, Window window, char *out, size_t out_len)
+/* WM_COMMAND holds argv as NUL-terminated strings; they are joined with spaces. */
+static int window_fetch_command(xcb_connection_t *conn, WindowFetch *fetch, char *out, size_t out_len)
 {
-    if (!out || out_len == 0) return;
     out[0] = '\0';
-    XClassHint hint;
-    if (XGetClassHint(dpy, window, &hint) == 0) return;
-    const char *res_name = hint.res_name ? hint.res_name : "";
-    const char *res_class = hint.res_class ? hint.res_class : "";
-    if (res_name[0] && res_class[0]) {
-        snprintf(out, out_len, "%s/%s", res_name, res_class);
-    } else if (res_class[0]) {
-        snprintf(out, out_len, "%s", res_class);
-    } else if (res_name[0]) {
-        snprintf(out, out_len, "%s", res_name);
-    }
-    if (hint.res_name) XFree(hint.res_name);
-    if (hint.res_class) XFree(hint.res_class);
-}
-
-static int get_window_command(Display *dpy, Window window, char *out, size_t out_len)
-{
-    if (!dpy || !out || out_len == 0) return -1;
-    char **argv = NULL;
-    int argc = 0;
-    Status status = XGetCommand(dpy, window, &argv, &argc);
-    if (status == 0 || !argv || argc <= 0) {
-        if (argv) XFreeStringList(argv);
+    xcb_get_property_reply_t *reply = window_property_reply(conn, &fetch->command);
+    if (!reply || reply->format != 8) {
+        free(reply);
         return -1;
     }
+    const char *value = (const char *)xcb_get_property_value(reply);
+    int value_len = xcb_get_property_value_length(reply);
+    /* The terminator of the last argument is not a separator. */
+    if (value_len > 0 && value[value_len - 1] == '\0') --value_len;
     size_t pos = 0;
-    for (int i = 0; i < argc && argv && argv[i]; ++i) {
-        size_t chunk = strlen(argv[i]);
-        if (pos + chunk >= out_len) {
-            chunk = out_len - pos - 1;
-        }
-        if (chunk > 0) {
-            memcpy(out + pos, argv[i], chunk);
-            pos += chunk;
-        }
-        if (i < argc - 1 && pos < out_len - 1) {
-            out[pos++] = ' ';
-        }
-        if (pos >= out_len - 1) break;
+    for (int i = 0; i < value_len && pos + 1 < out_len; ++i) {
+        out[pos++] = value[i] ? value[i] : ' ';
     }
-    if (pos >= out_len) pos = out_len - 1;
     out[pos] = '\0';
-    if (argv) XFreeStringList(argv);
+    free(reply);
     return pos > 0 ? 0 : -1;
 }
 
-static int tasks_ctrl_application_matches_search(TasksController *ctrl, const TasksApplicationEntry *entry)
+/* Shows the entries of the last listing that match the search text. A longer
+ * query than the last one only re-tests the entries that matched before. */
+static void tasks_ctrl_filter_applications(TasksController *ctrl)
 {
-    if (!ctrl || !entry) return 1;
-    if (!ctrl->apps_search_text[0]) return 1;
-    char pid_buffer[16];
-    pid_buffer[0] = '\0';
-    if (entry->pid_known) {
-        snprintf(pid_buffer, sizeof(pid_buffer), "%d", (int)entry->pid);
+    if (!ctrl) return;
+    free(ctrl->applications);
+    ctrl->applications = NULL;
+    ctrl->applications_count = 0;
+    ctrl->selected_application = -1;
+
+    int total = ctrl->all_applications_count;
+    size_t slots = total > 0 ? (size_t)total : 1;
+    TasksApplicationEntry *shown = (TasksApplicationEntry *)malloc(sizeof(TasksApplicationEntry) * slots);
+    int *rows = (int *)malloc(sizeof(int) * slots);
+    if (!shown || !rows) {
+        free(shown);
+        free(rows);
+        tasks_ui_set_applications_table(ctrl->ui, NULL, 0);
+        return;
     }
-    return contains_ignore_case(entry->title, ctrl->apps_search_text) ||
-           contains_ignore_case(entry->command, ctrl->apps_search_text) ||
-           contains_ignore_case(entry->wm_class, ctrl->apps_search_text) ||
-           contains_ignore_case(pid_buffer, ctrl->apps_search_text);
+
+    char query[TASKS_SEARCH_QUERY_MAX];
+    size_t query_len = tasks_search_fold(ctrl->apps_search_text, query, sizeof(query));
+    const int *candidates = NULL;
+    int candidate_count = total;
+    if (query_len > 0 && tasks_search_matches_narrow(&ctrl->apps_matches, query)) {
+        candidates = ctrl->apps_matches.rows;
+        candidate_count = ctrl->apps_matches.count;
+    }
+    int count = 0;
+    for (int k = 0; k < candidate_count; ++k) {
+        int i = candidates ? candidates[k] : k;
+        if (!tasks_search_index_match(&ctrl->apps_search, i, query, query_len)) continue;
+        shown[count] = ctrl->all_applications[i];
+        rows[count++] = i;
+    }
+    if (query_len > 0) {
+        tasks_search_matches_store(&ctrl->apps_matches, query, rows, count);
+    } else {
+        tasks_search_matches_invalidate(&ctrl->apps_matches);
+    }
+    free(rows);
+
+    ctrl->applications = shown;
+    ctrl->applications_count = count;
+    tasks_ui_set_applications_table(ctrl->ui, ctrl->applications, ctrl->applications_count);
 }
 
-static pid_t tasks_ctrl_find_pid_by_command(TasksController *ctrl, const char *command)
+/* Copies the first word of a command line (quotes allowed) into token. */
+static size_t tasks_ctrl_command_token(const char *command, char *token, size_t token_len)
 {
-    if (!ctrl || !command || !command[0] || ctrl->process_count <= 0 || !ctrl->process_entries) return -1;
+    if (!token || token_len == 0) return 0;
+    token[0] = '\0';
+    if (!command) return 0;
     const char *p = command;
     while (*p && isspace((unsigned char)*p)) ++p;
-    if (!*p) return -1;
-    char token[PATH_MAX];
-    memset(token, 0, sizeof(token));
     size_t len = 0;
     if (*p == '"' || *p == '\'') {
         char quote = *p++;
-        while (*p && *p != quote && len + 1 < sizeof(token)) {
+        while (*p && *p != quote && len + 1 < token_len) {
             token[len++] = *p++;
         }
-        if (*p == quote) ++p;
     } else {
-        while (*p && !isspace((unsigned char)*p) && len + 1 < sizeof(token)) {
+        while (*p && !isspace((unsigned char)*p) && len + 1 < token_len) {
             token[len++] = *p++;
         }
     }
     token[len] = '\0';
-    if (!token[0]) return -1;
+    return len;
+}
+
+static const char *tasks_ctrl_token_basename(const char *token)
+{
     const char *slash = strrchr(token, '/');
-    const char *base = slash ? slash + 1 : token;
-    for (int i = 0; i < ctrl->process_count; ++i) {
-        const TasksProcessEntry *entry = &ctrl->process_entries[i];
-        if (!entry) continue;
-        if (entry->command[0]) {
-            if (strcasecmp(entry->command, token) == 0 ||
-                (base && strcasecmp(entry->command, base) == 0) ||
-                strcasestr(entry->command, token) ||
-                (base && strcasestr(entry->command, base))) {
-                return entry->pid;
-            }
+    return slash ? slash + 1 : token;
+}
+
+/* The comm index needs only the scanned names. The argv[0] indexes load every
+ * command line, so they are built only once a window misses the comm index.
+ * Both last until the next process snapshot. */
+static void tasks_ctrl_index_process_names(TasksController *ctrl, Boolean commands)
+{
+    TasksProcessList *list = ctrl->all_processes;
+    if (!list) return;
+    if (!ctrl->pid_names_indexed) {
+        ctrl->pid_names_indexed = True;
+        for (int i = 0; i < list->count; ++i) {
+            const char *name = tasks_model_process_name(list, i);
+            if (!name[0]) continue;
+            if (tasks_pid_index_add(&ctrl->pid_by_comm, name, strlen(name), list->pids[i]) != 0) break;
         }
-        if (entry->name[0]) {
-            if (strcasecmp(entry->name, base) == 0 ||
-                (base && strcasestr(base, entry->name))) {
-                return entry->pid;
-            }
-            if (command && strcasestr(command, entry->name)) {
-                return entry->pid;
+    }
+    if (commands && !ctrl->pid_commands_indexed) {
+        ctrl->pid_commands_indexed = True;
+        char token[PATH_MAX];
+        for (int i = 0; i < list->count; ++i) {
+            /* Loads the command line on first use; it stays cached in the list. */
+            const char *command = tasks_model_process_command(list, i);
+            size_t len = tasks_ctrl_command_token(command, token, sizeof(token));
+            if (len == 0) continue;
+            const char *base = tasks_ctrl_token_basename(token);
+            if (tasks_pid_index_add(&ctrl->pid_by_argv0, token, len, list->pids[i]) != 0 ||
+                (base[0] && tasks_pid_index_add(&ctrl->pid_by_exe, base, strlen(base), list->pids[i]) != 0)) {
+                break;
             }
         }
     }
-    return -1;
+}
+
+static void tasks_ctrl_invalidate_process_names(TasksController *ctrl)
+{
+    tasks_pid_index_clear(&ctrl->pid_by_comm);
+    tasks_pid_index_clear(&ctrl->pid_by_argv0);
+    tasks_pid_index_clear(&ctrl->pid_by_exe);
+    ctrl->pid_names_indexed = False;
+    ctrl->pid_commands_indexed = False;
+}
+
+/* Resolves a window's WM_COMMAND to a process: by the executable name against
+ * comm (which the kernel cuts to 15 bytes), then by the full argv[0], then by
+ * the basename of argv[0]. */
+static pid_t tasks_ctrl_find_pid_by_command(TasksController *ctrl, const char *command)
+{
+    if (!ctrl || !command || !command[0] || !ctrl->all_processes) return -1;
+    char token[PATH_MAX];
+    size_t len = tasks_ctrl_command_token(command, token, sizeof(token));
+    if (len == 0) return -1;
+    const char *base = tasks_ctrl_token_basename(token);
+    size_t base_len = strlen(base);
+
+    tasks_ctrl_index_process_names(ctrl, False);
+    pid_t pid = -1;
+    if (base_len > 0) {
+        pid = tasks_pid_index_find(&ctrl->pid_by_comm, base, base_len);
+        if (pid < 0 && base_len > TASKS_COMM_MAX) {
+            pid = tasks_pid_index_find(&ctrl->pid_by_comm, base, TASKS_COMM_MAX);
+        }
+    }
+    if (pid >= 0) return pid;
+
+    tasks_ctrl_index_process_names(ctrl, True);
+    pid = tasks_pid_index_find(&ctrl->pid_by_argv0, token, len);
+    if (pid < 0 && base_len > 0) pid = tasks_pid_index_find(&ctrl->pid_by_exe, base, base_len);
+    return pid;
 }
 
 static void window_collection_init(WindowCollection *collection)
@@ -547,169 +1161,6 @@ static void window_collection_add_from_atom(Display *dpy, Window root, const cha
     if (data) XFree(data);
 }
 
-static int window_property_contains_atom(Display *dpy, Window window, Atom property, Atom value)
-{
-    if (!dpy || property == None || value == None) return 0;
-    Atom actual_type = None;
-    int format = 0;
-    unsigned long nitems = 0;
-    unsigned long bytes_after = 0;
-    unsigned char *data = NULL;
-    int status = XGetWindowProperty(dpy, window, property, 0, 32, False, XA_ATOM,
-                                    &actual_type, &format, &nitems, &bytes_after, &data);
-    if (status != Success || !data || actual_type != XA_ATOM || format != 32) {
-        if (data) XFree(data);
-        return 0;
-    }
-    Atom *atoms = (Atom *)data;
-    int found = 0;
-    for (unsigned long i = 0; i < nitems; ++i) {
-        if (atoms[i] == value) {
-            found = 1;
-            break;
-        }
-    }
-    XFree(data);
-    return found;
-}
-
-static int get_window_wm_state(Display *dpy, Window window, long *state_out)
-{
-    if (!dpy || !state_out) return -1;
-    Atom wm_state = XInternAtom(dpy, "WM_STATE", True);
-    if (wm_state == None) return -1;
-    Atom actual_type = None;
-    int format = 0;
-    unsigned long nitems = 0;
-    unsigned long bytes_after = 0;
-    unsigned char *data = NULL;
-    int status = XGetWindowProperty(dpy, window, wm_state, 0, 2, False, AnyPropertyType,
-                                    &actual_type, &format, &nitems, &bytes_after, &data);
-    if (status != Success || !data || format != 32 || nitems < 1) {
-        if (data) XFree(data);
-        return -1;
-    }
-    long *state = (long *)data;
-    *state_out = state[0];
-    XFree(data);
-    return 0;
-}
-
-static int window_has_net_wm_state(Display *dpy, Window window, const char *state_name)
-{
-    if (!dpy || !state_name) return 0;
-    Atom net_state = XInternAtom(dpy, "_NET_WM_STATE", True);
-    if (net_state == None) return 0;
-    Atom state = XInternAtom(dpy, state_name, True);
-    if (state == None) return 0;
-    return window_property_contains_atom(dpy, window, net_state, state);
-}
-
-static int window_get_net_wm_types(Display *dpy, Window window, Atom **out_types, unsigned long *out_count)
-{
-    if (out_types) *out_types = NULL;
-    if (out_count) *out_count = 0;
-    if (!dpy || window == None || !out_types || !out_count) return 0;
-    Atom net_type = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE", True);
-    if (net_type == None) return 0;
-    Atom actual_type = None;
-    int format = 0;
-    unsigned long nitems = 0;
-    unsigned long bytes_after = 0;
-    unsigned char *data = NULL;
-    int status = XGetWindowProperty(dpy, window, net_type, 0, 32, False, XA_ATOM,
-                                    &actual_type, &format, &nitems, &bytes_after, &data);
-    if (status != Success || !data || actual_type != XA_ATOM || format != 32 || nitems == 0) {
-        if (data) XFree(data);
-        return 0;
-    }
-    *out_types = (Atom *)data;
-    *out_count = nitems;
-    return 1;
-}
-
-static int atom_list_contains_any(const Atom *atoms, unsigned long atom_count, const Atom *needles, size_t needle_count)
-{
-    if (!atoms || atom_count == 0 || !needles || needle_count == 0) return 0;
-    for (unsigned long i = 0; i < atom_count; ++i) {
-        for (size_t j = 0; j < needle_count; ++j) {
-            if (needles[j] != None && atoms[i] == needles[j]) {
-                return 1;
-            }
-        }
-    }
-    return 0;
-}
-
-static int window_is_task_list_window(Display *dpy, Window window)
-{
-    if (!dpy || window == None) return 0;
-    XWindowAttributes attrs;
-    if (XGetWindowAttributes(dpy, window, &attrs) == 0) return 0;
-    if (attrs.class != InputOutput || attrs.override_redirect) return 0;
-
-    if (window_has_net_wm_state(dpy, window, "_NET_WM_STATE_SKIP_TASKBAR") ||
-        window_has_net_wm_state(dpy, window, "_NET_WM_STATE_SKIP_PAGER")) {
-        return 0;
-    }
-
-    if (attrs.map_state != IsViewable &&
-        !window_has_net_wm_state(dpy, window, "_NET_WM_STATE_HIDDEN")) {
-        return 0;
-    }
-
-    long state = 0;
-    if (get_window_wm_state(dpy, window, &state) == 0 && state == WithdrawnState) {
-        return 0;
-    }
-
-    Atom type_normal = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_NORMAL", True);
-    Atom type_dialog = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_DIALOG", True);
-    Atom type_utility = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_UTILITY", True);
-    Atom type_toolbar = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_TOOLBAR", True);
-    Atom type_menu = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_MENU", True);
-    Atom type_splash = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_SPLASH", True);
-    Atom type_dock = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_DOCK", True);
-    Atom type_desktop = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_DESKTOP", True);
-    Atom type_notification = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_NOTIFICATION", True);
-    Atom type_dropdown = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_DROPDOWN_MENU", True);
-    Atom type_popup = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_POPUP_MENU", True);
-    Atom type_tooltip = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_TOOLTIP", True);
-    Atom type_combo = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_COMBO", True);
-    Atom type_dnd = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_DND", True);
-
-    Atom *types = NULL;
-    unsigned long type_count = 0;
-    if (window_get_net_wm_types(dpy, window, &types, &type_count)) {
-        Atom skip_types[] = {
-            type_utility,
-            type_toolbar,
-            type_menu,
-            type_splash,
-            type_dock,
-            type_desktop,
-            type_notification,
-            type_dropdown,
-            type_popup,
-            type_tooltip,
-            type_combo,
-            type_dnd
-        };
-        if (atom_list_contains_any(types, type_count, skip_types, sizeof(skip_types) / sizeof(skip_types[0]))) {
-            XFree(types);
-            return 0;
-        }
-        if (atom_list_contains_any(types, type_count, &type_normal, 1) ||
-            atom_list_contains_any(types, type_count, &type_dialog, 1)) {
-            XFree(types);
-            return 1;
-        }
-        XFree(types);
-    }
-
-    return 1;
-}
-
 static int query_client_list(Display *dpy, Window root, Window **out_list, unsigned long *out_count)
 {
     if (!dpy || !out_list || !out_count) return -1;
@@ -755,27 +1206,48 @@ static void tasks_ctrl_refresh_applications(TasksController *ctrl)
     unsigned long count = 0;
     if (query_client_list(dpy, root, &windows, &count) != 0) return;
 
-    free(ctrl->applications);
-    ctrl->applications = NULL;
-    ctrl->applications_count = 0;
-    ctrl->selected_application = -1;
-
-    TasksApplicationEntry *entries = NULL;
-    int entry_count = 0;
-    int entry_capacity = 0;
+    xcb_connection_t *conn = XGetXCBConnection(dpy);
+    WindowFetch *fetches = count > 0 ? (WindowFetch *)calloc(count, sizeof(WindowFetch)) : NULL;
+    if (!conn || (count > 0 && !fetches)) {
+        free(fetches);
+        free(windows);
+        return;
+    }
+    Atom atoms[APP_ATOM_COUNT];
+    app_atoms_intern(dpy, atoms);
 
+    /* Two round trips for the whole listing: one to pick the task list
+     * windows, one for what the table shows of them. */
     for (unsigned long i = 0; i < count; ++i) {
-        if (!window_is_task_list_window(dpy, windows[i])) {
-            continue;
+        fetches[i].window = windows[i];
+        window_fetch_send_filter(conn, &fetches[i], atoms);
+    }
+    unsigned long listed = 0;
+    for (unsigned long i = 0; i < count; ++i) {
+        if (window_fetch_is_task_list_window(conn, &fetches[i], atoms)) {
+            fetches[listed++].window = windows[i];
         }
+    }
+    free(windows);
+    for (unsigned long i = 0; i < listed; ++i) {
+        window_fetch_send_info(conn, &fetches[i], atoms);
+    }
+
+    TasksApplicationEntry *entries = listed > 0 ?
+        (TasksApplicationEntry *)malloc(sizeof(TasksApplicationEntry) * listed) : NULL;
+    int entry_count = 0;
+
+    for (unsigned long i = 0; i < listed; ++i) {
         char title[128] = {0};
         char command[256] = {0};
         char wm_class[128] = {0};
-        get_window_title(dpy, windows[i], title, sizeof(title));
-        get_window_command(dpy, windows[i], command, sizeof(command));
-        get_window_wm_class(dpy, windows[i], wm_class, sizeof(wm_class));
+        window_fetch_title(conn, &fetches[i], atoms, title, sizeof(title));
+        window_fetch_command(conn, &fetches[i], command, sizeof(command));
+        window_fetch_wm_class(conn, &fetches[i], wm_class, sizeof(wm_class));
         pid_t pid = 0;
-        int pid_known = (get_window_pid(dpy, windows[i], &pid) == 0) ? 1 : 0;
+        int pid_known = (window_fetch_pid(conn, &fetches[i], &pid) == 0) ? 1 : 0;
+        /* Replies are drained even when there is nowhere to put the entry. */
+        if (!entries) continue;
         if (!pid_known && command[0]) {
             pid_t matched = tasks_ctrl_find_pid_by_command(ctrl, command);
             if (matched > 0) {
@@ -784,17 +1256,9 @@ static void tasks_ctrl_refresh_applications(TasksController *ctrl)
             }
         }
 
-        if (entry_count >= entry_capacity) {
-            int new_capacity = entry_capacity ? entry_capacity * 2 : 32;
-            TasksApplicationEntry *resized = (TasksApplicationEntry *)realloc(entries, sizeof(TasksApplicationEntry) * new_capacity);
-            if (!resized) break;
-            entries = resized;
-            entry_capacity = new_capacity;
-        }
-
         TasksApplicationEntry *entry = &entries[entry_count];
         memset(entry, 0, sizeof(*entry));
-        entry->window = windows[i];
+        entry->window = fetches[i].window;
         entry->pid = pid_known ? pid : -1;
         entry->pid_known = pid_known;
         entry->window_count = 1;
@@ -812,52 +1276,86 @@ static void tasks_ctrl_refresh_applications(TasksController *ctrl)
         entry_count++;
     }
 
-    free(windows);
+    free(fetches);
 
-    int write_index = 0;
+    /* Searchable text is folded once per listing, not per keystroke. */
+    tasks_search_index_clear(&ctrl->apps_search);
+    tasks_search_matches_invalidate(&ctrl->apps_matches);
     for (int i = 0; i < entry_count; ++i) {
-        if (!tasks_ctrl_application_matches_search(ctrl, &entries[i])) continue;
-        if (write_index != i) {
-            entries[write_index] = entries[i];
+        char pid_buffer[16];
+        pid_buffer[0] = '\0';
+        if (entries[i].pid_known) {
+            snprintf(pid_buffer, sizeof(pid_buffer), "%d", (int)entries[i].pid);
         }
-        write_index++;
+        const char *fields[] = { entries[i].title, entries[i].command, entries[i].wm_class, pid_buffer };
+        if (tasks_search_index_add_row(&ctrl->apps_search, fields, 4) < 0) break;
     }
-    entry_count = write_index;
 
-    ctrl->applications = entries;
-    ctrl->applications_count = entry_count;
-    tasks_ui_set_applications_table(ctrl->ui, ctrl->applications, ctrl->applications_count);
+    free(ctrl->all_applications);
+    ctrl->all_applications = entries;
+    ctrl->all_applications_count = entry_count;
+    tasks_ctrl_filter_applications(ctrl);
 }
 
-static void tasks_ctrl_refresh_users(TasksController *ctrl)
+static void tasks_ctrl_refresh_users(TasksController *ctrl, TasksSnapshot *snapshot)
 {
-    if (!ctrl || !ctrl->ui) return;
+    if (!ctrl || !ctrl->ui || !snapshot) return;
     if (ctrl->ui->users_updates_paused) return;
-    TasksUserEntry *entries = NULL;
-    int count = 0;
-    if (tasks_model_list_users(&entries, &count) != 0) {
-        return;
-    }
+    if (!snapshot->users_ok) return;
     tasks_model_free_users(ctrl->user_sessions, ctrl->user_session_count);
-    ctrl->user_sessions = entries;
-    ctrl->user_session_count = count;
+    ctrl->user_sessions = snapshot->users;
+    ctrl->user_session_count = snapshot->user_count;
+    snapshot->users = NULL;
+    snapshot->user_count = 0;
     tasks_ui_set_users_table(ctrl->ui, ctrl->user_sessions, ctrl->user_session_count);
 }
 
-static void tasks_ctrl_refresh_services(TasksController *ctrl)
+static void tasks_ctrl_refresh_network(TasksController *ctrl, TasksSnapshot *snapshot)
 {
-    if (!ctrl || !ctrl->ui) return;
-    if (ctrl->ui->services_updates_paused) return;
-    TasksServiceEntry *entries = NULL;
-    int count = 0;
-    TasksInitInfo init_info;
-    if (tasks_model_list_services(&entries, &count, &init_info, ctrl->show_disabled_services ? 1 : 0) != 0) {
-        return;
+    if (!ctrl || !ctrl->ui || !snapshot) return;
+    if (!snapshot->network_ok) return;
+    /* The socket table keeps reading the previous array until it gets the new one. */
+    TasksNetInterface *old_interfaces = ctrl->net_interfaces;
+    TasksNetSocket *old_sockets = ctrl->net_sockets;
+    ctrl->net_interfaces = snapshot->interfaces;
+    ctrl->net_sockets = snapshot->sockets;
+    tasks_ui_set_network(ctrl->ui, snapshot->interfaces, snapshot->interface_count,
+                         snapshot->sockets, snapshot->socket_count);
+    snapshot->interfaces = NULL;
+    snapshot->sockets = NULL;
+    tasks_model_free_network(old_interfaces, old_sockets);
+}
+
+static void tasks_ctrl_refresh_cgroups(TasksController *ctrl, TasksSnapshot *snapshot)
+{
+    if (!ctrl || !ctrl->ui || !snapshot) return;
+    /* Like the sockets, the table reads the entries until it gets new ones. */
+    TasksCgroupEntry *old_cgroups = ctrl->cgroups;
+    ctrl->cgroups = snapshot->cgroups_ok ? snapshot->cgroups : NULL;
+    tasks_ui_set_cgroups(ctrl->ui, ctrl->cgroups, snapshot->cgroups_ok ? snapshot->cgroup_count : 0);
+    if (snapshot->cgroups_ok) snapshot->cgroups = NULL;
+    tasks_model_free_cgroups(old_cgroups);
+}
+
+static void tasks_ctrl_refresh_services(TasksController *ctrl, TasksSnapshot *snapshot)
+{
+    if (!ctrl || !ctrl->ui || !snapshot) return;
+    /* Without services_ok the listing is unchanged (or unreadable): keep the table. */
+    if (snapshot->services_ok) {
+        tasks_model_free_services(ctrl->pending_services, ctrl->pending_service_count);
+        ctrl->pending_services = snapshot->services;
+        ctrl->pending_service_count = snapshot->service_count;
+        ctrl->pending_init_info = snapshot->init_info;
+        snapshot->services = NULL;
+        snapshot->service_count = 0;
     }
+    if (ctrl->ui->services_updates_paused || !ctrl->pending_services) return;
     tasks_model_free_services(ctrl->service_entries, ctrl->service_count);
-    ctrl->service_entries = entries;
-    ctrl->service_count = count;
-    ctrl->service_init_info = init_info;
+    ctrl->service_entries = ctrl->pending_services;
+    ctrl->service_count = ctrl->pending_service_count;
+    ctrl->service_init_info = ctrl->pending_init_info;
+    ctrl->pending_services = NULL;
+    ctrl->pending_service_count = 0;
 
     if (!ctrl->show_disabled_services && ctrl->service_init_info.init_name[0] &&
         strcmp(ctrl->service_init_info.init_name, "systemd") == 0) {
@@ -912,7 +1410,7 @@ static void on_refresh_timer(XtPointer client_data, XtIntervalId *id)
     TasksController *ctrl = client_data;
     if (!ctrl) return;
     ctrl->refresh_timer = 0;
-    on_view_refresh(NULL, ctrl, NULL);
+    tasks_ctrl_refresh_now(ctrl);
     tasks_ctrl_schedule_refresh(ctrl);
 }
 
@@ -934,7 +1432,7 @@ static void tasks_ctrl_update_virtual_scrollbar(TasksController *ctrl)
 {
     if (!ctrl || !ctrl->ui || !ctrl->ui->process_scrollbar) return;
     Widget scrollbar = ctrl->ui->process_scrollbar;
-    int total = ctrl->process_count;
+    int total = ctrl->process_views[ctrl->process_view_index].count;
     int page = tasks_ui_get_process_row_page_size();
     if (page <= 0) page = 1;
     int slider_size = total > 0 ? (total < page ? total : page) : 1;
@@ -958,7 +1456,7 @@ static void tasks_ctrl_set_virtual_window(TasksController *ctrl, int start)
     if (!ctrl) return;
     int page = tasks_ui_get_process_row_page_size();
     if (page <= 0) page = 1;
-    int total = ctrl->process_count;
+    int total = ctrl->process_views[ctrl->process_view_index].count;
     int max_start = total > page ? total - page : 0;
     if (max_start < 0) max_start = 0;
     if (start < 0) start = 0;
@@ -966,6 +1464,26 @@ static void tasks_ctrl_set_virtual_window(TasksController *ctrl, int start)
     ctrl->virtual_row_start = start;
     tasks_ui_set_process_row_window(start);
     tasks_ctrl_update_virtual_scrollbar(ctrl);
+    tasks_ctrl_request_details(ctrl);
+}
+
+/* Asks for the detail columns of the rows on screen; rows cached within the
+ * TTL are skipped by the details worker. */
+static void tasks_ctrl_request_details(TasksController *ctrl)
+{
+    if (!ctrl || !ctrl->details || ctrl->remote) return;
+    if (tasks_ui_get_current_tab(ctrl->ui) != TASKS_TAB_PROCESSES) return;
+    const TasksProcessView *view = &ctrl->process_views[ctrl->process_view_index];
+    if (!view->list) return;
+    int rows[TASKS_DETAILS_MAX_ROWS];
+    pid_t pids[TASKS_DETAILS_MAX_ROWS];
+    int count = tasks_ui_get_visible_process_rows(ctrl->ui, rows, TASKS_DETAILS_MAX_ROWS);
+    int pid_count = 0;
+    for (int i = 0; i < count; ++i) {
+        if (rows[i] < 0 || rows[i] >= view->count) continue;
+        pids[pid_count++] = view->list->pids[view->rows[rows[i]]];
+    }
+    tasks_details_request(ctrl->details, tasks_model_process_root(view->list), pids, pid_count);
 }
 
 void tasks_ctrl_handle_viewport_change(TasksController *ctrl)
@@ -993,62 +1511,72 @@ static void on_process_scroll(Widget widget, XtPointer client, XtPointer call)
     tasks_ctrl_set_virtual_window(ctrl, cb->value);
 }
 
-static int tasks_ctrl_filter_processes(TasksController *ctrl, TasksProcessEntry *entries, int count)
+/* Folds the searchable columns of every process once per list. */
+static int tasks_ctrl_index_processes(TasksController *ctrl, const TasksProcessList *list)
 {
-    if (!ctrl || !entries || count <= 0) return 0;
+    if (ctrl->process_search.count == list->count) return 0;
+    tasks_search_index_clear(&ctrl->process_search);
+    for (int i = 0; i < list->count; ++i) {
+        char pid_string[16];
+        snprintf(pid_string, sizeof(pid_string), "%d", (int)list->pids[i]);
+        const char *fields[] = { tasks_model_process_name(list, i), tasks_model_process_user(list, i), pid_string };
+        if (tasks_search_index_add_row(&ctrl->process_search, fields, 3) < 0) {
+            tasks_search_index_clear(&ctrl->process_search);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Fills view->rows with the indices of view->list that pass the user filter and
+ * search; the caller has reserved room for every entry. When the search only
+ * got longer, just the rows the shorter one matched are tested again. */
+static void tasks_ctrl_filter_processes(TasksController *ctrl, TasksProcessView *view)
+{
+    if (!ctrl || !view || !view->list) return;
+    const TasksProcessList *list = view->list;
     uid_t uid = getuid();
-    struct passwd *pw = getpwuid(uid);
     char uid_buffer[16];
     snprintf(uid_buffer, sizeof(uid_buffer), "%d", (int)uid);
 
-    const char *user_name = (pw && pw->pw_name) ? pw->pw_name : "";
+    char user_name[64];
+    user_cache_lookup(uid, user_name, sizeof(user_name));
+
+    char query[TASKS_SEARCH_QUERY_MAX];
+    size_t query_len = tasks_search_fold(ctrl->search_text, query, sizeof(query));
+    if (query_len > 0 && tasks_ctrl_index_processes(ctrl, list) != 0) {
+        view->count = 0;
+        return;
+    }
+    const int *candidates = NULL;
+    int candidate_count = list->count;
+    if (query_len > 0 && tasks_search_matches_narrow(&ctrl->process_matches, query)) {
+        candidates = ctrl->process_matches.rows;
+        candidate_count = ctrl->process_matches.count;
+    }
+
     int write_index = 0;
-    for (int i = 0; i < count; ++i) {
-        const char *entry_user = entries[i].user;
+    for (int k = 0; k < candidate_count; ++k) {
+        int i = candidates ? candidates[k] : k;
         if (ctrl->filter_by_user) {
+            const char *entry_user = tasks_model_process_user(list, i);
             if (!entry_user || entry_user[0] == '\0') continue;
             if (!((user_name[0] && strcmp(entry_user, user_name) == 0) ||
                   strcmp(entry_user, uid_buffer) == 0)) {
                 continue;
             }
         }
-        if (!tasks_ctrl_entry_matches_search(ctrl, &entries[i])) {
+        if (!tasks_search_index_match(&ctrl->process_search, i, query, query_len)) {
             continue;
         }
-        if (write_index != i) {
-            entries[write_index] = entries[i];
-        }
-        write_index++;
+        view->rows[write_index++] = i;
     }
-    return write_index;
-}
-
-static int contains_ignore_case(const char *text, const char *pattern)
-{
-    if (!text || !pattern || !pattern[0]) return 0;
-    size_t pattern_len = strlen(pattern);
-    for (const char *base = text; *base; ++base) {
-        size_t i = 0;
-        for (; i < pattern_len; ++i) {
-            char tc = base[i];
-            char pc = pattern[i];
-            if (tc == '\0') break;
-            if (tolower((unsigned char)tc) != tolower((unsigned char)pc)) break;
-        }
-        if (i == pattern_len) return 1;
+    view->count = write_index;
+    if (query_len > 0) {
+        tasks_search_matches_store(&ctrl->process_matches, query, view->rows, view->count);
+    } else {
+        tasks_search_matches_invalidate(&ctrl->process_matches);
     }
-    return 0;
-}
-
-static int tasks_ctrl_entry_matches_search(TasksController *ctrl, const TasksProcessEntry *entry)
-{
-    if (!ctrl || !entry) return 1;
-    if (!ctrl->search_text[0]) return 1;
-    char pid_string[16];
-    snprintf(pid_string, sizeof(pid_string), "%d", (int)entry->pid);
-    return contains_ignore_case(entry->name, ctrl->search_text) ||
-           contains_ignore_case(entry->user, ctrl->search_text) ||
-           contains_ignore_case(pid_string, ctrl->search_text);
 }
 
 static void tasks_ctrl_set_search_text(TasksController *ctrl, const char *text)
@@ -1067,6 +1595,8 @@ static void tasks_ctrl_apply_filter_state(TasksController *ctrl, Boolean state)
 {
     if (!ctrl) return;
     ctrl->filter_by_user = state;
+    /* The remembered matches passed the old user filter. */
+    tasks_search_matches_invalidate(&ctrl->process_matches);
     if (ctrl->ui->process_filter_toggle) {
         XmToggleButtonGadgetSetState(ctrl->ui->process_filter_toggle, state, False);
     }
@@ -1092,6 +1622,8 @@ TasksController *tasks_ctrl_create(TasksUi *ui, SessionData *session_data)
     ctrl->service_entries = NULL;
     ctrl->service_count = 0;
     memset(&ctrl->service_init_info, 0, sizeof(ctrl->service_init_info));
+    ctrl->pending_services = NULL;
+    ctrl->pending_service_count = 0;
     ctrl->show_disabled_services = False;
 
     XtAddCallback(ui->menu_file_exit, XmNactivateCallback, on_file_exit, ctrl);
@@ -1118,6 +1650,10 @@ TasksController *tasks_ctrl_create(TasksUi *ui, SessionData *session_data)
         XtAddCallback(ui->process_scrollbar, XmNdragCallback, on_process_scroll, ctrl);
     }
 
+    if (ui->tab_stack) {
+        XtAddCallback(ui->tab_stack, XmNtabSelectedCallback, on_tab_selected, ctrl);
+    }
+
     XtAddCallback(ui->menu_help_help, XmNactivateCallback, on_help_view, ctrl);
     XtAddCallback(ui->menu_help_about, XmNactivateCallback, on_about, ctrl);
     if (ui->apps_search_field) {
@@ -1134,9 +1670,23 @@ TasksController *tasks_ctrl_create(TasksUi *ui, SessionData *session_data)
     XtVaSetValues(ui->menu_options_update_2s, XmNuserData, (XtPointer)(intptr_t)2000, NULL);
     XtVaSetValues(ui->menu_options_update_5s, XmNuserData, (XtPointer)(intptr_t)5000, NULL);
 
+    ctrl->details = tasks_details_create(TASKS_DETAILS_TTL_MS, TASKS_DETAILS_BUDGET_MS);
+    if (ctrl->details) {
+        ui->process_details = ctrl->details;
+        ctrl->details_input = XtAppAddInput(tasks_ui_get_app_context(ui), tasks_details_get_fd(ctrl->details),
+                                            (XtPointer)XtInputReadMask, on_details_input, ctrl);
+    }
+
     tasks_ctrl_apply_filter_state(ctrl, True);
-    on_view_refresh(NULL, ctrl, NULL);
-    tasks_ctrl_schedule_refresh(ctrl);
+    ctrl->sampler = tasks_sampler_create(ctrl->refresh_interval_ms, ctrl->show_disabled_services ? 1 : 0);
+    if (ctrl->sampler) {
+        ctrl->sampler_input = XtAppAddInput(tasks_ui_get_app_context(ui), tasks_sampler_get_fd(ctrl->sampler),
+                                            (XtPointer)XtInputReadMask, on_sampler_input, ctrl);
+    } else {
+        /* No thread available: collect on the main loop as before. */
+        tasks_ctrl_refresh_now(ctrl);
+        tasks_ctrl_schedule_refresh(ctrl);
+    }
 
     return ctrl;
 }
@@ -1146,7 +1696,13 @@ void tasks_ctrl_set_show_disabled_services(TasksController *ctrl, Boolean show_d
     if (!ctrl) return;
     if (ctrl->show_disabled_services == show_disabled) return;
     ctrl->show_disabled_services = show_disabled;
-    tasks_ctrl_refresh_services(ctrl);
+    tasks_ctrl_mark_dirty(ctrl, TASKS_SOURCE_SERVICES);
+    tasks_ctrl_update_sources(ctrl);
+    if (ctrl->sampler) {
+        tasks_sampler_set_include_disabled_services(ctrl->sampler, show_disabled ? 1 : 0);
+    } else {
+        tasks_ctrl_refresh_now(ctrl);
+    }
 }
 
 void tasks_ctrl_destroy(TasksController *ctrl)
@@ -1156,12 +1712,55 @@ void tasks_ctrl_destroy(TasksController *ctrl)
         XtRemoveTimeOut(ctrl->refresh_timer);
         ctrl->refresh_timer = 0;
     }
+    if (ctrl->sampler_input) {
+        XtRemoveInput(ctrl->sampler_input);
+        ctrl->sampler_input = 0;
+    }
+    if (ctrl->remote_input) {
+        XtRemoveInput(ctrl->remote_input);
+        ctrl->remote_input = 0;
+    }
+    if (ctrl->remote) {
+        tasks_remote_destroy(ctrl->remote);
+        ctrl->remote = NULL;
+    }
+    if (ctrl->details_input) {
+        XtRemoveInput(ctrl->details_input);
+        ctrl->details_input = 0;
+    }
+    if (ctrl->details) {
+        if (ctrl->ui) ctrl->ui->process_details = NULL;
+        tasks_details_destroy(ctrl->details);
+        ctrl->details = NULL;
+    }
+    if (ctrl->sampler) {
+        /* Does not wait for a scan in progress; the sampler thread shuts the
+         * model down once it notices. */
+        tasks_sampler_destroy(ctrl->sampler);
+        ctrl->sampler = NULL;
+    } else {
+        tasks_model_shutdown();
+    }
     if (ctrl->about_shell && XtIsWidget(ctrl->about_shell)) {
         XtDestroyWidget(ctrl->about_shell);
     }
-    tasks_model_free_processes(ctrl->process_entries, ctrl->process_count);
+    tasks_model_free_processes(ctrl->all_processes);
+    tasks_model_free_process_view(&ctrl->process_views[0]);
+    tasks_model_free_process_view(&ctrl->process_views[1]);
+    tasks_model_free_process_diff(&ctrl->process_diff);
     tasks_model_free_users(ctrl->user_sessions, ctrl->user_session_count);
+    tasks_model_free_network(ctrl->net_interfaces, ctrl->net_sockets);
+    tasks_model_free_cgroups(ctrl->cgroups);
     tasks_model_free_services(ctrl->service_entries, ctrl->service_count);
+    tasks_model_free_services(ctrl->pending_services, ctrl->pending_service_count);
+    tasks_search_index_free(&ctrl->process_search);
+    tasks_search_matches_free(&ctrl->process_matches);
+    tasks_search_index_free(&ctrl->apps_search);
+    tasks_search_matches_free(&ctrl->apps_matches);
+    tasks_pid_index_free(&ctrl->pid_by_comm);
+    tasks_pid_index_free(&ctrl->pid_by_argv0);
+    tasks_pid_index_free(&ctrl->pid_by_exe);
+    free(ctrl->all_applications);
     free(ctrl->applications);
     if (ctrl->ui) {
         ctrl->ui->controller = NULL;
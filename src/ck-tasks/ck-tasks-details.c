@@ -0,0 +1,295 @@
+#include "ck-tasks-details.h"
+#include "../shared/tool_utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TASKS_DETAILS_INITIAL_SLOTS 256
+
+typedef struct {
+    TasksProcessDetails details; /* details.pid == 0 marks an empty slot */
+    long long fetched_ms;
+} TasksDetailsEntry;
+
+struct TasksDetails {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int wake_read_fd;
+    int wake_write_fd;
+    int ttl_ms;
+    int budget_ms;
+    int stopping;
+
+    /* Request from the UI; guarded by lock. */
+    pid_t *request_pids;
+    int request_count;
+    int request_capacity;
+    unsigned long request_generation;
+    char request_root[PATH_MAX];
+
+    /* Results from the worker; guarded by lock. */
+    TasksProcessDetails *results;
+    int result_count;
+    int result_capacity;
+
+    /* Cache: pid-keyed open addressing, UI thread only. */
+    TasksDetailsEntry *slots;
+    int slot_count;
+    int used_count;
+    TasksProcessDetails *collected;
+    int collected_capacity;
+};
+
+static int tasks_details_reserve(void **array, size_t element_size, int *capacity, int needed)
+{
+    if (needed <= *capacity) return 0;
+    int new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < needed) new_capacity *= 2;
+    void *resized = realloc(*array, element_size * (size_t)new_capacity);
+    if (!resized) return -1;
+    *array = resized;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static unsigned int tasks_details_hash(pid_t pid, int slot_count)
+{
+    return ((unsigned int)pid * 2654435769u) & (unsigned int)(slot_count - 1);
+}
+
+static TasksDetailsEntry *tasks_details_find(const TasksDetails *details, pid_t pid)
+{
+    if (!details->slots || pid <= 0) return NULL;
+    unsigned int mask = (unsigned int)(details->slot_count - 1);
+    for (unsigned int slot = tasks_details_hash(pid, details->slot_count);; slot = (slot + 1) & mask) {
+        TasksDetailsEntry *entry = &details->slots[slot];
+        if (entry->details.pid == 0) return NULL;
+        if (entry->details.pid == pid) return entry;
+    }
+}
+
+/* Rebuilds the table without entries older than the TTL, growing it if it
+ * would still be more than a quarter full. */
+static int tasks_details_rehash(TasksDetails *details, long long now)
+{
+    TasksDetailsEntry *old_slots = details->slots;
+    int old_count = details->slot_count;
+    int live = 0;
+    for (int i = 0; i < old_count; ++i) {
+        const TasksDetailsEntry *entry = &old_slots[i];
+        if (entry->details.pid != 0 && now - entry->fetched_ms < details->ttl_ms) live++;
+    }
+    int slot_count = old_count ? old_count : TASKS_DETAILS_INITIAL_SLOTS;
+    while (live * 4 > slot_count) slot_count *= 2;
+    TasksDetailsEntry *slots = (TasksDetailsEntry *)calloc((size_t)slot_count, sizeof(TasksDetailsEntry));
+    if (!slots) return -1;
+    details->slots = slots;
+    details->slot_count = slot_count;
+    details->used_count = 0;
+    unsigned int mask = (unsigned int)(slot_count - 1);
+    for (int i = 0; i < old_count; ++i) {
+        const TasksDetailsEntry *entry = &old_slots[i];
+        if (entry->details.pid == 0 || now - entry->fetched_ms >= details->ttl_ms) continue;
+        unsigned int slot = tasks_details_hash(entry->details.pid, slot_count);
+        while (slots[slot].details.pid != 0) slot = (slot + 1) & mask;
+        slots[slot] = *entry;
+        details->used_count++;
+    }
+    free(old_slots);
+    return 0;
+}
+
+static void tasks_details_store(TasksDetails *details, const TasksProcessDetails *result, long long now)
+{
+    TasksDetailsEntry *entry = tasks_details_find(details, result->pid);
+    if (!entry) {
+        if ((details->used_count + 1) * 2 > details->slot_count && tasks_details_rehash(details, now) != 0) return;
+        unsigned int mask = (unsigned int)(details->slot_count - 1);
+        unsigned int slot = tasks_details_hash(result->pid, details->slot_count);
+        while (details->slots[slot].details.pid != 0) slot = (slot + 1) & mask;
+        entry = &details->slots[slot];
+        details->used_count++;
+    }
+    entry->details = *result;
+    entry->fetched_ms = now;
+}
+
+static void tasks_details_notify(TasksDetails *details)
+{
+    char byte = 1;
+    ssize_t rc;
+    do {
+        rc = write(details->wake_write_fd, &byte, 1);
+    } while (rc < 0 && errno == EINTR);
+    /* EAGAIN means a wakeup is already pending. */
+}
+
+static void *tasks_details_main(void *arg)
+{
+    TasksDetails *details = arg;
+    pid_t *pids = NULL;
+    int pid_capacity = 0;
+    char root[PATH_MAX];
+    unsigned long handled_generation = 0;
+
+    pthread_mutex_lock(&details->lock);
+    while (!details->stopping) {
+        if (details->request_generation == handled_generation) {
+            pthread_cond_wait(&details->cond, &details->lock);
+            continue;
+        }
+        handled_generation = details->request_generation;
+        int count = details->request_count;
+        if (tasks_details_reserve((void **)&pids, sizeof(pid_t), &pid_capacity, count) != 0) count = 0;
+        if (count > 0) memcpy(pids, details->request_pids, sizeof(pid_t) * (size_t)count);
+        memcpy(root, details->request_root, sizeof(root));
+        pthread_mutex_unlock(&details->lock);
+
+        /* Rows still missing when the budget runs out are asked for again
+         * with the next refresh or scroll. */
+        long long deadline = tool_now_ms() + details->budget_ms;
+        int produced = 0;
+        for (int i = 0; i < count; ++i) {
+            TasksProcessDetails result;
+            tasks_model_read_process_details(root, pids[i], &result);
+            pthread_mutex_lock(&details->lock);
+            int superseded = details->stopping || details->request_generation != handled_generation;
+            if (tasks_details_reserve((void **)&details->results, sizeof(TasksProcessDetails),
+                                      &details->result_capacity, details->result_count + 1) == 0) {
+                details->results[details->result_count++] = result;
+                produced++;
+            }
+            pthread_mutex_unlock(&details->lock);
+            if (superseded || tool_now_ms() >= deadline) break;
+        }
+        if (produced > 0) tasks_details_notify(details);
+        pthread_mutex_lock(&details->lock);
+    }
+    pthread_mutex_unlock(&details->lock);
+    free(pids);
+    return NULL;
+}
+
+TasksDetails *tasks_details_create(int ttl_ms, int budget_ms)
+{
+    TasksDetails *details = (TasksDetails *)calloc(1, sizeof(TasksDetails));
+    if (!details) return NULL;
+    details->ttl_ms = ttl_ms > 0 ? ttl_ms : 1;
+    details->budget_ms = budget_ms > 0 ? budget_ms : 1;
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        free(details);
+        return NULL;
+    }
+    for (int i = 0; i < 2; ++i) {
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+    }
+    details->wake_read_fd = fds[0];
+    details->wake_write_fd = fds[1];
+    pthread_mutex_init(&details->lock, NULL);
+    pthread_cond_init(&details->cond, NULL);
+
+    if (pthread_create(&details->thread, NULL, tasks_details_main, details) != 0) {
+        pthread_cond_destroy(&details->cond);
+        pthread_mutex_destroy(&details->lock);
+        close(fds[0]);
+        close(fds[1]);
+        free(details);
+        return NULL;
+    }
+    return details;
+}
+
+void tasks_details_destroy(TasksDetails *details)
+{
+    if (!details) return;
+    pthread_mutex_lock(&details->lock);
+    details->stopping = 1;
+    pthread_cond_signal(&details->cond);
+    pthread_mutex_unlock(&details->lock);
+    pthread_join(details->thread, NULL);
+
+    close(details->wake_read_fd);
+    close(details->wake_write_fd);
+    pthread_cond_destroy(&details->cond);
+    pthread_mutex_destroy(&details->lock);
+    free(details->request_pids);
+    free(details->results);
+    free(details->slots);
+    free(details->collected);
+    free(details);
+}
+
+int tasks_details_get_fd(TasksDetails *details)
+{
+    return details ? details->wake_read_fd : -1;
+}
+
+void tasks_details_request(TasksDetails *details, const char *proc_root, const pid_t *pids, int count)
+{
+    if (!details || !pids || count <= 0) return;
+    long long now = tool_now_ms();
+    pthread_mutex_lock(&details->lock);
+    if (tasks_details_reserve((void **)&details->request_pids, sizeof(pid_t), &details->request_capacity,
+                              count) != 0) {
+        pthread_mutex_unlock(&details->lock);
+        return;
+    }
+    int wanted = 0;
+    for (int i = 0; i < count; ++i) {
+        const TasksDetailsEntry *entry = tasks_details_find(details, pids[i]);
+        if (entry && now - entry->fetched_ms < details->ttl_ms) continue;
+        details->request_pids[wanted++] = pids[i];
+    }
+    /* Nothing stale: leave a pass for an earlier window running. */
+    if (wanted > 0) {
+        details->request_count = wanted;
+        snprintf(details->request_root, sizeof(details->request_root), "%s", proc_root ? proc_root : "");
+        details->request_generation++;
+        pthread_cond_signal(&details->cond);
+    }
+    pthread_mutex_unlock(&details->lock);
+}
+
+int tasks_details_collect(TasksDetails *details)
+{
+    if (!details) return 0;
+    char drain[64];
+    while (read(details->wake_read_fd, drain, sizeof(drain)) > 0) {
+    }
+
+    /* Swap the results out so the worker is not held up while caching. */
+    pthread_mutex_lock(&details->lock);
+    TasksProcessDetails *results = details->results;
+    int count = details->result_count;
+    int capacity = details->result_capacity;
+    details->results = details->collected;
+    details->result_capacity = details->collected_capacity;
+    details->result_count = 0;
+    pthread_mutex_unlock(&details->lock);
+    details->collected = results;
+    details->collected_capacity = capacity;
+
+    long long now = tool_now_ms();
+    for (int i = 0; i < count; ++i) {
+        tasks_details_store(details, &results[i], now);
+    }
+    return count;
+}
+
+const TasksProcessDetails *tasks_details_lookup(const TasksDetails *details, pid_t pid)
+{
+    if (!details) return NULL;
+    const TasksDetailsEntry *entry = tasks_details_find(details, pid);
+    return entry ? &entry->details : NULL;
+}
@@ -0,0 +1,36 @@
+#ifndef CK_TASKS_DETAILS_H
+#define CK_TASKS_DETAILS_H
+
+#include "ck-tasks-model.h"
+
+/*
+ * On-demand process details (PSS, I/O bytes, open fds) for the rows the
+ * process table shows.
+ *
+ * Reading smaps_rollup, io and the fd directory costs far more than a stat
+ * line, so it is only done for the visible rows, off the UI thread and at
+ * most once per TTL. The UI hands over the visible pids with
+ * tasks_details_request(); a worker thread reads the ones without a fresh
+ * cache entry, giving up on a pass once its time budget is spent or a newer
+ * request arrives, and wakes the UI through a self-pipe (XtAppAddInput).
+ * tasks_details_collect() then moves the results into the cache, which only
+ * the UI thread reads.
+ */
+
+typedef struct TasksDetails TasksDetails;
+
+/* Returns NULL if the worker thread cannot be started. */
+TasksDetails *tasks_details_create(int ttl_ms, int budget_ms);
+/* Waits for the worker to finish the process it is reading. */
+void tasks_details_destroy(TasksDetails *details);
+/* Read end of the wakeup pipe (non-blocking), for XtAppAddInput. */
+int tasks_details_get_fd(TasksDetails *details);
+
+/* Replaces any unfinished request; pids cached within the TTL are skipped. */
+void tasks_details_request(TasksDetails *details, const char *proc_root, const pid_t *pids, int count);
+/* Drains the wakeup pipe and caches finished results; returns how many arrived. */
+int tasks_details_collect(TasksDetails *details);
+/* Cached details for pid (valid may be 0 if nothing was readable), or NULL. */
+const TasksProcessDetails *tasks_details_lookup(const TasksDetails *details, pid_t pid);
+
+#endif /* CK_TASKS_DETAILS_H */
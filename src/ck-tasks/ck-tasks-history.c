@@ -0,0 +1,78 @@
+#include "ck-tasks-history.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct TasksCpuHistory {
+    int core_count;
+    int columns;            /* core_count + 1 */
+    unsigned long capacity; /* power of two */
+    unsigned char *values;  /* capacity * columns, slot = sample & (capacity - 1) */
+    atomic_ulong head;
+};
+
+TasksCpuHistory *tasks_cpu_history_create(int core_count, int capacity)
+{
+    if (core_count < 0 || capacity <= 0) return NULL;
+    unsigned long slots = 1;
+    while (slots < (unsigned long)capacity) slots <<= 1;
+    TasksCpuHistory *history = (TasksCpuHistory *)calloc(1, sizeof(TasksCpuHistory));
+    if (!history) return NULL;
+    history->core_count = core_count;
+    history->columns = core_count + 1;
+    history->capacity = slots;
+    history->values = (unsigned char *)calloc(slots, (size_t)history->columns);
+    if (!history->values) {
+        free(history);
+        return NULL;
+    }
+    atomic_init(&history->head, 0);
+    return history;
+}
+
+void tasks_cpu_history_destroy(TasksCpuHistory *history)
+{
+    if (!history) return;
+    free(history->values);
+    free(history);
+}
+
+int tasks_cpu_history_core_count(const TasksCpuHistory *history)
+{
+    return history ? history->core_count : 0;
+}
+
+int tasks_cpu_history_capacity(const TasksCpuHistory *history)
+{
+    return history ? (int)history->capacity : 0;
+}
+
+void tasks_cpu_history_push(TasksCpuHistory *history, const unsigned char *column)
+{
+    if (!history || !column) return;
+    unsigned long head = atomic_load_explicit(&history->head, memory_order_relaxed);
+    unsigned char *slot = history->values + (head & (history->capacity - 1)) * (size_t)history->columns;
+    memcpy(slot, column, (size_t)history->columns);
+    atomic_store_explicit(&history->head, head + 1, memory_order_release);
+}
+
+unsigned long tasks_cpu_history_head(const TasksCpuHistory *history)
+{
+    if (!history) return 0;
+    return atomic_load_explicit(&((TasksCpuHistory *)history)->head, memory_order_acquire);
+}
+
+int tasks_cpu_history_read(const TasksCpuHistory *history, unsigned long sample, unsigned char *out_column)
+{
+    if (!history || !out_column) return -1;
+    TasksCpuHistory *shared = (TasksCpuHistory *)history;
+    unsigned long head = atomic_load_explicit(&shared->head, memory_order_acquire);
+    if (sample >= head || head - sample >= history->capacity) return -1;
+    const unsigned char *slot = history->values + (sample & (history->capacity - 1)) * (size_t)history->columns;
+    memcpy(out_column, slot, (size_t)history->columns);
+    /* Once head reaches sample + capacity the writer may be refilling this slot. */
+    atomic_thread_fence(memory_order_acquire);
+    head = atomic_load_explicit(&shared->head, memory_order_relaxed);
+    return head - sample < history->capacity ? 0 : -1;
+}
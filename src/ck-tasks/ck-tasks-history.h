@@ -0,0 +1,34 @@
+#ifndef CK_TASKS_HISTORY_H
+#define CK_TASKS_HISTORY_H
+
+/*
+ * Fixed-size CPU usage history shared between the collecting thread and the
+ * UI without a lock. Each sample is one column of percentages (0-100):
+ * column[0] is the whole machine and column[1 + N] is core N.
+ *
+ * There is a single writer. It fills the slot after the newest sample and
+ * then publishes it by advancing the head counter with a release store, so
+ * it never waits for the reader. The reader copies a sample out and checks
+ * the head again afterwards; a sample the writer may have started to reuse
+ * in the meantime is reported as gone.
+ */
+
+typedef struct TasksCpuHistory TasksCpuHistory;
+
+/* capacity is rounded up to a power of two. Returns NULL on allocation failure. */
+TasksCpuHistory *tasks_cpu_history_create(int core_count, int capacity);
+void tasks_cpu_history_destroy(TasksCpuHistory *history);
+
+int tasks_cpu_history_core_count(const TasksCpuHistory *history);
+int tasks_cpu_history_capacity(const TasksCpuHistory *history);
+
+/* Writer side: column holds core_count + 1 values. */
+void tasks_cpu_history_push(TasksCpuHistory *history, const unsigned char *column);
+
+/* Number of samples pushed so far; sample numbers run from 0 to head - 1. */
+unsigned long tasks_cpu_history_head(const TasksCpuHistory *history);
+/* Copies sample into out_column (core_count + 1 values). Returns 0, or -1 if
+ * the sample was not pushed yet or has already been overwritten. */
+int tasks_cpu_history_read(const TasksCpuHistory *history, unsigned long sample, unsigned char *out_column);
+
+#endif /* CK_TASKS_HISTORY_H */
@@ -1,10 +1,20 @@
 #include "ck-tasks-model.h"
 
+#include "ck-tasks-history.h"
+#include "../shared/procfs/proc_events.h"
+#include "../shared/procfs/procfs.h"
+#include "../shared/procfs/stat_shm.h"
+#include "../shared/file_watch.h"
+#include "../shared/user_cache.h"
+
+#include <arpa/inet.h>
 #include <ctype.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
-#include <pwd.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -17,487 +27,2283 @@ static long g_clock_ticks = 0;
 static int g_cpu_count = 1;
 static unsigned long long g_prev_cpu_total = 0;
 static unsigned long long g_prev_cpu_idle = 0;
-
+static int g_last_cpu_percent = 0;
+
+/*
+ * Per-core usage: the previous cpuN ticks, indexed by core number, and the
+ * history the Performance tab draws from. Sized once from the configured
+ * core count; cores that are offline simply read as idle.
+ */
+#define TASKS_CPU_HISTORY_MAX_CORES 1024
+#define TASKS_CPU_HISTORY_SAMPLES 512
+
+static int g_core_count = 0;
+static ProcfsCpuTimes *g_core_times = NULL;
+static ProcfsCpuTimes *g_core_prev = NULL;
+static unsigned char *g_history_column = NULL;
+static TasksCpuHistory *g_cpu_history = NULL;
+
+/*
+ * Per-pid CPU samples live in an open-addressing hash table (linear probing,
+ * pid 0 marks an empty slot). Each refresh bumps g_proc_generation and stamps
+ * every pid it sees; entries left with an older generation are dropped by
+ * rebuilding the table once per refresh, so a refresh stays O(n).
+ */
 typedef struct {
     pid_t pid;
+    unsigned int generation;
     unsigned long long total_ticks;
     double last_uptime;
-    int seen;
+    int exited;          /* exit event seen; dropped at the end of the refresh */
 } ProcSample;
 
+#define PROC_SAMPLES_INITIAL_CAPACITY 1024
+
 static ProcSample *g_proc_samples = NULL;
 static int g_proc_samples_count = 0;
 static int g_proc_samples_capacity = 0;
+static unsigned int g_proc_generation = 0;
+
+/*
+ * With the kernel proc connector, the sample table doubles as the live pid
+ * set: fork/exec events add pids, exit events mark them, and a refresh
+ * re-reads only those pids instead of walking /proc. A full walk still runs
+ * first, after lost events, and always when the connector cannot be opened
+ * (usually for lack of CAP_NET_ADMIN) or another proc root is in use.
+ */
+enum {
+    PROC_EVENTS_UNTRIED,
+    PROC_EVENTS_ACTIVE,
+    PROC_EVENTS_UNAVAILABLE,
+};
+
+static ProcEvents g_proc_events = {-1};
+static int g_proc_events_state = PROC_EVENTS_UNTRIED;
+static int g_proc_events_need_scan = 1;
+static pid_t *g_live_pids = NULL;
+static int g_live_pid_capacity = 0;
+
+static ProcfsReader g_procfs;
+static int g_procfs_ready = 0;
+/* System-wide figures come from ck-statd while it runs (default proc root only). */
+static StatShmReader g_stat_shm = {NULL, 0, 0, -1, 0};
+static char g_proc_root[PATH_MAX] = "";
+/* Prefix for the /etc, /run and /lib paths the services walk reads. */
+static char g_system_root[PATH_MAX] = "";
+static char g_utmp_path[PATH_MAX] = "";
+static char g_cgroup_root[PATH_MAX] = "";
+
+/* State of the inotify watches behind the services, users and cgroup caches. */
+enum {
+    WATCH_UNTRIED,
+    WATCH_ACTIVE,
+    WATCH_UNAVAILABLE,
+};
+
+/*
+ * Services listing cache. The directories a walk reads are watched; while
+ * none of them changes, the last listing is handed out again and a refresh
+ * costs one read() on the watch. After a change the walk runs again, but an
+ * init script's LSB header is only parsed again when the script's inode,
+ * size or mtime changed. Without a usable watch every refresh walks, still
+ * reusing the parsed headers.
+ */
+static FileWatch g_service_watch = {-1};
+static int g_service_watch_state = WATCH_UNTRIED;
+static int g_service_watch_complete = 0; /* every path the last walk read is watched */
+static TasksServiceEntry *g_services = NULL;
+static int g_service_count = 0;
+static TasksInitInfo g_services_info;
+static int g_services_valid = 0;
+static int g_services_include_disabled = 0;
+
+typedef struct {
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    long long mtime_ns;
+} ServiceFileStamp;
 
-static int is_pid_dir(const char *name)
+typedef struct {
+    unsigned int hash;
+    unsigned int path;  /* offset into g_init_info_paths */
+    unsigned int walk;  /* last walk that used the record */
+    ServiceFileStamp stamp;
+    int info_count;
+    TasksServiceInfoField info_fields[TASKS_SERVICE_INFO_MAX_FIELDS];
+} InitInfoRecord;
+
+static InitInfoRecord *g_init_info = NULL;
+static int g_init_info_count = 0;
+static int g_init_info_capacity = 0;
+static int *g_init_info_slots = NULL; /* record index + 1; 0 = empty */
+static int g_init_info_slot_capacity = 0;
+static char *g_init_info_paths = NULL;
+static size_t g_init_info_paths_used = 0;
+static size_t g_init_info_paths_capacity = 0;
+static unsigned int g_init_info_walk = 0;
+
+/*
+ * Users listing cache. Sessions are parsed from utmp only when a watch on
+ * the file reports a change; the idle times in between are advanced from
+ * the cached terminal access times, which are stat()ed again only every
+ * TASKS_USER_IDLE_CHECK_SECONDS.
+ */
+#define TASKS_USER_IDLE_CHECK_SECONDS 15
+
+typedef struct {
+    char path[48]; /* "" if the session has no terminal */
+    time_t atime;  /* -1 if the terminal could not be read */
+} UserTty;
+
+static FileWatch g_utmp_watch = {-1};
+static int g_utmp_watch_state = WATCH_UNTRIED;
+static TasksUserEntry *g_users = NULL; /* idle columns are filled in per listing */
+static UserTty *g_user_ttys = NULL;
+static int g_user_count = 0;
+static int g_user_capacity = 0;
+static int g_users_valid = 0;
+static time_t g_user_ttys_checked = 0;
+
+static void tasks_model_reset_services(void);
+static void init_info_clear(void);
+static void init_info_free(void);
+static void tasks_model_reset_users(void);
+
+/*
+ * Interning table for the list being built: open addressing over arena
+ * offsets (slots hold offset + 1, 0 marks empty). Reused across scans.
+ */
+static unsigned int *g_intern_slots = NULL;
+static int g_intern_slot_capacity = 0;
+static int g_intern_count = 0;
+
+static void net_reset(void);
+static void cgroup_reset(void);
+
+static int tasks_model_ensure_procfs(void)
 {
-    if (!name || !name[0]) return 0;
-    for (const char *p = name; *p; ++p) {
-        if (!isdigit((unsigned char)*p)) return 0;
+    if (g_procfs_ready) return 0;
+    if (procfs_reader_open(&g_procfs, g_proc_root[0] ? g_proc_root : NULL) != 0) return -1;
+    g_procfs_ready = 1;
+    return 0;
+}
+
+/* One system-wide sample, published by ck-statd or read from the proc root.
+ * Also refreshes g_core_times when per-core tracking is set up. */
+static int read_system_sample(StatShmSample *out_sample)
+{
+    if (!g_proc_root[0] && stat_shm_read(&g_stat_shm, out_sample, g_core_times, g_core_count) == 0) return 0;
+    if (tasks_model_ensure_procfs() != 0) return -1;
+    return stat_shm_sample_procfs(&g_procfs, out_sample, g_core_times, g_core_count);
+}
+
+static int read_cpu_totals(unsigned long long *out_total, unsigned long long *out_idle)
+{
+    StatShmSample sample;
+    if (read_system_sample(&sample) != 0) return -1;
+    if (out_total) *out_total = procfs_cpu_total_ticks(&sample.cpu);
+    if (out_idle) *out_idle = procfs_cpu_idle_ticks(&sample.cpu);
+    return 0;
+}
+
+static int busy_percent(unsigned long long total_diff, unsigned long long idle_diff)
+{
+    if (total_diff == 0 || idle_diff > total_diff) return 0;
+    return (int)((double)(total_diff - idle_diff) / (double)total_diff * 100.0);
+}
+
+static void init_cpu_history(void)
+{
+    long configured = sysconf(_SC_NPROCESSORS_CONF);
+    if (configured < g_cpu_count) configured = g_cpu_count;
+    if (configured > TASKS_CPU_HISTORY_MAX_CORES) configured = TASKS_CPU_HISTORY_MAX_CORES;
+    g_core_count = (int)configured;
+    g_core_times = (ProcfsCpuTimes *)calloc((size_t)g_core_count, sizeof(ProcfsCpuTimes));
+    g_core_prev = (ProcfsCpuTimes *)calloc((size_t)g_core_count, sizeof(ProcfsCpuTimes));
+    g_history_column = (unsigned char *)calloc((size_t)g_core_count + 1, 1);
+    g_cpu_history = tasks_cpu_history_create(g_core_count, TASKS_CPU_HISTORY_SAMPLES);
+    if (!g_core_times || !g_core_prev || !g_history_column || !g_cpu_history) {
+        free(g_core_times);
+        free(g_core_prev);
+        free(g_history_column);
+        tasks_cpu_history_destroy(g_cpu_history);
+        g_core_times = NULL;
+        g_core_prev = NULL;
+        g_history_column = NULL;
+        g_cpu_history = NULL;
+        g_core_count = 0;
     }
-    return 1;
 }
 
-static int read_proc_stat(pid_t pid, char *name, size_t name_len,
-                          unsigned long long *utime, unsigned long long *stime,
-                          int *threads)
+/* Pushes one history sample from g_core_times against the previous read;
+ * repeats the last one when no ticks passed (ck-statd has not published yet). */
+static void record_cpu_history(int cpu_percent, int fresh)
 {
-    char path[64];
-    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
-    FILE *fp = fopen(path, "r");
-    if (!fp) return -1;
+    if (!g_cpu_history) return;
+    if (!fresh) {
+        tasks_cpu_history_push(g_cpu_history, g_history_column);
+        return;
+    }
+    g_history_column[0] = (unsigned char)cpu_percent;
+    for (int i = 0; i < g_core_count; ++i) {
+        unsigned long long total = procfs_cpu_total_ticks(&g_core_times[i]);
+        unsigned long long idle = procfs_cpu_idle_ticks(&g_core_times[i]);
+        unsigned long long prev_total = procfs_cpu_total_ticks(&g_core_prev[i]);
+        unsigned long long prev_idle = procfs_cpu_idle_ticks(&g_core_prev[i]);
+        /* A core that went offline and came back restarts from zero. */
+        unsigned long long idle_diff = idle >= prev_idle ? idle - prev_idle : 0;
+        int percent = total >= prev_total ? busy_percent(total - prev_total, idle_diff) : 0;
+        g_history_column[1 + i] = (unsigned char)percent;
+    }
+    memcpy(g_core_prev, g_core_times, sizeof(ProcfsCpuTimes) * (size_t)g_core_count);
+    tasks_cpu_history_push(g_cpu_history, g_history_column);
+}
 
-    char comm[64] = {0};
-    char state = 0;
-    unsigned long long ut = 0, st = 0;
-    long num_threads = 0;
-
-    int scanned = fscanf(fp,
-                         "%*d (%63[^)]) %c "
-                         "%*d %*d %*d %*d %*d "
-                         "%*u %*u %*u %*u %*u "
-                         "%llu %llu "
-                         "%*d %*d %*d %*d %ld",
-                         comm, &state, &ut, &st, &num_threads);
-    fclose(fp);
-    if (scanned < 5) return -1;
+static unsigned int proc_sample_slot(pid_t pid, int capacity)
+{
+    /* Fibonacci hashing; capacity is always a power of two. */
+    return ((unsigned int)pid * 2654435769u) & (unsigned int)(capacity - 1);
+}
 
-    if (name && name_len > 0) {
-        (void)snprintf(name, name_len, "%s", comm);
+static ProcSample *proc_sample_insert_slot(ProcSample *table, int capacity, pid_t pid)
+{
+    unsigned int mask = (unsigned int)(capacity - 1);
+    unsigned int slot = proc_sample_slot(pid, capacity);
+    while (table[slot].pid != 0 && table[slot].pid != pid) {
+        slot = (slot + 1) & mask;
+    }
+    return &table[slot];
+}
+
+/* Rehash the samples stamped with the current generation into a table of new_capacity slots. */
+static int rebuild_proc_samples(int new_capacity)
+{
+    ProcSample *table = (ProcSample *)calloc((size_t)new_capacity, sizeof(ProcSample));
+    if (!table) return -1;
+    int count = 0;
+    for (int i = 0; i < g_proc_samples_capacity; ++i) {
+        ProcSample *sample = &g_proc_samples[i];
+        if (sample->pid == 0 || sample->generation != g_proc_generation) continue;
+        *proc_sample_insert_slot(table, new_capacity, sample->pid) = *sample;
+        count++;
     }
-    if (utime) *utime = ut;
-    if (stime) *stime = st;
-    if (threads) *threads = (int)num_threads;
+    free(g_proc_samples);
+    g_proc_samples = table;
+    g_proc_samples_capacity = new_capacity;
+    g_proc_samples_count = count;
     return 0;
 }
 
-static int read_proc_status_uid(pid_t pid, uid_t *out_uid)
+static ProcSample *get_proc_sample(pid_t pid, int create)
 {
-    char path[64];
-    snprintf(path, sizeof(path), "/proc/%d/status", pid);
-    FILE *fp = fopen(path, "r");
-    if (!fp) return -1;
-    char line[256];
-    uid_t uid = 0;
-    int found = 0;
-    while (fgets(line, sizeof(line), fp)) {
-        if (strncmp(line, "Uid:", 4) == 0) {
-            unsigned int real_uid = 0;
-            if (sscanf(line, "Uid:\t%u", &real_uid) == 1) {
-                uid = (uid_t)real_uid;
-                found = 1;
-                break;
-            }
+    if (pid <= 0) return NULL;
+    if (g_proc_samples_capacity > 0) {
+        ProcSample *sample = proc_sample_insert_slot(g_proc_samples, g_proc_samples_capacity, pid);
+        if (sample->pid == pid) return sample;
+    }
+    if (!create) return NULL;
+    /* Keep the load factor at or below 1/2 so probe runs stay short. */
+    if ((g_proc_samples_count + 1) * 2 > g_proc_samples_capacity) {
+        if (g_proc_samples_capacity < 0 || g_proc_samples_capacity > INT_MAX / 2) return NULL;
+        int new_capacity = g_proc_samples_capacity ? g_proc_samples_capacity * 2 : PROC_SAMPLES_INITIAL_CAPACITY;
+        ProcSample *table = (ProcSample *)calloc((size_t)new_capacity, sizeof(ProcSample));
+        if (!table) return NULL;
+        for (int i = 0; i < g_proc_samples_capacity; ++i) {
+            if (g_proc_samples[i].pid == 0) continue;
+            *proc_sample_insert_slot(table, new_capacity, g_proc_samples[i].pid) = g_proc_samples[i];
         }
+        free(g_proc_samples);
+        g_proc_samples = table;
+        g_proc_samples_capacity = new_capacity;
     }
-    fclose(fp);
-    if (!found) return -1;
-    if (out_uid) *out_uid = uid;
-    return 0;
+    ProcSample *sample = proc_sample_insert_slot(g_proc_samples, g_proc_samples_capacity, pid);
+    sample->pid = pid;
+    sample->generation = 0;
+    sample->total_ticks = 0;
+    sample->last_uptime = 0.0;
+    sample->exited = 0;
+    g_proc_samples_count++;
+    return sample;
 }
 
-static void read_proc_cmdline(pid_t pid, char *buffer, size_t len)
+static void tasks_model_close_proc_events(void)
 {
-    if (!buffer || len == 0) return;
-    buffer[0] = '\0';
-    char path[64];
-    snprintf(path, sizeof(path), "/proc/%d/cmdline", pid);
-    FILE *fp = fopen(path, "r");
-    if (!fp) return;
-    size_t read = fread(buffer, 1, len - 1, fp);
-    fclose(fp);
-    if (read == 0) {
-        buffer[0] = '\0';
+    proc_events_close(&g_proc_events);
+    g_proc_events_state = PROC_EVENTS_UNTRIED;
+    g_proc_events_need_scan = 1;
+}
+
+/*
+ * The exit event of a thread-group leader also fires when only the leader's
+ * thread ended (pthread_exit in main) and the others still run, so it only
+ * counts once /proc/PID is gone or a zombie with no threads left. A process
+ * wrongly kept is dropped by the next refresh, which cannot read it.
+ */
+static int proc_event_process_gone(pid_t pid)
+{
+    ProcfsPidStat stat;
+    if (procfs_read_pid_stat(&g_procfs, pid, &stat) != 0) return 1;
+    return stat.state == 'Z' && stat.threads <= 1;
+}
+
+static void on_proc_event(void *context, ProcEventsType type, pid_t pid)
+{
+    (void)context;
+    ProcSample *sample = get_proc_sample(pid, 0);
+    if (type == PROC_EVENTS_EXIT) {
+        if (sample && proc_event_process_gone(pid)) sample->exited = 1;
         return;
     }
-    for (size_t i = 0; i < read; ++i) {
-        if (buffer[i] == '\0') {
-            buffer[i] = ' ';
+    if (sample && !sample->exited) return; /* exec of a process we already track */
+    if (!sample) {
+        sample = get_proc_sample(pid, 1);
+        if (!sample) {
+            g_proc_events_need_scan = 1;
+            return;
         }
     }
-    buffer[read] = '\0';
+    /* A new process, possibly reusing the pid of one that exited. */
+    sample->total_ticks = 0;
+    sample->last_uptime = 0.0;
+    sample->exited = 0;
 }
 
-static int read_proc_rss_mb(pid_t pid, double *out_mb)
+/* Applies pending proc events; returns 1 if the live pid set is complete, so
+ * the refresh can skip the /proc walk. */
+static int tasks_model_sync_proc_events(void)
 {
-    char path[64];
-    snprintf(path, sizeof(path), "/proc/%d/statm", pid);
-    FILE *fp = fopen(path, "r");
-    if (!fp) return -1;
-    unsigned long size = 0;
-    unsigned long rss = 0;
-    int scanned = fscanf(fp, "%lu %lu", &size, &rss);
-    fclose(fp);
-    if (scanned < 2) return -1;
-    long page_size = sysconf(_SC_PAGESIZE);
-    if (page_size <= 0) page_size = 4096;
-    if (out_mb) {
-        *out_mb = (double)rss * (double)page_size / (1024.0 * 1024.0);
+    if (g_proc_root[0]) return 0;
+    if (g_proc_events_state == PROC_EVENTS_UNTRIED) {
+        g_proc_events_state = (proc_events_open(&g_proc_events) == 0) ? PROC_EVENTS_ACTIVE
+                                                                       : PROC_EVENTS_UNAVAILABLE;
+        g_proc_events_need_scan = 1;
+    }
+    if (g_proc_events_state != PROC_EVENTS_ACTIVE) return 0;
+    if (proc_events_drain(&g_proc_events, on_proc_event, NULL) != 0) {
+        g_proc_events_need_scan = 1;
+    }
+    return !g_proc_events_need_scan;
+}
+
+static int compare_pids(const void *a, const void *b)
+{
+    pid_t left = *(const pid_t *)a;
+    pid_t right = *(const pid_t *)b;
+    return (left > right) - (left < right);
+}
+
+/* Live pids from the sample table in ascending order, like a /proc walk; returns the count or -1. */
+static int collect_live_pids(void)
+{
+    if (g_proc_samples_count > g_live_pid_capacity) {
+        pid_t *pids = (pid_t *)realloc(g_live_pids, sizeof(pid_t) * (size_t)g_proc_samples_count);
+        if (!pids) return -1;
+        g_live_pids = pids;
+        g_live_pid_capacity = g_proc_samples_count;
+    }
+    int count = 0;
+    for (int i = 0; i < g_proc_samples_capacity; ++i) {
+        const ProcSample *sample = &g_proc_samples[i];
+        if (sample->pid == 0 || sample->exited) continue;
+        g_live_pids[count++] = sample->pid;
+    }
+    qsort(g_live_pids, (size_t)count, sizeof(pid_t), compare_pids);
+    return count;
+}
+
+void tasks_model_initialize(void)
+{
+    g_clock_ticks = sysconf(_SC_CLK_TCK);
+    if (g_clock_ticks <= 0) g_clock_ticks = 100;
+    g_cpu_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (g_cpu_count <= 0) g_cpu_count = 1;
+    tasks_model_ensure_procfs();
+    if (!g_cpu_history) init_cpu_history();
+    read_cpu_totals(&g_prev_cpu_total, &g_prev_cpu_idle);
+    if (g_core_prev) memcpy(g_core_prev, g_core_times, sizeof(ProcfsCpuTimes) * (size_t)g_core_count);
+}
+
+int tasks_model_set_system_root(const char *root)
+{
+    if (root && strlen(root) >= sizeof(g_system_root)) return -1;
+    snprintf(g_system_root, sizeof(g_system_root), "%s", root ? root : "");
+    /* Paths are joined as root + "/etc/...", so drop trailing slashes. */
+    size_t len = strlen(g_system_root);
+    while (len > 0 && g_system_root[len - 1] == '/') g_system_root[--len] = '\0';
+    tasks_model_reset_services();
+    init_info_clear();
+    return 0;
+}
+
+int tasks_model_set_utmp_path(const char *path)
+{
+    if (path && strlen(path) >= sizeof(g_utmp_path)) return -1;
+    snprintf(g_utmp_path, sizeof(g_utmp_path), "%s", path ? path : "");
+    g_services_valid = 0; /* the sysv run level is read from it */
+    tasks_model_reset_users();
+    return utmpname(g_utmp_path[0] ? g_utmp_path : _PATH_UTMP) == 0 ? 0 : -1;
+}
+
+const TasksCpuHistory *tasks_model_get_cpu_history(void)
+{
+    return g_cpu_history;
+}
+
+int tasks_model_set_proc_root(const char *root)
+{
+    if (root && strlen(root) >= sizeof(g_proc_root)) return -1;
+    snprintf(g_proc_root, sizeof(g_proc_root), "%s", root ? root : "");
+    if (g_procfs_ready) {
+        procfs_reader_close(&g_procfs);
+        g_procfs_ready = 0;
+    }
+    tasks_model_close_proc_events();
+    free(g_proc_samples);
+    g_proc_samples = NULL;
+    g_proc_samples_count = 0;
+    g_proc_samples_capacity = 0;
+    net_reset();
+    return tasks_model_ensure_procfs();
+}
+
+void tasks_model_shutdown(void)
+{
+    free(g_proc_samples);
+    g_proc_samples = NULL;
+    g_proc_samples_count = 0;
+    g_proc_samples_capacity = 0;
+    g_proc_generation = 0;
+    free(g_intern_slots);
+    g_intern_slots = NULL;
+    g_intern_slot_capacity = 0;
+    g_intern_count = 0;
+    tasks_model_close_proc_events();
+    free(g_live_pids);
+    g_live_pids = NULL;
+    g_live_pid_capacity = 0;
+    user_cache_clear();
+    net_reset();
+    cgroup_reset();
+    tasks_model_reset_services();
+    init_info_free();
+    tasks_model_reset_users();
+    free(g_core_times);
+    free(g_core_prev);
+    free(g_history_column);
+    tasks_cpu_history_destroy(g_cpu_history);
+    g_core_times = NULL;
+    g_core_prev = NULL;
+    g_history_column = NULL;
+    g_cpu_history = NULL;
+    g_core_count = 0;
+    stat_shm_reader_close(&g_stat_shm);
+    if (g_procfs_ready) {
+        procfs_reader_close(&g_procfs);
+        g_procfs_ready = 0;
+    }
+}
+
+#define PROCESS_LIST_INITIAL_CAPACITY 256
+#define PROCESS_STRINGS_INITIAL_CAPACITY 16384
+#define PROCESS_INTERN_INITIAL_SLOTS 1024
+
+static unsigned int intern_hash(const char *text, size_t len)
+{
+    /* FNV-1a */
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int intern_reset(int expected)
+{
+    int slots = g_intern_slot_capacity ? g_intern_slot_capacity : PROCESS_INTERN_INITIAL_SLOTS;
+    while (slots < expected * 2) {
+        if (slots > INT_MAX / 2) return -1;
+        slots *= 2;
+    }
+    if (slots != g_intern_slot_capacity) {
+        unsigned int *table = (unsigned int *)malloc(sizeof(unsigned int) * (size_t)slots);
+        if (!table) return -1;
+        free(g_intern_slots);
+        g_intern_slots = table;
+        g_intern_slot_capacity = slots;
+    }
+    memset(g_intern_slots, 0, sizeof(unsigned int) * (size_t)g_intern_slot_capacity);
+    g_intern_count = 0;
+    return 0;
+}
+
+/* Appends text (plus NUL) to an arena; returns its offset or TASKS_PROCESS_NO_STRING. */
+static unsigned int arena_append(char **arena, size_t *used, size_t *capacity, const char *text, size_t len)
+{
+    size_t needed = *used + len + 1;
+    if (needed >= TASKS_PROCESS_NO_STRING) return TASKS_PROCESS_NO_STRING;
+    if (needed > *capacity) {
+        size_t new_capacity = *capacity ? *capacity : PROCESS_STRINGS_INITIAL_CAPACITY;
+        while (new_capacity < needed) new_capacity *= 2;
+        char *resized = (char *)realloc(*arena, new_capacity);
+        if (!resized) return TASKS_PROCESS_NO_STRING;
+        *arena = resized;
+        *capacity = new_capacity;
+    }
+    unsigned int offset = (unsigned int)*used;
+    memcpy(*arena + offset, text, len);
+    (*arena)[offset + len] = '\0';
+    *used = needed;
+    return offset;
+}
+
+static int intern_grow(const TasksProcessList *list)
+{
+    int new_capacity = g_intern_slot_capacity * 2;
+    if (g_intern_slot_capacity > INT_MAX / 2) return -1;
+    unsigned int *table = (unsigned int *)calloc((size_t)new_capacity, sizeof(unsigned int));
+    if (!table) return -1;
+    unsigned int mask = (unsigned int)(new_capacity - 1);
+    for (int i = 0; i < g_intern_slot_capacity; ++i) {
+        unsigned int value = g_intern_slots[i];
+        if (value == 0) continue;
+        const char *text = list->strings + (value - 1);
+        unsigned int slot = intern_hash(text, strlen(text)) & mask;
+        while (table[slot] != 0) slot = (slot + 1) & mask;
+        table[slot] = value;
+    }
+    free(g_intern_slots);
+    g_intern_slots = table;
+    g_intern_slot_capacity = new_capacity;
+    return 0;
+}
+
+/* Returns the offset of text in the list arena, adding it on first sight. */
+static unsigned int process_list_intern(TasksProcessList *list, const char *text)
+{
+    size_t len = strlen(text);
+    if ((g_intern_count + 1) * 2 > g_intern_slot_capacity && intern_grow(list) != 0) {
+        return arena_append(&list->strings, &list->strings_used, &list->strings_capacity, text, len);
+    }
+    unsigned int mask = (unsigned int)(g_intern_slot_capacity - 1);
+    unsigned int slot = intern_hash(text, len) & mask;
+    while (g_intern_slots[slot] != 0) {
+        unsigned int offset = g_intern_slots[slot] - 1;
+        if (strcmp(list->strings + offset, text) == 0) return offset;
+        slot = (slot + 1) & mask;
+    }
+    unsigned int offset = arena_append(&list->strings, &list->strings_used, &list->strings_capacity, text, len);
+    if (offset != TASKS_PROCESS_NO_STRING) {
+        g_intern_slots[slot] = offset + 1;
+        g_intern_count++;
+    }
+    return offset;
+}
+
+static int process_list_reserve(TasksProcessList *list, int needed)
+{
+    if (needed <= list->capacity) return 0;
+    int new_capacity = list->capacity ? list->capacity : PROCESS_LIST_INITIAL_CAPACITY;
+    while (new_capacity < needed) {
+        if (new_capacity > INT_MAX / 2) return -1;
+        new_capacity *= 2;
+    }
+    size_t n = (size_t)new_capacity;
+    pid_t *pids = (pid_t *)realloc(list->pids, sizeof(pid_t) * n);
+    if (pids) list->pids = pids;
+    double *cpu = (double *)realloc(list->cpu_percent, sizeof(double) * n);
+    if (cpu) list->cpu_percent = cpu;
+    double *memory = (double *)realloc(list->memory_mb, sizeof(double) * n);
+    if (memory) list->memory_mb = memory;
+    int *threads = (int *)realloc(list->threads, sizeof(int) * n);
+    if (threads) list->threads = threads;
+    unsigned int *names = (unsigned int *)realloc(list->name_offsets, sizeof(unsigned int) * n);
+    if (names) list->name_offsets = names;
+    unsigned int *users = (unsigned int *)realloc(list->user_offsets, sizeof(unsigned int) * n);
+    if (users) list->user_offsets = users;
+    unsigned int *commands = (unsigned int *)realloc(list->command_offsets, sizeof(unsigned int) * n);
+    if (commands) list->command_offsets = commands;
+    if (!pids || !cpu || !memory || !threads || !names || !users || !commands) return -1;
+    list->capacity = new_capacity;
+    return 0;
+}
+
+/* Reads one pid into the list; a pid that vanished is skipped. Returns -1 only on allocation failure. */
+static int process_list_add(TasksProcessList *list, pid_t pid, double uptime, double page_mb, int *live_samples)
+{
+    ProcfsPidStat pid_stat;
+    if (procfs_read_pid_stat(&g_procfs, pid, &pid_stat) != 0) {
+        return 0;
     }
+    char user[32];
+    uid_t uid = (uid_t)-1;
+    if (procfs_read_pid_uid(&g_procfs, pid, &uid) == 0) {
+        user_cache_format(uid, user, sizeof(user));
+    } else {
+        snprintf(user, sizeof(user), "unknown");
+    }
+    unsigned long long total_ticks = pid_stat.utime + pid_stat.stime;
+    double cpu_percent = 0.0;
+    if (uptime > 0.0 && g_clock_ticks > 0) {
+        ProcSample *sample = get_proc_sample(pid, 1);
+        if (sample && sample->last_uptime > 0.0 && uptime > sample->last_uptime &&
+            total_ticks >= sample->total_ticks) {
+            double delta_ticks = (double)(total_ticks - sample->total_ticks);
+            double delta_seconds = delta_ticks / (double)g_clock_ticks;
+            double interval = uptime - sample->last_uptime;
+            if (interval > 0.0) {
+                cpu_percent = (delta_seconds / interval) * 100.0;
+            }
+        } else {
+            double total_time = (double)total_ticks / (double)g_clock_ticks;
+            cpu_percent = (total_time / uptime) * 100.0;
+        }
+        if (sample) {
+            sample->total_ticks = total_ticks;
+            sample->last_uptime = uptime;
+            sample->exited = 0;
+            if (sample->generation != g_proc_generation) {
+                sample->generation = g_proc_generation;
+                (*live_samples)++;
+            }
+        }
+    }
+    int index = list->count;
+    unsigned int name_offset = process_list_intern(list, pid_stat.comm);
+    unsigned int user_offset = process_list_intern(list, user);
+    if (name_offset == TASKS_PROCESS_NO_STRING || user_offset == TASKS_PROCESS_NO_STRING ||
+        process_list_reserve(list, index + 1) != 0) {
+        return -1;
+    }
+    list->pids[index] = pid;
+    list->cpu_percent[index] = cpu_percent;
+    list->memory_mb[index] = (double)pid_stat.rss_pages * page_mb;
+    list->threads[index] = pid_stat.threads;
+    list->name_offsets[index] = name_offset;
+    list->user_offsets[index] = user_offset;
+    list->command_offsets[index] = TASKS_PROCESS_NO_STRING;
+    list->count++;
     return 0;
 }
 
-static double read_uptime_seconds(void)
+int tasks_model_list_processes(TasksProcessList **out_list)
 {
-    FILE *fp = fopen("/proc/uptime", "r");
-    if (!fp) return 0.0;
+    if (!out_list) return -1;
+    *out_list = NULL;
+    if (tasks_model_ensure_procfs() != 0) return -1;
+
     double uptime = 0.0;
-    if (fscanf(fp, "%lf", &uptime) != 1) uptime = 0.0;
-    fclose(fp);
-    return uptime;
+    if (procfs_read_uptime(&g_procfs, &uptime) != 0) uptime = 0.0;
+    /* Samples are only kept with a valid uptime, and in event mode they are the pid set. */
+    int use_events = tasks_model_sync_proc_events() && uptime > 0.0 && g_clock_ticks > 0;
+    int live_count = use_events ? collect_live_pids() : 0;
+    if (live_count < 0) use_events = 0;
+    if (!use_events && procfs_pid_iter_begin(&g_procfs) != 0) return -1;
+
+    TasksProcessList *list = (TasksProcessList *)calloc(1, sizeof(TasksProcessList));
+    if (!list) return -1;
+    /* Size everything from the previous scan so a steady state does not realloc. */
+    if (process_list_reserve(list, g_proc_samples_count) != 0 ||
+        intern_reset(g_proc_samples_count) != 0) {
+        tasks_model_free_processes(list);
+        return -1;
+    }
+    list->root_offset = arena_append(&list->strings, &list->strings_used, &list->strings_capacity,
+                                     g_proc_root, strlen(g_proc_root));
+    if (list->root_offset == TASKS_PROCESS_NO_STRING) {
+        tasks_model_free_processes(list);
+        return -1;
+    }
+
+    double page_mb = (double)g_procfs.page_size / (1024.0 * 1024.0);
+    if (++g_proc_generation == 0) g_proc_generation = 1;
+    int live_samples = 0;
+    int rc = 0;
+    if (use_events) {
+        for (int i = 0; rc == 0 && i < live_count; ++i) {
+            rc = process_list_add(list, g_live_pids[i], uptime, page_mb, &live_samples);
+        }
+    } else {
+        pid_t pid = 0;
+        while (rc == 0 && procfs_pid_iter_next(&g_procfs, &pid)) {
+            rc = process_list_add(list, pid, uptime, page_mb, &live_samples);
+        }
+        if (rc == 0 && uptime > 0.0) g_proc_events_need_scan = 0;
+    }
+    if (rc != 0) {
+        /* Samples of unread pids would be evicted wrongly; start over with a walk. */
+        g_proc_events_need_scan = 1;
+        tasks_model_free_processes(list);
+        return -1;
+    }
+    if (live_samples < g_proc_samples_count) {
+        int new_capacity = g_proc_samples_capacity;
+        while (new_capacity > PROC_SAMPLES_INITIAL_CAPACITY && live_samples * 8 < new_capacity) {
+            new_capacity /= 2;
+        }
+        rebuild_proc_samples(new_capacity);
+    }
+
+    *out_list = list;
+    return 0;
 }
 
-static int read_cpu_totals(unsigned long long *out_total, unsigned long long *out_idle)
+TasksProcessList *tasks_model_new_processes(int capacity)
 {
-    FILE *fp = fopen("/proc/stat", "r");
-    if (!fp) return -1;
-    char line[256];
-    unsigned long long user = 0, nice = 0, system = 0, idle = 0;
-    unsigned long long iowait = 0, irq = 0, softirq = 0, steal = 0;
-    if (!fgets(line, sizeof(line), fp)) {
-        fclose(fp);
+    TasksProcessList *list = (TasksProcessList *)calloc(1, sizeof(TasksProcessList));
+    if (!list) return NULL;
+    if (process_list_reserve(list, capacity > 0 ? capacity : 1) != 0) {
+        tasks_model_free_processes(list);
+        return NULL;
+    }
+    list->root_offset = arena_append(&list->strings, &list->strings_used, &list->strings_capacity, "", 0);
+    if (list->root_offset == TASKS_PROCESS_NO_STRING) {
+        tasks_model_free_processes(list);
+        return NULL;
+    }
+    return list;
+}
+
+int tasks_model_append_process(TasksProcessList *list, pid_t pid, const char *name, const char *user,
+                               const char *command, double cpu_percent, double memory_mb, int threads)
+{
+    if (!list) return -1;
+    int index = list->count;
+    if (process_list_reserve(list, index + 1) != 0) return -1;
+    const char *name_text = name ? name : "";
+    const char *user_text = user ? user : "";
+    unsigned int name_offset = arena_append(&list->strings, &list->strings_used, &list->strings_capacity,
+                                            name_text, strlen(name_text));
+    unsigned int user_offset = arena_append(&list->strings, &list->strings_used, &list->strings_capacity,
+                                            user_text, strlen(user_text));
+    unsigned int command_offset = TASKS_PROCESS_NO_STRING;
+    if (command) {
+        command_offset = arena_append(&list->commands, &list->commands_used, &list->commands_capacity,
+                                      command, strlen(command));
+    }
+    if (name_offset == TASKS_PROCESS_NO_STRING || user_offset == TASKS_PROCESS_NO_STRING ||
+        (command && command_offset == TASKS_PROCESS_NO_STRING)) {
         return -1;
     }
-    fclose(fp);
-    int scanned = sscanf(line, "cpu  %llu %llu %llu %llu %llu %llu %llu %llu",
-                         &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal);
-    if (scanned < 4) return -1;
-    unsigned long long idle_all = idle + iowait;
-    unsigned long long non_idle = user + nice + system + irq + softirq + steal;
-    unsigned long long total = idle_all + non_idle;
-    if (out_total) *out_total = total;
-    if (out_idle) *out_idle = idle_all;
+    list->pids[index] = pid;
+    list->cpu_percent[index] = cpu_percent;
+    list->memory_mb[index] = memory_mb;
+    list->threads[index] = threads;
+    list->name_offsets[index] = name_offset;
+    list->user_offsets[index] = user_offset;
+    list->command_offsets[index] = command_offset;
+    list->count++;
+    return 0;
+}
+
+void tasks_model_free_processes(TasksProcessList *list)
+{
+    if (!list) return;
+    free(list->pids);
+    free(list->cpu_percent);
+    free(list->memory_mb);
+    free(list->threads);
+    free(list->name_offsets);
+    free(list->user_offsets);
+    free(list->command_offsets);
+    free(list->strings);
+    free(list->commands);
+    free(list);
+}
+
+const char *tasks_model_process_name(const TasksProcessList *list, int index)
+{
+    if (!list || index < 0 || index >= list->count) return "";
+    return list->strings + list->name_offsets[index];
+}
+
+const char *tasks_model_process_user(const TasksProcessList *list, int index)
+{
+    if (!list || index < 0 || index >= list->count) return "";
+    return list->strings + list->user_offsets[index];
+}
+
+const char *tasks_model_process_command(TasksProcessList *list, int index)
+{
+    if (!list || index < 0 || index >= list->count) return "";
+    if (list->command_offsets[index] == TASKS_PROCESS_NO_STRING) {
+        char command[PATH_MAX];
+        const char *text = command;
+        int len = procfs_read_pid_cmdline_path(list->strings + list->root_offset, list->pids[index],
+                                               command, sizeof(command));
+        if (len <= 0) {
+            /* Kernel threads and exited processes have no command line. */
+            text = list->strings + list->name_offsets[index];
+            len = (int)strlen(text);
+        }
+        unsigned int offset = arena_append(&list->commands, &list->commands_used, &list->commands_capacity,
+                                           text, (size_t)len);
+        if (offset == TASKS_PROCESS_NO_STRING) return list->strings + list->name_offsets[index];
+        list->command_offsets[index] = offset;
+    }
+    return list->commands + list->command_offsets[index];
+}
+
+const char *tasks_model_process_root(const TasksProcessList *list)
+{
+    if (!list || !list->strings) return "";
+    return list->strings + list->root_offset;
+}
+
+int tasks_model_read_process_details(const char *proc_root, pid_t pid, TasksProcessDetails *out)
+{
+    if (!out) return -1;
+    memset(out, 0, sizeof(*out));
+    out->pid = pid;
+    ProcfsPidDetails details;
+    if (procfs_read_pid_details_path(proc_root, pid, &details) != 0) return -1;
+    if (details.valid & PROCFS_DETAIL_PSS) out->valid |= TASKS_DETAIL_PSS;
+    if (details.valid & PROCFS_DETAIL_IO) out->valid |= TASKS_DETAIL_IO;
+    if (details.valid & PROCFS_DETAIL_FDS) out->valid |= TASKS_DETAIL_FDS;
+    out->pss_kb = details.pss_kb;
+    out->read_bytes = details.read_bytes;
+    out->write_bytes = details.write_bytes;
+    out->fd_count = details.fd_count;
+    return 0;
+}
+
+int tasks_model_reserve_process_view(TasksProcessView *view, int count)
+{
+    if (!view || count < 0) return -1;
+    if (count <= view->capacity) return 0;
+    int new_capacity = view->capacity ? view->capacity : PROCESS_LIST_INITIAL_CAPACITY;
+    while (new_capacity < count) {
+        if (new_capacity > INT_MAX / 2) return -1;
+        new_capacity *= 2;
+    }
+    int *rows = (int *)realloc(view->rows, sizeof(int) * (size_t)new_capacity);
+    if (!rows) return -1;
+    view->rows = rows;
+    view->capacity = new_capacity;
+    return 0;
+}
+
+void tasks_model_free_process_view(TasksProcessView *view)
+{
+    if (!view) return;
+    free(view->rows);
+    memset(view, 0, sizeof(*view));
+}
+
+static int diff_reserve(void **array, size_t element_size, int *capacity, int needed)
+{
+    if (needed <= *capacity) return 0;
+    int new_capacity = *capacity ? *capacity : 256;
+    while (new_capacity < needed) {
+        if (new_capacity > INT_MAX / 2) return -1;
+        new_capacity *= 2;
+    }
+    void *resized = realloc(*array, element_size * (size_t)new_capacity);
+    if (!resized) return -1;
+    *array = resized;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static unsigned int diff_compare_entries(const TasksProcessList *a, int a_index,
+                                         const TasksProcessList *b, int b_index)
+{
+    unsigned int fields = 0;
+    if (a->cpu_percent[a_index] != b->cpu_percent[b_index]) fields |= TASKS_PROCESS_FIELD_CPU;
+    if (a->memory_mb[a_index] != b->memory_mb[b_index]) fields |= TASKS_PROCESS_FIELD_MEMORY;
+    if (a->threads[a_index] != b->threads[b_index]) fields |= TASKS_PROCESS_FIELD_THREADS;
+    /* Interned strings in the same list compare by offset. */
+    if (a == b) {
+        if (a->name_offsets[a_index] != b->name_offsets[b_index]) fields |= TASKS_PROCESS_FIELD_NAME;
+        if (a->user_offsets[a_index] != b->user_offsets[b_index]) fields |= TASKS_PROCESS_FIELD_USER;
+        return fields;
+    }
+    if (strcmp(tasks_model_process_name(a, a_index), tasks_model_process_name(b, b_index)) != 0) {
+        fields |= TASKS_PROCESS_FIELD_NAME;
+    }
+    if (strcmp(tasks_model_process_user(a, a_index), tasks_model_process_user(b, b_index)) != 0) {
+        fields |= TASKS_PROCESS_FIELD_USER;
+    }
+    return fields;
+}
+
+int tasks_model_diff_processes(const TasksProcessView *old_view, const TasksProcessView *new_view,
+                               TasksProcessDiff *diff)
+{
+    if (!diff) return -1;
+    int old_count = (old_view && old_view->list) ? old_view->count : 0;
+    int new_count = (new_view && new_view->list) ? new_view->count : 0;
+    if (old_count < 0) old_count = 0;
+    if (new_count < 0) new_count = 0;
+    diff->old_count = 0;
+    diff->added_count = 0;
+    diff->changed_count = 0;
+
+    int old_capacity = diff->old_capacity;
+    if (diff_reserve((void **)&diff->old_to_new, sizeof(int), &old_capacity, old_count) != 0) return -1;
+    diff->old_capacity = old_capacity;
+    int new_capacity = diff->new_capacity;
+    int added_capacity = diff->new_capacity;
+    int changed_capacity = diff->new_capacity;
+    if (diff_reserve((void **)&diff->added, sizeof(int), &added_capacity, new_count) != 0 ||
+        diff_reserve((void **)&diff->changed, sizeof(int), &changed_capacity, new_count) != 0 ||
+        diff_reserve((void **)&diff->changed_fields, sizeof(unsigned int), &new_capacity, new_count) != 0) {
+        return -1;
+    }
+    diff->new_capacity = new_capacity;
+
+    /* pid -> new index, open addressing; slots hold index + 1 so 0 means empty. */
+    int slots = 64;
+    while (slots < new_count * 2) slots *= 2;
+    int slot_capacity = diff->pid_slot_capacity;
+    if (diff_reserve((void **)&diff->pid_slots, sizeof(int), &slot_capacity, slots) != 0) return -1;
+    diff->pid_slot_capacity = slot_capacity;
+    memset(diff->pid_slots, 0, sizeof(int) * (size_t)slots);
+    unsigned int mask = (unsigned int)(slots - 1);
+    const pid_t *new_pids = new_count > 0 ? new_view->list->pids : NULL;
+    for (int i = 0; i < new_count; ++i) {
+        unsigned int slot = ((unsigned int)new_pids[new_view->rows[i]] * 2654435769u) & mask;
+        while (diff->pid_slots[slot] != 0) slot = (slot + 1) & mask;
+        diff->pid_slots[slot] = i + 1;
+    }
+
+    /* Matched new entries are marked by negating their slot value. */
+    for (int i = 0; i < old_count; ++i) {
+        int old_row = old_view->rows[i];
+        pid_t pid = old_view->list->pids[old_row];
+        unsigned int slot = ((unsigned int)pid * 2654435769u) & mask;
+        int match = -1;
+        while (diff->pid_slots[slot] != 0) {
+            int value = diff->pid_slots[slot];
+            int index = (value < 0 ? -value : value) - 1;
+            if (value > 0 && new_pids[new_view->rows[index]] == pid) {
+                match = index;
+                diff->pid_slots[slot] = -value;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+        diff->old_to_new[i] = match;
+        if (match < 0) continue;
+        unsigned int fields = diff_compare_entries(old_view->list, old_row,
+                                                   new_view->list, new_view->rows[match]);
+        if (fields) {
+            diff->changed[diff->changed_count] = match;
+            diff->changed_fields[diff->changed_count] = fields;
+            diff->changed_count++;
+        }
+    }
+    for (int slot = 0; slot < slots; ++slot) {
+        if (diff->pid_slots[slot] > 0) {
+            diff->added[diff->added_count++] = diff->pid_slots[slot] - 1;
+        }
+    }
+    diff->old_count = old_count;
     return 0;
 }
 
-static ProcSample *get_proc_sample(pid_t pid, int create)
+void tasks_model_free_process_diff(TasksProcessDiff *diff)
+{
+    if (!diff) return;
+    free(diff->old_to_new);
+    free(diff->added);
+    free(diff->changed);
+    free(diff->changed_fields);
+    free(diff->pid_slots);
+    memset(diff, 0, sizeof(*diff));
+}
+
+int tasks_model_get_system_stats(TasksSystemStats *out_stats)
+{
+    if (!out_stats) return -1;
+    StatShmSample sample;
+    if (read_system_sample(&sample) != 0) return -1;
+    unsigned long long total = procfs_cpu_total_ticks(&sample.cpu);
+    unsigned long long idle = procfs_cpu_idle_ticks(&sample.cpu);
+
+    unsigned long long total_diff = total - g_prev_cpu_total;
+    unsigned long long idle_diff = idle - g_prev_cpu_idle;
+    int fresh = total_diff != 0;
+    if (fresh) {
+        g_prev_cpu_total = total;
+        g_prev_cpu_idle = idle;
+        g_last_cpu_percent = busy_percent(total_diff, idle_diff);
+    }
+    int cpu_percent = g_last_cpu_percent;
+    record_cpu_history(cpu_percent, fresh);
+
+    unsigned long mem_total = 0;
+    unsigned long mem_available = 0;
+    if (sample.valid & STAT_SHM_HAVE_MEMINFO) {
+        mem_total = sample.memory.mem_total_kb;
+        mem_available = sample.memory.mem_available_kb;
+    }
+    unsigned long mem_used = 0;
+    int mem_percent = 0;
+    if (mem_total > 0) {
+        mem_used = mem_total > mem_available ? (mem_total - mem_available) : 0;
+        mem_percent = (int)((double)mem_used / (double)mem_total * 100.0);
+    }
+
+    int cpu_count = sample.online_cores > 0 ? sample.online_cores : g_cpu_count;
+    double scale = 100.0 / (double)cpu_count;
+    int load1p = (int)(sample.load1 * scale);
+    int load5p = (int)(sample.load5 * scale);
+    int load15p = (int)(sample.load15 * scale);
+
+    out_stats->cpu_percent = cpu_percent;
+    out_stats->memory_percent = mem_percent;
+    out_stats->load1_percent = load1p;
+    out_stats->load5_percent = load5p;
+    out_stats->load15_percent = load15p;
+    out_stats->mem_total_kb = mem_total;
+    out_stats->mem_used_kb = mem_used;
+    return 0;
+}
+
+#define TASKS_USER_UNKNOWN_TEXT "(unknown)"
+#define TASKS_USER_LOCAL_TEXT "(local)"
+#define TASKS_USER_IDLE_NA_TEXT "n/a"
+
+static void tasks_model_format_login_time(char *buffer, size_t len, time_t seconds)
+{
+    if (!buffer || len == 0) return;
+    if (seconds <= 0) {
+        snprintf(buffer, len, "%s", TASKS_USER_UNKNOWN_TEXT);
+        buffer[len - 1] = '\0';
+        return;
+    }
+    struct tm tm_storage;
+    struct tm *tm_info = localtime_r(&seconds, &tm_storage);
+    if (!tm_info) {
+        snprintf(buffer, len, "%s", TASKS_USER_UNKNOWN_TEXT);
+        buffer[len - 1] = '\0';
+        return;
+    }
+    strftime(buffer, len, "%Y-%m-%d %H:%M:%S", tm_info);
+}
+
+/* Access time of a session's terminal, or -1 if it cannot be read. */
+static time_t tasks_model_tty_atime(const char *path)
+{
+    struct stat st;
+    if (!path[0] || stat(path, &st) != 0) return (time_t)-1;
+    return st.st_atime;
+}
+
+static long long tasks_model_idle_seconds(time_t atime, time_t now)
+{
+    if (atime == (time_t)-1) return -1;
+    if (now < atime) return 0;
+    return (long long)(now - atime);
+}
+
+static void tasks_model_format_idle_time(char *buffer, size_t len, long long seconds)
+{
+    if (!buffer || len == 0) return;
+    if (seconds < 0) {
+        snprintf(buffer, len, "%s", TASKS_USER_IDLE_NA_TEXT);
+        buffer[len - 1] = '\0';
+        return;
+    }
+    long long hours = seconds / 3600;
+    long long minutes = (seconds % 3600) / 60;
+    long long secs = seconds % 60;
+    if (hours > 0) {
+        snprintf(buffer, len, "%lluh %02llum", hours, minutes);
+    } else if (minutes > 0) {
+        snprintf(buffer, len, "%llum %02llus", minutes, secs);
+    } else {
+        snprintf(buffer, len, "%llus", secs);
+    }
+    buffer[len - 1] = '\0';
+}
+
+static void tasks_model_copy_string(char *dst, const char *src, size_t len, const char *fallback)
+{
+    if (!dst || len == 0) return;
+    if (src && src[0]) {
+        strncpy(dst, src, len - 1);
+        dst[len - 1] = '\0';
+        return;
+    }
+    if (fallback) {
+        strncpy(dst, fallback, len - 1);
+        dst[len - 1] = '\0';
+    } else {
+        dst[0] = '\0';
+    }
+}
+
+/* Re-reads the sessions from utmp into g_users. */
+static int tasks_model_read_utmp(time_t now)
+{
+    int count = 0;
+    int result = 0;
+    setutent();
+    struct utmp *ut = NULL;
+    while ((ut = getutent()) != NULL) {
+        if (ut->ut_type != USER_PROCESS) continue;
+        if (count >= g_user_capacity) {
+            int new_capacity = g_user_capacity ? g_user_capacity * 2 : 32;
+            TasksUserEntry *users = (TasksUserEntry *)realloc(g_users, sizeof(TasksUserEntry) * new_capacity);
+            if (users) g_users = users;
+            UserTty *ttys = users ? (UserTty *)realloc(g_user_ttys, sizeof(UserTty) * new_capacity) : NULL;
+            if (!ttys) {
+                result = -1;
+                break;
+            }
+            g_user_ttys = ttys;
+            g_user_capacity = new_capacity;
+        }
+        TasksUserEntry *entry = &g_users[count];
+        memset(entry, 0, sizeof(*entry));
+        tasks_model_copy_string(entry->user, ut->ut_user, sizeof(entry->user), TASKS_USER_UNKNOWN_TEXT);
+        tasks_model_copy_string(entry->tty, ut->ut_line, sizeof(entry->tty), TASKS_USER_UNKNOWN_TEXT);
+        tasks_model_copy_string(entry->host, ut->ut_host, sizeof(entry->host), TASKS_USER_LOCAL_TEXT);
+        time_t login_seconds = ut->ut_time;
+        tasks_model_format_login_time(entry->login_time, sizeof(entry->login_time), login_seconds);
+        entry->pid = ut->ut_pid;
+
+        UserTty *tty = &g_user_ttys[count];
+        char line[sizeof(ut->ut_line) + 1];
+        memcpy(line, ut->ut_line, sizeof(ut->ut_line));
+        line[sizeof(ut->ut_line)] = '\0';
+        tty->path[0] = '\0';
+        if (line[0] == '/') {
+            snprintf(tty->path, sizeof(tty->path), "%s", line);
+        } else if (line[0]) {
+            snprintf(tty->path, sizeof(tty->path), "/dev/%s", line);
+        }
+        tty->atime = tasks_model_tty_atime(tty->path);
+        count++;
+    }
+    endutent();
+    g_user_count = result == 0 ? count : 0;
+    g_user_ttys_checked = now;
+    return result;
+}
+
+int tasks_model_list_users(TasksUserEntry **out_entries, int *out_count)
+{
+    if (!out_entries || !out_count) return -1;
+    if (g_utmp_watch_state == WATCH_UNTRIED) {
+        g_utmp_watch_state = (file_watch_open(&g_utmp_watch) == 0) ? WATCH_ACTIVE
+                                                                   : WATCH_UNAVAILABLE;
+        g_users_valid = 0;
+    }
+    int changed = 1;
+    if (g_utmp_watch_state == WATCH_ACTIVE) {
+        changed = file_watch_changed(&g_utmp_watch);
+        if (changed < 0) {
+            file_watch_close(&g_utmp_watch);
+            g_utmp_watch_state = WATCH_UNAVAILABLE;
+            changed = 1;
+        }
+    }
+
+    time_t now = time(NULL);
+    if (changed || !g_users_valid) {
+        /* Watched before reading, so a login during the read is seen next
+         * time. A utmp that is replaced drops the watch, which also counts
+         * as a change, and the new file is watched here. */
+        int watched = g_utmp_watch_state == WATCH_ACTIVE &&
+                      file_watch_add(&g_utmp_watch, g_utmp_path[0] ? g_utmp_path : _PATH_UTMP) == 0;
+        g_users_valid = 0;
+        if (tasks_model_read_utmp(now) != 0) {
+            *out_entries = NULL;
+            *out_count = 0;
+            return -1;
+        }
+        g_users_valid = watched;
+    } else if (now - g_user_ttys_checked >= TASKS_USER_IDLE_CHECK_SECONDS || now < g_user_ttys_checked) {
+        for (int i = 0; i < g_user_count; ++i) {
+            g_user_ttys[i].atime = tasks_model_tty_atime(g_user_ttys[i].path);
+        }
+        g_user_ttys_checked = now;
+    }
+
+    TasksUserEntry *entries = NULL;
+    if (g_user_count > 0) {
+        entries = (TasksUserEntry *)malloc(sizeof(TasksUserEntry) * (size_t)g_user_count);
+        if (!entries) {
+            *out_entries = NULL;
+            *out_count = 0;
+            return -1;
+        }
+    }
+    for (int i = 0; i < g_user_count; ++i) {
+        entries[i] = g_users[i];
+        entries[i].idle_seconds = tasks_model_idle_seconds(g_user_ttys[i].atime, now);
+        tasks_model_format_idle_time(entries[i].idle_time, sizeof(entries[i].idle_time), entries[i].idle_seconds);
+    }
+    *out_entries = entries;
+    *out_count = g_user_count;
+    return 0;
+}
+
+static void tasks_model_reset_users(void)
+{
+    file_watch_close(&g_utmp_watch);
+    g_utmp_watch_state = WATCH_UNTRIED;
+    free(g_users);
+    free(g_user_ttys);
+    g_users = NULL;
+    g_user_ttys = NULL;
+    g_user_count = 0;
+    g_user_capacity = 0;
+    g_users_valid = 0;
+}
+
+void tasks_model_free_users(TasksUserEntry *entries, int count)
+{
+    (void)count;
+    free(entries);
+}
+
+/*
+ * Networking: per-interface counters from <root>/net/dev and the sockets of
+ * <root>/net/{tcp,tcp6,udp,udp6}.
+ *
+ * Sockets are attributed to processes through an inode -> pid table built
+ * from the /proc/<pid>/fd links. Reading every fd of every process on each
+ * refresh is what makes netstat-style tools slow, so the pid set is compared
+ * with the previous refresh and only new processes have their fd directory
+ * read; a pid whose start time or name changed (reused, or exec'd) counts as
+ * new. A socket that a long-running process opens later shows up as an
+ * unresolved inode; then the pids that already own sockets, plus a small
+ * round-robin batch of the others, are read again. Inodes still unresolved
+ * after that (usually another user's sockets) stay in the table as
+ * NET_INODE_UNRESOLVED and do not trigger another pass. The table is rebuilt
+ * from the current sockets, so it never holds more than the socket count.
+ */
+typedef struct {
+    pid_t pid;
+    unsigned long long starttime;
+    int socket_count;   /* sockets attributed to it by the previous refresh */
+    int unreadable;     /* fd directory not accessible (another user's process) */
+    char name[PROCFS_COMM_MAX];
+} NetPid;
+
+typedef struct {
+    unsigned long inode; /* 0 marks an empty slot */
+    pid_t pid;
+} NetInodeSlot;
+
+typedef struct {
+    char name[32];
+    unsigned long long rx_bytes;
+    unsigned long long tx_bytes;
+} NetCounters;
+
+#define NET_RESCAN_BATCH 64
+#define NET_INODE_UNRESOLVED ((pid_t)-1)
+#define NET_INODE_INITIAL_SLOTS 1024
+
+static NetPid *g_net_pids = NULL;
+static int g_net_pid_count = 0;
+static int g_net_pid_capacity = 0;
+static NetPid *g_net_pids_next = NULL;
+static int g_net_pids_next_capacity = 0;
+static pid_t *g_net_scan_pids = NULL;
+static int g_net_scan_capacity = 0;
+static int g_net_rescan_cursor = 0;
+static NetInodeSlot *g_net_inodes = NULL;
+static int g_net_inode_capacity = 0;
+static int g_net_inode_count = 0;
+static NetCounters *g_net_counters = NULL;
+static int g_net_counter_count = 0;
+static double g_net_counters_time = 0.0;
+
+static const char *const net_tcp_states[] = {
+    "", "ESTABLISHED", "SYN_SENT", "SYN_RECV", "FIN_WAIT1", "FIN_WAIT2", "TIME_WAIT",
+    "CLOSE", "CLOSE_WAIT", "LAST_ACK", "LISTEN", "CLOSING",
+};
+
+static void net_reset(void)
+{
+    free(g_net_pids);
+    free(g_net_pids_next);
+    free(g_net_scan_pids);
+    free(g_net_inodes);
+    free(g_net_counters);
+    g_net_pids = NULL;
+    g_net_pid_count = 0;
+    g_net_pid_capacity = 0;
+    g_net_pids_next = NULL;
+    g_net_pids_next_capacity = 0;
+    g_net_scan_pids = NULL;
+    g_net_scan_capacity = 0;
+    g_net_rescan_cursor = 0;
+    g_net_inodes = NULL;
+    g_net_inode_capacity = 0;
+    g_net_inode_count = 0;
+    g_net_counters = NULL;
+    g_net_counter_count = 0;
+    g_net_counters_time = 0.0;
+}
+
+static double net_monotonic_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static FILE *net_open(const char *relative)
+{
+    int fd = openat(g_procfs.root_fd, relative, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+    FILE *fp = fdopen(fd, "r");
+    if (!fp) close(fd);
+    return fp;
+}
+
+static unsigned int net_inode_slot(unsigned long inode, int capacity)
+{
+    return (unsigned int)(((unsigned long long)inode * 11400714819323198485ull) >> 32) &
+           (unsigned int)(capacity - 1);
+}
+
+static int net_inode_reset(int expected)
+{
+    int slots = g_net_inode_capacity ? g_net_inode_capacity : NET_INODE_INITIAL_SLOTS;
+    while (slots < expected * 2) {
+        if (slots > INT_MAX / 2) return -1;
+        slots *= 2;
+    }
+    if (slots != g_net_inode_capacity) {
+        NetInodeSlot *table = (NetInodeSlot *)realloc(g_net_inodes, sizeof(NetInodeSlot) * (size_t)slots);
+        if (!table) return -1;
+        g_net_inodes = table;
+        g_net_inode_capacity = slots;
+    }
+    memset(g_net_inodes, 0, sizeof(NetInodeSlot) * (size_t)g_net_inode_capacity);
+    g_net_inode_count = 0;
+    return 0;
+}
+
+static void net_inode_put(unsigned long inode, pid_t pid)
+{
+    if (inode == 0) return;
+    if (!g_net_inodes || (g_net_inode_count + 1) * 2 > g_net_inode_capacity) {
+        /* Grow by rehashing the current entries. */
+        NetInodeSlot *old = g_net_inodes;
+        int old_capacity = g_net_inode_capacity;
+        g_net_inodes = NULL;
+        g_net_inode_capacity = 0;
+        if (net_inode_reset(old_capacity ? old_capacity : NET_INODE_INITIAL_SLOTS / 2) != 0) {
+            g_net_inodes = old;
+            g_net_inode_capacity = old_capacity;
+            return;
+        }
+        for (int i = 0; i < old_capacity; ++i) {
+            if (old[i].inode) net_inode_put(old[i].inode, old[i].pid);
+        }
+        free(old);
+    }
+    unsigned int mask = (unsigned int)(g_net_inode_capacity - 1);
+    unsigned int slot = net_inode_slot(inode, g_net_inode_capacity);
+    while (g_net_inodes[slot].inode != 0 && g_net_inodes[slot].inode != inode) {
+        slot = (slot + 1) & mask;
+    }
+    if (g_net_inodes[slot].inode == 0) g_net_inode_count++;
+    g_net_inodes[slot].inode = inode;
+    g_net_inodes[slot].pid = pid;
+}
+
+static pid_t net_inode_get(unsigned long inode)
+{
+    if (inode == 0 || !g_net_inodes) return 0;
+    unsigned int mask = (unsigned int)(g_net_inode_capacity - 1);
+    unsigned int slot = net_inode_slot(inode, g_net_inode_capacity);
+    while (g_net_inodes[slot].inode != 0) {
+        if (g_net_inodes[slot].inode == inode) return g_net_inodes[slot].pid;
+        slot = (slot + 1) & mask;
+    }
+    return 0;
+}
+
+static NetPid *net_find_pid(pid_t pid)
+{
+    int lo = 0;
+    int hi = g_net_pid_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (g_net_pids[mid].pid == pid) return &g_net_pids[mid];
+        if (g_net_pids[mid].pid < pid) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return NULL;
+}
+
+/* Records the socket inodes among the fds of one process. */
+static void net_scan_pid(NetPid *entry)
+{
+    char path[32];
+    snprintf(path, sizeof(path), "%d/fd", (int)entry->pid);
+    int dir_fd = openat(g_procfs.root_fd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        if (errno == EACCES || errno == EPERM) entry->unreadable = 1;
+        return;
+    }
+    DIR *dir = fdopendir(dir_fd);
+    if (!dir) {
+        close(dir_fd);
+        return;
+    }
+    struct dirent *ent = NULL;
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] < '0' || ent->d_name[0] > '9') continue;
+        char target[64];
+        ssize_t len = readlinkat(dirfd(dir), ent->d_name, target, sizeof(target) - 1);
+        if (len <= 8) continue;
+        target[len] = '\0';
+        if (strncmp(target, "socket:[", 8) != 0) continue;
+        unsigned long inode = strtoul(target + 8, NULL, 10);
+        net_inode_put(inode, entry->pid);
+    }
+    closedir(dir);
+}
+
+/* Replaces g_net_pids with the current process set; new processes get their fds read. */
+static int net_update_pids(void)
+{
+    int count = 0;
+    procfs_pid_iter_begin(&g_procfs);
+    pid_t pid = 0;
+    while (procfs_pid_iter_next(&g_procfs, &pid)) {
+        if (count >= g_net_scan_capacity) {
+            int capacity = g_net_scan_capacity ? g_net_scan_capacity * 2 : 1024;
+            pid_t *pids = (pid_t *)realloc(g_net_scan_pids, sizeof(pid_t) * (size_t)capacity);
+            if (!pids) return -1;
+            g_net_scan_pids = pids;
+            g_net_scan_capacity = capacity;
+        }
+        g_net_scan_pids[count++] = pid;
+    }
+    qsort(g_net_scan_pids, (size_t)count, sizeof(pid_t), compare_pids);
+
+    if (count > g_net_pids_next_capacity) {
+        NetPid *next = (NetPid *)realloc(g_net_pids_next, sizeof(NetPid) * (size_t)count);
+        if (!next) return -1;
+        g_net_pids_next = next;
+        g_net_pids_next_capacity = count;
+    }
+    /* Merge the sorted lists: known processes keep their record, new ones start empty. */
+    int old_index = 0;
+    for (int i = 0; i < count; ++i) {
+        while (old_index < g_net_pid_count && g_net_pids[old_index].pid < g_net_scan_pids[i]) old_index++;
+        NetPid *entry = &g_net_pids_next[i];
+        ProcfsPidStat stat;
+        int have_stat = procfs_read_pid_stat(&g_procfs, g_net_scan_pids[i], &stat) == 0;
+        if (old_index < g_net_pid_count && g_net_pids[old_index].pid == g_net_scan_pids[i]) {
+            const NetPid *old = &g_net_pids[old_index++];
+            if (have_stat && old->starttime == stat.starttime && strcmp(old->name, stat.comm) == 0) {
+                *entry = *old;
+                continue;
+            }
+        }
+        memset(entry, 0, sizeof(*entry));
+        entry->pid = g_net_scan_pids[i];
+        if (have_stat) {
+            entry->starttime = stat.starttime;
+            snprintf(entry->name, sizeof(entry->name), "%s", stat.comm);
+        }
+        entry->socket_count = -1; /* marks "not read yet" until the swap below */
+    }
+    NetPid *swap = g_net_pids;
+    int swap_capacity = g_net_pid_capacity;
+    g_net_pids = g_net_pids_next;
+    g_net_pid_capacity = g_net_pids_next_capacity;
+    g_net_pid_count = count;
+    g_net_pids_next = swap;
+    g_net_pids_next_capacity = swap_capacity;
+
+    for (int i = 0; i < count; ++i) {
+        NetPid *entry = &g_net_pids[i];
+        if (entry->socket_count >= 0) continue;
+        entry->socket_count = 0;
+        net_scan_pid(entry);
+    }
+    return 0;
+}
+
+/* Parses a hex address from /proc/net/tcp{,6} (32-bit words in host order). */
+static void net_format_address(const char *hex, unsigned int port, int ipv6, char *out, size_t out_len)
+{
+    char text[INET6_ADDRSTRLEN] = "?";
+    if (ipv6) {
+        struct in6_addr addr;
+        for (int word = 0; word < 4; ++word) {
+            char chunk[9];
+            memcpy(chunk, hex + word * 8, 8);
+            chunk[8] = '\0';
+            uint32_t value = (uint32_t)strtoul(chunk, NULL, 16);
+            memcpy(&addr.s6_addr[word * 4], &value, sizeof(value));
+        }
+        inet_ntop(AF_INET6, &addr, text, sizeof(text));
+    } else {
+        struct in_addr addr;
+        addr.s_addr = (uint32_t)strtoul(hex, NULL, 16);
+        inet_ntop(AF_INET, &addr, text, sizeof(text));
+    }
+    if (port == 0) {
+        snprintf(out, out_len, ipv6 ? "[%s]:*" : "%s:*", text);
+    } else {
+        snprintf(out, out_len, ipv6 ? "[%s]:%u" : "%s:%u", text, port);
+    }
+}
+
+static int net_read_sockets(const char *relative, const char *protocol, int ipv6, int tcp,
+                            TasksNetSocket **sockets, int *count, int *capacity)
+{
+    FILE *fp = net_open(relative);
+    if (!fp) return -1;
+    char *line = NULL;
+    size_t line_len = 0;
+    int header = 1;
+    while (getline(&line, &line_len, fp) > 0) {
+        if (header) {
+            header = 0;
+            continue;
+        }
+        char local[33];
+        char remote[33];
+        unsigned int local_port = 0;
+        unsigned int remote_port = 0;
+        unsigned int state = 0;
+        unsigned int uid = 0;
+        unsigned long inode = 0;
+        if (sscanf(line, " %*d: %32[0-9A-Fa-f]:%x %32[0-9A-Fa-f]:%x %x %*x:%*x %*x:%*x %*x %u %*d %lu",
+                   local, &local_port, remote, &remote_port, &state, &uid, &inode) != 7) {
+            continue;
+        }
+        if (strlen(local) != (ipv6 ? 32u : 8u) || strlen(remote) != strlen(local)) continue;
+        if (*count >= *capacity) {
+            int grown = *capacity ? *capacity * 2 : 256;
+            TasksNetSocket *expanded = (TasksNetSocket *)realloc(*sockets, sizeof(TasksNetSocket) * (size_t)grown);
+            if (!expanded) break;
+            *sockets = expanded;
+            *capacity = grown;
+        }
+        TasksNetSocket *entry = &(*sockets)[(*count)++];
+        memset(entry, 0, sizeof(*entry));
+        snprintf(entry->protocol, sizeof(entry->protocol), "%s", protocol);
+        net_format_address(local, local_port, ipv6, entry->local, sizeof(entry->local));
+        net_format_address(remote, remote_port, ipv6, entry->remote, sizeof(entry->remote));
+        if (tcp && state < sizeof(net_tcp_states) / sizeof(net_tcp_states[0])) {
+            snprintf(entry->state, sizeof(entry->state), "%s", net_tcp_states[state]);
+        } else if (!tcp) {
+            snprintf(entry->state, sizeof(entry->state), "%s", state == 1 ? "ESTABLISHED" : "UNCONN");
+        }
+        entry->uid = (uid_t)uid;
+        entry->inode = inode;
+    }
+    free(line);
+    fclose(fp);
+    return 0;
+}
+
+/*
+ * Sets pid and process name of every socket whose inode is known. Returns
+ * how many are unresolved without being known as NET_INODE_UNRESOLVED.
+ */
+static int net_resolve_sockets(TasksNetSocket *sockets, int count)
+{
+    int unresolved = 0;
+    for (int i = 0; i < count; ++i) {
+        TasksNetSocket *entry = &sockets[i];
+        if (entry->pid > 0 || entry->inode == 0) continue;
+        pid_t pid = net_inode_get(entry->inode);
+        NetPid *owner = pid > 0 ? net_find_pid(pid) : NULL;
+        if (!owner) {
+            if (pid != NET_INODE_UNRESOLVED) unresolved++;
+            continue;
+        }
+        entry->pid = owner->pid;
+        snprintf(entry->process, sizeof(entry->process), "%s", owner->name);
+    }
+    return unresolved;
+}
+
+static void net_rescan_known_pids(void)
+{
+    /* Processes that already own sockets are the likeliest to have opened more. */
+    for (int i = 0; i < g_net_pid_count; ++i) {
+        if (g_net_pids[i].socket_count > 0 && !g_net_pids[i].unreadable) net_scan_pid(&g_net_pids[i]);
+    }
+    int scanned = 0;
+    for (int tries = 0; tries < g_net_pid_count && scanned < NET_RESCAN_BATCH; ++tries) {
+        if (g_net_rescan_cursor >= g_net_pid_count) g_net_rescan_cursor = 0;
+        NetPid *entry = &g_net_pids[g_net_rescan_cursor++];
+        if (entry->socket_count > 0 || entry->unreadable) continue;
+        net_scan_pid(entry);
+        scanned++;
+    }
+}
+
+static int net_read_interfaces(TasksNetInterface **out_interfaces, int *out_count)
+{
+    FILE *fp = net_open("net/dev");
+    if (!fp) return -1;
+    TasksNetInterface *interfaces = NULL;
+    int count = 0;
+    int capacity = 0;
+    char line[512];
+    double now = net_monotonic_seconds();
+    double elapsed = g_net_counters_time > 0.0 ? now - g_net_counters_time : 0.0;
+    while (fgets(line, sizeof(line), fp)) {
+        char *colon = strchr(line, ':');
+        if (!colon) continue; /* the two header lines */
+        *colon = '\0';
+        const char *name = line;
+        while (*name == ' ') name++;
+        unsigned long long rx = 0;
+        unsigned long long tx = 0;
+        if (sscanf(colon + 1, "%llu %*u %*u %*u %*u %*u %*u %*u %llu", &rx, &tx) != 2) continue;
+        if (count >= capacity) {
+            int grown = capacity ? capacity * 2 : 8;
+            TasksNetInterface *expanded =
+                (TasksNetInterface *)realloc(interfaces, sizeof(TasksNetInterface) * (size_t)grown);
+            if (!expanded) break;
+            interfaces = expanded;
+            capacity = grown;
+        }
+        TasksNetInterface *entry = &interfaces[count++];
+        memset(entry, 0, sizeof(*entry));
+        snprintf(entry->name, sizeof(entry->name), "%.31s", name);
+        entry->rx_bytes = rx;
+        entry->tx_bytes = tx;
+        for (int i = 0; i < g_net_counter_count && elapsed > 0.0; ++i) {
+            const NetCounters *prev = &g_net_counters[i];
+            if (strcmp(prev->name, entry->name) != 0) continue;
+            /* Counters restart when an interface is re-created. */
+            if (rx >= prev->rx_bytes) entry->rx_rate = (double)(rx - prev->rx_bytes) / elapsed;
+            if (tx >= prev->tx_bytes) entry->tx_rate = (double)(tx - prev->tx_bytes) / elapsed;
+            break;
+        }
+    }
+    fclose(fp);
+
+    NetCounters *counters = (NetCounters *)realloc(g_net_counters, sizeof(NetCounters) * (size_t)(count ? count : 1));
+    if (counters) {
+        g_net_counters = counters;
+        for (int i = 0; i < count; ++i) {
+            snprintf(counters[i].name, sizeof(counters[i].name), "%s", interfaces[i].name);
+            counters[i].rx_bytes = interfaces[i].rx_bytes;
+            counters[i].tx_bytes = interfaces[i].tx_bytes;
+        }
+        g_net_counter_count = count;
+        g_net_counters_time = now;
+    }
+    *out_interfaces = interfaces;
+    *out_count = count;
+    return 0;
+}
+
+int tasks_model_list_network(TasksNetInterface **out_interfaces, int *out_interface_count,
+                             TasksNetSocket **out_sockets, int *out_socket_count)
+{
+    if (!out_interfaces || !out_interface_count || !out_sockets || !out_socket_count) return -1;
+    *out_interfaces = NULL;
+    *out_interface_count = 0;
+    *out_sockets = NULL;
+    *out_socket_count = 0;
+    if (tasks_model_ensure_procfs() != 0) return -1;
+
+    TasksNetInterface *interfaces = NULL;
+    int interface_count = 0;
+    int interfaces_ok = net_read_interfaces(&interfaces, &interface_count) == 0;
+
+    TasksNetSocket *sockets = NULL;
+    int socket_count = 0;
+    int socket_capacity = 0;
+    int tables = 0;
+    tables += net_read_sockets("net/tcp", "tcp", 0, 1, &sockets, &socket_count, &socket_capacity) == 0;
+    tables += net_read_sockets("net/tcp6", "tcp6", 1, 1, &sockets, &socket_count, &socket_capacity) == 0;
+    tables += net_read_sockets("net/udp", "udp", 0, 0, &sockets, &socket_count, &socket_capacity) == 0;
+    tables += net_read_sockets("net/udp6", "udp6", 1, 0, &sockets, &socket_count, &socket_capacity) == 0;
+    if (!interfaces_ok && tables == 0) return -1;
+
+    if (socket_count > 0 && net_update_pids() == 0) {
+        if (net_resolve_sockets(sockets, socket_count) > 0) {
+            net_rescan_known_pids();
+            net_resolve_sockets(sockets, socket_count);
+        }
+        /* Keep only the inodes that are still sockets; remember which could not be resolved. */
+        for (int i = 0; i < g_net_pid_count; ++i) {
+            g_net_pids[i].socket_count = 0;
+        }
+        if (net_inode_reset(socket_count) == 0) {
+            for (int i = 0; i < socket_count; ++i) {
+                if (sockets[i].pid <= 0) {
+                    net_inode_put(sockets[i].inode, NET_INODE_UNRESOLVED);
+                    continue;
+                }
+                net_inode_put(sockets[i].inode, sockets[i].pid);
+                NetPid *owner = net_find_pid(sockets[i].pid);
+                if (owner) owner->socket_count++;
+            }
+        }
+    }
+
+    *out_interfaces = interfaces;
+    *out_interface_count = interface_count;
+    *out_sockets = sockets;
+    *out_socket_count = socket_count;
+    return 0;
+}
+
+void tasks_model_free_network(TasksNetInterface *interfaces, TasksNetSocket *sockets)
+{
+    free(interfaces);
+    free(sockets);
+}
+
+/*
+ * cgroup v2 groups. The tree is walked once and every group directory is
+ * watched; it is walked again only when a watch reports a directory being
+ * created or removed, or events were lost. A group with processes has
+ * counters that move without any notification, so it is re-read on every
+ * refresh. A group without processes cannot use CPU or do I/O: it is
+ * re-read only when one of its files changes, which is how the kernel
+ * announces the populated flag in cgroup.events flipping. Every
+ * CGROUP_SWEEP_SECONDS all groups are re-read anyway, which picks up memory
+ * an empty group gave back to reclaim. Without inotify, or when a watch
+ * could not be added, every refresh walks and reads everything.
+ */
+typedef struct {
+    int wd;                  /* directory watch, -1 if none */
+    int stale;               /* re-read, with cgroup.events, on the next refresh */
+    unsigned int read_valid; /* TASKS_CGROUP_* values the last read found */
+    unsigned long long usage_usec;
+    unsigned long long read_bytes;
+    unsigned long long write_bytes;
+    double read_time;        /* monotonic seconds; 0 = never read */
+} CgroupState;
+
+/* Groups being collected by a walk; the previous tree stays in place until
+ * the walk completes, so groups that still exist keep their counters. */
+typedef struct {
+    TasksCgroupEntry *entries;
+    CgroupState *states;
+    int count;
+    int capacity;
+    int failed;
+} CgroupWalk;
+
+#define CGROUP_SWEEP_SECONDS 30
+#define CGROUP_MAX_DEPTH 64
+#define CGROUP_FILE_BUFFER 8192
+
+static char g_cgroup_mount[PATH_MAX] = ""; /* the v2 hierarchy; "" until found */
+static FileWatch g_cgroup_watch = {-1};
+static int g_cgroup_watch_state = WATCH_UNTRIED;
+static int g_cgroup_watch_complete = 0; /* every group of the last walk is watched */
+static TasksCgroupEntry *g_cgroups = NULL;
+static CgroupState *g_cgroup_states = NULL;
+static int g_cgroup_count = 0;
+static int g_cgroups_valid = 0;
+static double g_cgroup_sweep_time = 0.0;
+/* Open addressing over g_cgroups (slots hold index + 1): by watch
+ * descriptor for events, and by parent and name to carry groups across a walk. */
+static int *g_cgroup_wd_slots = NULL;
+static int g_cgroup_wd_slot_count = 0;
+static int *g_cgroup_name_slots = NULL;
+static int g_cgroup_name_slot_count = 0;
+
+static void cgroup_reset(void)
+{
+    file_watch_close(&g_cgroup_watch);
+    g_cgroup_watch_state = WATCH_UNTRIED;
+    g_cgroup_watch_complete = 0;
+    free(g_cgroups);
+    free(g_cgroup_states);
+    free(g_cgroup_wd_slots);
+    free(g_cgroup_name_slots);
+    g_cgroups = NULL;
+    g_cgroup_states = NULL;
+    g_cgroup_count = 0;
+    g_cgroups_valid = 0;
+    g_cgroup_sweep_time = 0.0;
+    g_cgroup_wd_slots = NULL;
+    g_cgroup_wd_slot_count = 0;
+    g_cgroup_name_slots = NULL;
+    g_cgroup_name_slot_count = 0;
+    g_cgroup_mount[0] = '\0';
+}
+
+int tasks_model_set_cgroup_root(const char *root)
+{
+    if (root && strlen(root) >= sizeof(g_cgroup_root)) return -1;
+    snprintf(g_cgroup_root, sizeof(g_cgroup_root), "%s", root ? root : "");
+    size_t len = strlen(g_cgroup_root);
+    while (len > 0 && g_cgroup_root[len - 1] == '/') g_cgroup_root[--len] = '\0';
+    cgroup_reset();
+    return 0;
+}
+
+/* Slot tables are kept at most half full. Returns the slot count, or 0 on
+ * allocation failure. */
+static int cgroup_slots_reset(int **slots, int *slot_count, int count)
+{
+    int needed = 64;
+    while (needed < count * 2) needed *= 2;
+    if (needed != *slot_count) {
+        int *resized = (int *)realloc(*slots, sizeof(int) * (size_t)needed);
+        if (!resized) return 0;
+        *slots = resized;
+        *slot_count = needed;
+    }
+    memset(*slots, 0, sizeof(int) * (size_t)*slot_count);
+    return *slot_count;
+}
+
+static unsigned int cgroup_name_hash(int parent, const char *name)
+{
+    unsigned int hash = 2166136261u ^ (unsigned int)parent;
+    hash *= 16777619u;
+    for (const char *p = name; *p; ++p) {
+        hash ^= (unsigned char)*p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void cgroup_index_names(void)
+{
+    if (!cgroup_slots_reset(&g_cgroup_name_slots, &g_cgroup_name_slot_count, g_cgroup_count)) return;
+    unsigned int mask = (unsigned int)g_cgroup_name_slot_count - 1;
+    for (int i = 0; i < g_cgroup_count; ++i) {
+        unsigned int slot = cgroup_name_hash(g_cgroups[i].parent, g_cgroups[i].name) & mask;
+        while (g_cgroup_name_slots[slot]) slot = (slot + 1) & mask;
+        g_cgroup_name_slots[slot] = i + 1;
+    }
+}
+
+/* Index of the previous tree's group with this parent and name, or -1. */
+static int cgroup_find_name(int parent, const char *name)
+{
+    if (g_cgroup_name_slot_count == 0) return -1;
+    unsigned int mask = (unsigned int)g_cgroup_name_slot_count - 1;
+    for (unsigned int slot = cgroup_name_hash(parent, name) & mask; g_cgroup_name_slots[slot];
+         slot = (slot + 1) & mask) {
+        int index = g_cgroup_name_slots[slot] - 1;
+        if (g_cgroups[index].parent == parent && strcmp(g_cgroups[index].name, name) == 0) return index;
+    }
+    return -1;
+}
+
+static void cgroup_index_watches(void)
+{
+    if (!cgroup_slots_reset(&g_cgroup_wd_slots, &g_cgroup_wd_slot_count, g_cgroup_count)) {
+        g_cgroup_watch_complete = 0;
+        return;
+    }
+    unsigned int mask = (unsigned int)g_cgroup_wd_slot_count - 1;
+    for (int i = 0; i < g_cgroup_count; ++i) {
+        int wd = g_cgroup_states[i].wd;
+        if (wd < 0) continue;
+        unsigned int slot = ((unsigned int)wd * 2654435769u) & mask;
+        while (g_cgroup_wd_slots[slot]) slot = (slot + 1) & mask;
+        g_cgroup_wd_slots[slot] = i + 1;
+    }
+}
+
+static int cgroup_find_watch(int wd)
+{
+    if (wd < 0 || g_cgroup_wd_slot_count == 0) return -1;
+    unsigned int mask = (unsigned int)g_cgroup_wd_slot_count - 1;
+    for (unsigned int slot = ((unsigned int)wd * 2654435769u) & mask; g_cgroup_wd_slots[slot];
+         slot = (slot + 1) & mask) {
+        int index = g_cgroup_wd_slots[slot] - 1;
+        if (g_cgroup_states[index].wd == wd) return index;
+    }
+    return -1;
+}
+
+static void cgroup_on_event(void *context, int wd, unsigned int flags, const char *name)
 {
-    for (int i = 0; i < g_proc_samples_count; ++i) {
-        if (g_proc_samples[i].pid == pid) {
-            return &g_proc_samples[i];
-        }
+    (void)context;
+    (void)name;
+    if (flags & FILE_WATCH_EVENT_OVERFLOW) {
+        g_cgroups_valid = 0;
+        g_cgroup_sweep_time = 0.0;
+        return;
     }
-    if (!create) return NULL;
-    if (g_proc_samples_count >= g_proc_samples_capacity) {
-        int new_capacity = g_proc_samples_capacity ? g_proc_samples_capacity * 2 : 256;
-        ProcSample *resized = (ProcSample *)realloc(g_proc_samples, sizeof(ProcSample) * new_capacity);
-        if (!resized) return NULL;
-        g_proc_samples = resized;
-        g_proc_samples_capacity = new_capacity;
+    int index = cgroup_find_watch(wd);
+    if (index < 0) return;
+    /* A child group was created or removed, or this one went away. */
+    if ((flags & FILE_WATCH_EVENT_GONE) ||
+        ((flags & FILE_WATCH_EVENT_ENTRIES) && (flags & FILE_WATCH_EVENT_DIRECTORY))) {
+        g_cgroups_valid = 0;
     }
-    ProcSample *sample = &g_proc_samples[g_proc_samples_count++];
-    sample->pid = pid;
-    sample->total_ticks = 0;
-    sample->last_uptime = 0.0;
-    sample->seen = 0;
-    return sample;
+    g_cgroup_states[index].stale = 1;
 }
 
-void tasks_model_initialize(void)
+static int cgroup_find_mount(void)
 {
-    g_clock_ticks = sysconf(_SC_CLK_TCK);
-    if (g_clock_ticks <= 0) g_clock_ticks = 100;
-    g_cpu_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
-    if (g_cpu_count <= 0) g_cpu_count = 1;
-    read_cpu_totals(&g_prev_cpu_total, &g_prev_cpu_idle);
+    const char *root = g_cgroup_root[0] ? g_cgroup_root : "/sys/fs/cgroup";
+    char path[PATH_MAX + 32];
+    snprintf(path, sizeof(path), "%s/cgroup.controllers", root);
+    if (access(path, F_OK) == 0) {
+        snprintf(g_cgroup_mount, sizeof(g_cgroup_mount), "%s", root);
+        return 0;
+    }
+    /* The hybrid layout mounts the v2 hierarchy next to the v1 controllers. */
+    snprintf(path, sizeof(path), "%s/unified/cgroup.controllers", root);
+    if (access(path, F_OK) == 0 && strlen(root) + sizeof("/unified") <= sizeof(g_cgroup_mount)) {
+        snprintf(g_cgroup_mount, sizeof(g_cgroup_mount), "%s/unified", root);
+        return 0;
+    }
+    return -1;
 }
 
-void tasks_model_shutdown(void)
+static int cgroup_walk_add(CgroupWalk *walk, const char *name, int parent, int depth, int previous)
 {
-    free(g_proc_samples);
-    g_proc_samples = NULL;
-    g_proc_samples_count = 0;
-    g_proc_samples_capacity = 0;
+    if (walk->count == walk->capacity) {
+        int capacity = walk->capacity ? walk->capacity * 2 : 256;
+        TasksCgroupEntry *entries =
+            (TasksCgroupEntry *)realloc(walk->entries, sizeof(TasksCgroupEntry) * (size_t)capacity);
+        if (entries) walk->entries = entries;
+        CgroupState *states = (CgroupState *)realloc(walk->states, sizeof(CgroupState) * (size_t)capacity);
+        if (states) walk->states = states;
+        if (!entries || !states) {
+            walk->failed = 1;
+            return -1;
+        }
+        walk->capacity = capacity;
+    }
+    int index = walk->count++;
+    TasksCgroupEntry *entry = &walk->entries[index];
+    CgroupState *state = &walk->states[index];
+    if (previous >= 0) {
+        *entry = g_cgroups[previous];
+        *state = g_cgroup_states[previous];
+    } else {
+        memset(entry, 0, sizeof(*entry));
+        memset(state, 0, sizeof(*state));
+        snprintf(entry->name, sizeof(entry->name), "%s", name);
+        entry->populated = parent < 0; /* the root has no cgroup.events */
+        state->stale = 1;
+    }
+    entry->parent = parent;
+    entry->depth = depth;
+    state->wd = -1;
+    return index;
 }
 
-int tasks_model_list_processes(TasksProcessEntry **out_entries, int *out_count)
+static int cgroup_compare_names(const void *a, const void *b)
 {
-    if (!out_entries || !out_count) return -1;
-    DIR *dir = opendir("/proc");
-    if (!dir) return -1;
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
 
-    TasksProcessEntry *entries = NULL;
-    int capacity = 0;
-    int count = 0;
-    double uptime = read_uptime_seconds();
-    for (int i = 0; i < g_proc_samples_count; ++i) {
-        g_proc_samples[i].seen = 0;
-    }
-    struct dirent *ent = NULL;
+/* Adds the subgroups of the group at index (path, len bytes long) in
+ * pre-order, siblings sorted by name. previous is the same group in the
+ * last tree, or -1. */
+static void cgroup_walk_dir(CgroupWalk *walk, char *path, size_t len, int index, int previous)
+{
+    int depth = walk->entries[index].depth;
+    if (g_cgroup_watch_state == WATCH_ACTIVE) {
+        /* Watched before listing, so a group created meanwhile is not missed. */
+        walk->states[index].wd = file_watch_add_id(&g_cgroup_watch, path);
+        if (walk->states[index].wd < 0 && errno != ENOENT) g_cgroup_watch_complete = 0;
+    }
+    if (depth >= CGROUP_MAX_DEPTH) return;
+
+    DIR *dir = opendir(path);
+    if (!dir) return;
+    char **names = NULL;
+    int name_count = 0;
+    int name_capacity = 0;
+    struct dirent *ent;
     while ((ent = readdir(dir)) != NULL) {
-        if (!is_pid_dir(ent->d_name)) continue;
-        pid_t pid = (pid_t)atoi(ent->d_name);
-        TasksProcessEntry entry;
-        memset(&entry, 0, sizeof(entry));
-        entry.pid = pid;
-        unsigned long long ut = 0, st = 0;
-        if (read_proc_stat(pid, entry.name, sizeof(entry.name), &ut, &st, &entry.threads) != 0) {
-            continue;
-        }
-        uid_t uid = (uid_t)-1;
-        int have_uid = (read_proc_status_uid(pid, &uid) == 0);
-        if (have_uid) {
-            struct passwd *pw = getpwuid(uid);
-            if (pw && pw->pw_name) {
-                strncpy(entry.user, pw->pw_name, sizeof(entry.user) - 1);
-                entry.user[sizeof(entry.user) - 1] = '\0';
-            }
-        }
-        if (entry.user[0] == '\0' && have_uid) {
-            snprintf(entry.user, sizeof(entry.user), "%d", (int)uid);
-        }
-        if (entry.user[0] == '\0') {
-            snprintf(entry.user, sizeof(entry.user), "unknown");
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+        int is_dir = ent->d_type == DT_DIR;
+        if (ent->d_type == DT_UNKNOWN) {
+            struct stat st;
+            is_dir = fstatat(dirfd(dir), ent->d_name, &st, 0) == 0 && S_ISDIR(st.st_mode);
         }
-        read_proc_cmdline(pid, entry.command, sizeof(entry.command));
-        if (entry.command[0] == '\0') {
-            snprintf(entry.command, sizeof(entry.command), "%s", entry.name);
-        }
-        read_proc_rss_mb(pid, &entry.memory_mb);
-        unsigned long long total_ticks = ut + st;
-        double cpu_percent = 0.0;
-        if (uptime > 0.0 && g_clock_ticks > 0) {
-            ProcSample *sample = get_proc_sample(pid, 1);
-            if (sample && sample->last_uptime > 0.0 && uptime > sample->last_uptime &&
-                total_ticks >= sample->total_ticks) {
-                double delta_ticks = (double)(total_ticks - sample->total_ticks);
-                double delta_seconds = delta_ticks / (double)g_clock_ticks;
-                double interval = uptime - sample->last_uptime;
-                if (interval > 0.0) {
-                    cpu_percent = (delta_seconds / interval) * 100.0;
-                }
-            } else {
-                double total_time = (double)total_ticks / (double)g_clock_ticks;
-                cpu_percent = (total_time / uptime) * 100.0;
-            }
-            if (sample) {
-                sample->total_ticks = total_ticks;
-                sample->last_uptime = uptime;
-                sample->seen = 1;
-            }
-        }
-        entry.cpu_percent = cpu_percent;
-        if (count >= capacity) {
-            int new_capacity = capacity ? capacity * 2 : 256;
-            TasksProcessEntry *resized = (TasksProcessEntry *)realloc(entries, sizeof(TasksProcessEntry) * new_capacity);
-            if (!resized) {
-                free(entries);
-                closedir(dir);
-                return -1;
-            }
-            entries = resized;
-            capacity = new_capacity;
+        if (!is_dir) continue;
+        if (name_count == name_capacity) {
+            int capacity = name_capacity ? name_capacity * 2 : 16;
+            char **resized = (char **)realloc(names, sizeof(char *) * (size_t)capacity);
+            if (!resized) break;
+            names = resized;
+            name_capacity = capacity;
         }
-        entries[count++] = entry;
+        names[name_count] = strdup(ent->d_name);
+        if (names[name_count]) name_count++;
     }
     closedir(dir);
-    if (g_proc_samples_count > 0) {
-        int write_index = 0;
-        for (int i = 0; i < g_proc_samples_count; ++i) {
-            if (!g_proc_samples[i].seen) continue;
-            if (write_index != i) {
-                g_proc_samples[write_index] = g_proc_samples[i];
-            }
-            write_index++;
-        }
-        g_proc_samples_count = write_index;
-    }
+    if (name_count > 1) qsort(names, (size_t)name_count, sizeof(char *), cgroup_compare_names);
+
+    for (int i = 0; i < name_count; ++i) {
+        size_t name_len = strlen(names[i]);
+        if (walk->failed || len + 1 + name_len >= PATH_MAX) continue;
+        path[len] = '/';
+        memcpy(path + len + 1, names[i], name_len + 1);
+        int child_previous = previous >= 0 ? cgroup_find_name(previous, names[i]) : -1;
+        int child = cgroup_walk_add(walk, names[i], index, depth + 1, child_previous);
+        if (child >= 0) cgroup_walk_dir(walk, path, len + 1 + name_len, child, child_previous);
+    }
+    path[len] = '\0';
+    for (int i = 0; i < name_count; ++i) {
+        free(names[i]);
+    }
+    free(names);
+}
 
-    *out_entries = entries;
-    *out_count = count;
+static int cgroup_walk(void)
+{
+    cgroup_index_names();
+    CgroupWalk walk;
+    memset(&walk, 0, sizeof(walk));
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s", g_cgroup_mount);
+    g_cgroup_watch_complete = g_cgroup_watch_state == WATCH_ACTIVE;
+    int previous_root = g_cgroup_count > 0 ? 0 : -1;
+    int root = cgroup_walk_add(&walk, "/", -1, 0, previous_root);
+    if (root >= 0) cgroup_walk_dir(&walk, path, strlen(path), root, previous_root);
+    if (walk.failed) {
+        free(walk.entries);
+        free(walk.states);
+        return -1;
+    }
+    free(g_cgroups);
+    free(g_cgroup_states);
+    g_cgroups = walk.entries;
+    g_cgroup_states = walk.states;
+    g_cgroup_count = walk.count;
+    cgroup_index_watches();
+    /* Without complete watches the next refresh has to walk again. */
+    g_cgroups_valid = g_cgroup_watch_complete;
     return 0;
 }
 
-void tasks_model_free_processes(TasksProcessEntry *entries, int count)
+/* Reads name in the group directory dir_fd into buf; returns the length or -1. */
+static int cgroup_read_file(int dir_fd, const char *name, char *buf, size_t len)
 {
-    (void)count;
-    free(entries);
+    int fd = openat(dir_fd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    size_t used = 0;
+    while (used + 1 < len) {
+        ssize_t got = read(fd, buf + used, len - 1 - used);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) break;
+        used += (size_t)got;
+    }
+    close(fd);
+    buf[used] = '\0';
+    return (int)used;
 }
 
-int tasks_model_get_system_stats(TasksSystemStats *out_stats)
+static int cgroup_read_number(int dir_fd, const char *name, unsigned long long *out)
 {
-    if (!out_stats) return -1;
-    unsigned long long total = 0;
-    unsigned long long idle = 0;
-    if (read_cpu_totals(&total, &idle) != 0) return -1;
-
-    unsigned long long total_diff = total - g_prev_cpu_total;
-    unsigned long long idle_diff = idle - g_prev_cpu_idle;
-    g_prev_cpu_total = total;
-    g_prev_cpu_idle = idle;
-    int cpu_percent = 0;
-    if (total_diff > 0) {
-        cpu_percent = (int)((double)(total_diff - idle_diff) / (double)total_diff * 100.0);
-    }
+    char buf[64];
+    if (cgroup_read_file(dir_fd, name, buf, sizeof(buf)) <= 0) return -1;
+    char *end = NULL;
+    *out = strtoull(buf, &end, 10);
+    return end != buf ? 0 : -1;
+}
 
-    FILE *fp = fopen("/proc/meminfo", "r");
-    unsigned long mem_total = 0;
-    unsigned long mem_available = 0;
-    if (fp) {
-        char line[256];
-        while (fgets(line, sizeof(line), fp)) {
-            if (sscanf(line, "MemTotal: %lu kB", &mem_total) == 1) continue;
-            if (sscanf(line, "MemAvailable: %lu kB", &mem_available) == 1) continue;
+/* Value of a "key value" line, as in cpu.stat and cgroup.events. */
+static int cgroup_keyed_value(const char *text, const char *key, unsigned long long *out)
+{
+    size_t key_len = strlen(key);
+    for (const char *line = text; line && *line;) {
+        if (strncmp(line, key, key_len) == 0 && line[key_len] == ' ') {
+            *out = strtoull(line + key_len + 1, NULL, 10);
+            return 0;
         }
-        fclose(fp);
-    }
-    unsigned long mem_used = 0;
-    int mem_percent = 0;
-    if (mem_total > 0) {
-        mem_used = mem_total > mem_available ? (mem_total - mem_available) : 0;
-        mem_percent = (int)((double)mem_used / (double)mem_total * 100.0);
-    }
-
-    double load1 = 0.0, load5 = 0.0, load15 = 0.0;
-    fp = fopen("/proc/loadavg", "r");
-    if (fp) {
-        fscanf(fp, "%lf %lf %lf", &load1, &load5, &load15);
-        fclose(fp);
+        line = strchr(line, '\n');
+        if (line) line++;
     }
-    double scale = 100.0 / (double)g_cpu_count;
-    int load1p = (int)(load1 * scale);
-    int load5p = (int)(load5 * scale);
-    int load15p = (int)(load15 * scale);
-
-    out_stats->cpu_percent = cpu_percent;
-    out_stats->memory_percent = mem_percent;
-    out_stats->load1_percent = load1p;
-    out_stats->load5_percent = load5p;
-    out_stats->load15_percent = load15p;
-    out_stats->mem_total_kb = mem_total;
-    out_stats->mem_used_kb = mem_used;
-    return 0;
+    return -1;
 }
 
-#define TASKS_USER_UNKNOWN_TEXT "(unknown)"
-#define TASKS_USER_LOCAL_TEXT "(local)"
-#define TASKS_USER_IDLE_NA_TEXT "n/a"
-
-static void tasks_model_format_login_time(char *buffer, size_t len, time_t seconds)
+/* Sums rbytes= and wbytes= over the devices listed in io.stat. */
+static void cgroup_parse_io(const char *text, unsigned long long *read_bytes, unsigned long long *write_bytes)
 {
-    if (!buffer || len == 0) return;
-    if (seconds <= 0) {
-        snprintf(buffer, len, "%s", TASKS_USER_UNKNOWN_TEXT);
-        buffer[len - 1] = '\0';
-        return;
-    }
-    struct tm tm_storage;
-    struct tm *tm_info = localtime_r(&seconds, &tm_storage);
-    if (!tm_info) {
-        snprintf(buffer, len, "%s", TASKS_USER_UNKNOWN_TEXT);
-        buffer[len - 1] = '\0';
-        return;
+    *read_bytes = 0;
+    *write_bytes = 0;
+    for (const char *p = text; (p = strstr(p, "bytes=")) != NULL; p += 6) {
+        if (p - text < 2 || p[-2] != ' ') continue;
+        if (p[-1] == 'r') *read_bytes += strtoull(p + 6, NULL, 10);
+        if (p[-1] == 'w') *write_bytes += strtoull(p + 6, NULL, 10);
     }
-    strftime(buffer, len, "%Y-%m-%d %H:%M:%S", tm_info);
 }
 
-static long long tasks_model_get_idle_seconds(const char *line)
+static double cgroup_rate(unsigned long long value, unsigned long long previous, double elapsed, int had_previous)
 {
-    if (!line || line[0] == '\0') return -1;
-    char path[128] = {0};
-    if (line[0] == '/') {
-        snprintf(path, sizeof(path), "%s", line);
-    } else {
-        snprintf(path, sizeof(path), "/dev/%s", line);
-    }
-    struct stat st = {0};
-    if (stat(path, &st) != 0) return -1;
-    time_t now = time(NULL);
-    if (now < st.st_atime) return 0;
-    return (long long)(now - st.st_atime);
+    if (!had_previous || elapsed <= 0.0 || value < previous) return 0.0;
+    return (double)(value - previous) / elapsed;
 }
 
-static void tasks_model_format_idle_time(char *buffer, size_t len, long long seconds)
+static void cgroup_read_group(const char *path, int index, double now, int read_events)
 {
-    if (!buffer || len == 0) return;
-    if (seconds < 0) {
-        snprintf(buffer, len, "%s", TASKS_USER_IDLE_NA_TEXT);
-        buffer[len - 1] = '\0';
+    TasksCgroupEntry *entry = &g_cgroups[index];
+    CgroupState *state = &g_cgroup_states[index];
+    entry->cpu_percent = 0.0;
+    entry->read_rate = 0.0;
+    entry->write_rate = 0.0;
+    int dir_fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        /* Removed since the walk; the watch reports it as well. */
+        state->read_valid = 0;
+        g_cgroups_valid = 0;
         return;
     }
-    long long hours = seconds / 3600;
-    long long minutes = (seconds % 3600) / 60;
-    long long secs = seconds % 60;
-    if (hours > 0) {
-        snprintf(buffer, len, "%lluh %02llum", hours, minutes);
-    } else if (minutes > 0) {
-        snprintf(buffer, len, "%llum %02llus", minutes, secs);
-    } else {
-        snprintf(buffer, len, "%llus", secs);
-    }
-    buffer[len - 1] = '\0';
+
+    char buf[CGROUP_FILE_BUFFER];
+    unsigned long long value = 0;
+    double elapsed = state->read_time > 0.0 ? now - state->read_time : 0.0;
+    unsigned int valid = 0;
+    if (read_events && entry->parent >= 0 && cgroup_read_file(dir_fd, "cgroup.events", buf, sizeof(buf)) > 0 &&
+        cgroup_keyed_value(buf, "populated", &value) == 0) {
+        entry->populated = value != 0;
+    }
+    if (cgroup_read_file(dir_fd, "cpu.stat", buf, sizeof(buf)) > 0 &&
+        cgroup_keyed_value(buf, "usage_usec", &value) == 0) {
+        entry->cpu_percent = cgroup_rate(value, state->usage_usec, elapsed,
+                                         state->read_valid & TASKS_CGROUP_CPU) / 1e6 * 100.0;
+        state->usage_usec = value;
+        valid |= TASKS_CGROUP_CPU;
+    }
+    if (cgroup_read_number(dir_fd, "memory.current", &value) == 0) {
+        entry->memory_bytes = value;
+        valid |= TASKS_CGROUP_MEMORY;
+    }
+    /* Empty until the group does its first I/O. */
+    if (cgroup_read_file(dir_fd, "io.stat", buf, sizeof(buf)) >= 0) {
+        unsigned long long read_bytes = 0;
+        unsigned long long write_bytes = 0;
+        cgroup_parse_io(buf, &read_bytes, &write_bytes);
+        int had_io = (state->read_valid & TASKS_CGROUP_IO) != 0;
+        entry->read_rate = cgroup_rate(read_bytes, state->read_bytes, elapsed, had_io);
+        entry->write_rate = cgroup_rate(write_bytes, state->write_bytes, elapsed, had_io);
+        state->read_bytes = read_bytes;
+        state->write_bytes = write_bytes;
+        valid |= TASKS_CGROUP_IO;
+    }
+    if (cgroup_read_number(dir_fd, "pids.current", &value) == 0) {
+        entry->pids = value;
+        valid |= TASKS_CGROUP_PIDS;
+    }
+    close(dir_fd);
+    state->read_valid = valid;
+    state->read_time = now;
+    state->stale = 0;
 }
 
-static void tasks_model_copy_string(char *dst, const char *src, size_t len, const char *fallback)
+/* Fills in the values a group has no file for from its children, deepest
+ * groups first (children always follow their parent). */
+static void cgroup_sum_children(void)
 {
-    if (!dst || len == 0) return;
-    if (src && src[0]) {
-        strncpy(dst, src, len - 1);
-        dst[len - 1] = '\0';
-        return;
-    }
-    if (fallback) {
-        strncpy(dst, fallback, len - 1);
-        dst[len - 1] = '\0';
-    } else {
-        dst[0] = '\0';
+    for (int i = 0; i < g_cgroup_count; ++i) {
+        TasksCgroupEntry *entry = &g_cgroups[i];
+        entry->valid = g_cgroup_states[i].read_valid;
+        entry->summed = 0;
+        if (!(entry->valid & TASKS_CGROUP_CPU)) entry->cpu_percent = 0.0;
+        if (!(entry->valid & TASKS_CGROUP_MEMORY)) entry->memory_bytes = 0;
+        if (!(entry->valid & TASKS_CGROUP_IO)) {
+            entry->read_rate = 0.0;
+            entry->write_rate = 0.0;
+        }
+        if (!(entry->valid & TASKS_CGROUP_PIDS)) entry->pids = 0;
+    }
+    for (int i = g_cgroup_count - 1; i > 0; --i) {
+        const TasksCgroupEntry *child = &g_cgroups[i];
+        TasksCgroupEntry *parent = &g_cgroups[child->parent];
+        unsigned int add = child->valid & ~g_cgroup_states[child->parent].read_valid;
+        if (add & TASKS_CGROUP_CPU) parent->cpu_percent += child->cpu_percent;
+        if (add & TASKS_CGROUP_MEMORY) parent->memory_bytes += child->memory_bytes;
+        if (add & TASKS_CGROUP_IO) {
+            parent->read_rate += child->read_rate;
+            parent->write_rate += child->write_rate;
+        }
+        if (add & TASKS_CGROUP_PIDS) parent->pids += child->pids;
+        parent->valid |= add;
+        parent->summed |= add;
     }
 }
 
-int tasks_model_list_users(TasksUserEntry **out_entries, int *out_count)
+static int cgroup_refresh(void)
 {
-    if (!out_entries || !out_count) return -1;
-    TasksUserEntry *entries = NULL;
-    int capacity = 0;
-    int count = 0;
-    int result = 0;
-
-    setutent();
-    struct utmp *ut = NULL;
-    while ((ut = getutent()) != NULL) {
-        if (ut->ut_type != USER_PROCESS) continue;
-        if (count >= capacity) {
-            int new_capacity = capacity ? capacity * 2 : 32;
-            TasksUserEntry *resized = (TasksUserEntry *)realloc(entries, sizeof(TasksUserEntry) * new_capacity);
-            if (!resized) {
-                result = -1;
-                break;
-            }
-            entries = resized;
-            capacity = new_capacity;
+    if (!g_cgroup_mount[0] && cgroup_find_mount() != 0) return -1;
+    if (g_cgroup_watch_state == WATCH_UNTRIED) {
+        g_cgroup_watch_state = file_watch_open(&g_cgroup_watch) == 0 ? WATCH_ACTIVE : WATCH_UNAVAILABLE;
+    }
+    if (g_cgroup_watch_state == WATCH_ACTIVE &&
+        file_watch_read_events(&g_cgroup_watch, cgroup_on_event, NULL) < 0) {
+        file_watch_close(&g_cgroup_watch);
+        g_cgroup_watch_state = WATCH_UNAVAILABLE;
+        g_cgroups_valid = 0;
+    }
+    if (!g_cgroups_valid && cgroup_walk() != 0) return -1;
+
+    double now = net_monotonic_seconds();
+    int sweep = !g_cgroups_valid || g_cgroup_sweep_time <= 0.0 || now - g_cgroup_sweep_time >= CGROUP_SWEEP_SECONDS;
+    if (sweep) g_cgroup_sweep_time = now;
+
+    /* Pre-order, so the parent's path is still at the front of the buffer. */
+    char path[PATH_MAX];
+    size_t lengths[CGROUP_MAX_DEPTH + 1];
+    for (int i = 0; i < g_cgroup_count; ++i) {
+        TasksCgroupEntry *entry = &g_cgroups[i];
+        size_t len = 0;
+        if (entry->parent < 0) {
+            len = (size_t)snprintf(path, sizeof(path), "%s", g_cgroup_mount);
+        } else {
+            size_t base = lengths[entry->depth - 1];
+            size_t name_len = strlen(entry->name);
+            path[base] = '/';
+            memcpy(path + base + 1, entry->name, name_len + 1);
+            len = base + 1 + name_len;
         }
-        TasksUserEntry *entry = &entries[count];
-        memset(entry, 0, sizeof(*entry));
-        tasks_model_copy_string(entry->user, ut->ut_user, sizeof(entry->user), TASKS_USER_UNKNOWN_TEXT);
-        tasks_model_copy_string(entry->tty, ut->ut_line, sizeof(entry->tty), TASKS_USER_UNKNOWN_TEXT);
-        tasks_model_copy_string(entry->host, ut->ut_host, sizeof(entry->host), TASKS_USER_LOCAL_TEXT);
-        time_t login_seconds = ut->ut_time;
-        tasks_model_format_login_time(entry->login_time, sizeof(entry->login_time), login_seconds);
-        long long idle_seconds = tasks_model_get_idle_seconds(ut->ut_line);
-        entry->idle_seconds = idle_seconds;
-        tasks_model_format_idle_time(entry->idle_time, sizeof(entry->idle_time), idle_seconds);
-        entry->pid = ut->ut_pid;
-        count++;
-    }
-    endutent();
-
-    if (result != 0) {
-        free(entries);
-        entries = NULL;
-        count = 0;
+        lengths[entry->depth] = len;
+        if (!sweep && !g_cgroup_states[i].stale && !entry->populated) {
+            entry->cpu_percent = 0.0;
+            entry->read_rate = 0.0;
+            entry->write_rate = 0.0;
+            continue;
+        }
+        cgroup_read_group(path, i, now, sweep || g_cgroup_states[i].stale);
     }
+    cgroup_sum_children();
+    return 0;
+}
 
+int tasks_model_list_cgroups(TasksCgroupEntry **out_entries, int *out_count)
+{
+    if (!out_entries || !out_count) return -1;
+    *out_entries = NULL;
+    *out_count = 0;
+    if (cgroup_refresh() != 0) return -1;
+    TasksCgroupEntry *entries =
+        (TasksCgroupEntry *)malloc(sizeof(TasksCgroupEntry) * (size_t)(g_cgroup_count ? g_cgroup_count : 1));
+    if (!entries) return -1;
+    if (g_cgroup_count > 0) memcpy(entries, g_cgroups, sizeof(TasksCgroupEntry) * (size_t)g_cgroup_count);
     *out_entries = entries;
-    *out_count = count;
-    return result;
+    *out_count = g_cgroup_count;
+    return 0;
 }
 
-void tasks_model_free_users(TasksUserEntry *entries, int count)
+void tasks_model_free_cgroups(TasksCgroupEntry *entries)
 {
-    (void)count;
     free(entries);
 }
 
+/* Returns path under the configured system root, formatted into buf if needed. */
+static const char *tasks_model_system_path(const char *path, char *buf, size_t buf_len)
+{
+    if (!g_system_root[0]) return path;
+    if (snprintf(buf, buf_len, "%s%s", g_system_root, path) >= (int)buf_len) buf[0] = '\0';
+    return buf;
+}
+
 static int tasks_model_path_exists(const char *path)
 {
     if (!path || path[0] == '\0') return 0;
@@ -621,6 +2427,159 @@ static void tasks_model_parse_init_info(const char *path, TasksServiceEntry *ent
     fclose(fp);
 }
 
+static unsigned int init_info_hash(const char *path)
+{
+    unsigned int hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)path; *p; ++p) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void init_info_clear(void)
+{
+    if (g_init_info_slots) {
+        memset(g_init_info_slots, 0, sizeof(int) * (size_t)g_init_info_slot_capacity);
+    }
+    g_init_info_count = 0;
+    g_init_info_paths_used = 0;
+}
+
+static void init_info_free(void)
+{
+    free(g_init_info);
+    free(g_init_info_slots);
+    free(g_init_info_paths);
+    g_init_info = NULL;
+    g_init_info_slots = NULL;
+    g_init_info_paths = NULL;
+    g_init_info_count = 0;
+    g_init_info_capacity = 0;
+    g_init_info_slot_capacity = 0;
+    g_init_info_paths_used = 0;
+    g_init_info_paths_capacity = 0;
+}
+
+static int init_info_grow_slots(void)
+{
+    int capacity = g_init_info_slot_capacity ? g_init_info_slot_capacity * 2 : 256;
+    int *slots = (int *)calloc((size_t)capacity, sizeof(int));
+    if (!slots) return -1;
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (int i = 0; i < g_init_info_count; ++i) {
+        unsigned int pos = g_init_info[i].hash & mask;
+        while (slots[pos]) pos = (pos + 1) & mask;
+        slots[pos] = i + 1;
+    }
+    free(g_init_info_slots);
+    g_init_info_slots = slots;
+    g_init_info_slot_capacity = capacity;
+    return 0;
+}
+
+/* Finds or adds the record for path; a new record has no stamp yet (ino 0). */
+static InitInfoRecord *init_info_lookup(const char *path)
+{
+    unsigned int hash = init_info_hash(path);
+    if (g_init_info_slot_capacity > 0) {
+        unsigned int mask = (unsigned int)g_init_info_slot_capacity - 1;
+        for (unsigned int pos = hash & mask; g_init_info_slots[pos]; pos = (pos + 1) & mask) {
+            InitInfoRecord *record = &g_init_info[g_init_info_slots[pos] - 1];
+            if (record->hash == hash && strcmp(g_init_info_paths + record->path, path) == 0) return record;
+        }
+    }
+
+    if ((g_init_info_count + 1) * 2 > g_init_info_slot_capacity && init_info_grow_slots() != 0) return NULL;
+    if (g_init_info_count >= g_init_info_capacity) {
+        int capacity = g_init_info_capacity ? g_init_info_capacity * 2 : 64;
+        InitInfoRecord *records = (InitInfoRecord *)realloc(g_init_info, sizeof(InitInfoRecord) * (size_t)capacity);
+        if (!records) return NULL;
+        g_init_info = records;
+        g_init_info_capacity = capacity;
+    }
+    size_t len = strlen(path) + 1;
+    if (g_init_info_paths_used + len > g_init_info_paths_capacity) {
+        size_t capacity = g_init_info_paths_capacity ? g_init_info_paths_capacity * 2 : 8192;
+        while (capacity < g_init_info_paths_used + len) capacity *= 2;
+        char *paths = (char *)realloc(g_init_info_paths, capacity);
+        if (!paths) return NULL;
+        g_init_info_paths = paths;
+        g_init_info_paths_capacity = capacity;
+    }
+    memcpy(g_init_info_paths + g_init_info_paths_used, path, len);
+
+    InitInfoRecord *record = &g_init_info[g_init_info_count];
+    memset(record, 0, offsetof(InitInfoRecord, info_fields));
+    record->hash = hash;
+    record->path = (unsigned int)g_init_info_paths_used;
+    g_init_info_paths_used += len;
+    unsigned int mask = (unsigned int)g_init_info_slot_capacity - 1;
+    unsigned int pos = hash & mask;
+    while (g_init_info_slots[pos]) pos = (pos + 1) & mask;
+    g_init_info_slots[pos] = ++g_init_info_count;
+    return record;
+}
+
+/* Fills in the LSB header fields of entry->filename_path, parsing the
+ * script only if it is new or changed since it was last parsed. */
+static void tasks_model_load_init_info(TasksServiceEntry *entry)
+{
+    struct stat st;
+    if (stat(entry->filename_path, &st) != 0) return;
+    ServiceFileStamp stamp;
+    memset(&stamp, 0, sizeof(stamp));
+    stamp.dev = st.st_dev;
+    stamp.ino = st.st_ino;
+    stamp.size = st.st_size;
+    stamp.mtime_ns = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+
+    InitInfoRecord *record = init_info_lookup(entry->filename_path);
+    if (!record) {
+        tasks_model_parse_init_info(entry->filename_path, entry);
+        return;
+    }
+    record->walk = g_init_info_walk;
+    if (record->stamp.ino == 0 || memcmp(&record->stamp, &stamp, sizeof(stamp)) != 0) {
+        tasks_model_parse_init_info(entry->filename_path, entry);
+        record->stamp = stamp;
+        record->info_count = entry->info_count;
+        memcpy(record->info_fields, entry->info_fields, sizeof(TasksServiceInfoField) * (size_t)entry->info_count);
+        return;
+    }
+    entry->info_count = record->info_count;
+    memcpy(entry->info_fields, record->info_fields, sizeof(TasksServiceInfoField) * (size_t)record->info_count);
+}
+
+/* Drops the parsed headers once most of them belong to scripts that are gone. */
+static void init_info_prune(void)
+{
+    int used = 0;
+    for (int i = 0; i < g_init_info_count; ++i) {
+        if (g_init_info[i].walk == g_init_info_walk) used++;
+    }
+    if (g_init_info_count - used > used) init_info_clear();
+}
+
+static void tasks_model_watch_service_path(const char *path)
+{
+    if (g_service_watch_state != WATCH_ACTIVE) return;
+    /* Paths that do not exist are not read either; a change elsewhere will
+     * still show up through the directories that are watched. */
+    if (file_watch_add(&g_service_watch, path) != 0 && errno != ENOENT) g_service_watch_complete = 0;
+}
+
+static void tasks_model_reset_services(void)
+{
+    file_watch_close(&g_service_watch);
+    g_service_watch_state = WATCH_UNTRIED;
+    g_service_watch_complete = 0;
+    free(g_services);
+    g_services = NULL;
+    g_service_count = 0;
+    g_services_valid = 0;
+}
+
 static void tasks_model_set_service_path(char *dest, size_t dest_len, const char *path)
 {
     if (!dest || dest_len == 0) return;
@@ -640,7 +2599,7 @@ static void tasks_model_resolve_symlink_path(const char *dir, const char *link_t
     if (!link_target || !link_target[0]) return;
     char combined[PATH_MAX];
     if (link_target[0] == '/') {
-        snprintf(combined, sizeof(combined), "%s", link_target);
+        snprintf(combined, sizeof(combined), "%s%s", g_system_root, link_target);
     } else if (dir && dir[0]) {
         snprintf(combined, sizeof(combined), "%s/%s", dir, link_target);
     } else {
@@ -718,9 +2677,11 @@ static int tasks_model_get_runlevel(char *out_level, size_t out_len)
 
 static int tasks_model_is_systemd(void)
 {
-    if (tasks_model_path_exists("/run/systemd/system")) return 1;
+    char path[PATH_MAX];
+    if (tasks_model_path_exists(tasks_model_system_path("/run/systemd/system", path, sizeof(path)))) return 1;
     char comm[64] = {0};
-    if (tasks_model_read_file_line("/proc/1/comm", comm, sizeof(comm)) == 0) {
+    int len = snprintf(path, sizeof(path), "%s/1/comm", g_proc_root[0] ? g_proc_root : "/proc");
+    if (len < (int)sizeof(path) && tasks_model_read_file_line(path, comm, sizeof(comm)) == 0) {
         if (strcmp(comm, "systemd") == 0) return 1;
     }
     return 0;
@@ -736,9 +2697,10 @@ static void tasks_model_detect_systemd_target(TasksInitInfo *info)
         "/lib/systemd/system/default.target",
     };
     char linkbuf[PATH_MAX] = {0};
+    char path[PATH_MAX];
     const char *base = NULL;
     for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i) {
-        ssize_t len = readlink(paths[i], linkbuf, sizeof(linkbuf) - 1);
+        ssize_t len = readlink(tasks_model_system_path(paths[i], path, sizeof(path)), linkbuf, sizeof(linkbuf) - 1);
         if (len <= 0) continue;
         linkbuf[len] = '\0';
         base = strrchr(linkbuf, '/');
@@ -801,6 +2763,7 @@ static void tasks_model_collect_systemd_dir(const char *dir, int running,
                                             SystemdServiceInfo **items, int *count, int *cap)
 {
     if (!dir || !items || !count || !cap) return;
+    tasks_model_watch_service_path(dir);
     DIR *dp = opendir(dir);
     if (!dp) return;
     struct dirent *ent = NULL;
@@ -818,7 +2781,9 @@ static void tasks_model_collect_systemd_dir(const char *dir, int running,
 
 static void tasks_model_collect_systemd_enabled(SystemdServiceInfo **items, int *count, int *cap)
 {
-    const char *base = "/etc/systemd/system";
+    char base_buf[PATH_MAX];
+    const char *base = tasks_model_system_path("/etc/systemd/system", base_buf, sizeof(base_buf));
+    tasks_model_watch_service_path(base);
     DIR *dp = opendir(base);
     if (!dp) return;
     struct dirent *ent = NULL;
@@ -827,7 +2792,8 @@ static void tasks_model_collect_systemd_enabled(SystemdServiceInfo **items, int
         size_t len = strlen(ent->d_name);
         if (len < 6 || strcmp(ent->d_name + (len - 6), ".wants") != 0) continue;
         char wants_dir[PATH_MAX];
-        snprintf(wants_dir, sizeof(wants_dir), "%s/%s", base, ent->d_name);
+        if (snprintf(wants_dir, sizeof(wants_dir), "%s/%s", base, ent->d_name) >= (int)sizeof(wants_dir)) continue;
+        tasks_model_watch_service_path(wants_dir);
         DIR *wdp = opendir(wants_dir);
         if (!wdp) continue;
         struct dirent *went = NULL;
@@ -872,10 +2838,18 @@ static int tasks_model_list_systemd_services(TasksServiceEntry **out_entries, in
     SystemdServiceInfo *items = NULL;
     int count = 0;
     int cap = 0;
-    tasks_model_collect_systemd_dir("/run/systemd/system", 1, &items, &count, &cap);
-    tasks_model_collect_systemd_dir("/etc/systemd/system", 0, &items, &count, &cap);
-    tasks_model_collect_systemd_dir("/usr/lib/systemd/system", 0, &items, &count, &cap);
-    tasks_model_collect_systemd_dir("/lib/systemd/system", 0, &items, &count, &cap);
+    static const char *const dirs[] = {
+        "/run/systemd/system",
+        "/etc/systemd/system",
+        "/usr/lib/systemd/system",
+        "/lib/systemd/system",
+    };
+    char dir[PATH_MAX];
+    for (size_t i = 0; i < sizeof(dirs) / sizeof(dirs[0]); ++i) {
+        /* Units under /run are the ones currently loaded. */
+        tasks_model_collect_systemd_dir(tasks_model_system_path(dirs[i], dir, sizeof(dir)), i == 0,
+                                        &items, &count, &cap);
+    }
     tasks_model_collect_systemd_enabled(&items, &count, &cap);
 
     if (count > 1) {
@@ -922,13 +2896,20 @@ static int tasks_model_list_sysv_services(TasksServiceEntry **out_entries, int *
 
     char rc_dir[PATH_MAX] = {0};
     if (runlevel[0]) {
-        snprintf(rc_dir, sizeof(rc_dir), "/etc/rc%s.d", runlevel);
-        if (!tasks_model_is_dir(rc_dir)) {
-            snprintf(rc_dir, sizeof(rc_dir), "/etc/rc.d/rc%s.d", runlevel);
+        int len = snprintf(rc_dir, sizeof(rc_dir), "%s/etc/rc%s.d", g_system_root, runlevel);
+        if (len >= (int)sizeof(rc_dir) || !tasks_model_is_dir(rc_dir)) {
+            len = snprintf(rc_dir, sizeof(rc_dir), "%s/etc/rc.d/rc%s.d", g_system_root, runlevel);
+            if (len >= (int)sizeof(rc_dir)) rc_dir[0] = '\0';
         }
     }
     int have_rc = runlevel[0] && tasks_model_is_dir(rc_dir);
-    const char *fallback_dir = tasks_model_is_dir("/etc/init.d") ? "/etc/init.d" : NULL;
+    char init_dir[PATH_MAX];
+    const char *init_path = tasks_model_system_path("/etc/init.d", init_dir, sizeof(init_dir));
+    const char *fallback_dir = tasks_model_is_dir(init_path) ? init_path : NULL;
+    /* The run level comes from utmp; rc.d links point into init.d. */
+    tasks_model_watch_service_path(g_utmp_path[0] ? g_utmp_path : _PATH_UTMP);
+    if (have_rc) tasks_model_watch_service_path(rc_dir);
+    if (fallback_dir) tasks_model_watch_service_path(fallback_dir);
 
     TasksServiceEntry *entries = NULL;
     int count = 0;
@@ -983,12 +2964,14 @@ static int tasks_model_list_sysv_services(TasksServiceEntry **out_entries, int *
                                                      entry->filename_path, sizeof(entry->filename_path));
                 } else if (fallback_dir) {
                     char script_path[PATH_MAX];
-                    snprintf(script_path, sizeof(script_path), "%s/%s", fallback_dir, entry->name);
-                    script_path[sizeof(script_path) - 1] = '\0';
-                    tasks_model_set_service_path(entry->filename_path, sizeof(entry->filename_path), script_path);
+                    if (snprintf(script_path, sizeof(script_path), "%s/%s", fallback_dir, entry->name) <
+                        (int)sizeof(script_path)) {
+                        tasks_model_set_service_path(entry->filename_path, sizeof(entry->filename_path),
+                                                     script_path);
+                    }
                 }
                 if (entry->filename_path[0]) {
-                    tasks_model_parse_init_info(entry->filename_path, entry);
+                    tasks_model_load_init_info(entry);
                 }
 
                 if (enabled_count >= enabled_cap) {
@@ -1011,8 +2994,10 @@ static int tasks_model_list_sysv_services(TasksServiceEntry **out_entries, int *
             while ((ent = readdir(dp)) != NULL) {
                 if (ent->d_name[0] == '.') continue;
                 char script_path[PATH_MAX];
-                snprintf(script_path, sizeof(script_path), "%s/%s", fallback_dir, ent->d_name);
-                script_path[sizeof(script_path) - 1] = '\0';
+                if (snprintf(script_path, sizeof(script_path), "%s/%s", fallback_dir, ent->d_name) >=
+                    (int)sizeof(script_path)) {
+                    continue;
+                }
 
                 struct stat st = {0};
                 if (stat(script_path, &st) != 0) continue;
@@ -1040,7 +3025,7 @@ static int tasks_model_list_sysv_services(TasksServiceEntry **out_entries, int *
                 snprintf(entry->state, sizeof(entry->state), "disabled");
                 tasks_model_set_service_path(entry->filename_path, sizeof(entry->filename_path), script_path);
                 entry->symlink_path[0] = '\0';
-                tasks_model_parse_init_info(entry->filename_path, entry);
+                tasks_model_load_init_info(entry);
             }
             closedir(dp);
         }
@@ -1065,7 +3050,9 @@ static int tasks_model_list_bsd_services(TasksServiceEntry **out_entries, int *o
     if (!out_entries || !out_count) return -1;
     tasks_model_set_init_info(info, "bsd rc", NULL);
 
-    const char *dir = "/etc/rc.d";
+    char dir_buf[PATH_MAX];
+    const char *dir = tasks_model_system_path("/etc/rc.d", dir_buf, sizeof(dir_buf));
+    tasks_model_watch_service_path(dir);
     if (!tasks_model_is_dir(dir)) {
         *out_entries = NULL;
         *out_count = 0;
@@ -1096,10 +3083,10 @@ static int tasks_model_list_bsd_services(TasksServiceEntry **out_entries, int *o
         entry->state[0] = '\0';
         tasks_model_safe_copy(entry->name, sizeof(entry->name), ent->d_name);
         char script_path[PATH_MAX];
-        snprintf(script_path, sizeof(script_path), "%s/%s", dir, ent->d_name);
-        script_path[sizeof(script_path) - 1] = '\0';
-        tasks_model_set_service_path(entry->filename_path, sizeof(entry->filename_path), script_path);
-        tasks_model_parse_init_info(entry->filename_path, entry);
+        if (snprintf(script_path, sizeof(script_path), "%s/%s", dir, ent->d_name) < (int)sizeof(script_path)) {
+            tasks_model_set_service_path(entry->filename_path, sizeof(entry->filename_path), script_path);
+            tasks_model_load_init_info(entry);
+        }
     }
     closedir(dp);
 
@@ -1111,10 +3098,9 @@ static int tasks_model_list_bsd_services(TasksServiceEntry **out_entries, int *o
     return 0;
 }
 
-int tasks_model_list_services(TasksServiceEntry **out_entries, int *out_count, TasksInitInfo *out_info,
-                              int include_disabled_sysv)
+static int tasks_model_walk_services(TasksServiceEntry **out_entries, int *out_count, TasksInitInfo *out_info,
+                                     int include_disabled_sysv)
 {
-    if (!out_entries || !out_count) return -1;
     if (out_info) {
         out_info->init_name[0] = '\0';
         out_info->init_detail[0] = '\0';
@@ -1122,12 +3108,78 @@ int tasks_model_list_services(TasksServiceEntry **out_entries, int *out_count, T
     if (tasks_model_is_systemd()) {
         return tasks_model_list_systemd_services(out_entries, out_count, out_info);
     }
-    if (tasks_model_is_dir("/etc/rc.d") && tasks_model_path_exists("/etc/rc.conf")) {
+    char rc_d[PATH_MAX];
+    char rc_conf[PATH_MAX];
+    if (tasks_model_is_dir(tasks_model_system_path("/etc/rc.d", rc_d, sizeof(rc_d))) &&
+        tasks_model_path_exists(tasks_model_system_path("/etc/rc.conf", rc_conf, sizeof(rc_conf)))) {
         return tasks_model_list_bsd_services(out_entries, out_count, out_info);
     }
     return tasks_model_list_sysv_services(out_entries, out_count, out_info, include_disabled_sysv);
 }
 
+static int tasks_model_copy_services(TasksServiceEntry **out_entries, int *out_count, TasksInitInfo *out_info)
+{
+    TasksServiceEntry *entries = NULL;
+    if (g_service_count > 0) {
+        entries = (TasksServiceEntry *)malloc(sizeof(TasksServiceEntry) * (size_t)g_service_count);
+        if (!entries) return -1;
+        memcpy(entries, g_services, sizeof(TasksServiceEntry) * (size_t)g_service_count);
+    }
+    *out_entries = entries;
+    *out_count = g_service_count;
+    if (out_info) *out_info = g_services_info;
+    return 0;
+}
+
+int tasks_model_list_services(TasksServiceEntry **out_entries, int *out_count, TasksInitInfo *out_info,
+                              int include_disabled_sysv)
+{
+    if (!out_entries || !out_count) return -1;
+    if (g_service_watch_state == WATCH_UNTRIED) {
+        g_service_watch_state = (file_watch_open(&g_service_watch) == 0) ? WATCH_ACTIVE
+                                                                         : WATCH_UNAVAILABLE;
+        g_services_valid = 0;
+    }
+    int changed = 1;
+    if (g_service_watch_state == WATCH_ACTIVE) {
+        /* Drained before the walk, so changes made during it are seen next time. */
+        changed = file_watch_changed(&g_service_watch);
+        if (changed < 0) {
+            file_watch_close(&g_service_watch);
+            g_service_watch_state = WATCH_UNAVAILABLE;
+            changed = 1;
+        }
+    }
+    if (!changed && g_services_valid && g_service_watch_complete &&
+        g_services_include_disabled == include_disabled_sysv) {
+        *out_entries = NULL;
+        *out_count = 0;
+        if (out_info) *out_info = g_services_info;
+        return 1;
+    }
+
+    g_service_watch_complete = (g_service_watch_state == WATCH_ACTIVE);
+    g_init_info_walk++;
+    TasksServiceEntry *entries = NULL;
+    int count = 0;
+    TasksInitInfo info;
+    memset(&info, 0, sizeof(info));
+    int rc = tasks_model_walk_services(&entries, &count, &info, include_disabled_sysv);
+    init_info_prune();
+    if (rc != 0) {
+        g_services_valid = 0;
+        return rc;
+    }
+    free(g_services);
+    g_services = entries;
+    g_service_count = entries ? count : 0;
+    g_services_info = info;
+    g_services_include_disabled = include_disabled_sysv;
+    /* A listing the caller never got must not be reported as unchanged. */
+    g_services_valid = (tasks_model_copy_services(out_entries, out_count, out_info) == 0);
+    return g_services_valid ? 0 : -1;
+}
+
 void tasks_model_free_services(TasksServiceEntry *entries, int count)
 {
     (void)count;
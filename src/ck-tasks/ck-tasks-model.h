@@ -4,15 +4,85 @@
 #include <sys/types.h>
 #include <limits.h>
 
+/*
+ * One process scan, stored column by column. Names and user names are
+ * interned into the list's string arena (offsets, so the arena can grow).
+ * The command line is not read during the scan; tasks_model_process_command()
+ * loads it on first use and caches it in a separate arena, so name and user
+ * pointers stay valid while commands are being loaded.
+ */
+typedef struct {
+    int count;
+    int capacity;
+    pid_t *pids;
+    double *cpu_percent;
+    double *memory_mb;
+    int *threads;
+    unsigned int *name_offsets;
+    unsigned int *user_offsets;
+    unsigned int *command_offsets; /* into commands; TASKS_PROCESS_NO_STRING until loaded */
+    char *strings;
+    size_t strings_used;
+    size_t strings_capacity;
+    char *commands;
+    size_t commands_used;
+    size_t commands_capacity;
+    unsigned int root_offset;      /* proc root the list was read from */
+} TasksProcessList;
+
+#define TASKS_PROCESS_NO_STRING 0xffffffffu
+
+/* Rows of a process list in display order (filtered); rows index the list. */
+typedef struct {
+    TasksProcessList *list;
+    int *rows;
+    int count;
+    int capacity;
+} TasksProcessView;
+
+/* Fields compared by tasks_model_diff_processes (bits in TasksProcessDiff.changed_fields). */
+enum {
+    TASKS_PROCESS_FIELD_NAME = 1 << 0,
+    TASKS_PROCESS_FIELD_CPU = 1 << 1,
+    TASKS_PROCESS_FIELD_MEMORY = 1 << 2,
+    TASKS_PROCESS_FIELD_THREADS = 1 << 3,
+    TASKS_PROCESS_FIELD_USER = 1 << 4,
+};
+
+/* Difference between two process views, matched by pid. Arrays are owned by
+ * the diff and reused by the next tasks_model_diff_processes call. */
+typedef struct {
+    int *old_to_new;              /* per old row: index in the new view, or -1 if gone */
+    int old_count;
+    int *added;                   /* new view indices without an old row */
+    int added_count;
+    int *changed;                 /* new view indices whose fields differ */
+    unsigned int *changed_fields; /* TASKS_PROCESS_FIELD_* mask per changed entry */
+    int changed_count;
+    int *pid_slots;
+    int pid_slot_capacity;
+    int old_capacity;
+    int new_capacity;
+} TasksProcessDiff;
+
+/* Bits of TasksProcessDetails.valid. */
+enum {
+    TASKS_DETAIL_PSS = 1 << 0,
+    TASKS_DETAIL_IO = 1 << 1,
+    TASKS_DETAIL_FDS = 1 << 2,
+};
+
+/* Per-process values read on demand (see tasks_model_read_process_details). */
 typedef struct {
-    char name[64];
     pid_t pid;
-    double cpu_percent;
-    double memory_mb;
-    int threads;
-    char user[32];
-    char command[PATH_MAX];
-} TasksProcessEntry;
+    unsigned int valid; /* TASKS_DETAIL_* that could be read */
+    unsigned long long pss_kb;
+    unsigned long long read_bytes;
+    unsigned long long write_bytes;
+    int fd_count;
+} TasksProcessDetails;
+
+typedef struct TasksCpuHistory TasksCpuHistory;
 
 typedef struct {
     int cpu_percent;
@@ -34,6 +104,53 @@ typedef struct {
     pid_t pid;
 } TasksUserEntry;
 
+typedef struct {
+    char name[32];
+    unsigned long long rx_bytes;
+    unsigned long long tx_bytes;
+    double rx_rate;   /* bytes per second since the previous refresh */
+    double tx_rate;
+} TasksNetInterface;
+
+typedef struct {
+    char protocol[8]; /* tcp, tcp6, udp, udp6 */
+    char local[64];
+    char remote[64];
+    char state[16];
+    uid_t uid;
+    unsigned long inode;
+    pid_t pid;        /* 0 if the owning process is unknown (or not readable) */
+    char process[64];
+} TasksNetSocket;
+
+/* Bits of TasksCgroupEntry.valid and .summed. */
+enum {
+    TASKS_CGROUP_CPU = 1 << 0,
+    TASKS_CGROUP_MEMORY = 1 << 1,
+    TASKS_CGROUP_IO = 1 << 2,
+    TASKS_CGROUP_PIDS = 1 << 3,
+};
+
+/*
+ * One cgroup v2 group. The kernel counts every value over the whole
+ * subtree, so a slice's row already includes its children. A group that
+ * has no file for a value (memory.current at the root, or a controller the
+ * parent did not enable) gets the sum of its children's values instead.
+ */
+typedef struct {
+    char name[256];              /* directory name; "/" for the root */
+    int parent;                  /* index of the parent entry, -1 for the root */
+    int depth;
+    int populated;               /* processes in the group or below */
+    unsigned int valid;          /* TASKS_CGROUP_* values present */
+    unsigned int summed;         /* those of them summed from the children */
+    double cpu_percent;          /* of one CPU, since the previous refresh */
+    double read_rate;            /* bytes per second since the previous refresh */
+    double write_rate;
+    unsigned long long memory_bytes;
+    unsigned long long pids;
+} TasksCgroupEntry;
+
 typedef struct {
     char init_name[64];
     char init_detail[64];
@@ -58,12 +175,63 @@ typedef struct {
 
 void tasks_model_initialize(void);
 void tasks_model_shutdown(void);
+/* Read processes from another proc tree (NULL or "" = /proc); used by the benchmark. */
+int tasks_model_set_proc_root(const char *root);
+/* Prefix for the /etc, /run and /lib trees read by tasks_model_list_services()
+ * (NULL or "" = the real root). */
+int tasks_model_set_system_root(const char *root);
+/* utmp file read by tasks_model_list_users() (NULL or "" = the system default). */
+int tasks_model_set_utmp_path(const char *path);
+/* cgroup v2 mount read by tasks_model_list_cgroups() (NULL or "" = /sys/fs/cgroup). */
+int tasks_model_set_cgroup_root(const char *root);
 
-int tasks_model_list_processes(TasksProcessEntry **out_entries, int *out_count);
-void tasks_model_free_processes(TasksProcessEntry *entries, int count);
+int tasks_model_list_processes(TasksProcessList **out_list);
+void tasks_model_free_processes(TasksProcessList *list);
+/* Empty list for rows that were not scanned here (e.g. received from a remote
+ * agent). Appended strings are copied, not interned, and touch no model
+ * state, so any thread may build such a list. A NULL command is loaded from
+ * the local proc tree on first use, like a scanned row. */
+TasksProcessList *tasks_model_new_processes(int capacity);
+int tasks_model_append_process(TasksProcessList *list, pid_t pid, const char *name, const char *user,
+                               const char *command, double cpu_percent, double memory_mb, int threads);
+const char *tasks_model_process_name(const TasksProcessList *list, int index);
+const char *tasks_model_process_user(const TasksProcessList *list, int index);
+/* Reads <root>/<pid>/cmdline on first use (falls back to the name); the result
+ * is cached in the list, so only the thread that owns the list may call this. */
+const char *tasks_model_process_command(TasksProcessList *list, int index);
+/* Proc root the list was read from ("" = /proc). */
+const char *tasks_model_process_root(const TasksProcessList *list);
+/* Reads PSS, I/O byte counters and the open fd count of one process. Touches
+ * no model state, so it may run on any thread. Returns -1 if the process is
+ * gone or none of the values are readable. */
+int tasks_model_read_process_details(const char *proc_root, pid_t pid, TasksProcessDetails *out);
+/* Makes room for count rows; returns 0 on success. */
+int tasks_model_reserve_process_view(TasksProcessView *view, int count);
+void tasks_model_free_process_view(TasksProcessView *view);
+int tasks_model_diff_processes(const TasksProcessView *old_view, const TasksProcessView *new_view,
+                               TasksProcessDiff *diff);
+void tasks_model_free_process_diff(TasksProcessDiff *diff);
+/* Also appends a sample to the CPU history. */
 int tasks_model_get_system_stats(TasksSystemStats *out_stats);
+/* Overall and per-core usage, one sample per tasks_model_get_system_stats call.
+ * Safe to read from another thread; valid until tasks_model_shutdown(). */
+const TasksCpuHistory *tasks_model_get_cpu_history(void);
+/* Sessions are re-read only when utmp changes; idle times advance from
+ * terminal access times that are re-checked every few seconds. */
 int tasks_model_list_users(TasksUserEntry **out_entries, int *out_count);
 void tasks_model_free_users(TasksUserEntry *entries, int count);
+int tasks_model_list_network(TasksNetInterface **out_interfaces, int *out_interface_count,
+                             TasksNetSocket **out_sockets, int *out_socket_count);
+void tasks_model_free_network(TasksNetInterface *interfaces, TasksNetSocket *sockets);
+/* Entries come in tree order: each group before its children, siblings by
+ * name. The tree is walked again only when a group is created or removed;
+ * groups without processes are re-read only when their cgroup.events (or
+ * another of their files) changes, and otherwise every half minute. */
+int tasks_model_list_cgroups(TasksCgroupEntry **out_entries, int *out_count);
+void tasks_model_free_cgroups(TasksCgroupEntry *entries);
+/* Returns 0 with a fresh listing, or 1 with no entries (and the same
+ * out_info) while none of the watched service directories (and, for sysv,
+ * utmp) changed since the listing the previous call returned. */
 int tasks_model_list_services(TasksServiceEntry **out_entries, int *out_count, TasksInitInfo *out_info,
                               int include_disabled_sysv);
 void tasks_model_free_services(TasksServiceEntry *entries, int count);
@@ -0,0 +1,262 @@
+#include "ck-tasks-remote.h"
+#include "ck-tasks-wire.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+struct TasksRemote {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    int wake_read_fd;
+    int wake_write_fd;
+    char address[512];
+    int socket_fd;          /* -1 until connected; shut down by destroy */
+    TasksRemoteState state;
+    char message[256];
+    TasksSnapshot pending;
+    int pending_valid;
+    TasksSnapshot held;
+    int held_valid;
+    unsigned long sequence;
+    int stopping;
+    int finished;
+};
+
+static void tasks_remote_notify(TasksRemote *remote)
+{
+    char byte = 1;
+    ssize_t rc;
+    do {
+        rc = write(remote->wake_write_fd, &byte, 1);
+    } while (rc < 0 && errno == EINTR);
+    /* EAGAIN means a wakeup is already pending. */
+}
+
+static void tasks_remote_free(TasksRemote *remote)
+{
+    tasks_snapshot_clear(&remote->pending);
+    tasks_snapshot_clear(&remote->held);
+    if (remote->socket_fd >= 0) close(remote->socket_fd);
+    if (remote->wake_read_fd >= 0) close(remote->wake_read_fd);
+    if (remote->wake_write_fd >= 0) close(remote->wake_write_fd);
+    pthread_mutex_destroy(&remote->lock);
+    free(remote);
+}
+
+static void tasks_remote_set_state(TasksRemote *remote, TasksRemoteState state, const char *message)
+{
+    pthread_mutex_lock(&remote->lock);
+    remote->state = state;
+    snprintf(remote->message, sizeof(remote->message), "%s", message ? message : "");
+    pthread_mutex_unlock(&remote->lock);
+    tasks_remote_notify(remote);
+}
+
+static int read_full(int fd, unsigned char *buffer, size_t len)
+{
+    size_t done = 0;
+    while (done < len) {
+        ssize_t rc = read(fd, buffer + done, len - done);
+        if (rc < 0 && errno == EINTR) continue;
+        if (rc <= 0) return -1;
+        done += (size_t)rc;
+    }
+    return 0;
+}
+
+/* Reads frames until the connection ends; returns an error message. */
+static const char *tasks_remote_read_frames(TasksRemote *remote, int fd, TasksWireDecoder *decoder)
+{
+    unsigned char *frame = NULL;
+    size_t frame_capacity = 0;
+    const char *failure = NULL;
+    int hello_seen = 0;
+    while (!failure) {
+        unsigned char header[4];
+        if (read_full(fd, header, sizeof(header)) != 0) {
+            failure = "connection closed";
+            break;
+        }
+        size_t length = ((size_t)header[0] << 24) | ((size_t)header[1] << 16) | ((size_t)header[2] << 8) |
+                        (size_t)header[3];
+        if (length == 0 || length > TASKS_WIRE_MAX_FRAME) {
+            failure = "invalid frame from agent";
+            break;
+        }
+        if (length > frame_capacity) {
+            unsigned char *resized = (unsigned char *)realloc(frame, length);
+            if (!resized) {
+                failure = "out of memory";
+                break;
+            }
+            frame = resized;
+            frame_capacity = length;
+        }
+        if (read_full(fd, frame, length) != 0) {
+            failure = "connection closed";
+            break;
+        }
+
+        TasksSnapshot snapshot;
+        memset(&snapshot, 0, sizeof(snapshot));
+        char host[256] = "";
+        int type = tasks_wire_decode_frame(decoder, frame, length, &snapshot.stats, &snapshot.processes,
+                                           host, sizeof(host));
+        if (type == TASKS_WIRE_HELLO) {
+            hello_seen = 1;
+            tasks_remote_set_state(remote, TASKS_REMOTE_CONNECTED, host);
+        } else if (type == TASKS_WIRE_SNAPSHOT && hello_seen) {
+            snapshot.sources = TASKS_SOURCE_STATS | TASKS_SOURCE_PROCESSES;
+            snapshot.stats_ok = 1;
+            snapshot.processes_ok = 1;
+            pthread_mutex_lock(&remote->lock);
+            if (remote->stopping) {
+                pthread_mutex_unlock(&remote->lock);
+                tasks_snapshot_clear(&snapshot);
+                break;
+            }
+            /* An undelivered older snapshot is stale by now. */
+            tasks_snapshot_clear(&remote->pending);
+            snapshot.sequence = ++remote->sequence;
+            remote->pending = snapshot;
+            remote->pending_valid = 1;
+            pthread_mutex_unlock(&remote->lock);
+            tasks_remote_notify(remote);
+        } else {
+            tasks_snapshot_clear(&snapshot);
+            failure = hello_seen ? "invalid frame from agent" : "not a ck-tasks agent";
+        }
+    }
+    free(frame);
+    return failure;
+}
+
+static void *tasks_remote_main(void *arg)
+{
+    TasksRemote *remote = arg;
+    char error[256];
+    int fd = tasks_wire_connect(remote->address, error, sizeof(error));
+    pthread_mutex_lock(&remote->lock);
+    int stopping = remote->stopping;
+    if (!stopping) remote->socket_fd = fd;
+    pthread_mutex_unlock(&remote->lock);
+
+    if (stopping) {
+        if (fd >= 0) close(fd);
+    } else if (fd < 0) {
+        tasks_remote_set_state(remote, TASKS_REMOTE_FAILED, error);
+    } else {
+        TasksWireDecoder *decoder = tasks_wire_decoder_create();
+        const char *failure = decoder ? tasks_remote_read_frames(remote, fd, decoder) : "out of memory";
+        tasks_wire_decoder_destroy(decoder);
+        if (failure) tasks_remote_set_state(remote, TASKS_REMOTE_FAILED, failure);
+    }
+
+    /* Until destroy is called the UI may still read the state and hold a
+     * snapshot, so whichever of the two comes last frees the remote. */
+    pthread_mutex_lock(&remote->lock);
+    remote->finished = 1;
+    int free_here = remote->stopping;
+    pthread_mutex_unlock(&remote->lock);
+    if (free_here) tasks_remote_free(remote);
+    return NULL;
+}
+
+TasksRemote *tasks_remote_create(const char *address)
+{
+    if (!address || !*address) return NULL;
+    TasksRemote *remote = (TasksRemote *)calloc(1, sizeof(TasksRemote));
+    if (!remote) return NULL;
+    remote->wake_read_fd = -1;
+    remote->wake_write_fd = -1;
+    remote->socket_fd = -1;
+    remote->state = TASKS_REMOTE_CONNECTING;
+    snprintf(remote->address, sizeof(remote->address), "%s", address);
+    snprintf(remote->message, sizeof(remote->message), "%s", address);
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        free(remote);
+        return NULL;
+    }
+    for (int i = 0; i < 2; ++i) {
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+    }
+    remote->wake_read_fd = fds[0];
+    remote->wake_write_fd = fds[1];
+    pthread_mutex_init(&remote->lock, NULL);
+
+    if (pthread_create(&remote->thread, NULL, tasks_remote_main, remote) != 0) {
+        tasks_remote_free(remote);
+        return NULL;
+    }
+    return remote;
+}
+
+int tasks_remote_get_fd(TasksRemote *remote)
+{
+    return remote ? remote->wake_read_fd : -1;
+}
+
+TasksRemoteState tasks_remote_get_state(TasksRemote *remote, char *message, size_t message_len)
+{
+    if (!remote) return TASKS_REMOTE_FAILED;
+    pthread_mutex_lock(&remote->lock);
+    TasksRemoteState state = remote->state;
+    if (message && message_len > 0) snprintf(message, message_len, "%s", remote->message);
+    pthread_mutex_unlock(&remote->lock);
+    return state;
+}
+
+TasksSnapshot *tasks_remote_acquire(TasksRemote *remote)
+{
+    if (!remote) return NULL;
+    char drain[64];
+    while (read(remote->wake_read_fd, drain, sizeof(drain)) > 0) {
+    }
+    TasksSnapshot *snapshot = NULL;
+    pthread_mutex_lock(&remote->lock);
+    if (!remote->held_valid && remote->pending_valid) {
+        remote->held = remote->pending;
+        remote->held_valid = 1;
+        memset(&remote->pending, 0, sizeof(remote->pending));
+        remote->pending_valid = 0;
+        snapshot = &remote->held;
+    }
+    pthread_mutex_unlock(&remote->lock);
+    return snapshot;
+}
+
+void tasks_remote_release(TasksRemote *remote, TasksSnapshot *snapshot)
+{
+    if (!remote || snapshot != &remote->held) return;
+    pthread_mutex_lock(&remote->lock);
+    tasks_snapshot_clear(&remote->held);
+    remote->held_valid = 0;
+    pthread_mutex_unlock(&remote->lock);
+}
+
+void tasks_remote_destroy(TasksRemote *remote)
+{
+    if (!remote) return;
+    pthread_t thread = remote->thread;
+    pthread_mutex_lock(&remote->lock);
+    remote->stopping = 1;
+    /* Wakes a blocked read; the thread then frees the remote. */
+    if (remote->socket_fd >= 0) shutdown(remote->socket_fd, SHUT_RDWR);
+    int finished = remote->finished;
+    pthread_mutex_unlock(&remote->lock);
+    if (finished) {
+        pthread_join(thread, NULL);
+        tasks_remote_free(remote);
+    } else {
+        pthread_detach(thread);
+    }
+}
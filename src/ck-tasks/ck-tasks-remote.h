@@ -0,0 +1,40 @@
+#ifndef CK_TASKS_REMOTE_H
+#define CK_TASKS_REMOTE_H
+
+#include <stddef.h>
+
+#include "ck-tasks-sampler.h"
+
+/*
+ * Connection to a ck-tasks-agent (File > Connect).
+ *
+ * A thread connects, reads frames and decodes them into snapshots holding
+ * TASKS_SOURCE_STATS and TASKS_SOURCE_PROCESSES, then wakes the UI through a
+ * self-pipe like the sampler does. Only the newest undelivered snapshot is
+ * kept. State changes (connected, failed) also wake the UI.
+ */
+
+typedef enum {
+    TASKS_REMOTE_CONNECTING,
+    TASKS_REMOTE_CONNECTED,
+    TASKS_REMOTE_FAILED,
+} TasksRemoteState;
+
+typedef struct TasksRemote TasksRemote;
+
+/* Starts connecting in the background; NULL only if no thread can be started. */
+TasksRemote *tasks_remote_create(const char *address);
+/* Read end of the wakeup pipe (non-blocking), for XtAppAddInput. */
+int tasks_remote_get_fd(TasksRemote *remote);
+/* Fills message with the agent's host name once connected, or the error once failed. */
+TasksRemoteState tasks_remote_get_state(TasksRemote *remote, char *message, size_t message_len);
+
+/* Drains the wakeup pipe and returns the newest unread snapshot, or NULL.
+ * Arrays may be moved out before it is released. */
+TasksSnapshot *tasks_remote_acquire(TasksRemote *remote);
+void tasks_remote_release(TasksRemote *remote, TasksSnapshot *snapshot);
+
+/* Closes the connection without waiting; the thread frees the rest. */
+void tasks_remote_destroy(TasksRemote *remote);
+
+#endif /* CK_TASKS_REMOTE_H */
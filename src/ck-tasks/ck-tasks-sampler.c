@@ -0,0 +1,267 @@
+#include "ck-tasks-sampler.h"
+#include "../shared/tool_utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TASKS_SAMPLER_SLOTS 2
+#define TASKS_SAMPLER_DEFAULT_INTERVAL_MS 2000
+
+struct TasksSampler {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int wake_read_fd;
+    int wake_write_fd;
+    TasksSnapshot slots[TASKS_SAMPLER_SLOTS];
+    int published_slot;
+    int held_slot;
+    unsigned long sequence;
+    int interval_ms;
+    unsigned int sources;
+    int include_disabled_services;
+    int request_pending;
+    int stopping;
+};
+
+void tasks_snapshot_clear(TasksSnapshot *snapshot)
+{
+    if (!snapshot) return;
+    tasks_model_free_processes(snapshot->processes);
+    tasks_model_free_users(snapshot->users, snapshot->user_count);
+    tasks_model_free_services(snapshot->services, snapshot->service_count);
+    tasks_model_free_network(snapshot->interfaces, snapshot->sockets);
+    tasks_model_free_cgroups(snapshot->cgroups);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+void tasks_snapshot_collect(TasksSnapshot *snapshot, unsigned int sources, int include_disabled_services)
+{
+    tasks_snapshot_clear(snapshot);
+    snapshot->sources = sources & ~(unsigned int)TASKS_SOURCE_APPLICATIONS;
+    if (sources & TASKS_SOURCE_PROCESSES) {
+        snapshot->processes_ok = (tasks_model_list_processes(&snapshot->processes) == 0);
+    }
+    if (sources & TASKS_SOURCE_STATS) {
+        snapshot->stats_ok = (tasks_model_get_system_stats(&snapshot->stats) == 0);
+    }
+    if (sources & TASKS_SOURCE_USERS) {
+        snapshot->users_ok = (tasks_model_list_users(&snapshot->users, &snapshot->user_count) == 0);
+    }
+    if (sources & TASKS_SOURCE_SERVICES) {
+        snapshot->services_ok = (tasks_model_list_services(&snapshot->services, &snapshot->service_count,
+                                                           &snapshot->init_info, include_disabled_services) == 0);
+    }
+    if (sources & TASKS_SOURCE_NETWORK) {
+        snapshot->network_ok = (tasks_model_list_network(&snapshot->interfaces, &snapshot->interface_count,
+                                                         &snapshot->sockets, &snapshot->socket_count) == 0);
+    }
+    if (sources & TASKS_SOURCE_CGROUPS) {
+        snapshot->cgroups_ok = (tasks_model_list_cgroups(&snapshot->cgroups, &snapshot->cgroup_count) == 0);
+    }
+}
+
+static void tasks_sampler_notify(TasksSampler *sampler)
+{
+    char byte = 1;
+    ssize_t rc;
+    do {
+        rc = write(sampler->wake_write_fd, &byte, 1);
+    } while (rc < 0 && errno == EINTR);
+    /* EAGAIN means a wakeup is already pending, which is all we need. */
+}
+
+static int timespec_reached(const struct timespec *now, const struct timespec *deadline)
+{
+    if (now->tv_sec != deadline->tv_sec) return now->tv_sec > deadline->tv_sec;
+    return now->tv_nsec >= deadline->tv_nsec;
+}
+
+static void tasks_sampler_free(TasksSampler *sampler)
+{
+    for (int i = 0; i < TASKS_SAMPLER_SLOTS; ++i) {
+        tasks_snapshot_clear(&sampler->slots[i]);
+    }
+    if (sampler->wake_read_fd >= 0) close(sampler->wake_read_fd);
+    if (sampler->wake_write_fd >= 0) close(sampler->wake_write_fd);
+    pthread_cond_destroy(&sampler->cond);
+    pthread_mutex_destroy(&sampler->lock);
+    free(sampler);
+}
+
+static void *tasks_sampler_main(void *arg)
+{
+    TasksSampler *sampler = arg;
+    pthread_mutex_lock(&sampler->lock);
+    while (!sampler->stopping) {
+        /* Write into the slot the UI neither holds nor has yet to read; if the
+         * UI holds one and the other is still unread, that unread snapshot is
+         * stale by now and gets replaced. */
+        int slot = -1;
+        for (int i = 0; i < TASKS_SAMPLER_SLOTS; ++i) {
+            if (i != sampler->held_slot && i != sampler->published_slot) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0) {
+            slot = sampler->published_slot;
+            sampler->published_slot = -1;
+        }
+        int include_disabled = sampler->include_disabled_services;
+        unsigned int sources = sampler->sources;
+        sampler->request_pending = 0;
+        pthread_mutex_unlock(&sampler->lock);
+
+        struct timespec started;
+        clock_gettime(CLOCK_MONOTONIC, &started);
+        tasks_snapshot_collect(&sampler->slots[slot], sources, include_disabled);
+
+        pthread_mutex_lock(&sampler->lock);
+        if (sampler->stopping) break;
+        sampler->slots[slot].sequence = ++sampler->sequence;
+        sampler->published_slot = slot;
+        tasks_sampler_notify(sampler);
+
+        while (!sampler->stopping && !sampler->request_pending) {
+            struct timespec deadline = started;
+            int interval = sampler->interval_ms > 0 ? sampler->interval_ms : TASKS_SAMPLER_DEFAULT_INTERVAL_MS;
+            tool_timespec_add_ms(&deadline, interval);
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (timespec_reached(&now, &deadline)) break;
+            pthread_cond_timedwait(&sampler->cond, &sampler->lock, &deadline);
+        }
+    }
+    pthread_mutex_unlock(&sampler->lock);
+
+    /* The sampler thread is the only model user once it runs, so it also
+     * tears the model down. */
+    tasks_sampler_free(sampler);
+    tasks_model_shutdown();
+    return NULL;
+}
+
+TasksSampler *tasks_sampler_create(int interval_ms, int include_disabled_services)
+{
+    TasksSampler *sampler = (TasksSampler *)calloc(1, sizeof(TasksSampler));
+    if (!sampler) return NULL;
+    sampler->wake_read_fd = -1;
+    sampler->wake_write_fd = -1;
+    sampler->published_slot = -1;
+    sampler->held_slot = -1;
+    sampler->interval_ms = interval_ms;
+    sampler->sources = TASKS_SOURCE_ALL;
+    sampler->include_disabled_services = include_disabled_services;
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        free(sampler);
+        return NULL;
+    }
+    for (int i = 0; i < 2; ++i) {
+        fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+    }
+    sampler->wake_read_fd = fds[0];
+    sampler->wake_write_fd = fds[1];
+
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sampler->cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    pthread_mutex_init(&sampler->lock, NULL);
+
+    if (pthread_create(&sampler->thread, NULL, tasks_sampler_main, sampler) != 0) {
+        tasks_sampler_free(sampler);
+        return NULL;
+    }
+    return sampler;
+}
+
+int tasks_sampler_get_fd(TasksSampler *sampler)
+{
+    return sampler ? sampler->wake_read_fd : -1;
+}
+
+void tasks_sampler_set_interval(TasksSampler *sampler, int interval_ms)
+{
+    if (!sampler) return;
+    pthread_mutex_lock(&sampler->lock);
+    sampler->interval_ms = interval_ms;
+    pthread_cond_signal(&sampler->cond);
+    pthread_mutex_unlock(&sampler->lock);
+}
+
+void tasks_sampler_set_include_disabled_services(TasksSampler *sampler, int include_disabled_services)
+{
+    if (!sampler) return;
+    pthread_mutex_lock(&sampler->lock);
+    sampler->include_disabled_services = include_disabled_services;
+    sampler->request_pending = 1;
+    pthread_cond_signal(&sampler->cond);
+    pthread_mutex_unlock(&sampler->lock);
+}
+
+void tasks_sampler_set_sources(TasksSampler *sampler, unsigned int sources)
+{
+    if (!sampler) return;
+    pthread_mutex_lock(&sampler->lock);
+    sampler->sources = sources;
+    pthread_mutex_unlock(&sampler->lock);
+}
+
+void tasks_sampler_request(TasksSampler *sampler)
+{
+    if (!sampler) return;
+    pthread_mutex_lock(&sampler->lock);
+    sampler->request_pending = 1;
+    pthread_cond_signal(&sampler->cond);
+    pthread_mutex_unlock(&sampler->lock);
+}
+
+TasksSnapshot *tasks_sampler_acquire(TasksSampler *sampler)
+{
+    if (!sampler) return NULL;
+    char drain[64];
+    while (read(sampler->wake_read_fd, drain, sizeof(drain)) > 0) {
+    }
+
+    TasksSnapshot *snapshot = NULL;
+    pthread_mutex_lock(&sampler->lock);
+    if (sampler->held_slot < 0 && sampler->published_slot >= 0) {
+        sampler->held_slot = sampler->published_slot;
+        sampler->published_slot = -1;
+        snapshot = &sampler->slots[sampler->held_slot];
+    }
+    pthread_mutex_unlock(&sampler->lock);
+    return snapshot;
+}
+
+void tasks_sampler_release(TasksSampler *sampler, TasksSnapshot *snapshot)
+{
+    if (!sampler || !snapshot) return;
+    pthread_mutex_lock(&sampler->lock);
+    if (sampler->held_slot >= 0 && &sampler->slots[sampler->held_slot] == snapshot) {
+        sampler->held_slot = -1;
+    }
+    pthread_mutex_unlock(&sampler->lock);
+}
+
+void tasks_sampler_destroy(TasksSampler *sampler)
+{
+    if (!sampler) return;
+    pthread_t thread = sampler->thread;
+    pthread_mutex_lock(&sampler->lock);
+    sampler->stopping = 1;
+    sampler->held_slot = -1;
+    pthread_cond_signal(&sampler->cond);
+    pthread_mutex_unlock(&sampler->lock);
+    pthread_detach(thread);
+}
@@ -0,0 +1,89 @@
+#ifndef CK_TASKS_SAMPLER_H
+#define CK_TASKS_SAMPLER_H
+
+#include "ck-tasks-model.h"
+
+/*
+ * Background collection for ck-tasks.
+ *
+ * A dedicated thread runs the model (process scan, system stats, utmp, the
+ * services walk and the cgroup tree) and fills one of two snapshot slots. When a snapshot is
+ * complete it is published and one byte is written to a self-pipe; the UI
+ * registers the read end with XtAppAddInput, takes the newest snapshot with
+ * tasks_sampler_acquire(), moves the arrays it wants out of it and hands the
+ * slot back with tasks_sampler_release(). The UI thread never runs a model
+ * scan itself once the sampler is running.
+ */
+
+/* Data sources refreshed by the controller's scheduler. The sampler collects
+ * all of them except applications, which need the X connection. */
+enum {
+    TASKS_SOURCE_STATS = 1 << 0,
+    TASKS_SOURCE_PROCESSES = 1 << 1,
+    TASKS_SOURCE_USERS = 1 << 2,
+    TASKS_SOURCE_SERVICES = 1 << 3,
+    TASKS_SOURCE_APPLICATIONS = 1 << 4,
+    TASKS_SOURCE_NETWORK = 1 << 5,
+    TASKS_SOURCE_CGROUPS = 1 << 6,
+};
+
+#define TASKS_SOURCE_ALL (TASKS_SOURCE_STATS | TASKS_SOURCE_PROCESSES | TASKS_SOURCE_USERS | \
+                          TASKS_SOURCE_SERVICES | TASKS_SOURCE_APPLICATIONS | TASKS_SOURCE_NETWORK | \
+                          TASKS_SOURCE_CGROUPS)
+
+typedef struct {
+    unsigned long sequence;
+    unsigned int sources; /* TASKS_SOURCE_* collected into this snapshot */
+    int processes_ok;
+    TasksProcessList *processes;
+    int stats_ok;
+    TasksSystemStats stats;
+    int users_ok;
+    TasksUserEntry *users;
+    int user_count;
+    int services_ok;
+    TasksServiceEntry *services;
+    int service_count;
+    TasksInitInfo init_info;
+    int network_ok;
+    TasksNetInterface *interfaces;
+    int interface_count;
+    TasksNetSocket *sockets;
+    int socket_count;
+    int cgroups_ok;
+    TasksCgroupEntry *cgroups;
+    int cgroup_count;
+} TasksSnapshot;
+
+/* Run one collection pass over the given sources on the calling thread
+ * (frees what the snapshot held). */
+void tasks_snapshot_collect(TasksSnapshot *snapshot, unsigned int sources, int include_disabled_services);
+void tasks_snapshot_clear(TasksSnapshot *snapshot);
+
+typedef struct TasksSampler TasksSampler;
+
+/* Starts the sampler thread; the first snapshot is collected immediately. */
+TasksSampler *tasks_sampler_create(int interval_ms, int include_disabled_services);
+/* Read end of the wakeup pipe (non-blocking), for XtAppAddInput. */
+int tasks_sampler_get_fd(TasksSampler *sampler);
+void tasks_sampler_set_interval(TasksSampler *sampler, int interval_ms);
+void tasks_sampler_set_include_disabled_services(TasksSampler *sampler, int include_disabled_services);
+/* Sources collected from the next pass on (TASKS_SOURCE_ALL initially). */
+void tasks_sampler_set_sources(TasksSampler *sampler, unsigned int sources);
+/* Ask for a new snapshot now instead of waiting for the next interval. */
+void tasks_sampler_request(TasksSampler *sampler);
+
+/* Drains the wakeup pipe and returns the newest unread snapshot, or NULL.
+ * Arrays may be moved out of the snapshot (set the pointer to NULL) before
+ * it is released; whatever is left is freed when the slot is reused.
+ */
+TasksSnapshot *tasks_sampler_acquire(TasksSampler *sampler);
+void tasks_sampler_release(TasksSampler *sampler, TasksSnapshot *snapshot);
+
+/* Stops the sampler without waiting for a scan in progress. The thread frees
+ * the sampler and shuts the model down when it exits, so callers must not use
+ * the model after this.
+ */
+void tasks_sampler_destroy(TasksSampler *sampler);
+
+#endif /* CK_TASKS_SAMPLER_H */
@@ -0,0 +1,232 @@
+#include "ck-tasks-search.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+size_t tasks_search_fold(const char *text, char *out, size_t out_len)
+{
+    if (!out || out_len == 0) return 0;
+    size_t len = 0;
+    if (text) {
+        for (; text[len] && len + 1 < out_len; ++len) {
+            out[len] = (char)tolower((unsigned char)text[len]);
+        }
+    }
+    out[len] = '\0';
+    return len;
+}
+
+void tasks_search_index_clear(TasksSearchIndex *index)
+{
+    if (!index) return;
+    index->used = 0;
+    index->count = 0;
+}
+
+void tasks_search_index_free(TasksSearchIndex *index)
+{
+    if (!index) return;
+    free(index->text);
+    free(index->offsets);
+    memset(index, 0, sizeof(*index));
+}
+
+int tasks_search_index_add_row(TasksSearchIndex *index, const char *const *fields, int field_count)
+{
+    if (!index || field_count < 0) return -1;
+    size_t needed = 0;
+    for (int i = 0; i < field_count; ++i) {
+        if (fields[i]) needed += strlen(fields[i]) + 1;
+    }
+    if (index->used + needed > 0xffffffffu) return -1;
+
+    /* offsets keeps one more entry than there are rows: the end of the last. */
+    if (index->count + 2 > index->row_capacity) {
+        int capacity = index->row_capacity ? index->row_capacity * 2 : 256;
+        while (capacity < index->count + 2) capacity *= 2;
+        unsigned int *offsets = (unsigned int *)realloc(index->offsets, sizeof(unsigned int) * (size_t)capacity);
+        if (!offsets) return -1;
+        index->offsets = offsets;
+        index->row_capacity = capacity;
+    }
+    if (index->used + needed > index->capacity) {
+        size_t capacity = index->capacity ? index->capacity * 2 : 16384;
+        while (capacity < index->used + needed) capacity *= 2;
+        char *text = (char *)realloc(index->text, capacity);
+        if (!text) return -1;
+        index->text = text;
+        index->capacity = capacity;
+    }
+
+    int row = index->count;
+    index->offsets[row] = (unsigned int)index->used;
+    for (int i = 0; i < field_count; ++i) {
+        if (!fields[i]) continue;
+        for (const char *p = fields[i]; *p; ++p) {
+            index->text[index->used++] = (char)tolower((unsigned char)*p);
+        }
+        index->text[index->used++] = '\0';
+    }
+    index->count++;
+    index->offsets[index->count] = (unsigned int)index->used;
+    return row;
+}
+
+int tasks_search_index_match(const TasksSearchIndex *index, int row, const char *folded, size_t len)
+{
+    if (!folded || len == 0) return 1;
+    if (!index || row < 0 || row >= index->count) return 0;
+    const char *p = index->text + index->offsets[row];
+    const char *end = index->text + index->offsets[row + 1];
+    while ((size_t)(end - p) >= len) {
+        /* The first byte can only start a match this far from the end. */
+        const char *hit = (const char *)memchr(p, (unsigned char)folded[0], (size_t)(end - p) - len + 1);
+        if (!hit) return 0;
+        if (memcmp(hit + 1, folded + 1, len - 1) == 0) return 1;
+        p = hit + 1;
+    }
+    return 0;
+}
+
+int tasks_search_matches_narrow(const TasksSearchMatches *matches, const char *folded)
+{
+    if (!matches || !matches->valid || !folded || !matches->query[0]) return 0;
+    return strstr(folded, matches->query) != NULL;
+}
+
+void tasks_search_matches_store(TasksSearchMatches *matches, const char *folded, const int *rows, int count)
+{
+    if (!matches) return;
+    matches->valid = 0;
+    if (!folded || !folded[0] || count < 0 || (count > 0 && !rows)) return;
+    if (count > matches->capacity) {
+        int *resized = (int *)realloc(matches->rows, sizeof(int) * (size_t)count);
+        if (!resized) return;
+        matches->rows = resized;
+        matches->capacity = count;
+    }
+    if (count > 0) memcpy(matches->rows, rows, sizeof(int) * (size_t)count);
+    matches->count = count;
+    size_t len = strlen(folded);
+    if (len >= sizeof(matches->query)) return;
+    memcpy(matches->query, folded, len + 1);
+    matches->valid = 1;
+}
+
+void tasks_search_matches_invalidate(TasksSearchMatches *matches)
+{
+    if (matches) matches->valid = 0;
+}
+
+void tasks_search_matches_free(TasksSearchMatches *matches)
+{
+    if (!matches) return;
+    free(matches->rows);
+    memset(matches, 0, sizeof(*matches));
+}
+
+static unsigned int pid_index_hash(const char *name, size_t len)
+{
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (unsigned char)tolower((unsigned char)name[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int pid_index_key_equals(const TasksPidIndex *index, const TasksPidSlot *slot,
+                                const char *name, size_t len)
+{
+    const char *key = index->keys + slot->key - 1;
+    for (size_t i = 0; i < len; ++i) {
+        if (key[i] != (char)tolower((unsigned char)name[i])) return 0;
+    }
+    return key[len] == '\0';
+}
+
+static int pid_index_grow(TasksPidIndex *index)
+{
+    int slot_count = index->slot_count ? index->slot_count * 2 : 1024;
+    TasksPidSlot *slots = (TasksPidSlot *)calloc((size_t)slot_count, sizeof(TasksPidSlot));
+    if (!slots) return -1;
+    unsigned int mask = (unsigned int)slot_count - 1;
+    for (int i = 0; i < index->slot_count; ++i) {
+        const TasksPidSlot *old = &index->slots[i];
+        if (!old->key) continue;
+        unsigned int pos = old->hash & mask;
+        while (slots[pos].key) pos = (pos + 1) & mask;
+        slots[pos] = *old;
+    }
+    free(index->slots);
+    index->slots = slots;
+    index->slot_count = slot_count;
+    return 0;
+}
+
+void tasks_pid_index_clear(TasksPidIndex *index)
+{
+    if (!index) return;
+    if (index->slots && index->count > 0) {
+        memset(index->slots, 0, sizeof(TasksPidSlot) * (size_t)index->slot_count);
+    }
+    index->used = 0;
+    index->count = 0;
+}
+
+void tasks_pid_index_free(TasksPidIndex *index)
+{
+    if (!index) return;
+    free(index->keys);
+    free(index->slots);
+    memset(index, 0, sizeof(*index));
+}
+
+int tasks_pid_index_add(TasksPidIndex *index, const char *name, size_t len, pid_t pid)
+{
+    if (!index || !name || len == 0) return -1;
+    if (index->used + len + 1 > 0xfffffffeu) return -1;
+    /* Kept at most half full so probes stay short. */
+    if ((index->count + 1) * 2 > index->slot_count && pid_index_grow(index) != 0) return -1;
+
+    unsigned int hash = pid_index_hash(name, len);
+    unsigned int mask = (unsigned int)index->slot_count - 1;
+    unsigned int pos = hash & mask;
+    while (index->slots[pos].key) {
+        const TasksPidSlot *slot = &index->slots[pos];
+        if (slot->hash == hash && pid_index_key_equals(index, slot, name, len)) return 0;
+        pos = (pos + 1) & mask;
+    }
+
+    if (index->used + len + 1 > index->capacity) {
+        size_t capacity = index->capacity ? index->capacity * 2 : 16384;
+        while (capacity < index->used + len + 1) capacity *= 2;
+        char *keys = (char *)realloc(index->keys, capacity);
+        if (!keys) return -1;
+        index->keys = keys;
+        index->capacity = capacity;
+    }
+    TasksPidSlot *slot = &index->slots[pos];
+    slot->hash = hash;
+    slot->key = (unsigned int)index->used + 1;
+    slot->pid = pid;
+    for (size_t i = 0; i < len; ++i) {
+        index->keys[index->used++] = (char)tolower((unsigned char)name[i]);
+    }
+    index->keys[index->used++] = '\0';
+    index->count++;
+    return 0;
+}
+
+pid_t tasks_pid_index_find(const TasksPidIndex *index, const char *name, size_t len)
+{
+    if (!index || !name || len == 0 || index->count == 0) return -1;
+    unsigned int hash = pid_index_hash(name, len);
+    unsigned int mask = (unsigned int)index->slot_count - 1;
+    for (unsigned int pos = hash & mask; index->slots[pos].key; pos = (pos + 1) & mask) {
+        const TasksPidSlot *slot = &index->slots[pos];
+        if (slot->hash == hash && pid_index_key_equals(index, slot, name, len)) return slot->pid;
+    }
+    return -1;
+}
@@ -0,0 +1,88 @@
+#ifndef CK_TASKS_SEARCH_H
+#define CK_TASKS_SEARCH_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/*
+ * Search text for the table filters, built once per snapshot. Every row's
+ * searchable fields are case-folded and stored back to back in one buffer,
+ * separated by NUL bytes so a query never matches across two fields. A match
+ * is memchr for the query's first byte and memcmp for the rest, both of
+ * which libc vectorizes, instead of folding every character on every
+ * keystroke.
+ *
+ * TasksSearchMatches remembers the rows the last query matched: a query
+ * that contains the previous one can only match a subset of them, so typing
+ * more characters re-tests just those rows.
+ */
+
+#define TASKS_SEARCH_QUERY_MAX 128
+
+/*
+ * Exact, case-insensitive lookups from a name to a pid, for resolving
+ * windows that do not publish _NET_WM_PID. Keys are folded into one buffer
+ * and found through an open-addressing table; the first pid added under a
+ * key keeps it, so earlier rows win as they did in a linear scan.
+ */
+typedef struct {
+    unsigned int hash;
+    unsigned int key; /* offset into keys + 1; 0 = empty slot */
+    pid_t pid;
+} TasksPidSlot;
+
+typedef struct {
+    char *keys;
+    size_t used;
+    size_t capacity;
+    TasksPidSlot *slots;
+    int slot_count; /* power of two */
+    int count;
+} TasksPidIndex;
+
+typedef struct {
+    char *text;
+    size_t used;
+    size_t capacity;
+    unsigned int *offsets; /* row r spans offsets[r] .. offsets[r + 1] */
+    int count;
+    int row_capacity;
+} TasksSearchIndex;
+
+typedef struct {
+    int *rows;
+    int count;
+    int capacity;
+    int valid;
+    char query[TASKS_SEARCH_QUERY_MAX]; /* folded */
+} TasksSearchMatches;
+
+/* Folds text to lower case into out; returns the folded length. */
+size_t tasks_search_fold(const char *text, char *out, size_t out_len);
+
+void tasks_search_index_clear(TasksSearchIndex *index);
+void tasks_search_index_free(TasksSearchIndex *index);
+/* Appends a row made of field_count strings (NULL entries are skipped).
+ * Returns the row number, or -1 on allocation failure. */
+int tasks_search_index_add_row(TasksSearchIndex *index, const char *const *fields, int field_count);
+/* folded must come from tasks_search_fold(); an empty query matches every row. */
+int tasks_search_index_match(const TasksSearchIndex *index, int row, const char *folded, size_t len);
+
+/* True when the rows matched for the last query are a superset of the rows
+ * folded can match, so only they need testing. */
+int tasks_search_matches_narrow(const TasksSearchMatches *matches, const char *folded);
+/* Records rows as the matches of folded; on allocation failure the matches
+ * are dropped and the next query tests every row. */
+void tasks_search_matches_store(TasksSearchMatches *matches, const char *folded, const int *rows, int count);
+void tasks_search_matches_invalidate(TasksSearchMatches *matches);
+void tasks_search_matches_free(TasksSearchMatches *matches);
+
+void tasks_pid_index_clear(TasksPidIndex *index);
+void tasks_pid_index_free(TasksPidIndex *index);
+/* Adds the first len bytes of name. Returns 0 (also when the key is already
+ * taken), or -1 on allocation failure. */
+int tasks_pid_index_add(TasksPidIndex *index, const char *name, size_t len, pid_t pid);
+/* Returns the pid stored under the first len bytes of name, or -1. */
+pid_t tasks_pid_index_find(const TasksPidIndex *index, const char *name, size_t len);
+
+#endif /* CK_TASKS_SEARCH_H */
@@ -0,0 +1,305 @@
+#include "ck-tasks-tabs.h"
+#include "ck-tasks-ui-helpers.h"
+
+#include <Xm/Form.h>
+#include <Xm/LabelG.h>
+#include <Xm/ScrollBar.h>
+
+#include <stdio.h>
+#include <string.h>
+
+static const TableColumnDef cgroup_columns[] = {
+    {"cgroupName", "Group", TABLE_ALIGN_LEFT, False, True, 0},
+    {"cgroupCpu", "CPU", TABLE_ALIGN_RIGHT, True, True, 0},
+    {"cgroupMemory", "Memory", TABLE_ALIGN_RIGHT, True, True, 0},
+    {"cgroupRead", "Read/s", TABLE_ALIGN_RIGHT, True, True, 0},
+    {"cgroupWrite", "Write/s", TABLE_ALIGN_RIGHT, True, True, 0},
+    {"cgroupTasks", "Tasks", TABLE_ALIGN_RIGHT, True, True, 0},
+};
+
+#define CGROUP_COLUMN_COUNT (sizeof(cgroup_columns) / sizeof(cgroup_columns[0]))
+/* Indentation per tree level in the Group column. */
+#define CGROUP_INDENT 2
+
+/* Value bit a numeric column shows; 0 for the name column. */
+static unsigned int cgroup_column_value(int column)
+{
+    switch (column) {
+    case 1: return TASKS_CGROUP_CPU;
+    case 2: return TASKS_CGROUP_MEMORY;
+    case 3: return TASKS_CGROUP_IO;
+    case 4: return TASKS_CGROUP_IO;
+    case 5: return TASKS_CGROUP_PIDS;
+    default: return 0;
+    }
+}
+
+static double cgroup_number(const TasksCgroupEntry *entry, int column, Boolean *has_value)
+{
+    unsigned int value = cgroup_column_value(column);
+    if (!value || !(entry->valid & value)) {
+        if (has_value) *has_value = False;
+        return 0.0;
+    }
+    if (has_value) *has_value = True;
+    switch (column) {
+    case 1: return entry->cpu_percent;
+    case 2: return (double)entry->memory_bytes;
+    case 3: return entry->read_rate;
+    case 4: return entry->write_rate;
+    default: return (double)entry->pids;
+    }
+}
+
+static const char *cgroup_table_get_text(void *context,
+                                         const void *entries,
+                                         int row,
+                                         int column,
+                                         char *buffer,
+                                         size_t buffer_len)
+{
+    TasksUi *ui = (TasksUi *)context;
+    const TasksCgroupEntry *groups = (const TasksCgroupEntry *)entries;
+    if (!ui || !groups || row < 0 || row >= ui->cgroup_count) return "";
+    const TasksCgroupEntry *entry = &groups[row];
+    if (column == 0) {
+        int indent = entry->depth * CGROUP_INDENT;
+        snprintf(buffer, buffer_len, "%*s%s", indent, "", entry->name);
+        return buffer;
+    }
+    Boolean has_value = False;
+    double value = cgroup_number(entry, column, &has_value);
+    if (!has_value) return "";
+    switch (column) {
+    case 1:
+        snprintf(buffer, buffer_len, "%.1f%%", value);
+        break;
+    case 2:
+        tasks_ui_format_bytes(value, "", buffer, buffer_len);
+        break;
+    case 3:
+    case 4:
+        tasks_ui_format_bytes(value, "/s", buffer, buffer_len);
+        break;
+    default:
+        snprintf(buffer, buffer_len, "%llu", entry->pids);
+        break;
+    }
+    return buffer;
+}
+
+static double cgroup_table_get_number(void *context,
+                                      const void *entries,
+                                      int row,
+                                      int column,
+                                      Boolean *has_value)
+{
+    TasksUi *ui = (TasksUi *)context;
+    const TasksCgroupEntry *groups = (const TasksCgroupEntry *)entries;
+    if (!ui || !groups || row < 0 || row >= ui->cgroup_count) {
+        if (has_value) *has_value = False;
+        return 0.0;
+    }
+    return cgroup_number(&groups[row], column, has_value);
+}
+
+static int cgroup_compare_siblings(const TasksCgroupEntry *groups, int left, int right, int column)
+{
+    if (column == 0) return strcoll(groups[left].name, groups[right].name);
+    Boolean has_left = False;
+    Boolean has_right = False;
+    double a = cgroup_number(&groups[left], column, &has_left);
+    double b = cgroup_number(&groups[right], column, &has_right);
+    if (has_left != has_right) return has_left ? 1 : -1;
+    if (a < b) return -1;
+    if (a > b) return 1;
+    return 0;
+}
+
+/*
+ * Sorting reorders the groups within each level and keeps the tree intact:
+ * two rows compare as the siblings they descend from, and a group always
+ * stays above its descendants. The table reverses whatever this returns
+ * for a descending sort, so orders that must not flip are pre-reversed.
+ */
+static int cgroup_table_compare(void *context,
+                                const void *entries,
+                                int left,
+                                int right,
+                                int column,
+                                TableSortDirection direction)
+{
+    (void)context;
+    const TasksCgroupEntry *groups = (const TasksCgroupEntry *)entries;
+    int sign = direction == TABLE_SORT_DESCENDING ? -1 : 1;
+    int a = left;
+    int b = right;
+    while (groups[a].depth > groups[b].depth) a = groups[a].parent;
+    while (groups[b].depth > groups[a].depth) b = groups[b].parent;
+    if (a == b) return sign * (groups[left].depth - groups[right].depth);
+    while (groups[a].parent != groups[b].parent) {
+        a = groups[a].parent;
+        b = groups[b].parent;
+    }
+    int cmp = cgroup_compare_siblings(groups, a, b, column);
+    return cmp != 0 ? cmp : sign * (a - b);
+}
+
+static void cgroup_update_scrollbar(TasksUi *ui)
+{
+    if (!ui || !ui->cgroups_scrollbar || !ui->cgroups_table) return;
+    int total = ui->cgroup_count;
+    int page = ck_table_get_virtual_row_page_size(ui->cgroups_table);
+    if (page <= 0) page = 1;
+    int slider_size = total > 0 ? (total < page ? total : page) : 1;
+    int max_start = total > page ? total - page : 0;
+    int maximum = max_start + slider_size;
+    int value = ui->cgroups_row_start;
+    if (value < 0) value = 0;
+    if (value > max_start) value = max_start;
+    XtVaSetValues(ui->cgroups_scrollbar,
+                  XmNminimum, 0,
+                  XmNmaximum, maximum,
+                  NULL);
+    XmScrollBarSetValues(ui->cgroups_scrollbar, value, slider_size, 1, page, False);
+}
+
+static void cgroup_set_row_window(TasksUi *ui, int start)
+{
+    if (!ui || !ui->cgroups_table) return;
+    int page = ck_table_get_virtual_row_page_size(ui->cgroups_table);
+    if (page <= 0) page = 1;
+    int max_start = ui->cgroup_count > page ? ui->cgroup_count - page : 0;
+    if (start > max_start) start = max_start;
+    if (start < 0) start = 0;
+    ui->cgroups_row_start = start;
+    ck_table_set_virtual_row_window(ui->cgroups_table, start);
+    cgroup_update_scrollbar(ui);
+}
+
+static void cgroup_table_viewport_changed(void *context)
+{
+    TasksUi *ui = (TasksUi *)context;
+    if (ui) cgroup_set_row_window(ui, ui->cgroups_row_start);
+}
+
+static void on_cgroup_scroll(Widget widget, XtPointer client, XtPointer call)
+{
+    (void)widget;
+    TasksUi *ui = (TasksUi *)client;
+    XmScrollBarCallbackStruct *cb = (XmScrollBarCallbackStruct *)call;
+    if (!ui || !cb) return;
+    cgroup_set_row_window(ui, cb->value);
+}
+
+static void add_cgroups_tab_content(TasksUi *ui, Widget page)
+{
+    XmString label = tasks_ui_make_string("Control groups: -");
+    ui->cgroups_summary_label = XtVaCreateManagedWidget(
+        "cgroupsSummary",
+        xmLabelGadgetClass, page,
+        XmNlabelString, label,
+        XmNalignment, XmALIGNMENT_BEGINNING,
+        XmNtopAttachment, XmATTACH_FORM,
+        XmNtopOffset, 12,
+        XmNleftAttachment, XmATTACH_FORM,
+        XmNleftOffset, 12,
+        XmNrightAttachment, XmATTACH_FORM,
+        XmNrightOffset, 12,
+        NULL);
+    XmStringFree(label);
+
+    Widget area = XmCreateForm(page, "cgroupsArea", NULL, 0);
+    XtVaSetValues(area,
+                  XmNtopAttachment, XmATTACH_WIDGET,
+                  XmNtopWidget, ui->cgroups_summary_label,
+                  XmNtopOffset, 10,
+                  XmNbottomAttachment, XmATTACH_FORM,
+                  XmNbottomOffset, 10,
+                  XmNleftAttachment, XmATTACH_FORM,
+                  XmNleftOffset, 12,
+                  XmNrightAttachment, XmATTACH_FORM,
+                  XmNrightOffset, 12,
+                  NULL);
+    XtManageChild(area);
+
+    Widget scrollbar = XmCreateScrollBar(area, "cgroupsScrollBar", NULL, 0);
+    XtVaSetValues(scrollbar,
+                  XmNrightAttachment, XmATTACH_FORM,
+                  XmNtopAttachment, XmATTACH_FORM,
+                  XmNbottomAttachment, XmATTACH_FORM,
+                  XmNwidth, 20,
+                  NULL);
+    XtManageChild(scrollbar);
+    XtAddCallback(scrollbar, XmNvalueChangedCallback, on_cgroup_scroll, ui);
+    XtAddCallback(scrollbar, XmNdragCallback, on_cgroup_scroll, ui);
+    ui->cgroups_scrollbar = scrollbar;
+
+    ui->cgroups_table = ck_table_create_virtual(area, "cgroupsTable", cgroup_columns, CGROUP_COLUMN_COUNT);
+    if (ui->cgroups_table) {
+        Widget scroll = ck_table_get_widget(ui->cgroups_table);
+        XtVaSetValues(scroll,
+                      XmNtopAttachment, XmATTACH_FORM,
+                      XmNleftAttachment, XmATTACH_FORM,
+                      XmNrightAttachment, XmATTACH_WIDGET,
+                      XmNrightWidget, scrollbar,
+                      XmNrightOffset, 4,
+                      XmNbottomAttachment, XmATTACH_FORM,
+                      NULL);
+        ck_table_set_virtual_row_spacing(ui->cgroups_table, 4);
+        ck_table_set_virtual_callbacks(ui->cgroups_table,
+                                       cgroup_table_get_text,
+                                       cgroup_table_get_number,
+                                       cgroup_table_compare,
+                                       ui);
+        ck_table_set_virtual_viewport_changed_callback(ui->cgroups_table,
+                                                       cgroup_table_viewport_changed,
+                                                       ui);
+    }
+}
+
+Widget tasks_ui_create_cgroups_tab(TasksUi *ui)
+{
+    Widget page = tasks_ui_create_page(ui, "cgroupsPage", TASKS_TAB_CGROUPS,
+                                       "Control Groups", "CPU, memory, I/O and tasks per cgroup.");
+    add_cgroups_tab_content(ui, page);
+    return page;
+}
+
+void tasks_ui_destroy_cgroups_tab(TasksUi *ui)
+{
+    if (!ui) return;
+    if (ui->cgroups_table) {
+        ck_table_destroy(ui->cgroups_table);
+        ui->cgroups_table = NULL;
+    }
+    ui->cgroups = NULL;
+    ui->cgroup_count = 0;
+}
+
+/* The table reads rows straight from entries, which must stay valid until
+ * the next call. NULL entries means no cgroup v2 hierarchy could be read. */
+void tasks_ui_set_cgroups(TasksUi *ui, const TasksCgroupEntry *entries, int count)
+{
+    if (!ui) return;
+    ui->cgroups = entries;
+    ui->cgroup_count = (entries && count > 0) ? count : 0;
+    if (ui->cgroups_summary_label) {
+        char buffer[128];
+        if (!entries) {
+            snprintf(buffer, sizeof(buffer), "No cgroup v2 hierarchy is mounted.");
+        } else {
+            int populated = 0;
+            for (int i = 0; i < ui->cgroup_count; ++i) {
+                if (entries[i].populated) populated++;
+            }
+            snprintf(buffer, sizeof(buffer), "Control groups: %d (%d with processes)", ui->cgroup_count, populated);
+        }
+        tasks_ui_status_set_label_text(ui->cgroups_summary_label, ui->cgroups_summary_text,
+                                       sizeof(ui->cgroups_summary_text), buffer);
+    }
+    if (ui->cgroups_table) {
+        ck_table_set_virtual_data(ui->cgroups_table, ui->cgroups, ui->cgroup_count);
+        cgroup_set_row_window(ui, ui->cgroups_row_start);
+    }
+}
@@ -3,22 +3,158 @@
 
 #include <Xm/Form.h>
 #include <Xm/LabelG.h>
-#include <Xm/List.h>
 #include <Xm/RowColumn.h>
-#include <Xm/ScrolledW.h>
+#include <Xm/ScrollBar.h>
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-static const char *network_samples[] = {
-    "eth0: 192.168.1.12 -> 10.0.0.5 (UDP)  10 MB/s",
-    "eth0: 192.168.1.12 -> 172.16.0.3 (TCP)  2 MB/s",
-    "wlan0: 10.0.0.52 -> 52.15.5.1 (HTTPS) 1.2 MB/s",
-    "wlan0: adapter idle",
+static const TableColumnDef interface_columns[] = {
+    {"netInterface", "Interface", TABLE_ALIGN_LEFT, False, True, 0},
+    {"netRxRate", "Received/s", TABLE_ALIGN_RIGHT, True, True, 0},
+    {"netTxRate", "Sent/s", TABLE_ALIGN_RIGHT, True, True, 0},
+    {"netRxTotal", "Received", TABLE_ALIGN_RIGHT, True, True, 0},
+    {"netTxTotal", "Sent", TABLE_ALIGN_RIGHT, True, True, 0},
 };
 
+#define INTERFACE_COLUMN_COUNT (sizeof(interface_columns) / sizeof(interface_columns[0]))
+
+static const TableColumnDef socket_columns[] = {
+    {"netProtocol", "Protocol", TABLE_ALIGN_LEFT, False, True, 0},
+    {"netLocal", "Local Address", TABLE_ALIGN_LEFT, False, True, 0},
+    {"netRemote", "Remote Address", TABLE_ALIGN_LEFT, False, True, 0},
+    {"netState", "State", TABLE_ALIGN_LEFT, False, True, 0},
+    {"netPid", "PID", TABLE_ALIGN_RIGHT, True, True, 0},
+    {"netProcess", "Process", TABLE_ALIGN_LEFT, False, True, 0},
+};
+
+#define SOCKET_COLUMN_COUNT (sizeof(socket_columns) / sizeof(socket_columns[0]))
+
+static const char *socket_table_get_text(void *context,
+                                         const void *entries,
+                                         int row,
+                                         int column,
+                                         char *buffer,
+                                         size_t buffer_len)
+{
+    TasksUi *ui = (TasksUi *)context;
+    const TasksNetSocket *sockets = (const TasksNetSocket *)entries;
+    if (!ui || !sockets || row < 0 || row >= ui->net_socket_count) return "";
+    const TasksNetSocket *entry = &sockets[row];
+    switch (column) {
+    case 0:
+        return entry->protocol;
+    case 1:
+        return entry->local;
+    case 2:
+        return entry->remote;
+    case 3:
+        return entry->state;
+    case 4:
+        if (entry->pid <= 0) return "";
+        snprintf(buffer, buffer_len, "%d", (int)entry->pid);
+        return buffer;
+    case 5:
+        return entry->process;
+    default:
+        return "";
+    }
+}
+
+static double socket_table_get_number(void *context,
+                                      const void *entries,
+                                      int row,
+                                      int column,
+                                      Boolean *has_value)
+{
+    TasksUi *ui = (TasksUi *)context;
+    const TasksNetSocket *sockets = (const TasksNetSocket *)entries;
+    if (!ui || !sockets || row < 0 || row >= ui->net_socket_count || column != 4) {
+        if (has_value) *has_value = False;
+        return 0.0;
+    }
+    if (has_value) *has_value = True;
+    return (double)sockets[row].pid;
+}
+
+static void socket_update_scrollbar(TasksUi *ui)
+{
+    if (!ui || !ui->net_socket_scrollbar || !ui->net_sockets_table) return;
+    int total = ui->net_socket_count;
+    int page = ck_table_get_virtual_row_page_size(ui->net_sockets_table);
+    if (page <= 0) page = 1;
+    int slider_size = total > 0 ? (total < page ? total : page) : 1;
+    int max_start = total > page ? total - page : 0;
+    int maximum = max_start + slider_size;
+    int value = ui->net_socket_row_start;
+    if (value < 0) value = 0;
+    if (value > max_start) value = max_start;
+    XtVaSetValues(ui->net_socket_scrollbar,
+                  XmNminimum, 0,
+                  XmNmaximum, maximum,
+                  NULL);
+    XmScrollBarSetValues(ui->net_socket_scrollbar, value, slider_size, 1, page, False);
+}
+
+static void socket_set_row_window(TasksUi *ui, int start)
+{
+    if (!ui || !ui->net_sockets_table) return;
+    int page = ck_table_get_virtual_row_page_size(ui->net_sockets_table);
+    if (page <= 0) page = 1;
+    int max_start = ui->net_socket_count > page ? ui->net_socket_count - page : 0;
+    if (start > max_start) start = max_start;
+    if (start < 0) start = 0;
+    ui->net_socket_row_start = start;
+    ck_table_set_virtual_row_window(ui->net_sockets_table, start);
+    socket_update_scrollbar(ui);
+}
+
+static void socket_table_viewport_changed(void *context)
+{
+    TasksUi *ui = (TasksUi *)context;
+    if (ui) socket_set_row_window(ui, ui->net_socket_row_start);
+}
+
+static void on_socket_scroll(Widget widget, XtPointer client, XtPointer call)
+{
+    (void)widget;
+    TasksUi *ui = (TasksUi *)client;
+    XmScrollBarCallbackStruct *cb = (XmScrollBarCallbackStruct *)call;
+    if (!ui || !cb) return;
+    socket_set_row_window(ui, cb->value);
+}
+
+static void ensure_interface_row_capacity(TasksUi *ui, int needed)
+{
+    if (!ui || needed <= ui->net_interface_row_capacity) return;
+    int new_cap = ui->net_interface_row_capacity ? ui->net_interface_row_capacity : 8;
+    while (new_cap < needed) {
+        new_cap *= 2;
+    }
+    TableRow **expanded = (TableRow **)realloc(ui->net_interface_rows, sizeof(TableRow *) * new_cap);
+    if (!expanded) return;
+    memset(expanded + ui->net_interface_row_capacity, 0,
+           sizeof(TableRow *) * (new_cap - ui->net_interface_row_capacity));
+    ui->net_interface_rows = expanded;
+    ui->net_interface_row_capacity = new_cap;
+}
+
+static Widget create_summary_label(Widget parent, const char *name, const char *text)
+{
+    XmString label = tasks_ui_make_string(text);
+    Widget widget = XtVaCreateManagedWidget(
+        name,
+        xmLabelGadgetClass, parent,
+        XmNlabelString, label,
+        XmNalignment, XmALIGNMENT_BEGINNING,
+        NULL);
+    XmStringFree(label);
+    return widget;
+}
+
 static void add_networking_tab_content(TasksUi *ui, Widget page)
 {
-    (void)ui;
     Widget summary_box = XmCreateRowColumn(page, "networkSummary", NULL, 0);
     XtVaSetValues(summary_box,
                   XmNorientation, XmHORIZONTAL,
@@ -33,57 +169,78 @@ static void add_networking_tab_content(TasksUi *ui, Widget page)
                   NULL);
     XtManageChild(summary_box);
 
-    XmString tx = tasks_ui_make_string("Tx: 12 MB/s");
-    XtVaCreateManagedWidget(
-        "netTxLabel",
-        xmLabelGadgetClass, summary_box,
-        XmNlabelString, tx,
-        XmNalignment, XmALIGNMENT_BEGINNING,
-        NULL);
-    XmStringFree(tx);
+    ui->net_tx_label = create_summary_label(summary_box, "netTxLabel", "Tx: -");
+    ui->net_rx_label = create_summary_label(summary_box, "netRxLabel", "Rx: -");
+    ui->net_sockets_label = create_summary_label(summary_box, "netSocketsLabel", "Sockets: -");
 
-    XmString rx = tasks_ui_make_string("Rx: 3.6 MB/s");
-    XtVaCreateManagedWidget(
-        "netRxLabel",
-        xmLabelGadgetClass, summary_box,
-        XmNlabelString, rx,
-        XmNalignment, XmALIGNMENT_BEGINNING,
-        NULL);
-    XmStringFree(rx);
-
-    Arg scroll_args[10];
-    int sn = 0;
-    XtSetArg(scroll_args[sn], XmNtopAttachment, XmATTACH_WIDGET); sn++;
-    XtSetArg(scroll_args[sn], XmNtopWidget, summary_box); sn++;
-    XtSetArg(scroll_args[sn], XmNtopOffset, 10); sn++;
-    XtSetArg(scroll_args[sn], XmNbottomAttachment, XmATTACH_FORM); sn++;
-    XtSetArg(scroll_args[sn], XmNbottomOffset, 10); sn++;
-    XtSetArg(scroll_args[sn], XmNleftAttachment, XmATTACH_FORM); sn++;
-    XtSetArg(scroll_args[sn], XmNrightAttachment, XmATTACH_FORM); sn++;
-    XtSetArg(scroll_args[sn], XmNleftOffset, 12); sn++;
-    XtSetArg(scroll_args[sn], XmNrightOffset, 12); sn++;
-    XtSetArg(scroll_args[sn], XmNscrollingPolicy, XmAUTOMATIC); sn++;
-    Widget scroll = XmCreateScrolledWindow(page, "networkListScroll", scroll_args, sn);
-    XtManageChild(scroll);
-
-    Widget list = XmCreateScrolledList(scroll, "networkEntries", NULL, 0);
-    XtVaSetValues(list,
-                  XmNvisibleItemCount, 5,
-                  XmNselectionPolicy, XmSINGLE_SELECT,
-                  XmNscrollBarDisplayPolicy, XmAS_NEEDED,
+    ui->net_interfaces_table = ck_table_create_standard(page, "networkInterfaces",
+                                                        interface_columns, INTERFACE_COLUMN_COUNT);
+    Widget anchor = summary_box;
+    if (ui->net_interfaces_table) {
+        Widget table_widget = ck_table_get_widget(ui->net_interfaces_table);
+        XtVaSetValues(table_widget,
+                      XmNtopAttachment, XmATTACH_WIDGET,
+                      XmNtopWidget, summary_box,
+                      XmNtopOffset, 10,
+                      XmNleftAttachment, XmATTACH_FORM,
+                      XmNrightAttachment, XmATTACH_FORM,
+                      XmNleftOffset, 12,
+                      XmNrightOffset, 12,
+                      XmNheight, 140,
+                      NULL);
+        ck_table_set_grid(ui->net_interfaces_table, True);
+        ck_table_set_alternate_row_colors(ui->net_interfaces_table, True);
+        anchor = table_widget;
+    }
+
+    Widget socket_area = XmCreateForm(page, "networkSocketArea", NULL, 0);
+    XtVaSetValues(socket_area,
+                  XmNtopAttachment, XmATTACH_WIDGET,
+                  XmNtopWidget, anchor,
+                  XmNtopOffset, 10,
+                  XmNbottomAttachment, XmATTACH_FORM,
+                  XmNbottomOffset, 10,
+                  XmNleftAttachment, XmATTACH_FORM,
+                  XmNleftOffset, 12,
+                  XmNrightAttachment, XmATTACH_FORM,
+                  XmNrightOffset, 12,
                   NULL);
+    XtManageChild(socket_area);
 
-    size_t sample_count = sizeof(network_samples) / sizeof(network_samples[0]);
-    XmString *items = tasks_ui_make_string_array(network_samples, (int)sample_count);
-    if (items) {
-        XmListAddItems(list, items, (Cardinal)sample_count, 0);
-        for (size_t i = 0; i < sample_count; ++i) {
-            XmStringFree(items[i]);
-        }
-        free(items);
-    }
+    Widget scrollbar = XmCreateScrollBar(socket_area, "networkSocketScrollBar", NULL, 0);
+    XtVaSetValues(scrollbar,
+                  XmNrightAttachment, XmATTACH_FORM,
+                  XmNtopAttachment, XmATTACH_FORM,
+                  XmNbottomAttachment, XmATTACH_FORM,
+                  XmNwidth, 20,
+                  NULL);
+    XtManageChild(scrollbar);
+    XtAddCallback(scrollbar, XmNvalueChangedCallback, on_socket_scroll, ui);
+    XtAddCallback(scrollbar, XmNdragCallback, on_socket_scroll, ui);
+    ui->net_socket_scrollbar = scrollbar;
 
-    XtManageChild(list);
+    ui->net_sockets_table = ck_table_create_virtual(socket_area, "networkSockets",
+                                                    socket_columns, SOCKET_COLUMN_COUNT);
+    if (ui->net_sockets_table) {
+        Widget scroll = ck_table_get_widget(ui->net_sockets_table);
+        XtVaSetValues(scroll,
+                      XmNtopAttachment, XmATTACH_FORM,
+                      XmNleftAttachment, XmATTACH_FORM,
+                      XmNrightAttachment, XmATTACH_WIDGET,
+                      XmNrightWidget, scrollbar,
+                      XmNrightOffset, 4,
+                      XmNbottomAttachment, XmATTACH_FORM,
+                      NULL);
+        ck_table_set_virtual_row_spacing(ui->net_sockets_table, 4);
+        ck_table_set_virtual_callbacks(ui->net_sockets_table,
+                                       socket_table_get_text,
+                                       socket_table_get_number,
+                                       NULL,
+                                       ui);
+        ck_table_set_virtual_viewport_changed_callback(ui->net_sockets_table,
+                                                       socket_table_viewport_changed,
+                                                       ui);
+    }
 }
 
 Widget tasks_ui_create_networking_tab(TasksUi *ui)
@@ -93,3 +250,101 @@ Widget tasks_ui_create_networking_tab(TasksUi *ui)
     add_networking_tab_content(ui, page);
     return page;
 }
+
+void tasks_ui_destroy_networking_tab(TasksUi *ui)
+{
+    if (!ui) return;
+    if (ui->net_interfaces_table) {
+        ck_table_destroy(ui->net_interfaces_table);
+        ui->net_interfaces_table = NULL;
+    }
+    if (ui->net_sockets_table) {
+        ck_table_destroy(ui->net_sockets_table);
+        ui->net_sockets_table = NULL;
+    }
+    free(ui->net_interface_rows);
+    ui->net_interface_rows = NULL;
+    ui->net_interface_row_count = 0;
+    ui->net_interface_row_capacity = 0;
+    ui->net_sockets = NULL;
+    ui->net_socket_count = 0;
+}
+
+static void set_interface_rows(TasksUi *ui, const TasksNetInterface *interfaces, int count)
+{
+    int desired = (interfaces && count > 0) ? count : 0;
+    ensure_interface_row_capacity(ui, desired);
+    if (desired > ui->net_interface_row_capacity) desired = ui->net_interface_row_capacity;
+    int old_count = ui->net_interface_row_count;
+
+    for (int i = 0; i < desired; ++i) {
+        const TasksNetInterface *entry = &interfaces[i];
+        char rx_rate[32], tx_rate[32], rx_total[32], tx_total[32];
+        char rx_rate_sort[32], tx_rate_sort[32], rx_total_sort[32], tx_total_sort[32];
+        tasks_ui_format_bytes(entry->rx_rate, "/s", rx_rate, sizeof(rx_rate));
+        tasks_ui_format_bytes(entry->tx_rate, "/s", tx_rate, sizeof(tx_rate));
+        tasks_ui_format_bytes((double)entry->rx_bytes, "", rx_total, sizeof(rx_total));
+        tasks_ui_format_bytes((double)entry->tx_bytes, "", tx_total, sizeof(tx_total));
+        snprintf(rx_rate_sort, sizeof(rx_rate_sort), "%.0f", entry->rx_rate);
+        snprintf(tx_rate_sort, sizeof(tx_rate_sort), "%.0f", entry->tx_rate);
+        snprintf(rx_total_sort, sizeof(rx_total_sort), "%llu", entry->rx_bytes);
+        snprintf(tx_total_sort, sizeof(tx_total_sort), "%llu", entry->tx_bytes);
+        const char *values[] = {entry->name, rx_rate, tx_rate, rx_total, tx_total};
+        const char *sort_values[] = {NULL, rx_rate_sort, tx_rate_sort, rx_total_sort, tx_total_sort};
+        if (i < old_count && ui->net_interface_rows[i]) {
+            ck_table_update_row_with_sort_values(ui->net_interface_rows[i], values, sort_values);
+        } else {
+            ui->net_interface_rows[i] =
+                ck_table_add_row_with_sort_values(ui->net_interfaces_table, values, sort_values);
+        }
+    }
+    for (int i = desired; i < old_count; ++i) {
+        if (ui->net_interface_rows[i]) {
+            ck_table_remove_row(ui->net_interfaces_table, ui->net_interface_rows[i]);
+            ui->net_interface_rows[i] = NULL;
+        }
+    }
+    ui->net_interface_row_count = desired;
+}
+
+/* The socket table reads rows straight from sockets, which must stay valid
+ * until the next call. */
+void tasks_ui_set_network(TasksUi *ui, const TasksNetInterface *interfaces, int interface_count,
+                          const TasksNetSocket *sockets, int socket_count)
+{
+    if (!ui) return;
+    double rx = 0.0;
+    double tx = 0.0;
+    for (int i = 0; i < interface_count; ++i) {
+        /* Loopback traffic never leaves the machine. */
+        if (strcmp(interfaces[i].name, "lo") == 0) continue;
+        rx += interfaces[i].rx_rate;
+        tx += interfaces[i].tx_rate;
+    }
+    char rate[32];
+    char buffer[64];
+    if (ui->net_tx_label) {
+        tasks_ui_format_bytes(tx, "/s", rate, sizeof(rate));
+        snprintf(buffer, sizeof(buffer), "Tx: %s", rate);
+        tasks_ui_set_label_text(ui->net_tx_label, buffer);
+    }
+    if (ui->net_rx_label) {
+        tasks_ui_format_bytes(rx, "/s", rate, sizeof(rate));
+        snprintf(buffer, sizeof(buffer), "Rx: %s", rate);
+        tasks_ui_set_label_text(ui->net_rx_label, buffer);
+    }
+    if (ui->net_sockets_label) {
+        snprintf(buffer, sizeof(buffer), "Sockets: %d", socket_count);
+        tasks_ui_set_label_text(ui->net_sockets_label, buffer);
+    }
+
+    if (ui->net_interfaces_table) {
+        set_interface_rows(ui, interfaces, interface_count);
+    }
+    ui->net_sockets = sockets;
+    ui->net_socket_count = (sockets && socket_count > 0) ? socket_count : 0;
+    if (ui->net_sockets_table) {
+        ck_table_set_virtual_data(ui->net_sockets_table, ui->net_sockets, ui->net_socket_count);
+        socket_set_row_window(ui, ui->net_socket_row_start);
+    }
+}
@@ -2,6 +2,9 @@
 #include "ck-tasks-ui-helpers.h"
 #include "ck-tasks-ui.h"
 
+#include "ck-tasks-history.h"
+
+#include <Xm/DrawingA.h>
 #include <Xm/Form.h>
 #include <Xm/Frame.h>
 #include <Xm/LabelG.h>
@@ -9,9 +12,422 @@
 #include <Xm/ToggleBG.h>
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "../ck-load/vertical_meter.h"
 
+/*
+ * CPU history chart. The plot is kept in a pixmap laid out as one cell
+ * (overall) or one cell per core. A new sample scrolls the whole pixmap left
+ * with a single XCopyArea, repaints the gaps between cell columns and then
+ * draws only the newest column of every cell, batched into one request per
+ * GC, so the cost per tick does not grow with the chart width. The full plot
+ * is only redrawn from the history after a resize or a mode switch.
+ */
+#define PERF_CHART_STEP 2            /* pixels per sample */
+#define PERF_CHART_GAP 3             /* pixels between per-core cells */
+#define PERF_CHART_VGRID_SAMPLES 15  /* samples between vertical grid lines */
+#define PERF_CHART_MIN_CELL 8
+
+struct TasksCpuChart {
+    Widget area;
+    Widget overall_toggle;
+    Widget per_core_toggle;
+    Boolean per_core;
+    const TasksCpuHistory *history;
+    unsigned long drawn_head;  /* samples already in the pixmap */
+    Pixmap pixmap;
+    int width;
+    int height;
+    GC gc_gap;
+    GC gc_plot_bg;
+    GC gc_grid;
+    GC gc_line;
+    GC gc_copy;
+    int cell_count;
+    int cell_columns;
+    XRectangle *cells;
+    XRectangle *gaps;          /* full-height strips left of, between and right of cell columns */
+    int gap_count;
+    int grid_divisions;
+    unsigned char *column;     /* core_count + 1 values */
+    unsigned char *prev_column;
+    int column_size;
+    Boolean has_prev;
+    XRectangle *fill_rects;    /* per-cell scratch for one column */
+    XSegment *grid_segments;
+    XSegment *line_segments;
+    Time last_click;
+};
+
+static Pixel perf_chart_color(Widget w, const char *name, Pixel fallback)
+{
+    Display *dpy = XtDisplay(w);
+    Colormap cmap = DefaultColormap(dpy, DefaultScreen(dpy));
+    XColor screen, exact;
+    if (XAllocNamedColor(dpy, cmap, name, &screen, &exact)) return screen.pixel;
+    return fallback;
+}
+
+static GC perf_chart_gc(Widget w, Pixel pixel)
+{
+    XGCValues gcv;
+    gcv.foreground = pixel;
+    gcv.graphics_exposures = False;
+    return XtGetGC(w, GCForeground | GCGraphicsExposures, &gcv);
+}
+
+static int perf_chart_cell_total(TasksCpuChart *chart)
+{
+    int cores = tasks_cpu_history_core_count(chart->history);
+    return (chart->per_core && cores > 0) ? cores : 1;
+}
+
+/* Splits the pixmap into cells; per-core cells form a grid close to the area's aspect ratio. */
+static Boolean perf_chart_layout(TasksCpuChart *chart)
+{
+    int count = perf_chart_cell_total(chart);
+    /* Pick the grid whose cells come closest to twice as wide as tall. */
+    int columns = 1;
+    int rows = count;
+    double best = 0.0;
+    for (int c = 1; c <= count; ++c) {
+        int r = (count + c - 1) / c;
+        double ratio = ((double)chart->width / c) / ((double)chart->height / r) / 2.0;
+        double score = ratio >= 1.0 ? ratio : 1.0 / ratio;
+        if (c == 1 || score < best) {
+            best = score;
+            columns = c;
+            rows = r;
+        }
+    }
+    int gap = count > 1 ? PERF_CHART_GAP : 0;
+    int cell_w = (chart->width - gap * (columns + 1)) / columns;
+    int cell_h = (chart->height - gap * (rows + 1)) / rows;
+    if (cell_w < PERF_CHART_MIN_CELL || cell_h < PERF_CHART_MIN_CELL) return False;
+
+    if (count != chart->cell_count || columns != chart->cell_columns) {
+        XRectangle *cells = (XRectangle *)realloc(chart->cells, sizeof(XRectangle) * (size_t)count);
+        if (cells) chart->cells = cells;
+        XRectangle *fills = (XRectangle *)realloc(chart->fill_rects, sizeof(XRectangle) * (size_t)count);
+        if (fills) chart->fill_rects = fills;
+        XSegment *lines = (XSegment *)realloc(chart->line_segments, sizeof(XSegment) * (size_t)count * 2);
+        if (lines) chart->line_segments = lines;
+        XSegment *grid = (XSegment *)realloc(chart->grid_segments, sizeof(XSegment) * (size_t)count * 10);
+        if (grid) chart->grid_segments = grid;
+        XRectangle *gaps = (XRectangle *)realloc(chart->gaps, sizeof(XRectangle) * (size_t)(columns + 1));
+        if (gaps) chart->gaps = gaps;
+        if (!cells || !fills || !lines || !grid || !gaps) {
+            chart->cell_count = 0;
+            return False;
+        }
+    }
+    chart->cell_count = count;
+    chart->cell_columns = columns;
+    for (int i = 0; i < count; ++i) {
+        XRectangle *cell = &chart->cells[i];
+        cell->x = (short)(gap + (i % columns) * (cell_w + gap));
+        cell->y = (short)(gap + (i / columns) * (cell_h + gap));
+        cell->width = (unsigned short)cell_w;
+        cell->height = (unsigned short)cell_h;
+    }
+    chart->gap_count = 0;
+    if (gap > 0) {
+        for (int c = 0; c <= columns; ++c) {
+            int x = c * (cell_w + gap);
+            int right = (c == columns) ? chart->width : x + gap;
+            XRectangle *strip = &chart->gaps[chart->gap_count++];
+            strip->x = (short)x;
+            strip->y = 0;
+            strip->width = (unsigned short)(right - x);
+            strip->height = (unsigned short)chart->height;
+        }
+    }
+    chart->grid_divisions = cell_h >= 100 ? 10 : (cell_h >= 24 ? 4 : 0);
+    return True;
+}
+
+static short perf_chart_value_y(const XRectangle *cell, int percent)
+{
+    if (percent < 0) percent = 0;
+    if (percent > 100) percent = 100;
+    return (short)(cell->y + cell->height - 1 - (percent * (cell->height - 1)) / 100);
+}
+
+/*
+ * Draws sample (values in chart->column, the previous sample in
+ * prev_column) offset samples left of the right edge of every cell.
+ */
+static void perf_chart_draw_column(TasksCpuChart *chart, Display *dpy, unsigned long sample, int offset)
+{
+    int grid_count = 0;
+    Boolean vgrid = (sample % PERF_CHART_VGRID_SAMPLES) == 0;
+    for (int i = 0; i < chart->cell_count; ++i) {
+        const XRectangle *cell = &chart->cells[i];
+        int x_end = cell->x + cell->width - 1 - offset * PERF_CHART_STEP;
+        int x_start = x_end - PERF_CHART_STEP + 1;
+        if (x_start < cell->x) x_start = cell->x;
+
+        XRectangle *fill = &chart->fill_rects[i];
+        fill->x = (short)x_start;
+        fill->y = cell->y;
+        fill->width = (unsigned short)(x_end - x_start + 1);
+        fill->height = cell->height;
+
+        for (int d = 1; d < chart->grid_divisions; ++d) {
+            short y = (short)(cell->y + (d * cell->height) / chart->grid_divisions);
+            XSegment *seg = &chart->grid_segments[grid_count++];
+            seg->x1 = (short)x_start;
+            seg->x2 = (short)x_end;
+            seg->y1 = seg->y2 = y;
+        }
+        if (vgrid) {
+            XSegment *seg = &chart->grid_segments[grid_count++];
+            seg->x1 = seg->x2 = (short)x_end;
+            seg->y1 = cell->y;
+            seg->y2 = (short)(cell->y + cell->height - 1);
+        }
+
+        int value_index = chart->cell_count > 1 ? 1 + i : 0;
+        short y = perf_chart_value_y(cell, chart->column[value_index]);
+        short prev_y = chart->has_prev ? perf_chart_value_y(cell, chart->prev_column[value_index]) : y;
+        XSegment *line = &chart->line_segments[i];
+        line->x1 = (short)(x_start - 1 >= cell->x ? x_start - 1 : x_start);
+        line->y1 = prev_y;
+        line->x2 = (short)x_end;
+        line->y2 = y;
+    }
+    XFillRectangles(dpy, chart->pixmap, chart->gc_plot_bg, chart->fill_rects, chart->cell_count);
+    if (grid_count > 0) XDrawSegments(dpy, chart->pixmap, chart->gc_grid, chart->grid_segments, grid_count);
+    XDrawSegments(dpy, chart->pixmap, chart->gc_line, chart->line_segments, chart->cell_count);
+}
+
+/* Loads sample into chart->column, keeping the previous one; False if it is gone. */
+static Boolean perf_chart_load_sample(TasksCpuChart *chart, unsigned long sample)
+{
+    unsigned char *swap = chart->prev_column;
+    chart->prev_column = chart->column;
+    chart->column = swap;
+    if (tasks_cpu_history_read(chart->history, sample, chart->column) != 0) {
+        chart->has_prev = False;
+        return False;
+    }
+    return True;
+}
+
+static void perf_chart_copy_to_window(TasksCpuChart *chart, int x, int y, int width, int height)
+{
+    if (!chart->pixmap || !XtIsRealized(chart->area)) return;
+    XCopyArea(XtDisplay(chart->area), chart->pixmap, XtWindow(chart->area), chart->gc_copy,
+              x, y, (unsigned int)width, (unsigned int)height, x, y);
+}
+
+/* Rebuilds the pixmap from the history (after a resize or a mode switch). */
+static void perf_chart_redraw(TasksCpuChart *chart)
+{
+    if (!chart->area || !XtIsRealized(chart->area)) return;
+    Display *dpy = XtDisplay(chart->area);
+    Dimension width = 0, height = 0;
+    XtVaGetValues(chart->area, XmNwidth, &width, XmNheight, &height, NULL);
+    if (width < 2 || height < 2) return;
+    if (!chart->pixmap || chart->width != (int)width || chart->height != (int)height) {
+        if (chart->pixmap) XFreePixmap(dpy, chart->pixmap);
+        chart->pixmap = XCreatePixmap(dpy, XtWindow(chart->area), width, height,
+                                      DefaultDepthOfScreen(XtScreen(chart->area)));
+        chart->width = width;
+        chart->height = height;
+        chart->cell_count = 0;
+        chart->cell_columns = 0;
+    }
+
+    XFillRectangle(dpy, chart->pixmap, chart->gc_gap, 0, 0, width, height);
+    chart->drawn_head = tasks_cpu_history_head(chart->history);
+    if (!chart->history || !perf_chart_layout(chart)) {
+        chart->cell_count = 0;
+        perf_chart_copy_to_window(chart, 0, 0, chart->width, chart->height);
+        return;
+    }
+    int size = tasks_cpu_history_core_count(chart->history) + 1;
+    if (size != chart->column_size) {
+        unsigned char *column = (unsigned char *)realloc(chart->column, (size_t)size);
+        if (column) chart->column = column;
+        unsigned char *prev = (unsigned char *)realloc(chart->prev_column, (size_t)size);
+        if (prev) chart->prev_column = prev;
+        if (!column || !prev) {
+            chart->cell_count = 0;
+            return;
+        }
+        chart->column_size = size;
+    }
+    XFillRectangles(dpy, chart->pixmap, chart->gc_plot_bg, chart->cells, chart->cell_count);
+
+    /* Oldest sample that still fits into a cell, and that the ring still holds. */
+    unsigned long head = chart->drawn_head;
+    unsigned long visible = (unsigned long)(chart->cells[0].width / PERF_CHART_STEP);
+    unsigned long capacity = (unsigned long)tasks_cpu_history_capacity(chart->history);
+    if (visible >= capacity) visible = capacity - 1;
+    unsigned long first = head > visible ? head - visible : 0;
+    chart->has_prev = False;
+    for (unsigned long sample = first; sample < head; ++sample) {
+        if (!perf_chart_load_sample(chart, sample)) continue;
+        perf_chart_draw_column(chart, dpy, sample, (int)(head - 1 - sample));
+        chart->has_prev = True;
+    }
+    perf_chart_copy_to_window(chart, 0, 0, chart->width, chart->height);
+}
+
+/* Scrolls in the samples pushed since the last update. */
+static void perf_chart_update(TasksCpuChart *chart)
+{
+    if (!chart->pixmap || chart->cell_count == 0) {
+        perf_chart_redraw(chart);
+        return;
+    }
+    unsigned long head = tasks_cpu_history_head(chart->history);
+    if (head == chart->drawn_head) return;
+    unsigned long visible = (unsigned long)(chart->cells[0].width / PERF_CHART_STEP);
+    if (head - chart->drawn_head >= visible) {
+        perf_chart_redraw(chart);
+        return;
+    }
+    Display *dpy = XtDisplay(chart->area);
+    for (unsigned long sample = chart->drawn_head; sample < head; ++sample) {
+        XCopyArea(dpy, chart->pixmap, chart->pixmap, chart->gc_copy, PERF_CHART_STEP, 0,
+                  (unsigned int)(chart->width - PERF_CHART_STEP), (unsigned int)chart->height, 0, 0);
+        if (chart->gap_count > 0) {
+            XFillRectangles(dpy, chart->pixmap, chart->gc_gap, chart->gaps, chart->gap_count);
+        }
+        if (perf_chart_load_sample(chart, sample)) {
+            perf_chart_draw_column(chart, dpy, sample, 0);
+            chart->has_prev = True;
+        }
+    }
+    chart->drawn_head = head;
+    perf_chart_copy_to_window(chart, 0, 0, chart->width, chart->height);
+}
+
+static void perf_chart_set_per_core(TasksCpuChart *chart, Boolean per_core)
+{
+    if (chart->per_core == per_core) return;
+    chart->per_core = per_core;
+    if (chart->overall_toggle) XmToggleButtonGadgetSetState(chart->overall_toggle, !per_core, False);
+    if (chart->per_core_toggle) XmToggleButtonGadgetSetState(chart->per_core_toggle, per_core, False);
+    chart->cell_count = 0;
+    perf_chart_redraw(chart);
+}
+
+static void on_perf_chart_expose(Widget w, XtPointer client, XtPointer call)
+{
+    (void)w;
+    TasksCpuChart *chart = (TasksCpuChart *)client;
+    XmDrawingAreaCallbackStruct *cbs = (XmDrawingAreaCallbackStruct *)call;
+    if (!chart || !cbs || !cbs->event) return;
+    if (!chart->pixmap) {
+        perf_chart_redraw(chart);
+        return;
+    }
+    XExposeEvent *expose = &cbs->event->xexpose;
+    perf_chart_copy_to_window(chart, expose->x, expose->y, expose->width, expose->height);
+}
+
+static void on_perf_chart_resize(Widget w, XtPointer client, XtPointer call)
+{
+    (void)w;
+    (void)call;
+    TasksCpuChart *chart = (TasksCpuChart *)client;
+    if (!chart) return;
+    perf_chart_redraw(chart);
+}
+
+/* Double-click on the plot switches between the overall and per-core views. */
+static void on_perf_chart_input(Widget w, XtPointer client, XtPointer call)
+{
+    TasksCpuChart *chart = (TasksCpuChart *)client;
+    XmDrawingAreaCallbackStruct *cbs = (XmDrawingAreaCallbackStruct *)call;
+    if (!chart || !cbs || !cbs->event || cbs->event->type != ButtonPress) return;
+    XButtonEvent *button = &cbs->event->xbutton;
+    if (button->button != Button1) return;
+    Time interval = (Time)XtGetMultiClickTime(XtDisplay(w));
+    if (chart->last_click != 0 && button->time - chart->last_click <= interval) {
+        chart->last_click = 0;
+        perf_chart_set_per_core(chart, !chart->per_core);
+        return;
+    }
+    chart->last_click = button->time;
+}
+
+static void on_perf_chart_mode(Widget w, XtPointer client, XtPointer call)
+{
+    TasksCpuChart *chart = (TasksCpuChart *)client;
+    XmToggleButtonCallbackStruct *cbs = (XmToggleButtonCallbackStruct *)call;
+    if (!chart || !cbs || !cbs->set) return;
+    perf_chart_set_per_core(chart, w == chart->per_core_toggle);
+}
+
+static TasksCpuChart *perf_chart_create(Widget parent, Widget overall_toggle, Widget per_core_toggle)
+{
+    TasksCpuChart *chart = (TasksCpuChart *)calloc(1, sizeof(TasksCpuChart));
+    if (!chart) return NULL;
+    chart->overall_toggle = overall_toggle;
+    chart->per_core_toggle = per_core_toggle;
+
+    Arg args[4];
+    int n = 0;
+    XtSetArg(args[n], XmNwidth, 400); n++;
+    XtSetArg(args[n], XmNheight, 160); n++;
+    XtSetArg(args[n], XmNresizePolicy, XmRESIZE_NONE); n++;
+    chart->area = XmCreateDrawingArea(parent, "cpuHistoryChart", args, n);
+
+    Pixel gap = 0;
+    XtVaGetValues(chart->area, XmNbackground, &gap, NULL);
+    Pixel black = BlackPixelOfScreen(XtScreen(chart->area));
+    Pixel white = WhitePixelOfScreen(XtScreen(chart->area));
+    chart->gc_gap = perf_chart_gc(chart->area, gap);
+    chart->gc_plot_bg = perf_chart_gc(chart->area, black);
+    chart->gc_grid = perf_chart_gc(chart->area, perf_chart_color(chart->area, "#006000", white));
+    chart->gc_line = perf_chart_gc(chart->area, perf_chart_color(chart->area, "#00ff40", white));
+    chart->gc_copy = perf_chart_gc(chart->area, black);
+
+    XtAddCallback(chart->area, XmNexposeCallback, on_perf_chart_expose, chart);
+    XtAddCallback(chart->area, XmNresizeCallback, on_perf_chart_resize, chart);
+    XtAddCallback(chart->area, XmNinputCallback, on_perf_chart_input, chart);
+    if (overall_toggle) XtAddCallback(overall_toggle, XmNvalueChangedCallback, on_perf_chart_mode, chart);
+    if (per_core_toggle) XtAddCallback(per_core_toggle, XmNvalueChangedCallback, on_perf_chart_mode, chart);
+    XtManageChild(chart->area);
+    return chart;
+}
+
+static void perf_chart_destroy(TasksCpuChart *chart)
+{
+    if (!chart) return;
+    if (chart->area) {
+        XtRemoveCallback(chart->area, XmNexposeCallback, on_perf_chart_expose, chart);
+        XtRemoveCallback(chart->area, XmNresizeCallback, on_perf_chart_resize, chart);
+        XtRemoveCallback(chart->area, XmNinputCallback, on_perf_chart_input, chart);
+        if (chart->overall_toggle) {
+            XtRemoveCallback(chart->overall_toggle, XmNvalueChangedCallback, on_perf_chart_mode, chart);
+        }
+        if (chart->per_core_toggle) {
+            XtRemoveCallback(chart->per_core_toggle, XmNvalueChangedCallback, on_perf_chart_mode, chart);
+        }
+        if (chart->pixmap) XFreePixmap(XtDisplay(chart->area), chart->pixmap);
+        XtReleaseGC(chart->area, chart->gc_gap);
+        XtReleaseGC(chart->area, chart->gc_plot_bg);
+        XtReleaseGC(chart->area, chart->gc_grid);
+        XtReleaseGC(chart->area, chart->gc_line);
+        XtReleaseGC(chart->area, chart->gc_copy);
+    }
+    free(chart->cells);
+    free(chart->gaps);
+    free(chart->column);
+    free(chart->prev_column);
+    free(chart->fill_rects);
+    free(chart->grid_segments);
+    free(chart->line_segments);
+    free(chart);
+}
+
 static Widget create_meter_column(Widget parent, const char *label_text,
                                   Widget *out_meter, Widget *out_value_label)
 {
@@ -88,7 +504,7 @@ static void add_performance_tab_content(TasksUi *ui, Widget page)
                   XmNradioBehavior, True,
                   NULL);
     XmString overall = tasks_ui_make_string("Overall chart");
-    XtVaCreateManagedWidget(
+    Widget overall_toggle = XtVaCreateManagedWidget(
         "cpuOverallMode",
         xmToggleButtonGadgetClass, mode_box,
         XmNlabelString, overall,
@@ -98,7 +514,7 @@ static void add_performance_tab_content(TasksUi *ui, Widget page)
     XmStringFree(overall);
 
     XmString divided = tasks_ui_make_string("Divided per-core chart");
-    XtVaCreateManagedWidget(
+    Widget per_core_toggle = XtVaCreateManagedWidget(
         "cpuPerCoreMode",
         xmToggleButtonGadgetClass, mode_box,
         XmNlabelString, divided,
@@ -154,16 +570,7 @@ static void add_performance_tab_content(TasksUi *ui, Widget page)
                   NULL);
     XtManageChild(history_frame);
 
-    XmString history_text = tasks_ui_make_string("CPU history chart will alternate between overall and per-core views when the user toggles a mode or double-clicks the plot area.");
-    XtVaCreateManagedWidget(
-        "historyLabel",
-        xmLabelGadgetClass, history_frame,
-        XmNlabelString, history_text,
-        XmNalignment, XmALIGNMENT_BEGINNING,
-        XmNmarginHeight, 8,
-        XmNmarginWidth, 8,
-        NULL);
-    XmStringFree(history_text);
+    ui->perf_chart = perf_chart_create(history_frame, overall_toggle, per_core_toggle);
 }
 
 Widget tasks_ui_create_performance_tab(TasksUi *ui)
@@ -174,6 +581,26 @@ Widget tasks_ui_create_performance_tab(TasksUi *ui)
     return page;
 }
 
+void tasks_ui_destroy_performance_tab(TasksUi *ui)
+{
+    if (!ui) return;
+    perf_chart_destroy(ui->perf_chart);
+    ui->perf_chart = NULL;
+}
+
+void tasks_ui_update_cpu_history(TasksUi *ui, const TasksCpuHistory *history)
+{
+    if (!ui || !ui->perf_chart) return;
+    TasksCpuChart *chart = ui->perf_chart;
+    if (chart->history != history) {
+        chart->history = history;
+        chart->cell_count = 0;
+        perf_chart_redraw(chart);
+        return;
+    }
+    perf_chart_update(chart);
+}
+
 void tasks_ui_update_system_stats(TasksUi *ui, const TasksSystemStats *stats)
 {
     if (!ui || !stats) return;
@@ -1,6 +1,7 @@
 #include "ck-tasks-tabs.h"
 #include "ck-tasks-ctrl.h"
 #include "ck-tasks-ui-helpers.h"
+#include "ck-tasks-details.h"
 
 #include <Xm/Form.h>
 #include <Xm/ScrolledW.h>
@@ -23,11 +24,49 @@ static const TableColumnDef process_columns[] = {
     {"processMemory", "Memory (MB)", TABLE_ALIGN_RIGHT, True, True, 0},
     {"processThreads", "Threads", TABLE_ALIGN_RIGHT, True, True, 0},
     {"processUser", "User/Session", TABLE_ALIGN_LEFT, False, True, 0},
+    /* Detail columns are filled in lazily for the visible rows only, so they
+     * cannot order the whole list. */
+    {"processPss", "PSS (MB)", TABLE_ALIGN_RIGHT, True, False, 0},
+    {"processIoRead", "I/O Read (MB)", TABLE_ALIGN_RIGHT, True, False, 0},
+    {"processIoWrite", "I/O Write (MB)", TABLE_ALIGN_RIGHT, True, False, 0},
+    {"processHandles", "Handles", TABLE_ALIGN_RIGHT, True, False, 0},
 };
 
 #define PROCESS_COLUMN_COUNT (sizeof(process_columns) / sizeof(process_columns[0]))
+#define PROCESS_DETAIL_COLUMNS ((1u << 6) | (1u << 7) | (1u << 8) | (1u << 9))
 
 static CkTable *g_process_table = NULL;
+static int *g_process_delta_rows = NULL;
+static unsigned int *g_process_delta_columns = NULL;
+static int g_process_delta_capacity = 0;
+
+/* Empty until the details arrive, "-" if they could not be read. */
+static const char *process_detail_text(const TasksUi *ui, pid_t pid, int column,
+                                       char *buffer, size_t buffer_len)
+{
+    const TasksProcessDetails *details = ui ? tasks_details_lookup(ui->process_details, pid) : NULL;
+    if (!details) return "";
+    switch (column) {
+    case 6:
+        if (!(details->valid & TASKS_DETAIL_PSS)) return "-";
+        snprintf(buffer, buffer_len, "%.1f", (double)details->pss_kb / 1024.0);
+        return buffer;
+    case 7:
+        if (!(details->valid & TASKS_DETAIL_IO)) return "-";
+        snprintf(buffer, buffer_len, "%.1f", (double)details->read_bytes / (1024.0 * 1024.0));
+        return buffer;
+    case 8:
+        if (!(details->valid & TASKS_DETAIL_IO)) return "-";
+        snprintf(buffer, buffer_len, "%.1f", (double)details->write_bytes / (1024.0 * 1024.0));
+        return buffer;
+    case 9:
+        if (!(details->valid & TASKS_DETAIL_FDS)) return "-";
+        snprintf(buffer, buffer_len, "%d", details->fd_count);
+        return buffer;
+    default:
+        return "";
+    }
+}
 
 static const char *process_table_get_text(void *context,
                                           const void *entries,
@@ -36,27 +75,32 @@ static const char *process_table_get_text(void *context,
                                           char *buffer,
                                           size_t buffer_len)
 {
-    (void)context;
-    const TasksProcessEntry *list = (const TasksProcessEntry *)entries;
-    if (!list || row < 0) return "";
-    const TasksProcessEntry *entry = &list[row];
+    const TasksProcessView *view = (const TasksProcessView *)entries;
+    if (!view || !view->list || row < 0 || row >= view->count) return "";
+    const TasksProcessList *list = view->list;
+    int index = view->rows[row];
     switch (column) {
     case 0:
-        return entry->name;
+        return tasks_model_process_name(list, index);
     case 1:
-        snprintf(buffer, buffer_len, "%d", (int)entry->pid);
+        snprintf(buffer, buffer_len, "%d", (int)list->pids[index]);
         return buffer;
     case 2:
-        snprintf(buffer, buffer_len, "%.1f", entry->cpu_percent);
+        snprintf(buffer, buffer_len, "%.1f", list->cpu_percent[index]);
         return buffer;
     case 3:
-        snprintf(buffer, buffer_len, "%.0f", entry->memory_mb);
+        snprintf(buffer, buffer_len, "%.0f", list->memory_mb[index]);
         return buffer;
     case 4:
-        snprintf(buffer, buffer_len, "%d", entry->threads);
+        snprintf(buffer, buffer_len, "%d", list->threads[index]);
         return buffer;
     case 5:
-        return entry->user;
+        return tasks_model_process_user(list, index);
+    case 6:
+    case 7:
+    case 8:
+    case 9:
+        return process_detail_text((const TasksUi *)context, list->pids[index], column, buffer, buffer_len);
     default:
         return "";
     }
@@ -69,22 +113,23 @@ static double process_table_get_number(void *context,
                                        Boolean *has_value)
 {
     (void)context;
-    const TasksProcessEntry *list = (const TasksProcessEntry *)entries;
-    if (!list || row < 0) {
+    const TasksProcessView *view = (const TasksProcessView *)entries;
+    if (!view || !view->list || row < 0 || row >= view->count) {
         if (has_value) *has_value = False;
         return 0.0;
     }
-    const TasksProcessEntry *entry = &list[row];
+    const TasksProcessList *list = view->list;
+    int index = view->rows[row];
     if (has_value) *has_value = True;
     switch (column) {
     case 1:
-        return (double)entry->pid;
+        return (double)list->pids[index];
     case 2:
-        return entry->cpu_percent;
+        return list->cpu_percent[index];
     case 3:
-        return entry->memory_mb;
+        return list->memory_mb[index];
     case 4:
-        return (double)entry->threads;
+        return (double)list->threads[index];
     default:
         if (has_value) *has_value = False;
         return 0.0;
@@ -223,12 +268,71 @@ void tasks_ui_destroy_process_tab(TasksUi *ui)
         ck_table_destroy(ui->process_table);
         ui->process_table = NULL;
     }
+    free(g_process_delta_rows);
+    free(g_process_delta_columns);
+    g_process_delta_rows = NULL;
+    g_process_delta_columns = NULL;
+    g_process_delta_capacity = 0;
 }
 
-void tasks_ui_set_processes(TasksUi *ui, const TasksProcessEntry *entries, int count)
+/* The table keeps the view pointer and reads rows through it, so the view must
+ * stay in place (not be copied) while it is shown. */
+void tasks_ui_set_processes(TasksUi *ui, const TasksProcessView *view)
 {
-    if (!ui || !ui->process_table) return;
-    ck_table_set_virtual_data(ui->process_table, entries, count);
+    if (!ui || !ui->process_table || !view) return;
+    ck_table_set_virtual_data(ui->process_table, view, view->count);
+}
+
+/* Column bits (see process_columns) affected by each TASKS_PROCESS_FIELD_* bit. */
+static unsigned int process_fields_to_columns(unsigned int fields)
+{
+    unsigned int columns = 0;
+    if (fields & TASKS_PROCESS_FIELD_NAME) columns |= 1u << 0;
+    if (fields & TASKS_PROCESS_FIELD_CPU) columns |= 1u << 2;
+    if (fields & TASKS_PROCESS_FIELD_MEMORY) columns |= 1u << 3;
+    if (fields & TASKS_PROCESS_FIELD_THREADS) columns |= 1u << 4;
+    if (fields & TASKS_PROCESS_FIELD_USER) columns |= 1u << 5;
+    return columns;
+}
+
+void tasks_ui_apply_process_delta(TasksUi *ui, const TasksProcessView *view,
+                                  const TasksProcessDiff *diff)
+{
+    if (!ui || !ui->process_table || !view) return;
+    if (!diff) {
+        ck_table_set_virtual_data(ui->process_table, view, view->count);
+        return;
+    }
+    if (diff->changed_count > g_process_delta_capacity) {
+        int *rows = (int *)realloc(g_process_delta_rows, sizeof(int) * (size_t)diff->changed_count);
+        if (rows) g_process_delta_rows = rows;
+        unsigned int *columns = (unsigned int *)realloc(g_process_delta_columns,
+                                                        sizeof(unsigned int) * (size_t)diff->changed_count);
+        if (columns) g_process_delta_columns = columns;
+        if (!rows || !columns) {
+            ck_table_set_virtual_data(ui->process_table, view, view->count);
+            return;
+        }
+        g_process_delta_capacity = diff->changed_count;
+    }
+    int changed_count = 0;
+    for (int i = 0; i < diff->changed_count; ++i) {
+        unsigned int columns = process_fields_to_columns(diff->changed_fields[i]);
+        if (!columns) continue;
+        g_process_delta_rows[changed_count] = diff->changed[i];
+        g_process_delta_columns[changed_count] = columns;
+        changed_count++;
+    }
+
+    CkTableVirtualDelta delta;
+    delta.old_to_new = diff->old_to_new;
+    delta.old_count = diff->old_count;
+    delta.added = diff->added;
+    delta.added_count = diff->added_count;
+    delta.changed = g_process_delta_rows;
+    delta.changed_columns = g_process_delta_columns;
+    delta.changed_count = changed_count;
+    ck_table_apply_virtual_delta(ui->process_table, view, view->count, &delta);
 }
 
 void tasks_ui_set_process_row_window(int start)
@@ -242,3 +346,15 @@ int tasks_ui_get_process_row_page_size(void)
     if (!g_process_table) return 0;
     return ck_table_get_virtual_row_page_size(g_process_table);
 }
+
+int tasks_ui_get_visible_process_rows(TasksUi *ui, int *out_rows, int max_rows)
+{
+    if (!ui || !ui->process_table) return 0;
+    return ck_table_get_virtual_visible_entries(ui->process_table, out_rows, max_rows);
+}
+
+void tasks_ui_refresh_process_details(TasksUi *ui)
+{
+    if (!ui || !ui->process_table) return;
+    ck_table_refresh_virtual_columns(ui->process_table, PROCESS_DETAIL_COLUMNS);
+}
@@ -11,10 +11,14 @@ Widget tasks_ui_create_simple_tab(TasksUi *ui, TasksTab tab, const char *name,
                                   const char *title, const char *description);
 Widget tasks_ui_create_services_tab(TasksUi *ui);
 Widget tasks_ui_create_users_tab(TasksUi *ui);
+Widget tasks_ui_create_cgroups_tab(TasksUi *ui);
 
 void tasks_ui_destroy_process_tab(TasksUi *ui);
 void tasks_ui_destroy_applications_tab(TasksUi *ui);
+void tasks_ui_destroy_networking_tab(TasksUi *ui);
+void tasks_ui_destroy_performance_tab(TasksUi *ui);
 void tasks_ui_destroy_services_tab(TasksUi *ui);
 void tasks_ui_destroy_users_tab(TasksUi *ui);
+void tasks_ui_destroy_cgroups_tab(TasksUi *ui);
 
 #endif /* CK_TASKS_TABS_H */
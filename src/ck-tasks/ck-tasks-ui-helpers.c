@@ -2,6 +2,7 @@
 
 #include <Xm/Form.h>
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -21,6 +22,21 @@ XmString *tasks_ui_make_string_array(const char *const strings[], int count)
     return result;
 }
 
+void tasks_ui_format_bytes(double bytes, const char *suffix, char *buffer, size_t len)
+{
+    static const char *const units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit = 0;
+    while (bytes >= 1024.0 && unit < 4) {
+        bytes /= 1024.0;
+        unit++;
+    }
+    if (unit == 0) {
+        snprintf(buffer, len, "%.0f %s%s", bytes, units[unit], suffix);
+    } else {
+        snprintf(buffer, len, "%.1f %s%s", bytes, units[unit], suffix);
+    }
+}
+
 void tasks_ui_set_label_text(Widget widget, const char *text)
 {
     if (!widget) return;
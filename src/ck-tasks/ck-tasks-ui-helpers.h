@@ -9,6 +9,8 @@
 
 XmString tasks_ui_make_string(const char *text);
 XmString *tasks_ui_make_string_array(const char *const strings[], int count);
+/* "1.5 MB" style, with suffix appended (e.g. "/s" for rates). */
+void tasks_ui_format_bytes(double bytes, const char *suffix, char *buffer, size_t len);
 void tasks_ui_set_label_text(Widget widget, const char *text);
 Boolean tasks_ui_status_set_label_text(Widget label, char *cache, size_t cache_len, const char *text);
 Widget tasks_ui_create_page(TasksUi *ui, const char *name, TasksTab tab_number,
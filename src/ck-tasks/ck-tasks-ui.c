@@ -504,6 +504,7 @@ TasksUi *tasks_ui_create(XtAppContext app, Widget toplevel)
     ui->tab_performance = tasks_ui_create_performance_tab(ui);
     ui->tab_networking = tasks_ui_create_networking_tab(ui);
     ui->tab_users = tasks_ui_create_users_tab(ui);
+    ui->tab_cgroups = tasks_ui_create_cgroups_tab(ui);
 
     Widget initial_tab = tasks_ui_get_tab_widget(ui, TASKS_TAB_PROCESSES);
     if (initial_tab) {
@@ -517,8 +518,11 @@ void tasks_ui_destroy(TasksUi *ui)
 {
     tasks_ui_destroy_applications_tab(ui);
     tasks_ui_destroy_process_tab(ui);
+    tasks_ui_destroy_performance_tab(ui);
+    tasks_ui_destroy_networking_tab(ui);
     tasks_ui_destroy_services_tab(ui);
     tasks_ui_destroy_users_tab(ui);
+    tasks_ui_destroy_cgroups_tab(ui);
     free(ui);
 }
 
@@ -543,6 +547,7 @@ int tasks_ui_get_current_tab(TasksUi *ui)
     if (selected == ui->tab_applications) return TASKS_TAB_APPLICATIONS;
     if (selected == ui->tab_services) return TASKS_TAB_SERVICES;
     if (selected == ui->tab_users) return TASKS_TAB_USERS;
+    if (selected == ui->tab_cgroups) return TASKS_TAB_CGROUPS;
     return TASKS_TAB_PROCESSES;
 }
 
@@ -593,6 +598,7 @@ static Widget tasks_ui_get_tab_widget(TasksUi *ui, TasksTab tab)
     case TASKS_TAB_APPLICATIONS: return ui->tab_applications;
     case TASKS_TAB_SERVICES: return ui->tab_services;
     case TASKS_TAB_USERS: return ui->tab_users;
+    case TASKS_TAB_CGROUPS: return ui->tab_cgroups;
     default: return NULL;
     }
 }
@@ -8,6 +8,8 @@
 #include "ck-tasks-model.h"
 
 typedef struct TasksController TasksController;
+typedef struct TasksCpuChart TasksCpuChart;
+typedef struct TasksDetails TasksDetails;
 
 typedef struct TasksApplicationEntry {
     Window window;
@@ -26,6 +28,7 @@ typedef enum {
     TASKS_TAB_APPLICATIONS,
     TASKS_TAB_SERVICES,
     TASKS_TAB_USERS,
+    TASKS_TAB_CGROUPS,
 } TasksTab;
 
 typedef struct {
@@ -40,6 +43,7 @@ typedef struct {
     Widget tab_applications;
     Widget tab_services;
     Widget tab_users;
+    Widget tab_cgroups;
     Widget status_frame_processes;
     Widget status_frame_cpu;
     Widget status_frame_memory;
@@ -60,6 +64,7 @@ typedef struct {
     Widget process_search_field;
     Widget process_scrollbar;
     CkTable *process_table;
+    TasksDetails *process_details; /* owned by the controller */
     CkTable *apps_table;
     CkTable *services_table;
     Widget services_controls_form;
@@ -109,6 +114,26 @@ typedef struct {
     Widget perf_load1_value_label;
     Widget perf_load5_value_label;
     Widget perf_load15_value_label;
+    TasksCpuChart *perf_chart;
+    Widget net_tx_label;
+    Widget net_rx_label;
+    Widget net_sockets_label;
+    CkTable *net_interfaces_table;
+    TableRow **net_interface_rows;
+    int net_interface_row_count;
+    int net_interface_row_capacity;
+    CkTable *net_sockets_table;
+    Widget net_socket_scrollbar;
+    int net_socket_row_start;
+    const TasksNetSocket *net_sockets;
+    int net_socket_count;
+    Widget cgroups_summary_label;
+    char cgroups_summary_text[128];
+    CkTable *cgroups_table;
+    Widget cgroups_scrollbar;
+    int cgroups_row_start;
+    const TasksCgroupEntry *cgroups;
+    int cgroup_count;
     Widget menu_file_connect;
     Widget menu_file_new_window;
     Widget menu_file_exit;
@@ -134,15 +159,27 @@ int tasks_ui_get_current_tab(TasksUi *ui);
 void tasks_ui_set_current_tab(TasksUi *ui, TasksTab tab);
 void tasks_ui_update_status(TasksUi *ui, const char *text);
 void tasks_ui_center_on_screen(TasksUi *ui);
-void tasks_ui_set_processes(TasksUi *ui, const TasksProcessEntry *entries, int count);
+void tasks_ui_set_processes(TasksUi *ui, const TasksProcessView *view);
+void tasks_ui_apply_process_delta(TasksUi *ui, const TasksProcessView *view,
+                                  const TasksProcessDiff *diff);
 void tasks_ui_set_process_row_window(int start);
 int tasks_ui_get_process_row_page_size(void);
+/* View row indices of the process rows on screen; returns how many. */
+int tasks_ui_get_visible_process_rows(TasksUi *ui, int *out_rows, int max_rows);
+/* Redraws the lazily fetched detail columns of the visible rows. */
+void tasks_ui_refresh_process_details(TasksUi *ui);
 void tasks_ui_set_applications_table(TasksUi *ui, const TasksApplicationEntry *entries, int count);
 void tasks_ui_set_users_table(TasksUi *ui, const TasksUserEntry *entries, int count);
 void tasks_ui_set_services_table(TasksUi *ui, const TasksServiceEntry *entries, int count,
                                  const TasksInitInfo *init_info);
 void tasks_ui_update_process_count(TasksUi *ui, int total_processes);
 void tasks_ui_update_system_stats(TasksUi *ui, const TasksSystemStats *stats);
+void tasks_ui_set_network(TasksUi *ui, const TasksNetInterface *interfaces, int interface_count,
+                          const TasksNetSocket *sockets, int socket_count);
+/* NULL entries: no cgroup v2 hierarchy. */
+void tasks_ui_set_cgroups(TasksUi *ui, const TasksCgroupEntry *entries, int count);
+/* Scrolls the Performance tab chart to the newest samples of history. */
+void tasks_ui_update_cpu_history(TasksUi *ui, const TasksCpuHistory *history);
 void tasks_ui_statusbar_maybe_resize(TasksUi *ui);
 
 #endif /* CK_TASKS_UI_H */
@@ -0,0 +1,914 @@
+#include "ck-tasks-wire.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <zlib.h>
+
+/* Past this many dictionary strings the encoder starts over with a reset, so
+ * names of long-gone processes do not pile up on either side. */
+#define TASKS_WIRE_MAX_STRINGS 16384
+#define TASKS_WIRE_INITIAL_SLOTS 1024
+/* Smaller payloads are not worth a deflate stream. */
+#define TASKS_WIRE_COMPRESS_MIN 128
+
+typedef struct {
+    pid_t pid;
+    unsigned int name_id;
+    unsigned int user_id;
+    unsigned int cpu_tenths;
+    unsigned long long memory_kb;
+    unsigned int threads;
+} WireSentProcess;
+
+typedef struct {
+    pid_t pid;
+    unsigned int name_id;
+    unsigned int user_id;
+    unsigned int cpu_tenths;
+    unsigned long long memory_kb;
+    unsigned int threads;
+    char *command; /* owned; NULL if never sent */
+} WireProcess;
+
+struct TasksWireEncoder {
+    int compress;
+    int reset_pending;
+    WireSentProcess *sent;
+    int sent_count;
+    int sent_capacity;
+    WireSentProcess *next;
+    int next_capacity;
+    int *order;
+    int order_capacity;
+    char *strings;
+    size_t strings_used;
+    size_t strings_capacity;
+    unsigned int *string_offsets;
+    int string_count;
+    int string_capacity;
+    unsigned int *slots; /* string id + 1, 0 = empty */
+    int slot_count;
+    TasksWireBuffer removed;
+    TasksWireBuffer changed;
+    TasksWireBuffer payload;
+};
+
+struct TasksWireDecoder {
+    char **strings;
+    int string_count;
+    int string_capacity;
+    WireProcess *table;
+    int count;
+    int capacity;
+    WireProcess *next;
+    int next_capacity;
+    pid_t *removed;
+    int removed_capacity;
+    unsigned char *inflated;
+    size_t inflated_capacity;
+};
+
+static int wire_reserve(void **array, size_t element_size, int *capacity, int needed)
+{
+    if (needed <= *capacity) return 0;
+    int new_capacity = *capacity ? *capacity : 256;
+    while (new_capacity < needed) {
+        if (new_capacity > INT32_MAX / 2) return -1;
+        new_capacity *= 2;
+    }
+    void *resized = realloc(*array, element_size * (size_t)new_capacity);
+    if (!resized) return -1;
+    *array = resized;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static int buffer_reserve(TasksWireBuffer *buffer, size_t extra)
+{
+    size_t needed = buffer->length + extra;
+    if (needed <= buffer->capacity) return 0;
+    size_t new_capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (new_capacity < needed) new_capacity *= 2;
+    unsigned char *resized = (unsigned char *)realloc(buffer->data, new_capacity);
+    if (!resized) return -1;
+    buffer->data = resized;
+    buffer->capacity = new_capacity;
+    return 0;
+}
+
+static int buffer_append(TasksWireBuffer *buffer, const void *data, size_t len)
+{
+    if (buffer_reserve(buffer, len) != 0) return -1;
+    if (len > 0) memcpy(buffer->data + buffer->length, data, len);
+    buffer->length += len;
+    return 0;
+}
+
+static int buffer_put_varint(TasksWireBuffer *buffer, unsigned long long value)
+{
+    if (buffer_reserve(buffer, 10) != 0) return -1;
+    unsigned char *out = buffer->data + buffer->length;
+    size_t len = 0;
+    do {
+        unsigned char byte = (unsigned char)(value & 0x7f);
+        value >>= 7;
+        out[len++] = value ? (unsigned char)(byte | 0x80) : byte;
+    } while (value);
+    buffer->length += len;
+    return 0;
+}
+
+static int buffer_put_string(TasksWireBuffer *buffer, const char *text)
+{
+    size_t len = text ? strlen(text) : 0;
+    if (buffer_put_varint(buffer, len) != 0) return -1;
+    return buffer_append(buffer, text, len);
+}
+
+void tasks_wire_buffer_free(TasksWireBuffer *buffer)
+{
+    if (!buffer) return;
+    free(buffer->data);
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+/* Wraps payload into a frame in out, deflating it when that pays off. */
+static int wire_build_frame(const TasksWireBuffer *payload, int compress, TasksWireBuffer *out)
+{
+    out->length = 0;
+    unsigned char header[5] = {0, 0, 0, 0, 0};
+    if (buffer_append(out, header, sizeof(header)) != 0) return -1;
+    int compressed = 0;
+    if (compress && payload->length >= TASKS_WIRE_COMPRESS_MIN) {
+        uLongf bound = compressBound((uLong)payload->length);
+        if (buffer_put_varint(out, payload->length) != 0 || buffer_reserve(out, bound) != 0) return -1;
+        size_t start = out->length;
+        uLongf packed = bound;
+        if (compress2(out->data + start, &packed, payload->data, (uLong)payload->length,
+                      Z_DEFAULT_COMPRESSION) == Z_OK &&
+            start + packed < sizeof(header) + payload->length) {
+            out->length = start + packed;
+            compressed = 1;
+        } else {
+            out->length = sizeof(header);
+        }
+    }
+    if (!compressed && buffer_append(out, payload->data, payload->length) != 0) return -1;
+    if (out->length - 4 > TASKS_WIRE_MAX_FRAME) return -1;
+    uint32_t body = (uint32_t)(out->length - 4);
+    out->data[0] = (unsigned char)(body >> 24);
+    out->data[1] = (unsigned char)(body >> 16);
+    out->data[2] = (unsigned char)(body >> 8);
+    out->data[3] = (unsigned char)body;
+    out->data[4] = compressed ? TASKS_WIRE_FRAME_ZLIB : 0;
+    return 0;
+}
+
+/* ---- encoder ---- */
+
+static unsigned int wire_hash(const char *text)
+{
+    /* FNV-1a */
+    unsigned int hash = 2166136261u;
+    for (; *text; ++text) {
+        hash ^= (unsigned char)*text;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void encoder_reset_dictionary(TasksWireEncoder *encoder)
+{
+    encoder->strings_used = 0;
+    encoder->string_count = 0;
+    if (encoder->slots) memset(encoder->slots, 0, sizeof(unsigned int) * (size_t)encoder->slot_count);
+    encoder->sent_count = 0;
+    encoder->reset_pending = 1;
+}
+
+static int encoder_grow_slots(TasksWireEncoder *encoder)
+{
+    int slot_count = encoder->slot_count ? encoder->slot_count * 2 : TASKS_WIRE_INITIAL_SLOTS;
+    unsigned int *slots = (unsigned int *)calloc((size_t)slot_count, sizeof(unsigned int));
+    if (!slots) return -1;
+    unsigned int mask = (unsigned int)(slot_count - 1);
+    for (int id = 0; id < encoder->string_count; ++id) {
+        unsigned int slot = wire_hash(encoder->strings + encoder->string_offsets[id]) & mask;
+        while (slots[slot] != 0) slot = (slot + 1) & mask;
+        slots[slot] = (unsigned int)id + 1;
+    }
+    free(encoder->slots);
+    encoder->slots = slots;
+    encoder->slot_count = slot_count;
+    return 0;
+}
+
+/* Dictionary id of text, adding it (to be sent with this snapshot) on first sight. */
+static int encoder_intern(TasksWireEncoder *encoder, const char *text, unsigned int *out_id)
+{
+    if ((encoder->string_count + 1) * 2 > encoder->slot_count && encoder_grow_slots(encoder) != 0) return -1;
+    unsigned int mask = (unsigned int)(encoder->slot_count - 1);
+    unsigned int slot = wire_hash(text) & mask;
+    while (encoder->slots[slot] != 0) {
+        unsigned int id = encoder->slots[slot] - 1;
+        if (strcmp(encoder->strings + encoder->string_offsets[id], text) == 0) {
+            *out_id = id;
+            return 0;
+        }
+        slot = (slot + 1) & mask;
+    }
+    size_t len = strlen(text) + 1;
+    if (encoder->strings_used + len > encoder->strings_capacity) {
+        size_t new_capacity = encoder->strings_capacity ? encoder->strings_capacity : 16384;
+        while (new_capacity < encoder->strings_used + len) new_capacity *= 2;
+        char *resized = (char *)realloc(encoder->strings, new_capacity);
+        if (!resized) return -1;
+        encoder->strings = resized;
+        encoder->strings_capacity = new_capacity;
+    }
+    if (wire_reserve((void **)&encoder->string_offsets, sizeof(unsigned int), &encoder->string_capacity,
+                     encoder->string_count + 1) != 0) {
+        return -1;
+    }
+    memcpy(encoder->strings + encoder->strings_used, text, len);
+    encoder->string_offsets[encoder->string_count] = (unsigned int)encoder->strings_used;
+    encoder->strings_used += len;
+    *out_id = (unsigned int)encoder->string_count;
+    encoder->slots[slot] = (unsigned int)encoder->string_count + 1;
+    encoder->string_count++;
+    return 0;
+}
+
+TasksWireEncoder *tasks_wire_encoder_create(int compress)
+{
+    TasksWireEncoder *encoder = (TasksWireEncoder *)calloc(1, sizeof(TasksWireEncoder));
+    if (!encoder) return NULL;
+    encoder->compress = compress;
+    encoder->reset_pending = 1;
+    return encoder;
+}
+
+void tasks_wire_encoder_destroy(TasksWireEncoder *encoder)
+{
+    if (!encoder) return;
+    free(encoder->sent);
+    free(encoder->next);
+    free(encoder->order);
+    free(encoder->strings);
+    free(encoder->string_offsets);
+    free(encoder->slots);
+    tasks_wire_buffer_free(&encoder->removed);
+    tasks_wire_buffer_free(&encoder->changed);
+    tasks_wire_buffer_free(&encoder->payload);
+    free(encoder);
+}
+
+int tasks_wire_encode_hello(TasksWireEncoder *encoder, const char *host, TasksWireBuffer *out)
+{
+    if (!encoder || !out) return -1;
+    TasksWireBuffer *payload = &encoder->payload;
+    payload->length = 0;
+    unsigned char type = TASKS_WIRE_HELLO;
+    if (buffer_append(payload, &type, 1) != 0 || buffer_put_varint(payload, TASKS_WIRE_VERSION) != 0 ||
+        buffer_put_string(payload, host) != 0) {
+        return -1;
+    }
+    return wire_build_frame(payload, 0, out);
+}
+
+static const TasksProcessList *g_wire_sort_list = NULL;
+
+static int compare_list_pids(const void *a, const void *b)
+{
+    pid_t pa = g_wire_sort_list->pids[*(const int *)a];
+    pid_t pb = g_wire_sort_list->pids[*(const int *)b];
+    return (pa > pb) - (pa < pb);
+}
+
+static int encode_snapshot(TasksWireEncoder *encoder, TasksProcessList *list,
+                           const TasksSystemStats *stats, TasksWireBuffer *out)
+{
+    if (encoder->string_count > TASKS_WIRE_MAX_STRINGS) encoder_reset_dictionary(encoder);
+    int first_new_string = encoder->string_count;
+    int count = list->count;
+    if (wire_reserve((void **)&encoder->order, sizeof(int), &encoder->order_capacity, count) != 0 ||
+        wire_reserve((void **)&encoder->next, sizeof(WireSentProcess), &encoder->next_capacity, count) != 0) {
+        return -1;
+    }
+    /* Scans come out in pid order already; only sort when they do not. */
+    int sorted = 1;
+    for (int i = 0; i < count; ++i) {
+        encoder->order[i] = i;
+        if (i > 0 && list->pids[i] <= list->pids[i - 1]) sorted = 0;
+    }
+    if (!sorted) {
+        g_wire_sort_list = list;
+        qsort(encoder->order, (size_t)count, sizeof(int), compare_list_pids);
+        g_wire_sort_list = NULL;
+    }
+
+    TasksWireBuffer *removed = &encoder->removed;
+    TasksWireBuffer *changed = &encoder->changed;
+    removed->length = 0;
+    changed->length = 0;
+    unsigned long long removed_count = 0;
+    unsigned long long changed_count = 0;
+    pid_t last_removed = 0;
+    pid_t last_changed = 0;
+    int old = 0;
+    int next_count = 0;
+    for (int i = 0; i < count; ++i) {
+        int index = encoder->order[i];
+        pid_t pid = list->pids[index];
+        if (next_count > 0 && encoder->next[next_count - 1].pid == pid) continue;
+        while (old < encoder->sent_count && encoder->sent[old].pid < pid) {
+            if (buffer_put_varint(removed, (unsigned long long)(encoder->sent[old].pid - last_removed)) != 0) {
+                return -1;
+            }
+            last_removed = encoder->sent[old].pid;
+            removed_count++;
+            old++;
+        }
+        const WireSentProcess *previous = NULL;
+        if (old < encoder->sent_count && encoder->sent[old].pid == pid) previous = &encoder->sent[old++];
+
+        WireSentProcess *current = &encoder->next[next_count++];
+        current->pid = pid;
+        if (encoder_intern(encoder, tasks_model_process_name(list, index), &current->name_id) != 0 ||
+            encoder_intern(encoder, tasks_model_process_user(list, index), &current->user_id) != 0) {
+            return -1;
+        }
+        double cpu = list->cpu_percent[index];
+        double memory = list->memory_mb[index];
+        current->cpu_tenths = cpu > 0.0 ? (unsigned int)(cpu * 10.0 + 0.5) : 0;
+        current->memory_kb = memory > 0.0 ? (unsigned long long)(memory * 1024.0 + 0.5) : 0;
+        current->threads = list->threads[index] > 0 ? (unsigned int)list->threads[index] : 0;
+
+        unsigned int fields = TASKS_WIRE_FIELD_NAME | TASKS_WIRE_FIELD_USER | TASKS_WIRE_FIELD_COMMAND |
+                              TASKS_WIRE_FIELD_CPU | TASKS_WIRE_FIELD_MEMORY | TASKS_WIRE_FIELD_THREADS;
+        if (previous) {
+            fields = 0;
+            /* A new name means an exec, so the command line is worth sending again. */
+            if (previous->name_id != current->name_id) {
+                fields |= TASKS_WIRE_FIELD_NAME | TASKS_WIRE_FIELD_COMMAND;
+            }
+            if (previous->user_id != current->user_id) fields |= TASKS_WIRE_FIELD_USER;
+            if (previous->cpu_tenths != current->cpu_tenths) fields |= TASKS_WIRE_FIELD_CPU;
+            if (previous->memory_kb != current->memory_kb) fields |= TASKS_WIRE_FIELD_MEMORY;
+            if (previous->threads != current->threads) fields |= TASKS_WIRE_FIELD_THREADS;
+            if (!fields) continue;
+        }
+        if (buffer_put_varint(changed, (unsigned long long)(pid - last_changed)) != 0 ||
+            buffer_put_varint(changed, fields) != 0) {
+            return -1;
+        }
+        last_changed = pid;
+        changed_count++;
+        int rc = 0;
+        if (fields & TASKS_WIRE_FIELD_NAME) rc |= buffer_put_varint(changed, current->name_id);
+        if (fields & TASKS_WIRE_FIELD_USER) rc |= buffer_put_varint(changed, current->user_id);
+        if (fields & TASKS_WIRE_FIELD_COMMAND) {
+            rc |= buffer_put_string(changed, tasks_model_process_command(list, index));
+        }
+        if (fields & TASKS_WIRE_FIELD_CPU) rc |= buffer_put_varint(changed, current->cpu_tenths);
+        if (fields & TASKS_WIRE_FIELD_MEMORY) rc |= buffer_put_varint(changed, current->memory_kb);
+        if (fields & TASKS_WIRE_FIELD_THREADS) rc |= buffer_put_varint(changed, current->threads);
+        if (rc != 0) return -1;
+    }
+    for (; old < encoder->sent_count; ++old) {
+        if (buffer_put_varint(removed, (unsigned long long)(encoder->sent[old].pid - last_removed)) != 0) {
+            return -1;
+        }
+        last_removed = encoder->sent[old].pid;
+        removed_count++;
+    }
+
+    TasksWireBuffer *payload = &encoder->payload;
+    payload->length = 0;
+    unsigned char type = TASKS_WIRE_SNAPSHOT;
+    int rc = buffer_append(payload, &type, 1);
+    rc |= buffer_put_varint(payload, encoder->reset_pending ? TASKS_WIRE_SNAPSHOT_RESET : 0);
+    rc |= buffer_put_varint(payload, (unsigned int)(stats->cpu_percent > 0 ? stats->cpu_percent : 0));
+    rc |= buffer_put_varint(payload, (unsigned int)(stats->memory_percent > 0 ? stats->memory_percent : 0));
+    rc |= buffer_put_varint(payload, (unsigned int)(stats->load1_percent > 0 ? stats->load1_percent : 0));
+    rc |= buffer_put_varint(payload, (unsigned int)(stats->load5_percent > 0 ? stats->load5_percent : 0));
+    rc |= buffer_put_varint(payload, (unsigned int)(stats->load15_percent > 0 ? stats->load15_percent : 0));
+    rc |= buffer_put_varint(payload, stats->mem_total_kb);
+    rc |= buffer_put_varint(payload, stats->mem_used_kb);
+    rc |= buffer_put_varint(payload, (unsigned long long)(encoder->string_count - first_new_string));
+    for (int id = first_new_string; id < encoder->string_count; ++id) {
+        rc |= buffer_put_string(payload, encoder->strings + encoder->string_offsets[id]);
+    }
+    rc |= buffer_put_varint(payload, removed_count);
+    rc |= buffer_append(payload, removed->data, removed->length);
+    rc |= buffer_put_varint(payload, changed_count);
+    rc |= buffer_append(payload, changed->data, changed->length);
+    if (rc != 0 || wire_build_frame(payload, encoder->compress, out) != 0) return -1;
+
+    /* Only now is the frame certain to go out, so only now does it become
+     * the base for the next delta. */
+    WireSentProcess *swap = encoder->sent;
+    int swap_capacity = encoder->sent_capacity;
+    encoder->sent = encoder->next;
+    encoder->sent_capacity = encoder->next_capacity;
+    encoder->sent_count = next_count;
+    encoder->next = swap;
+    encoder->next_capacity = swap_capacity;
+    encoder->reset_pending = 0;
+    return 0;
+}
+
+int tasks_wire_encode_snapshot(TasksWireEncoder *encoder, TasksProcessList *list,
+                               const TasksSystemStats *stats, TasksWireBuffer *out)
+{
+    if (!encoder || !list || !stats || !out) return -1;
+    if (encode_snapshot(encoder, list, stats, out) != 0) {
+        /* Strings interned for the lost frame never reached the peer. */
+        encoder_reset_dictionary(encoder);
+        return -1;
+    }
+    return 0;
+}
+
+/* ---- decoder ---- */
+
+static int read_varint(const unsigned char **cursor, const unsigned char *end, unsigned long long *out)
+{
+    unsigned long long value = 0;
+    int shift = 0;
+    const unsigned char *p = *cursor;
+    while (p < end && shift < 64) {
+        unsigned char byte = *p++;
+        value |= (unsigned long long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *cursor = p;
+            *out = value;
+            return 0;
+        }
+        shift += 7;
+    }
+    return -1;
+}
+
+static int read_uint(const unsigned char **cursor, const unsigned char *end, unsigned int *out)
+{
+    unsigned long long value;
+    if (read_varint(cursor, end, &value) != 0 || value > UINT32_MAX) return -1;
+    *out = (unsigned int)value;
+    return 0;
+}
+
+/* Returns a malloc'd copy of the next string. */
+static char *read_string(const unsigned char **cursor, const unsigned char *end)
+{
+    unsigned long long len;
+    if (read_varint(cursor, end, &len) != 0 || len > (unsigned long long)(end - *cursor)) return NULL;
+    char *text = (char *)malloc((size_t)len + 1);
+    if (!text) return NULL;
+    memcpy(text, *cursor, (size_t)len);
+    text[len] = '\0';
+    *cursor += len;
+    return text;
+}
+
+static void decoder_clear(TasksWireDecoder *decoder)
+{
+    for (int i = 0; i < decoder->string_count; ++i) free(decoder->strings[i]);
+    decoder->string_count = 0;
+    for (int i = 0; i < decoder->count; ++i) free(decoder->table[i].command);
+    decoder->count = 0;
+}
+
+TasksWireDecoder *tasks_wire_decoder_create(void)
+{
+    return (TasksWireDecoder *)calloc(1, sizeof(TasksWireDecoder));
+}
+
+void tasks_wire_decoder_destroy(TasksWireDecoder *decoder)
+{
+    if (!decoder) return;
+    decoder_clear(decoder);
+    free(decoder->strings);
+    free(decoder->table);
+    free(decoder->next);
+    free(decoder->removed);
+    free(decoder->inflated);
+    free(decoder);
+}
+
+static const char *decoder_string(const TasksWireDecoder *decoder, unsigned int id)
+{
+    return id < (unsigned int)decoder->string_count ? decoder->strings[id] : "";
+}
+
+/* Moves old row into the next table (the command pointer changes owner). */
+static void decoder_keep(TasksWireDecoder *decoder, int old, int *next_count)
+{
+    decoder->next[(*next_count)++] = decoder->table[old];
+    decoder->table[old].command = NULL;
+}
+
+static int decode_snapshot(TasksWireDecoder *decoder, const unsigned char *p, const unsigned char *end,
+                           TasksSystemStats *stats, TasksProcessList **out_list)
+{
+    unsigned int flags;
+    if (read_uint(&p, end, &flags) != 0) return -1;
+    if (flags & TASKS_WIRE_SNAPSHOT_RESET) decoder_clear(decoder);
+
+    unsigned int values[5];
+    unsigned long long mem_total, mem_used;
+    for (int i = 0; i < 5; ++i) {
+        if (read_uint(&p, end, &values[i]) != 0) return -1;
+    }
+    if (read_varint(&p, end, &mem_total) != 0 || read_varint(&p, end, &mem_used) != 0) return -1;
+    memset(stats, 0, sizeof(*stats));
+    stats->cpu_percent = (int)values[0];
+    stats->memory_percent = (int)values[1];
+    stats->load1_percent = (int)values[2];
+    stats->load5_percent = (int)values[3];
+    stats->load15_percent = (int)values[4];
+    stats->mem_total_kb = (unsigned long)mem_total;
+    stats->mem_used_kb = (unsigned long)mem_used;
+
+    unsigned int string_count;
+    if (read_uint(&p, end, &string_count) != 0 || string_count > (unsigned int)(end - p)) return -1;
+    if (wire_reserve((void **)&decoder->strings, sizeof(char *), &decoder->string_capacity,
+                     decoder->string_count + (int)string_count) != 0) {
+        return -1;
+    }
+    for (unsigned int i = 0; i < string_count; ++i) {
+        char *text = read_string(&p, end);
+        if (!text) return -1;
+        decoder->strings[decoder->string_count++] = text;
+    }
+
+    unsigned int removed_count;
+    if (read_uint(&p, end, &removed_count) != 0 || removed_count > (unsigned int)(end - p) ||
+        wire_reserve((void **)&decoder->removed, sizeof(pid_t), &decoder->removed_capacity,
+                     (int)removed_count) != 0) {
+        return -1;
+    }
+    unsigned long long pid = 0;
+    for (unsigned int i = 0; i < removed_count; ++i) {
+        unsigned long long delta;
+        if (read_varint(&p, end, &delta) != 0) return -1;
+        pid += delta;
+        decoder->removed[i] = (pid_t)pid;
+    }
+
+    unsigned int changed_count;
+    if (read_uint(&p, end, &changed_count) != 0 || changed_count > (unsigned int)(end - p) ||
+        wire_reserve((void **)&decoder->next, sizeof(WireProcess), &decoder->next_capacity,
+                     decoder->count + (int)changed_count) != 0) {
+        return -1;
+    }
+    int old = 0;
+    unsigned int removed = 0;
+    int next_count = 0;
+    int rc = 0;
+    pid = 0;
+    for (unsigned int i = 0; rc == 0 && i < changed_count; ++i) {
+        unsigned long long delta;
+        unsigned int fields;
+        if (read_varint(&p, end, &delta) != 0 || read_uint(&p, end, &fields) != 0) {
+            rc = -1;
+            break;
+        }
+        pid += delta;
+        pid_t current_pid = (pid_t)pid;
+        while (old < decoder->count && decoder->table[old].pid < current_pid) {
+            while (removed < removed_count && decoder->removed[removed] < decoder->table[old].pid) removed++;
+            if (removed < removed_count && decoder->removed[removed] == decoder->table[old].pid) {
+                free(decoder->table[old].command);
+                decoder->table[old].command = NULL;
+            } else {
+                decoder_keep(decoder, old, &next_count);
+            }
+            old++;
+        }
+        WireProcess *row = &decoder->next[next_count];
+        if (old < decoder->count && decoder->table[old].pid == current_pid) {
+            decoder_keep(decoder, old, &next_count);
+            old++;
+        } else {
+            memset(row, 0, sizeof(*row));
+            row->pid = current_pid;
+            next_count++;
+        }
+        if ((fields & TASKS_WIRE_FIELD_NAME) && read_uint(&p, end, &row->name_id) != 0) rc = -1;
+        if (rc == 0 && (fields & TASKS_WIRE_FIELD_USER) && read_uint(&p, end, &row->user_id) != 0) rc = -1;
+        if (rc == 0 && (fields & TASKS_WIRE_FIELD_COMMAND)) {
+            char *command = read_string(&p, end);
+            if (command) {
+                free(row->command);
+                row->command = command;
+            } else {
+                rc = -1;
+            }
+        }
+        if (rc == 0 && (fields & TASKS_WIRE_FIELD_CPU) && read_uint(&p, end, &row->cpu_tenths) != 0) rc = -1;
+        if (rc == 0 && (fields & TASKS_WIRE_FIELD_MEMORY) && read_varint(&p, end, &row->memory_kb) != 0) {
+            rc = -1;
+        }
+        if (rc == 0 && (fields & TASKS_WIRE_FIELD_THREADS) && read_uint(&p, end, &row->threads) != 0) rc = -1;
+        if (rc == 0 && (row->name_id >= (unsigned int)decoder->string_count ||
+                        row->user_id >= (unsigned int)decoder->string_count)) {
+            rc = -1;
+        }
+    }
+    for (; rc == 0 && old < decoder->count; ++old) {
+        while (removed < removed_count && decoder->removed[removed] < decoder->table[old].pid) removed++;
+        if (removed < removed_count && decoder->removed[removed] == decoder->table[old].pid) {
+            free(decoder->table[old].command);
+            decoder->table[old].command = NULL;
+        } else {
+            decoder_keep(decoder, old, &next_count);
+        }
+    }
+    if (rc != 0) {
+        /* Rows not moved yet still own their commands; the state is lost
+         * either way and the caller has to reconnect. */
+        for (int i = 0; i < decoder->count; ++i) {
+            free(decoder->table[i].command);
+            decoder->table[i].command = NULL;
+        }
+    }
+    WireProcess *swap = decoder->table;
+    int swap_capacity = decoder->capacity;
+    decoder->table = decoder->next;
+    decoder->capacity = decoder->next_capacity;
+    decoder->count = next_count;
+    decoder->next = swap;
+    decoder->next_capacity = swap_capacity;
+    if (rc != 0) return -1;
+
+    TasksProcessList *list = tasks_model_new_processes(decoder->count);
+    if (!list) return -1;
+    for (int i = 0; i < decoder->count; ++i) {
+        const WireProcess *row = &decoder->table[i];
+        if (tasks_model_append_process(list, row->pid, decoder_string(decoder, row->name_id),
+                                       decoder_string(decoder, row->user_id),
+                                       row->command ? row->command : decoder_string(decoder, row->name_id),
+                                       (double)row->cpu_tenths / 10.0, (double)row->memory_kb / 1024.0,
+                                       (int)row->threads) != 0) {
+            tasks_model_free_processes(list);
+            return -1;
+        }
+    }
+    *out_list = list;
+    return 0;
+}
+
+int tasks_wire_decode_frame(TasksWireDecoder *decoder, const unsigned char *frame, size_t length,
+                            TasksSystemStats *stats, TasksProcessList **out_list,
+                            char *host, size_t host_len)
+{
+    if (!decoder || !frame || length < 2) return -1;
+    if (out_list) *out_list = NULL;
+    const unsigned char *p = frame + 1;
+    const unsigned char *end = frame + length;
+    if (frame[0] & TASKS_WIRE_FRAME_ZLIB) {
+        unsigned long long size;
+        if (read_varint(&p, end, &size) != 0 || size == 0 || size > TASKS_WIRE_MAX_FRAME) return -1;
+        if (size > decoder->inflated_capacity) {
+            unsigned char *resized = (unsigned char *)realloc(decoder->inflated, (size_t)size);
+            if (!resized) return -1;
+            decoder->inflated = resized;
+            decoder->inflated_capacity = (size_t)size;
+        }
+        uLongf inflated = (uLongf)size;
+        if (uncompress(decoder->inflated, &inflated, p, (uLong)(end - p)) != Z_OK || inflated != size) {
+            return -1;
+        }
+        p = decoder->inflated;
+        end = decoder->inflated + inflated;
+    }
+    if (p >= end) return -1;
+    int type = *p++;
+    if (type == TASKS_WIRE_HELLO) {
+        unsigned int version;
+        if (read_uint(&p, end, &version) != 0 || version != TASKS_WIRE_VERSION) return -1;
+        char *name = read_string(&p, end);
+        if (!name) return -1;
+        if (host && host_len > 0) {
+            strncpy(host, name, host_len - 1);
+            host[host_len - 1] = '\0';
+        }
+        free(name);
+        return type;
+    }
+    if (type == TASKS_WIRE_SNAPSHOT) {
+        if (!stats || !out_list) return -1;
+        return decode_snapshot(decoder, p, end, stats, out_list) == 0 ? type : -1;
+    }
+    return -1;
+}
+
+/* ---- sockets ---- */
+
+typedef struct {
+    int is_unix;
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    char host[256];
+    char port[16];
+} WireAddress;
+
+static int wire_parse_address(const char *address, WireAddress *out, char *error, size_t error_len)
+{
+    memset(out, 0, sizeof(*out));
+    if (!address || !*address) {
+        snprintf(error, error_len, "no address given");
+        return -1;
+    }
+    const char *path = NULL;
+    if (strncmp(address, "unix:", 5) == 0) {
+        path = address + 5;
+    } else if (strchr(address, '/')) {
+        path = address;
+    }
+    if (path) {
+        if (!*path || strlen(path) >= sizeof(out->path)) {
+            snprintf(error, error_len, "invalid socket path '%s'", path);
+            return -1;
+        }
+        out->is_unix = 1;
+        strcpy(out->path, path);
+        return 0;
+    }
+
+    const char *host = address;
+    size_t host_len = strlen(address);
+    const char *port = NULL;
+    if (address[0] == '[') {
+        const char *close = strchr(address, ']');
+        if (!close || (close[1] != '\0' && close[1] != ':')) {
+            snprintf(error, error_len, "invalid address '%s'", address);
+            return -1;
+        }
+        host = address + 1;
+        host_len = (size_t)(close - host);
+        if (close[1] == ':') port = close + 2;
+    } else {
+        const char *colon = strrchr(address, ':');
+        if (colon && strchr(address, ':') == colon) {
+            host_len = (size_t)(colon - address);
+            port = colon + 1;
+        } else if (!colon) {
+            int digits = 1;
+            for (const char *p = address; *p; ++p) {
+                if (!isdigit((unsigned char)*p)) digits = 0;
+            }
+            if (digits) {
+                host_len = 0;
+                port = address;
+            }
+        }
+    }
+    if (host_len >= sizeof(out->host) || (port && strlen(port) >= sizeof(out->port))) {
+        snprintf(error, error_len, "address too long");
+        return -1;
+    }
+    if (host_len > 0) {
+        memcpy(out->host, host, host_len);
+        out->host[host_len] = '\0';
+    } else {
+        strcpy(out->host, "localhost");
+    }
+    if (port && *port) {
+        strcpy(out->port, port);
+    } else {
+        snprintf(out->port, sizeof(out->port), "%d", TASKS_WIRE_DEFAULT_PORT);
+    }
+    return 0;
+}
+
+static int wire_socket(int domain, int type)
+{
+    int fd = socket(domain, type, 0);
+    if (fd >= 0) fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+}
+
+static int wire_unix_address(const WireAddress *address, struct sockaddr_un *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->sun_family = AF_UNIX;
+    strcpy(out->sun_path, address->path);
+    return 0;
+}
+
+int tasks_wire_connect(const char *address, char *error, size_t error_len)
+{
+    WireAddress parsed;
+    if (wire_parse_address(address, &parsed, error, error_len) != 0) return -1;
+    if (parsed.is_unix) {
+        struct sockaddr_un sun;
+        wire_unix_address(&parsed, &sun);
+        int fd = wire_socket(AF_UNIX, SOCK_STREAM);
+        if (fd < 0 || connect(fd, (struct sockaddr *)&sun, sizeof(sun)) != 0) {
+            snprintf(error, error_len, "%s: %s", parsed.path, strerror(errno));
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *results = NULL;
+    int rc = getaddrinfo(parsed.host, parsed.port, &hints, &results);
+    if (rc != 0) {
+        snprintf(error, error_len, "%s: %s", parsed.host, gai_strerror(rc));
+        return -1;
+    }
+    int fd = -1;
+    int saved_errno = 0;
+    for (struct addrinfo *ai = results; ai; ai = ai->ai_next) {
+        fd = wire_socket(ai->ai_family, ai->ai_socktype);
+        if (fd < 0) {
+            saved_errno = errno;
+            continue;
+        }
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        saved_errno = errno;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(results);
+    if (fd < 0) {
+        snprintf(error, error_len, "%s:%s: %s", parsed.host, parsed.port, strerror(saved_errno));
+        return -1;
+    }
+    return fd;
+}
+
+int tasks_wire_listen(const char *address, char *error, size_t error_len)
+{
+    WireAddress parsed;
+    if (wire_parse_address(address, &parsed, error, error_len) != 0) return -1;
+    if (parsed.is_unix) {
+        struct sockaddr_un sun;
+        wire_unix_address(&parsed, &sun);
+        /* Replace a stale socket from an earlier run, but never anything else. */
+        struct stat st;
+        if (lstat(parsed.path, &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) {
+                snprintf(error, error_len, "%s: exists and is not a socket", parsed.path);
+                return -1;
+            }
+            unlink(parsed.path);
+        }
+        int fd = wire_socket(AF_UNIX, SOCK_STREAM);
+        if (fd < 0 || bind(fd, (struct sockaddr *)&sun, sizeof(sun)) != 0 || listen(fd, 8) != 0) {
+            snprintf(error, error_len, "%s: %s", parsed.path, strerror(errno));
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    struct addrinfo *results = NULL;
+    int rc = getaddrinfo(parsed.host, parsed.port, &hints, &results);
+    if (rc != 0) {
+        snprintf(error, error_len, "%s: %s", parsed.host, gai_strerror(rc));
+        return -1;
+    }
+    int fd = -1;
+    int saved_errno = 0;
+    for (struct addrinfo *ai = results; ai; ai = ai->ai_next) {
+        fd = wire_socket(ai->ai_family, ai->ai_socktype);
+        if (fd < 0) {
+            saved_errno = errno;
+            continue;
+        }
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 8) == 0) break;
+        saved_errno = errno;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(results);
+    if (fd < 0) {
+        snprintf(error, error_len, "%s:%s: %s", parsed.host, parsed.port, strerror(saved_errno));
+        return -1;
+    }
+    return fd;
+}
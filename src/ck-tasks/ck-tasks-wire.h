@@ -0,0 +1,92 @@
+#ifndef CK_TASKS_WIRE_H
+#define CK_TASKS_WIRE_H
+
+#include <stddef.h>
+
+#include "ck-tasks-model.h"
+
+/*
+ * Snapshot stream between ck-tasks-agent and ck-tasks (File > Connect).
+ *
+ * A frame is a 4-byte big-endian length, one flags byte (TASKS_WIRE_FRAME_ZLIB)
+ * and the payload; a compressed payload starts with its inflated size as a
+ * varint. Payloads are a type byte followed by varints:
+ *
+ *   HELLO     version, host name
+ *   SNAPSHOT  flags (TASKS_WIRE_SNAPSHOT_RESET), system stats,
+ *             strings added to the dictionary (ids count up from 0),
+ *             exited pids, then new or changed processes: pid, a
+ *             TASKS_WIRE_FIELD_* mask and only the fields in the mask.
+ *
+ * Pids are sent in ascending order as differences from the previous one.
+ * Names and users are dictionary ids, so each distinct string crosses the
+ * link once; a command line is sent inline when a pid first appears or its
+ * name changes. CPU is in tenths of a percent and memory in KiB, so
+ * unchanged values at that precision cost nothing. The encoder keeps what it
+ * last sent per connection and the decoder mirrors it.
+ */
+
+#define TASKS_WIRE_VERSION 1
+#define TASKS_WIRE_DEFAULT_PORT 7741
+#define TASKS_WIRE_MAX_FRAME (64u * 1024u * 1024u)
+
+enum {
+    TASKS_WIRE_HELLO = 1,
+    TASKS_WIRE_SNAPSHOT = 2,
+};
+
+enum {
+    TASKS_WIRE_FRAME_ZLIB = 1 << 0,
+};
+
+enum {
+    TASKS_WIRE_SNAPSHOT_RESET = 1 << 0, /* drop the dictionary and process table first */
+};
+
+enum {
+    TASKS_WIRE_FIELD_NAME = 1 << 0,
+    TASKS_WIRE_FIELD_USER = 1 << 1,
+    TASKS_WIRE_FIELD_COMMAND = 1 << 2,
+    TASKS_WIRE_FIELD_CPU = 1 << 3,
+    TASKS_WIRE_FIELD_MEMORY = 1 << 4,
+    TASKS_WIRE_FIELD_THREADS = 1 << 5,
+};
+
+typedef struct {
+    unsigned char *data;
+    size_t length;
+    size_t capacity;
+} TasksWireBuffer;
+
+void tasks_wire_buffer_free(TasksWireBuffer *buffer);
+
+typedef struct TasksWireEncoder TasksWireEncoder;
+typedef struct TasksWireDecoder TasksWireDecoder;
+
+TasksWireEncoder *tasks_wire_encoder_create(int compress);
+void tasks_wire_encoder_destroy(TasksWireEncoder *encoder);
+/* Replaces out with a complete HELLO frame. */
+int tasks_wire_encode_hello(TasksWireEncoder *encoder, const char *host, TasksWireBuffer *out);
+/* Replaces out with a SNAPSHOT frame holding what changed since the last call.
+ * Command lines of new pids are loaded through the list, so it must belong
+ * to the calling thread. */
+int tasks_wire_encode_snapshot(TasksWireEncoder *encoder, TasksProcessList *list,
+                               const TasksSystemStats *stats, TasksWireBuffer *out);
+
+TasksWireDecoder *tasks_wire_decoder_create(void);
+void tasks_wire_decoder_destroy(TasksWireDecoder *decoder);
+/* Decodes one frame body (flags byte onwards, without the length). Returns
+ * the payload type, or -1 on a malformed frame. A SNAPSHOT fills stats and a
+ * new process list; a HELLO fills host. */
+int tasks_wire_decode_frame(TasksWireDecoder *decoder, const unsigned char *frame, size_t length,
+                            TasksSystemStats *stats, TasksProcessList **out_list,
+                            char *host, size_t host_len);
+
+/* Addresses are "unix:PATH" (or any path containing '/'), "HOST:PORT",
+ * "[V6ADDR]:PORT", "HOST" or "PORT"; the host defaults to localhost and the
+ * port to TASKS_WIRE_DEFAULT_PORT. Both return a CLOEXEC socket, or -1 with
+ * a message in error. */
+int tasks_wire_connect(const char *address, char *error, size_t error_len);
+int tasks_wire_listen(const char *address, char *error, size_t error_len);
+
+#endif /* CK_TASKS_WIRE_H */
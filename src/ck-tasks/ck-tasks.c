@@ -8,6 +8,7 @@
  */
 
 #include "ck-tasks-ui.h"
+#include "ck-tasks-batch.h"
 #include "ck-tasks-ctrl.h"
 #include "ck-tasks-model.h"
 
@@ -93,6 +94,12 @@ int main(int argc, char *argv[])
 {
     XtAppContext app;
     Widget toplevel;
+
+    /* Headless export; must not open the display. */
+    if (tasks_batch_requested(argc, argv)) {
+        return tasks_batch_main(argc, argv);
+    }
+
     XtSetLanguageProc(NULL, NULL, NULL);
 
     char *session_id = session_parse_argument(&argc, argv);
@@ -135,9 +142,11 @@ int main(int argc, char *argv[])
     XtAppMainLoop(app);
 
     if (g_controller) {
+        /* The controller owns the model from here on (see tasks_ctrl_destroy). */
         tasks_ctrl_destroy(g_controller);
+    } else {
+        tasks_model_shutdown();
     }
-    tasks_model_shutdown();
     session_data_free(g_session_data);
     return 0;
 }
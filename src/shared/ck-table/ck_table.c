@@ -24,6 +24,8 @@ typedef struct {
     Widget *cells;
     char **cell_text;
     int row_id;
+    int entry_index;
+    Boolean valid;
 } CkTableVirtualRow;
 
 struct CkTable {
@@ -41,6 +43,8 @@ struct CkTable {
     CkTableVirtualRow *rows;
     int rows_alloc;
     int *row_order;
+    /* Display position of each entry, used to order rows with equal keys. */
+    int *row_rank;
     int row_count;
     int row_start;
     int row_page_size;
@@ -56,6 +60,13 @@ struct CkTable {
 
     CkTableViewportChangedFn viewport_callback;
     void *viewport_context;
+
+    /* row_order, row_rank and the delta scratch below share one capacity
+     * and only ever grow, so per-tick updates do not allocate. */
+    int *delta_order;
+    int *delta_moved;
+    unsigned char *delta_flags;
+    int order_capacity;
 };
 
 static XmString ck_table_make_string(const char *text)
@@ -222,7 +233,7 @@ static int ck_table_virtual_compare_rows(const void *a, const void *b)
         }
     }
     if (table->sort_direction == TABLE_SORT_DESCENDING) cmp = -cmp;
-    if (cmp == 0) cmp = ia - ib;
+    if (cmp == 0) cmp = table->row_rank ? table->row_rank[ia] - table->row_rank[ib] : ia - ib;
     return cmp;
 }
 
@@ -241,13 +252,34 @@ static void ck_table_virtual_apply_sort(CkTable *table)
         qsort(table->row_order, table->row_count, sizeof(int), ck_table_virtual_compare_rows);
         g_ck_table_sort_context = NULL;
     }
+    for (int pos = 0; table->row_rank && pos < table->row_count; ++pos) {
+        table->row_rank[table->row_order[pos]] = pos;
+    }
     ck_table_virtual_refresh_header(table);
 }
 
-static void ck_table_virtual_update_row(CkTable *table, CkTableVirtualRow *row, int entry_index)
+static int ck_table_virtual_compare_entries(CkTable *table, int left, int right)
+{
+    g_ck_table_sort_context = table;
+    int cmp = ck_table_virtual_compare_rows(&left, &right);
+    g_ck_table_sort_context = NULL;
+    return cmp;
+}
+
+static void ck_table_virtual_invalidate_rows(CkTable *table)
+{
+    if (!table || !table->rows) return;
+    for (int i = 0; i < table->rows_alloc; ++i) {
+        table->rows[i].valid = False;
+    }
+}
+
+static void ck_table_virtual_update_cells(CkTable *table, CkTableVirtualRow *row, int entry_index,
+                                          unsigned int columns)
 {
-    if (!table || !row || !table->entries) return;
+    if (!table || !row || !table->entries || !row->cells || !row->cell_text) return;
     for (int col = 0; col < table->column_count; ++col) {
+        if (col < 32 && !(columns & (1u << col))) continue;
         char buffer[128];
         const char *value = ck_table_virtual_get_text(table, entry_index, col, buffer, sizeof(buffer));
         if (!value) value = "";
@@ -259,6 +291,11 @@ static void ck_table_virtual_update_row(CkTable *table, CkTableVirtualRow *row,
     }
 }
 
+static void ck_table_virtual_update_row(CkTable *table, CkTableVirtualRow *row, int entry_index)
+{
+    ck_table_virtual_update_cells(table, row, entry_index, ~0u);
+}
+
 static void ck_table_virtual_refresh_rows(CkTable *table)
 {
     if (!table || !table->grid) return;
@@ -317,7 +354,11 @@ static void ck_table_virtual_refresh_rows(CkTable *table)
         int dataset_index = table->row_start + i;
         if (dataset_index >= total_rows) break;
         int entry_index = table->row_order ? table->row_order[dataset_index] : dataset_index;
-        ck_table_virtual_update_row(table, row, entry_index);
+        if (!row->valid || row->entry_index != entry_index) {
+            ck_table_virtual_update_row(table, row, entry_index);
+            row->entry_index = entry_index;
+            row->valid = True;
+        }
         if (!XtIsManaged(row->row_form)) {
             XtManageChild(row->row_form);
         }
@@ -547,10 +588,11 @@ void ck_table_destroy(CkTable *table)
         table->table_widget = NULL;
     }
     ck_table_virtual_release_rows(table);
-    if (table->row_order) {
-        free(table->row_order);
-        table->row_order = NULL;
-    }
+    free(table->row_order);
+    free(table->row_rank);
+    free(table->delta_order);
+    free(table->delta_moved);
+    free(table->delta_flags);
     if (table->grid) {
         gridlayout_destroy(table->grid);
         table->grid = NULL;
@@ -710,6 +752,31 @@ void ck_table_set_virtual_callbacks(CkTable *table,
     table->number_fn = number_fn;
     table->compare_fn = compare_fn;
     table->callback_context = context;
+    ck_table_virtual_invalidate_rows(table);
+}
+
+static Boolean ck_table_virtual_reserve(CkTable *table, int count)
+{
+    if (count <= table->order_capacity) return True;
+    int capacity = table->order_capacity > 0 ? table->order_capacity : 64;
+    while (capacity < count) capacity *= 2;
+    int *row_order = (int *)realloc(table->row_order, sizeof(int) * (size_t)capacity);
+    if (!row_order) return False;
+    table->row_order = row_order;
+    int *row_rank = (int *)realloc(table->row_rank, sizeof(int) * (size_t)capacity);
+    if (!row_rank) return False;
+    table->row_rank = row_rank;
+    int *delta_order = (int *)realloc(table->delta_order, sizeof(int) * (size_t)capacity);
+    if (!delta_order) return False;
+    table->delta_order = delta_order;
+    int *delta_moved = (int *)realloc(table->delta_moved, sizeof(int) * (size_t)capacity);
+    if (!delta_moved) return False;
+    table->delta_moved = delta_moved;
+    unsigned char *delta_flags = (unsigned char *)realloc(table->delta_flags, (size_t)capacity);
+    if (!delta_flags) return False;
+    table->delta_flags = delta_flags;
+    table->order_capacity = capacity;
+    return True;
 }
 
 void ck_table_set_virtual_data(CkTable *table, const void *entries, int count)
@@ -717,21 +784,149 @@ void ck_table_set_virtual_data(CkTable *table, const void *entries, int count)
     if (!table || table->mode != CK_TABLE_MODE_VIRTUAL) return;
     table->entries = entries;
     table->row_count = (entries && count > 0) ? count : 0;
-    if (table->row_order) {
-        free(table->row_order);
-        table->row_order = NULL;
-    }
-    if (table->row_count > 0) {
-        table->row_order = (int *)calloc((size_t)table->row_count, sizeof(int));
-        if (!table->row_order) {
-            table->row_count = 0;
-            return;
-        }
+    if (!ck_table_virtual_reserve(table, table->row_count)) {
+        table->row_count = 0;
+        return;
+    }
+    for (int i = 0; i < table->row_count; ++i) {
+        table->row_rank[i] = i;
     }
+    ck_table_virtual_invalidate_rows(table);
     ck_table_virtual_apply_sort(table);
     ck_table_virtual_refresh_rows(table);
 }
 
+/* First position in order[from, count) whose entry sorts after entry. */
+static int ck_table_virtual_upper_bound(CkTable *table, const int *order, int from, int count, int entry)
+{
+    int lo = from;
+    int hi = count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (ck_table_virtual_compare_entries(table, order[mid], entry) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int ck_table_virtual_compare_moved(const void *a, const void *b)
+{
+    return ck_table_virtual_compare_rows(a, b);
+}
+
+void ck_table_apply_virtual_delta(CkTable *table, const void *entries, int count,
+                                  const CkTableVirtualDelta *delta)
+{
+    if (!table || table->mode != CK_TABLE_MODE_VIRTUAL) return;
+    int new_count = (entries && count > 0) ? count : 0;
+    if (!delta || delta->old_count != table->row_count || (table->row_count > 0 && !table->row_order) ||
+        new_count == 0) {
+        ck_table_set_virtual_data(table, entries, count);
+        return;
+    }
+
+    if (!ck_table_virtual_reserve(table, new_count)) {
+        ck_table_set_virtual_data(table, entries, count);
+        return;
+    }
+    int *order = table->delta_order;
+    int *moved = table->delta_moved;
+    unsigned char *moved_flags = table->delta_flags;
+    memset(moved_flags, 0, (size_t)new_count);
+
+    /* Ties keep the previous display order; added rows go after existing ones. */
+    int *rank = table->row_rank;
+    for (int i = 0; i < new_count; ++i) {
+        rank[i] = table->row_count + i;
+    }
+
+    /* Rows that need a (new) position: added rows and rows whose sort key changed. */
+    Boolean sorted = (table->sort_direction != TABLE_SORT_NONE && table->sort_column >= 0);
+    int moved_count = 0;
+    for (int i = 0; i < delta->added_count; ++i) {
+        int index = delta->added[i];
+        if (index < 0 || index >= new_count || moved_flags[index]) continue;
+        moved_flags[index] = 1;
+        moved[moved_count++] = index;
+    }
+    for (int i = 0; sorted && i < delta->changed_count; ++i) {
+        int index = delta->changed[i];
+        if (index < 0 || index >= new_count || moved_flags[index]) continue;
+        if (delta->changed_columns && table->sort_column < 32 &&
+            !(delta->changed_columns[i] & (1u << table->sort_column))) {
+            continue;
+        }
+        moved_flags[index] = 1;
+        moved[moved_count++] = index;
+    }
+
+    /* Surviving rows keep their relative order, so only the moved ones are compared. */
+    int kept_count = 0;
+    for (int pos = 0; pos < table->row_count; ++pos) {
+        int old_index = table->row_order[pos];
+        int index = (old_index >= 0 && old_index < delta->old_count) ? delta->old_to_new[old_index] : -1;
+        if (index < 0 || index >= new_count) continue;
+        rank[index] = pos;
+        if (moved_flags[index]) continue;
+        moved_flags[index] = 2;
+        order[kept_count++] = index;
+    }
+
+    table->entries = entries;
+    if (kept_count + moved_count != new_count) {
+        /* Inconsistent delta: fall back to a full rebuild. */
+        ck_table_set_virtual_data(table, entries, count);
+        return;
+    }
+
+    /* The old order has been consumed; the merged one is written in its place. */
+    if (!sorted) {
+        for (int i = 0; i < new_count; ++i) {
+            table->row_order[i] = i;
+        }
+    } else {
+        g_ck_table_sort_context = table;
+        qsort(moved, (size_t)moved_count, sizeof(int), ck_table_virtual_compare_moved);
+        g_ck_table_sort_context = NULL;
+        int *merged = table->row_order;
+        int out = 0;
+        int from = 0;
+        for (int i = 0; i < moved_count; ++i) {
+            int pos = ck_table_virtual_upper_bound(table, order, from, kept_count, moved[i]);
+            memcpy(&merged[out], &order[from], sizeof(int) * (size_t)(pos - from));
+            out += pos - from;
+            from = pos;
+            merged[out++] = moved[i];
+        }
+        memcpy(&merged[out], &order[from], sizeof(int) * (size_t)(kept_count - from));
+    }
+    for (int pos = 0; pos < new_count; ++pos) {
+        rank[table->row_order[pos]] = pos;
+    }
+
+    /* Visible rows stay valid when their entry survived unchanged. */
+    for (int i = 0; i < table->rows_alloc; ++i) {
+        CkTableVirtualRow *row = &table->rows[i];
+        if (!row->valid) continue;
+        int old_index = row->entry_index;
+        row->entry_index = (old_index >= 0 && old_index < delta->old_count) ? delta->old_to_new[old_index] : -1;
+        if (row->entry_index < 0) row->valid = False;
+    }
+    for (int c = 0; c < delta->changed_count; ++c) {
+        for (int i = 0; i < table->rows_alloc; ++i) {
+            if (table->rows[i].valid && table->rows[i].entry_index == delta->changed[c]) {
+                table->rows[i].valid = False;
+            }
+        }
+    }
+
+    table->row_count = new_count;
+    ck_table_virtual_refresh_rows(table);
+}
+
 void ck_table_set_virtual_row_window(CkTable *table, int start)
 {
     if (!table || table->mode != CK_TABLE_MODE_VIRTUAL) return;
@@ -752,6 +947,30 @@ int ck_table_get_virtual_row_page_size(const CkTable *table)
     return table->row_page_size;
 }
 
+int ck_table_get_virtual_visible_entries(const CkTable *table, int *out_entries, int max_entries)
+{
+    if (!table || table->mode != CK_TABLE_MODE_VIRTUAL || !out_entries || max_entries <= 0) return 0;
+    int page = table->row_page_size;
+    if (page <= 0) page = CK_TABLE_VIRTUAL_DEFAULT_ROWS;
+    int count = 0;
+    for (int i = 0; i < page && count < max_entries; ++i) {
+        int dataset_index = table->row_start + i;
+        if (dataset_index < 0 || dataset_index >= table->row_count) break;
+        out_entries[count++] = table->row_order ? table->row_order[dataset_index] : dataset_index;
+    }
+    return count;
+}
+
+void ck_table_refresh_virtual_columns(CkTable *table, unsigned int columns)
+{
+    if (!table || table->mode != CK_TABLE_MODE_VIRTUAL || !table->rows) return;
+    for (int i = 0; i < table->rows_alloc; ++i) {
+        CkTableVirtualRow *row = &table->rows[i];
+        if (!row->valid || !row->row_form || !XtIsManaged(row->row_form)) continue;
+        ck_table_virtual_update_cells(table, row, row->entry_index, columns);
+    }
+}
+
 void ck_table_set_virtual_row_spacing(CkTable *table, int pixels)
 {
     if (!table || table->mode != CK_TABLE_MODE_VIRTUAL || !table->grid) return;
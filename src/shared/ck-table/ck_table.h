@@ -38,6 +38,17 @@ typedef int (*CkTableSortCompareFn)(void *context,
 
 typedef void (*CkTableViewportChangedFn)(void *context);
 
+/* Describes how a new virtual entries array relates to the previous one. */
+typedef struct {
+    const int *old_to_new;              /* per previous entry: new index, or -1 if removed */
+    int old_count;
+    const int *added;                   /* new indices with no previous entry */
+    int added_count;
+    const int *changed;                 /* new indices whose values changed */
+    const unsigned int *changed_columns; /* per changed row, bit n = column n; NULL = all columns */
+    int changed_count;
+} CkTableVirtualDelta;
+
 CkTable *ck_table_create_standard(Widget parent, const char *name,
                                  const TableColumnDef *columns,
                                  int column_count);
@@ -80,8 +91,21 @@ void ck_table_set_virtual_callbacks(CkTable *table,
                                     CkTableSortCompareFn compare_fn,
                                     void *context);
 void ck_table_set_virtual_data(CkTable *table, const void *entries, int count);
+/* Like ck_table_set_virtual_data, but keeps the current row order: only added
+ * rows and rows whose sort column changed are re-positioned, and only visible
+ * rows that changed are re-rendered. Falls back to a full update when the
+ * delta does not match the current data.
+ */
+void ck_table_apply_virtual_delta(CkTable *table, const void *entries, int count,
+                                  const CkTableVirtualDelta *delta);
 void ck_table_set_virtual_row_window(CkTable *table, int start);
 int ck_table_get_virtual_row_page_size(const CkTable *table);
+/* Entry indices of the rows in the current window, in display order. */
+int ck_table_get_virtual_visible_entries(const CkTable *table, int *out_entries, int max_entries);
+/* Re-renders the given columns (bit n = column n) of the visible rows, for
+ * values that change without a new data set.
+ */
+void ck_table_refresh_virtual_columns(CkTable *table, unsigned int columns);
 void ck_table_set_virtual_row_spacing(CkTable *table, int pixels);
 void ck_table_set_virtual_viewport_changed_callback(CkTable *table,
                                                     CkTableViewportChangedFn callback,
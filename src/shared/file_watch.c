@@ -0,0 +1,99 @@
+#include "file_watch.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#define FILE_WATCH_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY | \
+                         IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF)
+
+/* Room for a few dozen events with names; more are picked up by the next read. */
+#define FILE_WATCH_BUFFER_SIZE 4096
+
+int file_watch_open(FileWatch *watch)
+{
+    if (!watch) return -1;
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    return watch->fd >= 0 ? 0 : -1;
+}
+
+void file_watch_close(FileWatch *watch)
+{
+    if (!watch || watch->fd < 0) return;
+    close(watch->fd);
+    watch->fd = -1;
+}
+
+int file_watch_add(FileWatch *watch, const char *path)
+{
+    if (!watch || watch->fd < 0 || !path || !path[0]) {
+        errno = EINVAL;
+        return -1;
+    }
+    return inotify_add_watch(watch->fd, path, FILE_WATCH_MASK) >= 0 ? 0 : -1;
+}
+
+int file_watch_add_id(FileWatch *watch, const char *path)
+{
+    if (!watch || watch->fd < 0 || !path || !path[0]) {
+        errno = EINVAL;
+        return -1;
+    }
+    return inotify_add_watch(watch->fd, path, FILE_WATCH_MASK);
+}
+
+int file_watch_changed(FileWatch *watch)
+{
+    if (!watch || watch->fd < 0) return -1;
+    char buffer[FILE_WATCH_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int changed = 0;
+    for (;;) {
+        ssize_t got = read(watch->fd, buffer, sizeof(buffer));
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return changed;
+            return -1;
+        }
+        if (got == 0) return changed;
+        /* Every event is a change, including IN_Q_OVERFLOW and IN_IGNORED,
+         * so the events themselves need no decoding. */
+        changed = 1;
+        /* A short read means the queue was empty; the next event would have fit. */
+        if ((size_t)got < sizeof(buffer) - (sizeof(struct inotify_event) + NAME_MAX + 1)) return changed;
+    }
+}
+
+static unsigned int file_watch_event_flags(unsigned int mask)
+{
+    unsigned int flags = 0;
+    if (mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB)) flags |= FILE_WATCH_EVENT_MODIFIED;
+    if (mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)) flags |= FILE_WATCH_EVENT_ENTRIES;
+    if (mask & IN_ISDIR) flags |= FILE_WATCH_EVENT_DIRECTORY;
+    if (mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) flags |= FILE_WATCH_EVENT_GONE;
+    if (mask & IN_Q_OVERFLOW) flags |= FILE_WATCH_EVENT_OVERFLOW;
+    return flags;
+}
+
+int file_watch_read_events(FileWatch *watch, FileWatchEventFn fn, void *context)
+{
+    if (!watch || watch->fd < 0) return -1;
+    char buffer[FILE_WATCH_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int events = 0;
+    for (;;) {
+        ssize_t got = read(watch->fd, buffer, sizeof(buffer));
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return events;
+            return -1;
+        }
+        if (got == 0) return events;
+        for (char *p = buffer; p < buffer + got;) {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            if (fn) fn(context, event->wd, file_watch_event_flags(event->mask), event->len ? event->name : "");
+            events++;
+            p += sizeof(struct inotify_event) + event->len;
+        }
+        if ((size_t)got < sizeof(buffer) - (sizeof(struct inotify_event) + NAME_MAX + 1)) return events;
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef CK_SHARED_FILE_WATCH_H
+#define CK_SHARED_FILE_WATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Change notification for files and directories (inotify).
+ *
+ * A watch only says that something under one of its paths changed, not
+ * what: callers keep their own cache and re-read it when
+ * file_watch_changed() reports a change. While nothing changes a check is a
+ * single non-blocking read(). A watched directory also reports changes to
+ * the files in it, but not in its subdirectories.
+ */
+
+typedef struct {
+    int fd;
+} FileWatch;
+
+/* Returns 0 on success, -1 if inotify is unavailable. */
+int file_watch_open(FileWatch *watch);
+void file_watch_close(FileWatch *watch);
+
+/* Watch path. Adding a path that is already watched is cheap and harmless,
+ * so callers can re-add everything they read after each rescan. Returns 0,
+ * or -1 with errno set (ENOENT if the path does not exist). */
+int file_watch_add(FileWatch *watch, const char *path);
+
+/* Reads all pending events without blocking. Returns 1 if anything changed
+ * since the last call, 0 if nothing did, -1 if the watch failed. Lost events
+ * (queue overflow) and removed watches count as changes. */
+int file_watch_changed(FileWatch *watch);
+
+/* What a reported event was about (flags of FileWatchEventFn). */
+enum {
+    FILE_WATCH_EVENT_MODIFIED = 1 << 0, /* contents or attributes of a file */
+    FILE_WATCH_EVENT_ENTRIES = 1 << 1,  /* an entry was created, removed or renamed */
+    FILE_WATCH_EVENT_DIRECTORY = 1 << 2, /* the named entry is a directory */
+    FILE_WATCH_EVENT_GONE = 1 << 3,     /* the watch itself was removed */
+    FILE_WATCH_EVENT_OVERFLOW = 1 << 4, /* events were lost; wd is -1 */
+};
+
+/* name is the entry inside a watched directory, or "" for the path itself. */
+typedef void (*FileWatchEventFn)(void *context, int wd, unsigned int flags, const char *name);
+
+/* Like file_watch_add(), but returns the watch descriptor events are
+ * reported with (the same one every time a path is added again), or -1
+ * with errno set. */
+int file_watch_add_id(FileWatch *watch, const char *path);
+
+/* For callers that need to know which watch changed: reads all pending
+ * events without blocking and passes each one to fn. Returns the number of
+ * events, or -1 if the watch failed. */
+int file_watch_read_events(FileWatch *watch, FileWatchEventFn fn, void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CK_SHARED_FILE_WATCH_H */
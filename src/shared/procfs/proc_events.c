@@ -0,0 +1,157 @@
+#include "proc_events.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+
+#define PROC_EVENTS_RCVBUF (1024 * 1024)
+#define PROC_EVENTS_ACK_TIMEOUT_MS 250
+
+/* Netlink messages are small; one recv() may carry several of them. */
+#define PROC_EVENTS_BUFFER_SIZE 8192
+
+static int proc_events_send_op(int fd, enum proc_cn_mcast_op op)
+{
+    char buffer[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op))];
+    memset(buffer, 0, sizeof(buffer));
+    struct nlmsghdr *header = (struct nlmsghdr *)buffer;
+    header->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+    header->nlmsg_type = NLMSG_DONE;
+    header->nlmsg_pid = 0;
+    struct cn_msg *msg = (struct cn_msg *)NLMSG_DATA(header);
+    msg->id.idx = CN_IDX_PROC;
+    msg->id.val = CN_VAL_PROC;
+    msg->len = sizeof(op);
+    memcpy(msg->data, &op, sizeof(op));
+    ssize_t sent;
+    do {
+        sent = send(fd, buffer, header->nlmsg_len, 0);
+    } while (sent < 0 && errno == EINTR);
+    return sent == (ssize_t)header->nlmsg_len ? 0 : -1;
+}
+
+/*
+ * Reads one datagram and dispatches the proc events in it. Returns 1 if a
+ * datagram was handled, 0 if none is pending, -1 on overflow or error. With
+ * ack set, stores the error of a subscription ack (PROC_EVENT_NONE) there.
+ */
+static int proc_events_read(int fd, ProcEventsCallback callback, void *context, int *ack)
+{
+    char buffer[PROC_EVENTS_BUFFER_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+    struct sockaddr_nl from;
+    socklen_t from_len = sizeof(from);
+    ssize_t got;
+    do {
+        got = recvfrom(fd, buffer, sizeof(buffer), MSG_DONTWAIT, (struct sockaddr *)&from, &from_len);
+    } while (got < 0 && errno == EINTR);
+    if (got < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    /* Only the kernel may send connector events. */
+    if (from_len != sizeof(from) || from.nl_pid != 0) return 1;
+
+    for (struct nlmsghdr *header = (struct nlmsghdr *)buffer; NLMSG_OK(header, (unsigned int)got);
+         header = NLMSG_NEXT(header, got)) {
+        if (header->nlmsg_type == NLMSG_NOOP) continue;
+        if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_OVERRUN) {
+            errno = EPROTO;
+            return -1;
+        }
+        if (header->nlmsg_len < NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(struct proc_event))) continue;
+        const struct cn_msg *msg = (const struct cn_msg *)NLMSG_DATA(header);
+        if (msg->id.idx != CN_IDX_PROC || msg->id.val != CN_VAL_PROC) continue;
+        /* cn_msg data is only 4-byte aligned; proc_event needs 8. */
+        struct proc_event event;
+        memcpy(&event, msg->data, sizeof(event));
+        switch (event.what) {
+        case PROC_EVENT_NONE:
+            if (ack) *ack = (int)event.event_data.ack.err;
+            break;
+        case PROC_EVENT_FORK:
+            if (callback && event.event_data.fork.child_pid == event.event_data.fork.child_tgid) {
+                callback(context, PROC_EVENTS_START, event.event_data.fork.child_tgid);
+            }
+            break;
+        case PROC_EVENT_EXEC:
+            if (callback) callback(context, PROC_EVENTS_START, event.event_data.exec.process_tgid);
+            break;
+        case PROC_EVENT_EXIT:
+            if (callback && event.event_data.exit.process_pid == event.event_data.exit.process_tgid) {
+                callback(context, PROC_EVENTS_EXIT, event.event_data.exit.process_tgid);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return 1;
+}
+
+int proc_events_open(ProcEvents *events)
+{
+    if (!events) return -1;
+    events->fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (events->fd < 0) return -1;
+
+    int rcvbuf = PROC_EVENTS_RCVBUF;
+    setsockopt(events->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    struct sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    addr.nl_pid = 0;
+    if (bind(events->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        proc_events_send_op(events->fd, PROC_CN_MCAST_LISTEN) != 0) {
+        close(events->fd);
+        events->fd = -1;
+        return -1;
+    }
+
+    /* The kernel acks the subscription on the multicast group; without the
+     * privilege there is either an error ack or, with no other listener,
+     * no ack at all. Events that arrive first are dropped here, which is fine
+     * because the caller starts with a full scan anyway. */
+    int ack = -1;
+    struct pollfd pfd = {events->fd, POLLIN, 0};
+    while (ack < 0) {
+        int ready = poll(&pfd, 1, PROC_EVENTS_ACK_TIMEOUT_MS);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) break;
+        if (proc_events_read(events->fd, NULL, NULL, &ack) < 0) break;
+    }
+    if (ack != 0) {
+        /* Not subscribed, so there is nothing to unsubscribe. */
+        close(events->fd);
+        events->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void proc_events_close(ProcEvents *events)
+{
+    if (!events || events->fd < 0) return;
+    proc_events_send_op(events->fd, PROC_CN_MCAST_IGNORE);
+    close(events->fd);
+    events->fd = -1;
+}
+
+int proc_events_drain(ProcEvents *events, ProcEventsCallback callback, void *context)
+{
+    if (!events || events->fd < 0) return -1;
+    int lost = 0;
+    for (;;) {
+        int rc = proc_events_read(events->fd, callback, context, NULL);
+        if (rc == 0) break;
+        if (rc < 0) {
+            /* ENOBUFS: the kernel dropped events; keep draining what is left. */
+            if (errno != ENOBUFS) return -1;
+            lost = 1;
+        }
+    }
+    return lost ? -1 : 0;
+}
@@ -0,0 +1,43 @@
+#ifndef CK_SHARED_PROC_EVENTS_H
+#define CK_SHARED_PROC_EVENTS_H
+
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Process lifecycle events from the kernel proc connector (netlink).
+ *
+ * Many kernels only let CAP_NET_ADMIN subscribe, so proc_events_open() can
+ * fail for normal users and callers must keep a /proc scan as the fallback.
+ * Only whole processes are reported: thread creation and exit are filtered
+ * out.
+ */
+
+typedef enum {
+    PROC_EVENTS_START, /* fork or exec: the pid is (still) a live process */
+    PROC_EVENTS_EXIT,
+} ProcEventsType;
+
+typedef struct {
+    int fd;
+} ProcEvents;
+
+typedef void (*ProcEventsCallback)(void *context, ProcEventsType type, pid_t pid);
+
+/* Open and subscribe. Returns 0 on success, -1 if the connector is unavailable. */
+int proc_events_open(ProcEvents *events);
+void proc_events_close(ProcEvents *events);
+
+/* Deliver all pending events without blocking. Returns 0, or -1 if events were
+ * dropped (receive buffer overflow) or the socket failed; the caller must then
+ * rescan, since its pid set may be incomplete. */
+int proc_events_drain(ProcEvents *events, ProcEventsCallback callback, void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CK_SHARED_PROC_EVENTS_H */
@@ -0,0 +1,640 @@
+#include "procfs.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+/* ---------- Low-level reads ---------- */
+
+static int procfs_open_relative(int dir_fd, const char *name)
+{
+    if (dir_fd < 0 || !name) return -1;
+    int fd;
+    do {
+        fd = openat(dir_fd, name, O_RDONLY | O_CLOEXEC);
+    } while (fd < 0 && errno == EINTR);
+    return fd;
+}
+
+static void procfs_close_fd(int *fd)
+{
+    if (fd && *fd >= 0) {
+        close(*fd);
+        *fd = -1;
+    }
+}
+
+/* Read a whole proc file from offset 0 into buffer; always NUL-terminates. */
+static ssize_t procfs_pread_all(int fd, char *buffer, size_t len)
+{
+    if (fd < 0 || !buffer || len == 0) return -1;
+    size_t total = 0;
+    while (total < len - 1) {
+        ssize_t got = pread(fd, buffer + total, len - 1 - total, (off_t)total);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            buffer[0] = '\0';
+            return -1;
+        }
+        if (got == 0) break;
+        total += (size_t)got;
+    }
+    buffer[total] = '\0';
+    return (ssize_t)total;
+}
+
+static ssize_t procfs_read_all(int fd, char *buffer, size_t len)
+{
+    if (fd < 0 || !buffer || len == 0) return -1;
+    size_t total = 0;
+    while (total < len - 1) {
+        ssize_t got = read(fd, buffer + total, len - 1 - total);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            buffer[0] = '\0';
+            return -1;
+        }
+        if (got == 0) break;
+        total += (size_t)got;
+    }
+    buffer[total] = '\0';
+    return (ssize_t)total;
+}
+
+/* Writes "<pid>/<name>" without going through stdio. */
+static void procfs_build_pid_path(char *out, size_t out_len, pid_t pid, const char *name)
+{
+    char digits[24];
+    int n = 0;
+    unsigned long value = (unsigned long)pid;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0 && n < (int)sizeof(digits));
+
+    size_t pos = 0;
+    while (n > 0 && pos + 1 < out_len) {
+        out[pos++] = digits[--n];
+    }
+    if (pos + 1 < out_len) out[pos++] = '/';
+    for (const char *p = name; p && *p && pos + 1 < out_len; ++p) {
+        out[pos++] = *p;
+    }
+    out[pos] = '\0';
+}
+
+static ssize_t procfs_read_pid_file(ProcfsReader *reader, pid_t pid, const char *name,
+                                    char *buffer, size_t len)
+{
+    if (!reader || reader->root_fd < 0 || pid <= 0) return -1;
+    char path[48];
+    procfs_build_pid_path(path, sizeof(path), pid, name);
+    int fd = procfs_open_relative(reader->root_fd, path);
+    if (fd < 0) return -1;
+    ssize_t got = procfs_read_all(fd, buffer, len);
+    close(fd);
+    return got;
+}
+
+/* ---------- Scanners ---------- */
+
+static const char *procfs_skip_spaces(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+static const char *procfs_skip_field(const char *p, const char *end)
+{
+    p = procfs_skip_spaces(p, end);
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\n') ++p;
+    return p;
+}
+
+static const char *procfs_next_line(const char *p, const char *end)
+{
+    while (p < end && *p != '\n') ++p;
+    return (p < end) ? p + 1 : end;
+}
+
+static const char *procfs_parse_ull(const char *p, const char *end, unsigned long long *out)
+{
+    p = procfs_skip_spaces(p, end);
+    if (p >= end || *p < '0' || *p > '9') return NULL;
+    unsigned long long value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10ULL + (unsigned long long)(*p - '0');
+        ++p;
+    }
+    if (out) *out = value;
+    return p;
+}
+
+/* Parses "123.45" style values as found in loadavg and uptime. */
+static const char *procfs_parse_decimal(const char *p, const char *end, double *out)
+{
+    unsigned long long whole = 0;
+    p = procfs_parse_ull(p, end, &whole);
+    if (!p) return NULL;
+    double value = (double)whole;
+    if (p < end && *p == '.') {
+        ++p;
+        double scale = 0.1;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value += (double)(*p - '0') * scale;
+            scale *= 0.1;
+            ++p;
+        }
+    }
+    if (out) *out = value;
+    return p;
+}
+
+static int procfs_has_prefix(const char *p, const char *end, const char *prefix, size_t prefix_len)
+{
+    return (size_t)(end - p) >= prefix_len && memcmp(p, prefix, prefix_len) == 0;
+}
+
+/* ---------- Reader lifecycle ---------- */
+
+static const char *const procfs_pressure_paths[PROCFS_PRESSURE_COUNT] = {
+    "pressure/cpu",
+    "pressure/memory",
+    "pressure/io",
+};
+
+int procfs_reader_open(ProcfsReader *reader, const char *root)
+{
+    if (!reader) return -1;
+    reader->root_fd = -1;
+    reader->stat_fd = -1;
+    reader->meminfo_fd = -1;
+    reader->loadavg_fd = -1;
+    reader->uptime_fd = -1;
+    for (int i = 0; i < PROCFS_PRESSURE_COUNT; ++i) reader->pressure_fds[i] = -1;
+    reader->root_dir = NULL;
+    reader->buffer[0] = '\0';
+    reader->page_size = sysconf(_SC_PAGESIZE);
+    if (reader->page_size <= 0) reader->page_size = 4096;
+
+    const char *path = (root && root[0]) ? root : PROCFS_DEFAULT_ROOT;
+    reader->root_fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (reader->root_fd < 0) return -1;
+
+    reader->stat_fd = procfs_open_relative(reader->root_fd, "stat");
+    reader->meminfo_fd = procfs_open_relative(reader->root_fd, "meminfo");
+    reader->loadavg_fd = procfs_open_relative(reader->root_fd, "loadavg");
+    reader->uptime_fd = procfs_open_relative(reader->root_fd, "uptime");
+    for (int i = 0; i < PROCFS_PRESSURE_COUNT; ++i) {
+        reader->pressure_fds[i] = procfs_open_relative(reader->root_fd, procfs_pressure_paths[i]);
+    }
+
+    int dir_fd = fcntl(reader->root_fd, F_DUPFD_CLOEXEC, 0);
+    if (dir_fd >= 0) {
+        reader->root_dir = fdopendir(dir_fd);
+        if (!reader->root_dir) close(dir_fd);
+    }
+    return 0;
+}
+
+void procfs_reader_close(ProcfsReader *reader)
+{
+    if (!reader) return;
+    if (reader->root_dir) {
+        closedir(reader->root_dir);
+        reader->root_dir = NULL;
+    }
+    procfs_close_fd(&reader->stat_fd);
+    procfs_close_fd(&reader->meminfo_fd);
+    procfs_close_fd(&reader->loadavg_fd);
+    procfs_close_fd(&reader->uptime_fd);
+    for (int i = 0; i < PROCFS_PRESSURE_COUNT; ++i) procfs_close_fd(&reader->pressure_fds[i]);
+    procfs_close_fd(&reader->root_fd);
+}
+
+/* ---------- System-wide files ---------- */
+
+/* Parses the tick columns that follow a "cpu" / "cpuN" label. */
+static const char *procfs_parse_cpu_fields(const char *p, const char *end, ProcfsCpuTimes *out_times)
+{
+    unsigned long long values[8] = {0};
+    int scanned = 0;
+    for (; scanned < 8; ++scanned) {
+        const char *next = procfs_parse_ull(p, end, &values[scanned]);
+        if (!next) break;
+        p = next;
+    }
+    if (scanned < 4) return NULL;
+
+    out_times->user = values[0];
+    out_times->nice = values[1];
+    out_times->system = values[2];
+    out_times->idle = values[3];
+    out_times->iowait = values[4];
+    out_times->irq = values[5];
+    out_times->softirq = values[6];
+    out_times->steal = values[7];
+    return p;
+}
+
+int procfs_read_cpu_times(ProcfsReader *reader, ProcfsCpuTimes *out_times)
+{
+    if (!reader || !out_times) return -1;
+    ssize_t len = procfs_pread_all(reader->stat_fd, reader->buffer, sizeof(reader->buffer));
+    if (len <= 0) return -1;
+    const char *p = reader->buffer;
+    const char *end = reader->buffer + len;
+    if (!procfs_has_prefix(p, end, "cpu ", 4)) return -1;
+    return procfs_parse_cpu_fields(p + 4, end, out_times) ? 0 : -1;
+}
+
+int procfs_read_cpu_times_per_core(ProcfsReader *reader, ProcfsCpuTimes *out_total,
+                                   ProcfsCpuTimes *out_cores, int max_cores)
+{
+    if (!reader || !out_total || (!out_cores && max_cores > 0)) return -1;
+    ssize_t len = procfs_pread_all(reader->stat_fd, reader->buffer, sizeof(reader->buffer));
+    if (len <= 0) return -1;
+    const char *p = reader->buffer;
+    const char *end = reader->buffer + len;
+    if (!procfs_has_prefix(p, end, "cpu ", 4)) return -1;
+    const char *after = procfs_parse_cpu_fields(p + 4, end, out_total);
+    if (!after) return -1;
+
+    if (max_cores > 0) memset(out_cores, 0, sizeof(*out_cores) * (size_t)max_cores);
+    int filled = 0;
+    /* The cpuN lines directly follow the aggregate line; stop at the first other one. */
+    for (p = procfs_next_line(after, end); procfs_has_prefix(p, end, "cpu", 3); p = procfs_next_line(p, end)) {
+        unsigned long long index = 0;
+        const char *fields = procfs_parse_ull(p + 3, end, &index);
+        if (!fields || fields == p + 3 || fields >= end || *fields != ' ') break;
+        if (index >= (unsigned long long)max_cores) continue;
+        if (!procfs_parse_cpu_fields(fields, end, &out_cores[index])) continue;
+        if ((int)index + 1 > filled) filled = (int)index + 1;
+    }
+    return filled;
+}
+
+unsigned long long procfs_cpu_idle_ticks(const ProcfsCpuTimes *times)
+{
+    if (!times) return 0;
+    return times->idle + times->iowait;
+}
+
+unsigned long long procfs_cpu_total_ticks(const ProcfsCpuTimes *times)
+{
+    if (!times) return 0;
+    return times->user + times->nice + times->system + times->irq + times->softirq + times->steal +
+           procfs_cpu_idle_ticks(times);
+}
+
+int procfs_read_meminfo(ProcfsReader *reader, ProcfsMemInfo *out_info)
+{
+    if (!reader || !out_info) return -1;
+    ssize_t len = procfs_pread_all(reader->meminfo_fd, reader->buffer, sizeof(reader->buffer));
+    if (len <= 0) return -1;
+    memset(out_info, 0, sizeof(*out_info));
+
+    const char *p = reader->buffer;
+    const char *end = reader->buffer + len;
+    int found = 0;
+    while (p < end && found < 4) {
+        unsigned long long value = 0;
+        unsigned long *target = NULL;
+        size_t skip = 0;
+        if (procfs_has_prefix(p, end, "MemTotal:", 9)) {
+            target = &out_info->mem_total_kb;
+            skip = 9;
+        } else if (procfs_has_prefix(p, end, "MemAvailable:", 13)) {
+            target = &out_info->mem_available_kb;
+            skip = 13;
+        } else if (procfs_has_prefix(p, end, "SwapTotal:", 10)) {
+            target = &out_info->swap_total_kb;
+            skip = 10;
+        } else if (procfs_has_prefix(p, end, "SwapFree:", 9)) {
+            target = &out_info->swap_free_kb;
+            skip = 9;
+        }
+        if (target && procfs_parse_ull(p + skip, end, &value)) {
+            *target = (unsigned long)value;
+            found++;
+        }
+        p = procfs_next_line(p, end);
+    }
+    return 0;
+}
+
+int procfs_read_loadavg(ProcfsReader *reader, double *out_l1, double *out_l5, double *out_l15)
+{
+    if (!reader) return -1;
+    ssize_t len = procfs_pread_all(reader->loadavg_fd, reader->buffer, sizeof(reader->buffer));
+    if (len <= 0) return -1;
+    const char *p = reader->buffer;
+    const char *end = reader->buffer + len;
+    double l1 = 0.0, l5 = 0.0, l15 = 0.0;
+    if (!(p = procfs_parse_decimal(p, end, &l1))) return -1;
+    if (!(p = procfs_parse_decimal(p, end, &l5))) return -1;
+    if (!procfs_parse_decimal(p, end, &l15)) return -1;
+    if (out_l1) *out_l1 = l1;
+    if (out_l5) *out_l5 = l5;
+    if (out_l15) *out_l15 = l15;
+    return 0;
+}
+
+int procfs_read_uptime(ProcfsReader *reader, double *out_seconds)
+{
+    if (!reader || !out_seconds) return -1;
+    ssize_t len = procfs_pread_all(reader->uptime_fd, reader->buffer, sizeof(reader->buffer));
+    if (len <= 0) return -1;
+    if (!procfs_parse_decimal(reader->buffer, reader->buffer + len, out_seconds)) return -1;
+    return 0;
+}
+
+/* Parses "avg10=0.12 avg60=0.05 avg300=0.01 total=12345" after a some/full label. */
+static int procfs_parse_pressure_line(const char *p, const char *end, ProcfsPressureLine *out_line)
+{
+    static const char *const keys[] = {"avg10=", "avg60=", "avg300=", "total="};
+    double *averages[] = {&out_line->avg10, &out_line->avg60, &out_line->avg300};
+    for (int i = 0; i < 4; ++i) {
+        size_t key_len = strlen(keys[i]);
+        p = procfs_skip_spaces(p, end);
+        if (!procfs_has_prefix(p, end, keys[i], key_len)) return -1;
+        p += key_len;
+        p = (i < 3) ? procfs_parse_decimal(p, end, averages[i]) : procfs_parse_ull(p, end, &out_line->total_us);
+        if (!p) return -1;
+    }
+    return 0;
+}
+
+int procfs_read_pressure(ProcfsReader *reader, int resource, ProcfsPressure *out_pressure)
+{
+    if (!reader || !out_pressure || resource < 0 || resource >= PROCFS_PRESSURE_COUNT) return -1;
+    ssize_t len = procfs_pread_all(reader->pressure_fds[resource], reader->buffer, sizeof(reader->buffer));
+    if (len <= 0) return -1;
+    memset(out_pressure, 0, sizeof(*out_pressure));
+    const char *p = reader->buffer;
+    const char *end = reader->buffer + len;
+    if (!procfs_has_prefix(p, end, "some ", 5) || procfs_parse_pressure_line(p + 5, end, &out_pressure->some) != 0) {
+        return -1;
+    }
+    p = procfs_next_line(p, end);
+    if (procfs_has_prefix(p, end, "full ", 5)) procfs_parse_pressure_line(p + 5, end, &out_pressure->full);
+    return 0;
+}
+
+int procfs_open_pressure_trigger(ProcfsReader *reader, int resource, unsigned int stall_us,
+                                 unsigned int window_us)
+{
+    if (!reader || reader->root_fd < 0 || resource < 0 || resource >= PROCFS_PRESSURE_COUNT) return -1;
+    int fd;
+    do {
+        fd = openat(reader->root_fd, procfs_pressure_paths[resource], O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) return -1;
+
+    /* "some <stall us> <window us>" including the terminating NUL, as the kernel expects. */
+    char command[64];
+    size_t len = 0;
+    const char *prefix = "some ";
+    while (*prefix) command[len++] = *prefix++;
+    unsigned int values[2] = {stall_us, window_us};
+    for (int v = 0; v < 2; ++v) {
+        char digits[16];
+        int n = 0;
+        unsigned int value = values[v];
+        do {
+            digits[n++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        while (n > 0) command[len++] = digits[--n];
+        command[len++] = v == 0 ? ' ' : '\0';
+    }
+    ssize_t written;
+    do {
+        written = write(fd, command, len);
+    } while (written < 0 && errno == EINTR);
+    if (written < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* ---------- PID enumeration ---------- */
+
+int procfs_pid_iter_begin(ProcfsReader *reader)
+{
+    if (!reader || !reader->root_dir) return -1;
+    rewinddir(reader->root_dir);
+    return 0;
+}
+
+int procfs_pid_iter_next(ProcfsReader *reader, pid_t *out_pid)
+{
+    if (!reader || !reader->root_dir) return 0;
+    struct dirent *ent = NULL;
+    while ((ent = readdir(reader->root_dir)) != NULL) {
+        const char *name = ent->d_name;
+        if (name[0] < '1' || name[0] > '9') continue;
+        unsigned long value = 0;
+        const char *p = name;
+        while (*p >= '0' && *p <= '9') {
+            value = value * 10UL + (unsigned long)(*p - '0');
+            ++p;
+        }
+        if (*p != '\0') continue;
+        if (out_pid) *out_pid = (pid_t)value;
+        return 1;
+    }
+    return 0;
+}
+
+/* ---------- Per-process files ---------- */
+
+int procfs_read_pid_stat(ProcfsReader *reader, pid_t pid, ProcfsPidStat *out_stat)
+{
+    if (!reader || !out_stat) return -1;
+    ssize_t len = procfs_read_pid_file(reader, pid, "stat", reader->buffer, sizeof(reader->buffer));
+    if (len <= 0) return -1;
+    const char *buf = reader->buffer;
+    const char *end = buf + len;
+
+    /* comm may itself contain ')' so anchor on the last one. */
+    const char *open = memchr(buf, '(', (size_t)len);
+    const char *close_paren = NULL;
+    for (const char *q = end; q > buf; --q) {
+        if (q[-1] == ')') {
+            close_paren = q - 1;
+            break;
+        }
+    }
+    if (!open || !close_paren || close_paren < open) return -1;
+
+    size_t comm_len = (size_t)(close_paren - open - 1);
+    if (comm_len >= sizeof(out_stat->comm)) comm_len = sizeof(out_stat->comm) - 1;
+    memcpy(out_stat->comm, open + 1, comm_len);
+    out_stat->comm[comm_len] = '\0';
+
+    const char *p = procfs_skip_spaces(close_paren + 1, end);
+    if (p >= end) return -1;
+    out_stat->state = *p++;
+
+    /* Fields 4..13: ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt */
+    for (int i = 0; i < 10; ++i) p = procfs_skip_field(p, end);
+
+    unsigned long long utime = 0, stime = 0, threads = 0, starttime = 0, rss = 0;
+    if (!(p = procfs_parse_ull(p, end, &utime))) return -1;
+    if (!(p = procfs_parse_ull(p, end, &stime))) return -1;
+    /* Fields 16..19: cutime cstime priority nice */
+    for (int i = 0; i < 4; ++i) p = procfs_skip_field(p, end);
+    if (!(p = procfs_parse_ull(p, end, &threads))) return -1;
+    p = procfs_skip_field(p, end); /* 21: itrealvalue */
+    if (!(p = procfs_parse_ull(p, end, &starttime))) return -1;
+    p = procfs_skip_field(p, end); /* 23: vsize */
+    if (!procfs_parse_ull(p, end, &rss)) rss = 0;
+
+    out_stat->utime = utime;
+    out_stat->stime = stime;
+    out_stat->threads = (int)threads;
+    out_stat->starttime = starttime;
+    out_stat->rss_pages = (unsigned long)rss;
+    return 0;
+}
+
+int procfs_read_pid_uid(ProcfsReader *reader, pid_t pid, uid_t *out_uid)
+{
+    if (!reader) return -1;
+    ssize_t len = procfs_read_pid_file(reader, pid, "status", reader->buffer, sizeof(reader->buffer));
+    if (len <= 0) return -1;
+    const char *p = reader->buffer;
+    const char *end = reader->buffer + len;
+    while (p < end) {
+        if (procfs_has_prefix(p, end, "Uid:", 4)) {
+            unsigned long long uid = 0;
+            if (!procfs_parse_ull(p + 4, end, &uid)) return -1;
+            if (out_uid) *out_uid = (uid_t)uid;
+            return 0;
+        }
+        p = procfs_next_line(p, end);
+    }
+    return -1;
+}
+
+/* NUL separators in a raw cmdline become spaces; trailing NULs are dropped. */
+static int procfs_finish_cmdline(char *buffer, ssize_t got)
+{
+    if (got <= 0) {
+        buffer[0] = '\0';
+        return -1;
+    }
+    while (got > 0 && buffer[got - 1] == '\0') --got;
+    for (ssize_t i = 0; i < got; ++i) {
+        if (buffer[i] == '\0') buffer[i] = ' ';
+    }
+    buffer[got] = '\0';
+    return (int)got;
+}
+
+int procfs_read_pid_cmdline(ProcfsReader *reader, pid_t pid, char *buffer, size_t len)
+{
+    if (!buffer || len == 0) return -1;
+    buffer[0] = '\0';
+    return procfs_finish_cmdline(buffer, procfs_read_pid_file(reader, pid, "cmdline", buffer, len));
+}
+
+/* Builds "<root>/<pid>/<name>" (root NULL = "/proc"); returns -1 if it does not fit. */
+static int procfs_build_root_pid_path(char *out, size_t out_len, const char *root, pid_t pid, const char *name)
+{
+    if (pid <= 0) return -1;
+    if (!root || !root[0]) root = PROCFS_DEFAULT_ROOT;
+    size_t root_len = strlen(root);
+    if (root_len + 48 > out_len) return -1;
+    memcpy(out, root, root_len);
+    out[root_len] = '/';
+    procfs_build_pid_path(out + root_len + 1, out_len - root_len - 1, pid, name);
+    return 0;
+}
+
+static ssize_t procfs_read_path(const char *path, char *buffer, size_t len)
+{
+    int fd;
+    do {
+        fd = open(path, O_RDONLY | O_CLOEXEC);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) return -1;
+    ssize_t got = procfs_read_all(fd, buffer, len);
+    close(fd);
+    return got;
+}
+
+int procfs_read_pid_cmdline_path(const char *root, pid_t pid, char *buffer, size_t len)
+{
+    if (!buffer || len == 0) return -1;
+    buffer[0] = '\0';
+    char path[PATH_MAX];
+    if (procfs_build_root_pid_path(path, sizeof(path), root, pid, "cmdline") != 0) return -1;
+    return procfs_finish_cmdline(buffer, procfs_read_path(path, buffer, len));
+}
+
+/* Finds "<key>" at the start of a line and parses the number after it. */
+static int procfs_find_key_ull(const char *p, const char *end, const char *key, unsigned long long *out)
+{
+    size_t key_len = strlen(key);
+    while (p < end) {
+        if (procfs_has_prefix(p, end, key, key_len)) {
+            return procfs_parse_ull(p + key_len, end, out) ? 0 : -1;
+        }
+        p = procfs_next_line(p, end);
+    }
+    return -1;
+}
+
+int procfs_read_pid_details_path(const char *root, pid_t pid, ProcfsPidDetails *out)
+{
+    if (!out) return -1;
+    memset(out, 0, sizeof(*out));
+    char path[PATH_MAX];
+    /* smaps_rollup is about 1 KiB and io about 100 bytes. */
+    char buffer[4096];
+
+    if (procfs_build_root_pid_path(path, sizeof(path), root, pid, "smaps_rollup") != 0) return -1;
+    ssize_t got = procfs_read_path(path, buffer, sizeof(buffer));
+    if (got > 0 && procfs_find_key_ull(buffer, buffer + got, "Pss:", &out->pss_kb) == 0) {
+        out->valid |= PROCFS_DETAIL_PSS;
+    }
+
+    procfs_build_root_pid_path(path, sizeof(path), root, pid, "io");
+    got = procfs_read_path(path, buffer, sizeof(buffer));
+    if (got > 0 && procfs_find_key_ull(buffer, buffer + got, "read_bytes:", &out->read_bytes) == 0 &&
+        procfs_find_key_ull(buffer, buffer + got, "write_bytes:", &out->write_bytes) == 0) {
+        out->valid |= PROCFS_DETAIL_IO;
+    }
+
+    procfs_build_root_pid_path(path, sizeof(path), root, pid, "fd");
+    int is_proc = !root || !root[0] || strcmp(root, PROCFS_DEFAULT_ROOT) == 0;
+    struct stat st;
+    if (is_proc && stat(path, &st) == 0 && st.st_size > 0) {
+        /* Since Linux 6.2 the size of a proc fd directory is its entry count. */
+        out->fd_count = (int)st.st_size;
+        out->valid |= PROCFS_DETAIL_FDS;
+    } else {
+        DIR *dir = opendir(path);
+        if (dir) {
+            int count = 0;
+            struct dirent *entry;
+            while ((entry = readdir(dir)) != NULL) {
+                if (entry->d_name[0] != '.') count++;
+            }
+            closedir(dir);
+            out->fd_count = count;
+            out->valid |= PROCFS_DETAIL_FDS;
+        }
+    }
+    return out->valid ? 0 : -1;
+}
@@ -0,0 +1,152 @@
+#ifndef CK_SHARED_PROCFS_H
+#define CK_SHARED_PROCFS_H
+
+#include <dirent.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Small /proc reader shared by ck-load and ck-tasks.
+ *
+ * All paths are resolved relative to a directory descriptor for the proc
+ * root (openat), the system-wide files (/proc/stat, /proc/meminfo,
+ * /proc/loadavg, /proc/uptime) stay open between refreshes and are re-read
+ * with pread(), and every parser works on the reader's own buffer, so no
+ * call allocates memory after procfs_reader_open().
+ */
+
+#define PROCFS_DEFAULT_ROOT "/proc"
+/* Large enough for the cpuN lines of /proc/stat on machines with several hundred cores. */
+#define PROCFS_BUFFER_SIZE 65536
+#define PROCFS_COMM_MAX 64
+
+typedef struct {
+    int root_fd;
+    int stat_fd;
+    int meminfo_fd;
+    int loadavg_fd;
+    int uptime_fd;
+    int pressure_fds[3];    /* PROCFS_PRESSURE_*; -1 on kernels without PSI */
+    DIR *root_dir;
+    long page_size;
+    char buffer[PROCFS_BUFFER_SIZE];
+} ProcfsReader;
+
+typedef struct {
+    unsigned long long user;
+    unsigned long long nice;
+    unsigned long long system;
+    unsigned long long idle;
+    unsigned long long iowait;
+    unsigned long long irq;
+    unsigned long long softirq;
+    unsigned long long steal;
+} ProcfsCpuTimes;
+
+typedef struct {
+    unsigned long mem_total_kb;
+    unsigned long mem_available_kb;
+    unsigned long swap_total_kb;
+    unsigned long swap_free_kb;
+} ProcfsMemInfo;
+
+/* Pressure stall files under <root>/pressure. */
+enum {
+    PROCFS_PRESSURE_CPU,
+    PROCFS_PRESSURE_MEMORY,
+    PROCFS_PRESSURE_IO,
+    PROCFS_PRESSURE_COUNT,
+};
+
+/* One "some" or "full" line: share of time stalled, in percent, and total stall time. */
+typedef struct {
+    double avg10;
+    double avg60;
+    double avg300;
+    unsigned long long total_us;
+} ProcfsPressureLine;
+
+typedef struct {
+    ProcfsPressureLine some;
+    ProcfsPressureLine full; /* zero for cpu before Linux 5.13 */
+} ProcfsPressure;
+
+/* Bits of ProcfsPidDetails.valid: which files could be read. */
+enum {
+    PROCFS_DETAIL_PSS = 1 << 0,
+    PROCFS_DETAIL_IO = 1 << 1,
+    PROCFS_DETAIL_FDS = 1 << 2,
+};
+
+/* Per-process values that are too costly to read on every scan. */
+typedef struct {
+    unsigned int valid;
+    unsigned long long pss_kb;      /* smaps_rollup */
+    unsigned long long read_bytes;  /* io: bytes fetched from storage */
+    unsigned long long write_bytes;
+    int fd_count;
+} ProcfsPidDetails;
+
+typedef struct {
+    char comm[PROCFS_COMM_MAX];
+    char state;
+    unsigned long long utime;
+    unsigned long long stime;
+    int threads;
+    unsigned long long starttime; /* clock ticks after boot; with the pid, names one process */
+    unsigned long rss_pages;
+} ProcfsPidStat;
+
+/* Open the proc root (NULL = "/proc"). Returns 0 on success, -1 on failure. */
+int procfs_reader_open(ProcfsReader *reader, const char *root);
+void procfs_reader_close(ProcfsReader *reader);
+
+/* System-wide files, re-read through the descriptors kept open by the reader. */
+int procfs_read_cpu_times(ProcfsReader *reader, ProcfsCpuTimes *out_times);
+/* Aggregate plus per-core times from one read; out_cores[N] gets the cpuN line
+ * (offline cores stay zeroed). Returns the highest N + 1 seen, capped at
+ * max_cores, or -1. */
+int procfs_read_cpu_times_per_core(ProcfsReader *reader, ProcfsCpuTimes *out_total,
+                                   ProcfsCpuTimes *out_cores, int max_cores);
+int procfs_read_meminfo(ProcfsReader *reader, ProcfsMemInfo *out_info);
+int procfs_read_loadavg(ProcfsReader *reader, double *out_l1, double *out_l5, double *out_l15);
+int procfs_read_uptime(ProcfsReader *reader, double *out_seconds);
+/* resource is a PROCFS_PRESSURE_* value; -1 when PSI is not available. */
+int procfs_read_pressure(ProcfsReader *reader, int resource, ProcfsPressure *out_pressure);
+/* Registers a PSI trigger: the returned descriptor polls POLLPRI whenever
+ * "some" stall time exceeds stall_us within a window of window_us (at most
+ * one event per window). Unprivileged users need Linux 6.5 and a window that
+ * is a multiple of 2 s. Returns -1 if triggers are not available. */
+int procfs_open_pressure_trigger(ProcfsReader *reader, int resource, unsigned int stall_us,
+                                 unsigned int window_us);
+
+/* Totals derived from a ProcfsCpuTimes sample. */
+unsigned long long procfs_cpu_idle_ticks(const ProcfsCpuTimes *times);
+unsigned long long procfs_cpu_total_ticks(const ProcfsCpuTimes *times);
+
+/* Walk the numeric entries of the proc root. next() returns 1 per pid, 0 at the end. */
+int procfs_pid_iter_begin(ProcfsReader *reader);
+int procfs_pid_iter_next(ProcfsReader *reader, pid_t *out_pid);
+
+/* Per-process files (<root>/<pid>/...). */
+int procfs_read_pid_stat(ProcfsReader *reader, pid_t pid, ProcfsPidStat *out_stat);
+int procfs_read_pid_uid(ProcfsReader *reader, pid_t pid, uid_t *out_uid);
+/* Copies the command line with NUL separators replaced by spaces; returns its length or -1. */
+int procfs_read_pid_cmdline(ProcfsReader *reader, pid_t pid, char *buffer, size_t len);
+/* Same, without a reader: opens <root>/<pid>/cmdline directly (root NULL = "/proc"). */
+int procfs_read_pid_cmdline_path(const char *root, pid_t pid, char *buffer, size_t len);
+/* Reads smaps_rollup, io and the fd directory of <root>/<pid> without a reader,
+ * so it may run on any thread. Files that cannot be read (usually another
+ * user's process) leave their bit in out->valid clear. Returns -1 if none
+ * could be read. */
+int procfs_read_pid_details_path(const char *root, pid_t pid, ProcfsPidDetails *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CK_SHARED_PROCFS_H */
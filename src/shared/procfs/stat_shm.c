@@ -0,0 +1,349 @@
+#include "stat_shm.h"
+
+#include "../tool_utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define STAT_SHM_MAGIC 0x636b7364u /* "cksd" */
+/* How often a reader looks for the segment again after it went missing or stale. */
+#define STAT_SHM_RETRY_MS 5000
+/* A sample older than this many intervals (plus a second of slack) is stale. */
+#define STAT_SHM_STALE_INTERVALS 2
+/* Reads that keep racing the writer give up and let the caller read /proc. */
+#define STAT_SHM_READ_ATTEMPTS 8
+/* Times the daemon replaces a stale segment before giving up. */
+#define STAT_SHM_CREATE_ATTEMPTS 3
+
+struct StatShmSegment {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int sequence;    /* seqlock: odd while the daemon writes */
+    unsigned int interval_ms;
+    unsigned int max_cores;   /* entries in cores[] */
+    unsigned int sample_size; /* sizeof(StatShmSample) of the writer */
+    long long updated_ms;     /* CLOCK_MONOTONIC time of the last publish */
+    StatShmSample sample;
+    ProcfsCpuTimes cores[];
+};
+
+static size_t stat_shm_segment_size(int max_cores)
+{
+    return offsetof(StatShmSegment, cores) + sizeof(ProcfsCpuTimes) * (size_t)max_cores;
+}
+
+/* ---------- Sampling /proc ---------- */
+
+int stat_shm_sample_procfs(ProcfsReader *reader, StatShmSample *out_sample,
+                           ProcfsCpuTimes *out_cores, int max_cores)
+{
+    if (!reader || !out_sample) return -1;
+    memset(out_sample, 0, sizeof(*out_sample));
+    if (out_cores && max_cores > 0) {
+        int filled = procfs_read_cpu_times_per_core(reader, &out_sample->cpu, out_cores, max_cores);
+        if (filled < 0) return -1;
+        out_sample->core_count = filled;
+    } else if (procfs_read_cpu_times(reader, &out_sample->cpu) != 0) {
+        return -1;
+    }
+    out_sample->valid = STAT_SHM_HAVE_CPU;
+    out_sample->sampled_ms = tool_now_ms();
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    out_sample->online_cores = online > 0 ? (int)online : 1;
+    if (procfs_read_meminfo(reader, &out_sample->memory) == 0) {
+        out_sample->valid |= STAT_SHM_HAVE_MEMINFO;
+    }
+    if (procfs_read_loadavg(reader, &out_sample->load1, &out_sample->load5, &out_sample->load15) == 0) {
+        out_sample->valid |= STAT_SHM_HAVE_LOADAVG;
+    }
+    for (int i = 0; i < PROCFS_PRESSURE_COUNT; ++i) {
+        if (procfs_read_pressure(reader, i, &out_sample->pressure[i]) == 0) {
+            out_sample->valid |= STAT_SHM_HAVE_PRESSURE;
+        }
+    }
+    return 0;
+}
+
+/* ---------- Reader ---------- */
+
+void stat_shm_reader_init(StatShmReader *reader)
+{
+    if (!reader) return;
+    reader->segment = NULL;
+    reader->size = 0;
+    reader->next_open_ms = 0;
+    reader->fd = -1;
+    reader->next_check_ms = 0;
+}
+
+static void stat_shm_reader_unmap(StatShmReader *reader)
+{
+    if (reader->segment) {
+        munmap((void *)reader->segment, reader->size);
+        close(reader->fd);
+    }
+    reader->segment = NULL;
+    reader->size = 0;
+    reader->fd = -1;
+}
+
+void stat_shm_reader_close(StatShmReader *reader)
+{
+    if (!reader) return;
+    stat_shm_reader_unmap(reader);
+    reader->next_open_ms = 0;
+}
+
+/* Anyone can create the name first: trust only root's or our own segment,
+ * and only if no one else may write it or truncate it under the mapping. */
+static int stat_shm_trusted(const struct stat *st)
+{
+    if (st->st_uid != 0 && st->st_uid != getuid()) return 0;
+    if (st->st_mode & (S_IWGRP | S_IWOTH)) return 0;
+    return 1;
+}
+
+static int stat_shm_reader_map(StatShmReader *reader)
+{
+    int fd = shm_open(STAT_SHM_NAME, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && stat_shm_trusted(&st) && (size_t)st.st_size >= sizeof(StatShmSegment)) {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    reader->segment = (const StatShmSegment *)map;
+    reader->size = (size_t)st.st_size;
+    reader->fd = fd;
+    return 0;
+}
+
+/* 0 while the mapped segment still has the owner, mode and size it was mapped with. */
+static int stat_shm_reader_check(const StatShmReader *reader)
+{
+    struct stat st;
+    if (fstat(reader->fd, &st) != 0 || !stat_shm_trusted(&st)) return -1;
+    return (size_t)st.st_size == reader->size ? 0 : -1;
+}
+
+int stat_shm_read(StatShmReader *reader, StatShmSample *out_sample,
+                  ProcfsCpuTimes *out_cores, int max_cores)
+{
+    if (!reader || !out_sample) return -1;
+    long long now = tool_now_ms();
+    if (reader->segment && now >= reader->next_check_ms) {
+        if (stat_shm_reader_check(reader) != 0) {
+            /* Resized or no longer trusted: map whatever has the name now. */
+            stat_shm_reader_unmap(reader);
+            reader->next_open_ms = 0;
+        } else {
+            reader->next_check_ms = now + STAT_SHM_RETRY_MS;
+        }
+    }
+    if (!reader->segment) {
+        if (now < reader->next_open_ms) return -1;
+        if (stat_shm_reader_map(reader) != 0) {
+            reader->next_open_ms = now + STAT_SHM_RETRY_MS;
+            return -1;
+        }
+        reader->next_check_ms = now + STAT_SHM_RETRY_MS;
+    }
+
+    const StatShmSegment *segment = reader->segment;
+    for (int attempt = 0; attempt < STAT_SHM_READ_ATTEMPTS; ++attempt) {
+        unsigned int before = __atomic_load_n(&segment->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1u) continue;
+        if (segment->magic != STAT_SHM_MAGIC || segment->version != STAT_SHM_VERSION ||
+            segment->sample_size != sizeof(StatShmSample) ||
+            stat_shm_segment_size((int)segment->max_cores) > reader->size) {
+            /* The checks can only fail for good on a settled header. */
+            if (__atomic_load_n(&segment->sequence, __ATOMIC_ACQUIRE) != before) continue;
+            /* A segment that grew is mapped again on the next read. */
+            int resized = stat_shm_reader_check(reader) != 0;
+            stat_shm_reader_unmap(reader);
+            reader->next_open_ms = resized ? now : now + STAT_SHM_RETRY_MS;
+            return -1;
+        }
+        int published = (int)segment->max_cores;
+        long long updated_ms = segment->updated_ms;
+        unsigned int interval_ms = segment->interval_ms;
+        memcpy(out_sample, &segment->sample, sizeof(*out_sample));
+        int copy = out_sample->core_count;
+        if (copy > published) copy = published;
+        if (copy > max_cores) copy = max_cores;
+        if (copy < 0 || !out_cores) copy = 0;
+        if (copy > 0) memcpy(out_cores, segment->cores, sizeof(ProcfsCpuTimes) * (size_t)copy);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&segment->sequence, __ATOMIC_RELAXED) != before) continue;
+
+        if (now - updated_ms > (long long)interval_ms * STAT_SHM_STALE_INTERVALS + 1000) {
+            /* The daemon died without cleaning up, or is stuck. */
+            stat_shm_reader_unmap(reader);
+            reader->next_open_ms = now + STAT_SHM_RETRY_MS;
+            return -1;
+        }
+        if (out_cores && max_cores > copy) {
+            memset(out_cores + copy, 0, sizeof(ProcfsCpuTimes) * (size_t)(max_cores - copy));
+        }
+        out_sample->core_count = copy;
+        return 0;
+    }
+    return -1;
+}
+
+/* ---------- Writer ---------- */
+
+static void stat_shm_write_begin(StatShmSegment *segment)
+{
+    unsigned int sequence = __atomic_load_n(&segment->sequence, __ATOMIC_RELAXED);
+    /* Left odd by a writer that crashed mid-update. */
+    sequence |= 1u;
+    __atomic_store_n(&segment->sequence, sequence, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void stat_shm_write_end(StatShmSegment *segment)
+{
+    unsigned int sequence = __atomic_load_n(&segment->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&segment->sequence, sequence + 1u, __ATOMIC_RELEASE);
+}
+
+/*
+ * Creates the segment with O_EXCL so it is never one someone else prepared.
+ * A segment that already has the name is left alone while a live daemon
+ * holds its lock, and otherwise unlinked and created again.
+ */
+static int stat_shm_writer_create(char *error, size_t error_len)
+{
+    int saved = EEXIST;
+    for (int attempt = 0; attempt < STAT_SHM_CREATE_ATTEMPTS; ++attempt) {
+        int fd = shm_open(STAT_SHM_NAME, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd >= 0) return fd;
+        saved = errno;
+        if (saved != EEXIST) break;
+        int old = shm_open(STAT_SHM_NAME, O_RDONLY | O_CLOEXEC, 0);
+        if (old >= 0) {
+            int running = flock(old, LOCK_EX | LOCK_NB) != 0 && errno == EWOULDBLOCK;
+            close(old);
+            if (running) {
+                if (error && error_len > 0) snprintf(error, error_len, "another ck-statd is running");
+                errno = EWOULDBLOCK;
+                return -1;
+            }
+        }
+        if (shm_unlink(STAT_SHM_NAME) != 0 && errno != ENOENT) {
+            saved = errno;
+            if (error && error_len > 0) {
+                snprintf(error, error_len, "cannot replace %s: %s", STAT_SHM_NAME, strerror(saved));
+            }
+            errno = saved;
+            return -1;
+        }
+    }
+    if (error && error_len > 0) snprintf(error, error_len, "shm_open %s: %s", STAT_SHM_NAME, strerror(saved));
+    errno = saved;
+    return -1;
+}
+
+int stat_shm_writer_open(StatShmWriter *writer, int max_cores, int interval_ms,
+                         char *error, size_t error_len)
+{
+    if (!writer || max_cores < 1 || max_cores > STAT_SHM_MAX_CORES || interval_ms <= 0) {
+        if (error && error_len > 0) snprintf(error, error_len, "invalid arguments");
+        errno = EINVAL;
+        return -1;
+    }
+    writer->fd = -1;
+    writer->segment = NULL;
+    writer->size = 0;
+    writer->max_cores = max_cores;
+
+    int fd = stat_shm_writer_create(error, error_len);
+    if (fd < 0) return -1;
+    /* The lock is dropped with the descriptor, so a crashed daemon never blocks a new one. */
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        int saved = errno;
+        if (error && error_len > 0) {
+            snprintf(error, error_len, "%s", saved == EWOULDBLOCK ? "another ck-statd is running" : strerror(saved));
+        }
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    fchmod(fd, 0644); /* whatever the umask, other users may read */
+
+    size_t size = stat_shm_segment_size(max_cores);
+    void *map = MAP_FAILED;
+    if (ftruncate(fd, (off_t)size) == 0) {
+        map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (map == MAP_FAILED) {
+        int saved = errno;
+        if (error && error_len > 0) snprintf(error, error_len, "cannot map %s: %s", STAT_SHM_NAME, strerror(saved));
+        shm_unlink(STAT_SHM_NAME);
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+
+    StatShmSegment *segment = (StatShmSegment *)map;
+    stat_shm_write_begin(segment);
+    segment->magic = STAT_SHM_MAGIC;
+    segment->version = STAT_SHM_VERSION;
+    segment->interval_ms = (unsigned int)interval_ms;
+    segment->max_cores = (unsigned int)max_cores;
+    segment->sample_size = sizeof(StatShmSample);
+    segment->updated_ms = 0;
+    memset(&segment->sample, 0, sizeof(segment->sample));
+    stat_shm_write_end(segment);
+
+    writer->fd = fd;
+    writer->segment = segment;
+    writer->size = size;
+    return 0;
+}
+
+void stat_shm_writer_publish(StatShmWriter *writer, const StatShmSample *sample,
+                             const ProcfsCpuTimes *cores)
+{
+    if (!writer || !writer->segment || !sample) return;
+    StatShmSegment *segment = writer->segment;
+    unsigned long long serial = segment->sample.serial + 1;
+    int core_count = cores ? sample->core_count : 0;
+    if (core_count > writer->max_cores) core_count = writer->max_cores;
+    if (core_count < 0) core_count = 0;
+
+    stat_shm_write_begin(segment);
+    segment->sample = *sample;
+    segment->sample.serial = serial;
+    segment->sample.core_count = core_count;
+    if (core_count > 0) memcpy(segment->cores, cores, sizeof(ProcfsCpuTimes) * (size_t)core_count);
+    segment->updated_ms = tool_now_ms();
+    stat_shm_write_end(segment);
+}
+
+void stat_shm_writer_close(StatShmWriter *writer)
+{
+    if (!writer || !writer->segment) return;
+    stat_shm_write_begin(writer->segment);
+    writer->segment->magic = 0;
+    stat_shm_write_end(writer->segment);
+    munmap(writer->segment, writer->size);
+    shm_unlink(STAT_SHM_NAME);
+    close(writer->fd);
+    writer->segment = NULL;
+    writer->size = 0;
+    writer->fd = -1;
+}
@@ -0,0 +1,100 @@
+#ifndef CK_SHARED_STAT_SHM_H
+#define CK_SHARED_STAT_SHM_H
+
+#include <stddef.h>
+
+#include "procfs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * System statistics published by ck-statd in POSIX shared memory.
+ *
+ * ck-statd reads /proc/stat, /proc/meminfo, /proc/loadavg and the PSI files
+ * once per interval and writes the result into STAT_SHM_NAME under a
+ * seqlock: the sequence counter is odd while the daemon writes, and readers
+ * retry when it changed under them. Once the segment is mapped a read is a
+ * memcpy plus clock_gettime (vDSO), with no system call.
+ *
+ * stat_shm_read() fails when the daemon is not running, has exited, or has
+ * not updated the segment for a few intervals; callers then sample /proc
+ * themselves with stat_shm_sample_procfs(), so the daemon is optional.
+ *
+ * The name is fixed, so readers only map a segment owned by root or by
+ * themselves that no one else can write, and the daemon always creates a
+ * fresh one rather than reusing whatever already has the name.
+ */
+
+#define STAT_SHM_NAME "/ck-statd"
+#define STAT_SHM_VERSION 1
+#define STAT_SHM_MAX_CORES 1024
+
+/* Bits of StatShmSample.valid: which files could be read. */
+enum {
+    STAT_SHM_HAVE_CPU = 1 << 0,
+    STAT_SHM_HAVE_MEMINFO = 1 << 1,
+    STAT_SHM_HAVE_LOADAVG = 1 << 2,
+    STAT_SHM_HAVE_PRESSURE = 1 << 3,
+};
+
+typedef struct {
+    unsigned long long serial; /* bumped per daemon sample; 0 for a direct read */
+    long long sampled_ms;      /* CLOCK_MONOTONIC time the files were read */
+    unsigned int valid;        /* STAT_SHM_HAVE_* */
+    int online_cores;
+    int core_count;            /* per-core entries that follow the sample */
+    ProcfsCpuTimes cpu;
+    ProcfsMemInfo memory;
+    double load1;
+    double load5;
+    double load15;
+    ProcfsPressure pressure[PROCFS_PRESSURE_COUNT];
+} StatShmSample;
+
+typedef struct StatShmSegment StatShmSegment;
+
+typedef struct {
+    const StatShmSegment *segment; /* NULL while not mapped */
+    size_t size;
+    long long next_open_ms;        /* throttles shm_open while the daemon is away */
+    int fd;                        /* open while mapped, to re-check owner and size */
+    long long next_check_ms;       /* next fstat of the mapped segment */
+} StatShmReader;
+
+typedef struct {
+    int fd;
+    StatShmSegment *segment;
+    size_t size;
+    int max_cores;
+} StatShmWriter;
+
+/* Fills a sample straight from /proc; out_cores (max_cores entries) may be NULL.
+ * Returns -1 only if /proc/stat could not be read. */
+int stat_shm_sample_procfs(ProcfsReader *reader, StatShmSample *out_sample,
+                           ProcfsCpuTimes *out_cores, int max_cores);
+
+void stat_shm_reader_init(StatShmReader *reader);
+void stat_shm_reader_close(StatShmReader *reader);
+/* Copies the daemon's latest sample and up to max_cores per-core entries
+ * (the rest of out_cores is zeroed). Returns -1 if no fresh sample is
+ * published; the segment is then looked for again every few seconds. */
+int stat_shm_read(StatShmReader *reader, StatShmSample *out_sample,
+                  ProcfsCpuTimes *out_cores, int max_cores);
+
+/* Creates the segment, replacing one left by a daemon that exited without
+ * unlinking it. Returns -1 with a message in error, and errno EWOULDBLOCK
+ * if another ck-statd already publishes it. */
+int stat_shm_writer_open(StatShmWriter *writer, int max_cores, int interval_ms,
+                         char *error, size_t error_len);
+void stat_shm_writer_publish(StatShmWriter *writer, const StatShmSample *sample,
+                             const ProcfsCpuTimes *cores);
+/* Invalidates and unlinks the segment so readers fall back at once. */
+void stat_shm_writer_close(StatShmWriter *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CK_SHARED_STAT_SHM_H */
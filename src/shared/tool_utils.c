@@ -0,0 +1,30 @@
+#include "tool_utils.h"
+
+#include <string.h>
+
+const char *tool_option_value(int argc, char **argv, int *index, const char *name)
+{
+    size_t len = strlen(name);
+    const char *arg = argv[*index];
+    if (strncmp(arg, name, len) != 0) return NULL;
+    if (arg[len] == '=') return arg + len + 1;
+    if (arg[len] != '\0' || *index + 1 >= argc) return NULL;
+    return argv[++*index];
+}
+
+long long tool_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000LL + ts.tv_nsec / 1000000L;
+}
+
+void tool_timespec_add_ms(struct timespec *ts, int ms)
+{
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
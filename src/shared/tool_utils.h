@@ -0,0 +1,24 @@
+#ifndef CK_SHARED_TOOL_UTILS_H
+#define CK_SHARED_TOOL_UTILS_H
+
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Value of option name at argv[*index], given as "--name value" or
+ * "--name=value"; advances *index past a separate value. NULL when
+ * argv[*index] is not that option or the value is missing. */
+const char *tool_option_value(int argc, char **argv, int *index, const char *name);
+
+/* CLOCK_MONOTONIC in milliseconds. */
+long long tool_now_ms(void);
+/* Moves ts forward by ms (0 <= ms), keeping tv_nsec normalised. */
+void tool_timespec_add_ms(struct timespec *ts, int ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CK_SHARED_TOOL_UTILS_H */
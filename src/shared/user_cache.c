@@ -0,0 +1,179 @@
+#include "user_cache.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <pwd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define USER_CACHE_DEFAULT_PASSWD "/etc/passwd"
+#define USER_CACHE_INITIAL_CAPACITY 64
+#define USER_CACHE_NAME_MAX 64
+/* getpwuid_r() scratch on the stack; larger entries retry on the heap up to the limit. */
+#define USER_CACHE_PW_BUFFER 4096
+#define USER_CACHE_PW_BUFFER_MAX (1024 * 1024)
+
+typedef struct {
+    uid_t uid;
+    int used;
+    int has_name;
+    char name[USER_CACHE_NAME_MAX];
+} UserCacheEntry;
+
+/* The sampler thread and the UI thread both look names up. */
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static UserCacheEntry *g_entries = NULL;
+static int g_count = 0;
+static int g_capacity = 0;
+static char g_passwd_path[PATH_MAX] = USER_CACHE_DEFAULT_PASSWD;
+static struct stat g_passwd_stat;
+static int g_passwd_stat_valid = 0;
+static time_t g_last_check = 0;
+
+static void user_cache_flush(void)
+{
+    if (g_entries && g_capacity > 0) {
+        memset(g_entries, 0, sizeof(UserCacheEntry) * (size_t)g_capacity);
+    }
+    g_count = 0;
+}
+
+static int passwd_changed(const struct stat *a, const struct stat *b)
+{
+    return a->st_dev != b->st_dev || a->st_ino != b->st_ino || a->st_size != b->st_size ||
+           a->st_mtim.tv_sec != b->st_mtim.tv_sec || a->st_mtim.tv_nsec != b->st_mtim.tv_nsec;
+}
+
+/* Flush the cache if the passwd file was replaced or edited since the last check. */
+static void user_cache_revalidate(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (g_passwd_stat_valid && now.tv_sec == g_last_check) return;
+    g_last_check = now.tv_sec;
+
+    struct stat st;
+    if (stat(g_passwd_path, &st) != 0) {
+        /* No file to watch (NSS-only setups): keep what we have. */
+        return;
+    }
+    if (g_passwd_stat_valid && passwd_changed(&st, &g_passwd_stat)) {
+        user_cache_flush();
+    }
+    g_passwd_stat = st;
+    g_passwd_stat_valid = 1;
+}
+
+static UserCacheEntry *find_slot(UserCacheEntry *table, int capacity, uid_t uid)
+{
+    unsigned int mask = (unsigned int)(capacity - 1);
+    unsigned int slot = ((unsigned int)uid * 2654435769u) & mask;
+    while (table[slot].used && table[slot].uid != uid) {
+        slot = (slot + 1) & mask;
+    }
+    return &table[slot];
+}
+
+static int user_cache_grow(void)
+{
+    if (g_capacity > INT_MAX / 2) return -1;
+    int new_capacity = g_capacity ? g_capacity * 2 : USER_CACHE_INITIAL_CAPACITY;
+    UserCacheEntry *table = (UserCacheEntry *)calloc((size_t)new_capacity, sizeof(UserCacheEntry));
+    if (!table) return -1;
+    for (int i = 0; i < g_capacity; ++i) {
+        if (!g_entries[i].used) continue;
+        *find_slot(table, new_capacity, g_entries[i].uid) = g_entries[i];
+    }
+    free(g_entries);
+    g_entries = table;
+    g_capacity = new_capacity;
+    return 0;
+}
+
+/*
+ * Copies the user name into name (empty when uid has no entry). Returns -1
+ * if the lookup itself failed (NSS error, or an entry beyond the buffer
+ * limit), which says nothing about the uid and must not be cached.
+ */
+static int user_cache_getpw(uid_t uid, char *name, size_t name_len)
+{
+    struct passwd pwd;
+    struct passwd *pw = NULL;
+    char stack_buffer[USER_CACHE_PW_BUFFER];
+    char *buffer = stack_buffer;
+    size_t size = sizeof(stack_buffer);
+    int rc;
+    name[0] = '\0';
+    while ((rc = getpwuid_r(uid, &pwd, buffer, size, &pw)) == ERANGE && size < USER_CACHE_PW_BUFFER_MAX) {
+        size *= 2;
+        char *grown = (char *)(buffer == stack_buffer ? malloc(size) : realloc(buffer, size));
+        if (!grown) break;
+        buffer = grown;
+    }
+    if (rc == 0 && pw && pw->pw_name) snprintf(name, name_len, "%s", pw->pw_name);
+    if (buffer != stack_buffer) free(buffer);
+    return rc == 0 ? 0 : -1;
+}
+
+int user_cache_lookup(uid_t uid, char *buf, size_t len)
+{
+    if (!buf || len == 0) return 0;
+    buf[0] = '\0';
+    pthread_mutex_lock(&g_lock);
+    user_cache_revalidate();
+    if (g_capacity > 0) {
+        const UserCacheEntry *entry = find_slot(g_entries, g_capacity, uid);
+        if (entry->used) {
+            if (entry->has_name) snprintf(buf, len, "%s", entry->name);
+            pthread_mutex_unlock(&g_lock);
+            return entry->has_name;
+        }
+    }
+
+    char name[USER_CACHE_NAME_MAX];
+    int found = user_cache_getpw(uid, name, sizeof(name));
+    int has_name = (found == 0 && name[0]);
+    if (has_name) snprintf(buf, len, "%s", name);
+    /* Failed lookups are retried next time; out of memory answers uncached. */
+    if (found == 0 && ((g_count + 1) * 2 <= g_capacity || user_cache_grow() == 0)) {
+        UserCacheEntry *entry = find_slot(g_entries, g_capacity, uid);
+        entry->used = 1;
+        entry->uid = uid;
+        entry->has_name = has_name;
+        snprintf(entry->name, sizeof(entry->name), "%s", name);
+        g_count++;
+    }
+    pthread_mutex_unlock(&g_lock);
+    return has_name;
+}
+
+void user_cache_format(uid_t uid, char *buf, size_t len)
+{
+    if (!buf || len == 0) return;
+    if (!user_cache_lookup(uid, buf, len)) snprintf(buf, len, "%d", (int)uid);
+}
+
+void user_cache_set_passwd_path(const char *path)
+{
+    pthread_mutex_lock(&g_lock);
+    snprintf(g_passwd_path, sizeof(g_passwd_path), "%s",
+             (path && path[0]) ? path : USER_CACHE_DEFAULT_PASSWD);
+    g_passwd_stat_valid = 0;
+    user_cache_flush();
+    pthread_mutex_unlock(&g_lock);
+}
+
+void user_cache_clear(void)
+{
+    pthread_mutex_lock(&g_lock);
+    free(g_entries);
+    g_entries = NULL;
+    g_count = 0;
+    g_capacity = 0;
+    g_passwd_stat_valid = 0;
+    pthread_mutex_unlock(&g_lock);
+}
@@ -0,0 +1,29 @@
+#ifndef USER_CACHE_H
+#define USER_CACHE_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/* Cached uid -> login name lookups.
+ *
+ * getpwuid() can be slow with NSS/LDAP backends, while a process list only
+ * contains a handful of distinct uids. Results, including uids that have no
+ * name, are kept until the passwd file changes (checked at most once per
+ * second by stat()ing it). Safe to call from several threads; names are
+ * copied out, so no caller holds a pointer into the cache.
+ */
+
+/* Copies the login name for uid into buf and returns 1, or leaves buf empty
+ * and returns 0 if the uid has no passwd entry. */
+int user_cache_lookup(uid_t uid, char *buf, size_t len);
+
+/* Copy the login name for uid into buf, or the numeric uid if it has no name. */
+void user_cache_format(uid_t uid, char *buf, size_t len);
+
+/* Watch a different passwd file for invalidation (NULL = /etc/passwd). */
+void user_cache_set_passwd_path(const char *path);
+
+/* Drop all cached entries and release their memory. */
+void user_cache_clear(void);
+
+#endif /* USER_CACHE_H */